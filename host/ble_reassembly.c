@@ -0,0 +1,170 @@
+/******************************************************************************
+* File Name:   ble_reassembly.c
+*
+* Description: This file implements the reassembly of the send requests that
+*              the BLE streaming interface fragments to the MTU. Each
+*              notification starts with a sequence number and the first/last
+*              flags; a request missing a notification is dropped.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ble_reassembly.h"
+#include "mtb_data_streaming.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define BLE_REASSEMBLY_INITIAL_CAPACITY (4u * 1024u)
+
+/*******************************************************************************
+* Function Name: ble_reassembly_init
+********************************************************************************
+* Summary:
+*    Sets up a reassembly.
+*
+*******************************************************************************/
+void ble_reassembly_init(ble_reassembly_t *reassembly, ble_reassembly_deliver_t deliver,
+                         void *context)
+{
+    memset(reassembly, 0, sizeof(*reassembly));
+    reassembly->deliver = deliver;
+    reassembly->context = context;
+}
+
+/*******************************************************************************
+* Function Name: ble_reassembly_feed
+********************************************************************************
+* Summary:
+*    Adds the value of a notification to the request being reassembled, and
+*    delivers the request on its last notification.
+*
+* Return:
+*     0 on success, -1 if the memory could not be allocated.
+*
+*******************************************************************************/
+int ble_reassembly_feed(ble_reassembly_t *reassembly, const uint8_t *notification, size_t count)
+{
+    uint8_t sequence;
+    uint8_t flags;
+
+    if (count < MTB_DATA_STREAMING_BLE_HEADER_SIZE)
+    {
+        reassembly->malformed++;
+        return 0;
+    }
+    reassembly->notifications++;
+    sequence = notification[0];
+    flags = notification[1];
+    notification += MTB_DATA_STREAMING_BLE_HEADER_SIZE;
+    count -= MTB_DATA_STREAMING_BLE_HEADER_SIZE;
+
+    if ((true == reassembly->started) && (sequence != reassembly->expected))
+    {
+        reassembly->lost += (uint8_t)(sequence - reassembly->expected);
+        if (true == reassembly->in_block)
+        {
+            reassembly->dropped++;
+            reassembly->in_block = false;
+        }
+    }
+    reassembly->expected = (uint8_t)(sequence + 1u);
+    reassembly->started = true;
+
+    if (0u != (flags & MTB_DATA_STREAMING_BLE_FIRST))
+    {
+        if (true == reassembly->in_block)
+        {
+            /* The last notification of the previous request never came */
+            reassembly->dropped++;
+        }
+        reassembly->in_block = true;
+        reassembly->size = 0;
+    }
+    if (false == reassembly->in_block)
+    {
+        /* Rest of a dropped request */
+        return 0;
+    }
+
+    if ((reassembly->size + count) > reassembly->capacity)
+    {
+        size_t capacity = (0u != reassembly->capacity) ? reassembly->capacity
+                                                       : BLE_REASSEMBLY_INITIAL_CAPACITY;
+        uint8_t *block;
+
+        while (capacity < (reassembly->size + count))
+        {
+            capacity *= 2u;
+        }
+        block = realloc(reassembly->block, capacity);
+        if (NULL == block)
+        {
+            return -1;
+        }
+        reassembly->block = block;
+        reassembly->capacity = capacity;
+    }
+    memcpy(&reassembly->block[reassembly->size], notification, count);
+    reassembly->size += count;
+
+    if (0u != (flags & MTB_DATA_STREAMING_BLE_LAST))
+    {
+        reassembly->blocks++;
+        reassembly->in_block = false;
+        reassembly->deliver(reassembly->context, reassembly->block, reassembly->size);
+    }
+    return 0;
+}
+
+/*******************************************************************************
+* Function Name: ble_reassembly_free
+********************************************************************************
+* Summary:
+*    Releases the memory of a reassembly.
+*
+*******************************************************************************/
+void ble_reassembly_free(ble_reassembly_t *reassembly)
+{
+    free(reassembly->block);
+    reassembly->block = NULL;
+    reassembly->capacity = 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,85 @@
+/******************************************************************************
+* File Name:   ble_reassembly.h
+*
+* Description: This file contains the declarations of the reassembly of the
+*              send requests fragmented in BLE notifications by the streaming
+*              interface.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef HOST_BLE_REASSEMBLY_H_
+#define HOST_BLE_REASSEMBLY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Called with the data of each send request reassembled */
+typedef void (*ble_reassembly_deliver_t)(void *context, const uint8_t *data, size_t count);
+
+typedef struct
+{
+    ble_reassembly_deliver_t deliver;
+    void *context;
+
+    uint8_t *block;             /* Send request being reassembled */
+    size_t size;
+    size_t capacity;
+    bool in_block;              /* The first notification of the request was received */
+    uint8_t expected;           /* Sequence number of the next notification */
+    bool started;
+
+    uint32_t notifications;     /* Notifications received, statistics follow */
+    uint32_t blocks;
+    uint32_t lost;              /* Notifications missing from the sequence */
+    uint32_t dropped;           /* Send requests incomplete */
+    uint32_t malformed;
+} ble_reassembly_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void ble_reassembly_init(ble_reassembly_t *reassembly, ble_reassembly_deliver_t deliver,
+                         void *context);
+int ble_reassembly_feed(ble_reassembly_t *reassembly, const uint8_t *notification, size_t count);
+void ble_reassembly_free(ble_reassembly_t *reassembly);
+
+
+#endif /* HOST_BLE_REASSEMBLY_H_ */
@@ -0,0 +1,172 @@
+/******************************************************************************
+* File Name:   ble_receive.c
+*
+* Description: Host tool that reassembles the data streamed by the device in
+*              BLE notifications and writes it to a file. The notifications are
+*              read from the standard input, as printed by the BlueZ tools:
+*              the hex bytes following "value:" on each line, e.g.
+*
+*              gatttool -b <address> --char-write-req --handle=<cccd>
+*                       --value=0100 --listen | ble_receive <output>
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ble_reassembly.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define BLE_RECEIVE_LINE_SIZE       (4096u)
+#define BLE_RECEIVE_MAX_VALUE       (512u)
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static size_t parse_value(const char *line, uint8_t *value);
+static void write_block(void *context, const uint8_t *data, size_t count);
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+*    Reassembles the notifications until the end of the input.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    static char line[BLE_RECEIVE_LINE_SIZE];
+    uint8_t value[BLE_RECEIVE_MAX_VALUE];
+    ble_reassembly_t reassembly;
+    uint64_t written = 0;
+    FILE *output;
+    size_t count;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: <notifications> | %s <output>\n", argv[0]);
+        return 1;
+    }
+    output = fopen(argv[1], "wb");
+    if (NULL == output)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    ble_reassembly_init(&reassembly, write_block, output);
+    while (NULL != fgets(line, sizeof(line), stdin))
+    {
+        count = parse_value(line, value);
+        if ((0u != count) && (0 != ble_reassembly_feed(&reassembly, value, count)))
+        {
+            fprintf(stderr, "out of memory\n");
+            break;
+        }
+    }
+    written = (uint64_t)ftell(output);
+
+    fprintf(stderr, "%u notifications, %u requests (%llu bytes), %u notifications lost, "
+            "%u requests dropped, %u malformed\n", reassembly.notifications, reassembly.blocks,
+            (unsigned long long)written, reassembly.lost, reassembly.dropped,
+            reassembly.malformed);
+    ble_reassembly_free(&reassembly);
+    fclose(output);
+    return 0;
+}
+
+/*******************************************************************************
+* Function Name: parse_value
+********************************************************************************
+* Summary:
+*    Parses the hex bytes following "value:" in a line of the BlueZ tools.
+*
+* Return:
+*     The number of bytes parsed, 0 if the line is not a notification.
+*
+*******************************************************************************/
+static size_t parse_value(const char *line, uint8_t *value)
+{
+    const char *start = NULL;
+    size_t count = 0;
+    char *end;
+
+    for (const char *c = line; ('\0' != *c) && (NULL == start); c++)
+    {
+        if (0 == strncmp(c, "alue:", 5u) && (c > line) && ('v' == tolower((unsigned char)c[-1])))
+        {
+            start = c + 5;
+        }
+    }
+    if (NULL == start)
+    {
+        return 0;
+    }
+
+    while (count < BLE_RECEIVE_MAX_VALUE)
+    {
+        unsigned long byte = strtoul(start, &end, 16);
+        if ((end == start) || (byte > 0xFFu))
+        {
+            break;
+        }
+        value[count++] = (uint8_t)byte;
+        start = end;
+    }
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: write_block
+********************************************************************************
+* Summary:
+*    Writes a reassembled request to the output file.
+*
+*******************************************************************************/
+static void write_block(void *context, const uint8_t *data, size_t count)
+{
+    if (fwrite(data, 1, count, (FILE *)context) != count)
+    {
+        perror("write");
+    }
+}
+
+/* [] END OF FILE */
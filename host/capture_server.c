@@ -0,0 +1,1135 @@
+/******************************************************************************
+* File Name:   capture_server.c
+*
+* Description: Host service that captures the streams of many devices at
+*              once, on a single epoll event loop (Linux). Each endpoint is a
+*              serial port, a device to connect to over TCP (tcp:host:port)
+*              or a port the devices connect to (listen:port). The stream of
+*              each device is written to its own file, its records are
+*              parsed to count the missing ones, and the throughput and loss
+*              of every device are printed at a regular interval. The memory
+*              used per device is fixed. Serial ports and TCP devices that
+*              disconnect are opened again at each report.
+*
+*              With -t, each device is pinged every second to estimate the
+*              offset and the drift of its clock. The exchanges are written
+*              next to its stream (see clock_sync.c), so that record_dump
+*              can convert its timestamps to the host time.
+*
+*              With -m, the records of each device are also split into one
+*              file per segment of a session, at the session markers sent by
+*              the device (kit button or commands). Lines typed on the
+*              standard input are sent to all the devices as commands:
+*              "start [label]", "stop" and "label <label>".
+*
+*              Usage: capture_server [-b baud_rate] [-w window] [-s]
+*                                    [-i interval] [-o prefix] <endpoint>...
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "clock_sync.h"
+#include "host_command.h"
+#include "record_reader.h"
+#include "serial_port.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define CAPTURE_SERVER_DEFAULT_BAUD_RATE    (1000000u)
+#define CAPTURE_SERVER_DEFAULT_INTERVAL     (1u)
+#define CAPTURE_SERVER_MAX_DEVICES          (256u)
+#define CAPTURE_SERVER_MAX_LISTENERS        (8u)
+#define CAPTURE_SERVER_MAX_EVENTS           (64u)
+/* Bytes read from a device per event, so that a busy device cannot starve
+ * the others */
+#define CAPTURE_SERVER_READ_SIZE            (16u * 1024u)
+/* Buffer of each output file */
+#define CAPTURE_SERVER_OUTPUT_BUFFER        (64u * 1024u)
+/* Interval between the pings of a device, in milliseconds */
+#define CAPTURE_SERVER_PING_PERIOD          (1000u)
+
+/* Identifiers of the epoll events, the devices use their index */
+#define CAPTURE_SERVER_TIMER_ID             (0xFFFFFFFFu)
+#define CAPTURE_SERVER_PING_ID              (0xFFFFFFFEu)
+#define CAPTURE_SERVER_INPUT_ID             (0xFFFFFFFDu)
+
+/* Longest command line read from the standard input */
+#define CAPTURE_SERVER_INPUT_SIZE           (256u)
+#define CAPTURE_SERVER_LISTENER_ID          (0x80000000u)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+typedef enum
+{
+    CAPTURE_SERIAL,             /* Serial port, opened again when lost */
+    CAPTURE_TCP,                /* Device connected to, connected again */
+    CAPTURE_ACCEPTED,           /* Device that connected to a listener */
+} capture_kind_t;
+
+typedef struct
+{
+    capture_kind_t kind;
+    char name[64];
+    const char *endpoint;
+    int fd;                     /* -1 while disconnected */
+    bool connecting;            /* TCP connection in progress */
+    FILE *output;
+    char *output_buffer;
+    record_reader_t reader;
+    clock_sync_t clock;
+    FILE *clock_output;         /* Exchanges, with -t only */
+    double read_time;           /* Host time of the bytes being parsed */
+    FILE *segment;              /* Segment being written, with -m only */
+    uint32_t segments;          /* Segments written */
+    uint8_t schema[STREAM_RECORD_HEADER_SIZE + STREAM_SCHEMA_SIZE];
+    uint32_t schema_size;       /* Last schema record, written at the start
+                                 * of each segment */
+
+    uint64_t received;          /* Bytes received, statistics follow */
+    uint64_t reported;          /* Bytes received at the last report */
+    uint64_t stream_start;      /* Bytes received before the connection */
+    uint32_t granted;           /* Flow control credit sent */
+    uint32_t connections;
+    uint32_t errors;            /* Read and command errors */
+} capture_device_t;
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static int add_device(capture_kind_t kind, const char *endpoint, int fd, const char *name);
+static int open_device(capture_device_t *device);
+static void start_device(capture_device_t *device);
+static void close_device(capture_device_t *device);
+static void read_device(capture_device_t *device);
+static void deliver_record(void *context, const stream_record_header_t *header,
+                           const uint8_t *payload);
+static void ping_devices(void);
+static void add_exchange(capture_device_t *device, const stream_record_header_t *header,
+                         const uint8_t *payload);
+static void split_segment(capture_device_t *device, const stream_record_header_t *header,
+                          const uint8_t *payload);
+static void open_segment(capture_device_t *device, uint16_t sequence, const char *label,
+                         uint8_t length);
+static void close_segment(capture_device_t *device);
+static void read_input(int epoll);
+static void send_all(host_command_type_t type, const void *payload, uint8_t length);
+static int send_command(capture_device_t *device, host_command_type_t type,
+                        const void *payload, uint8_t length);
+static int open_listener(const char *port);
+static void accept_devices(int listener);
+static int connect_tcp(const char *endpoint, bool *connecting);
+static void report(double elapsed);
+static void stop(int signal_number);
+static double now_s(void);
+static double realtime_s(void);
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+static capture_device_t devices[CAPTURE_SERVER_MAX_DEVICES];
+static uint32_t device_count;
+static int listeners[CAPTURE_SERVER_MAX_LISTENERS];
+static uint32_t listener_count;
+static int epoll_fd;
+static uint32_t baud_rate = CAPTURE_SERVER_DEFAULT_BAUD_RATE;
+static uint32_t window;
+static bool schema;
+static bool clock_enable;
+static bool split;
+static const char *prefix = "capture";
+static volatile sig_atomic_t stopping;
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+*    Opens the endpoints and captures their streams until interrupted.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    struct epoll_event events[CAPTURE_SERVER_MAX_EVENTS];
+    struct epoll_event event = { .events = EPOLLIN };
+    uint32_t interval = CAPTURE_SERVER_DEFAULT_INTERVAL;
+    struct itimerspec period;
+    struct sigaction action;
+    uint64_t expirations;
+    double start;
+    int timer_fd;
+    int ping_fd;
+    int option;
+    int count;
+
+    while ((option = getopt(argc, argv, "b:w:stmi:o:")) != -1)
+    {
+        switch (option)
+        {
+            case 'b':
+                baud_rate = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                window = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                schema = true;
+                break;
+            case 't':
+                clock_enable = true;
+                break;
+            case 'm':
+                split = true;
+                break;
+            case 'i':
+                interval = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'o':
+                prefix = optarg;
+                break;
+            default:
+                optind = argc;
+                break;
+        }
+    }
+    if ((optind >= argc) || (0u == interval))
+    {
+        fprintf(stderr, "usage: %s [-b baud_rate] [-w window] [-s] [-t] [-m] [-i interval] [-o prefix] "
+                "<port|tcp:host:port|listen:port>...\n", argv[0]);
+        return 1;
+    }
+
+    epoll_fd = epoll_create1(0);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    ping_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if ((epoll_fd < 0) || (timer_fd < 0) || (ping_fd < 0))
+    {
+        perror("epoll");
+        return 1;
+    }
+
+    for (int i = optind; i < argc; i++)
+    {
+        int result;
+        if (0 == strncmp(argv[i], "listen:", 7))
+        {
+            result = open_listener(&argv[i][7]);
+        }
+        else
+        {
+            result = add_device((0 == strncmp(argv[i], "tcp:", 4)) ? CAPTURE_TCP : CAPTURE_SERIAL,
+                                argv[i], -1, argv[i]);
+        }
+        if (0 != result)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+    }
+
+    period.it_interval.tv_sec = interval;
+    period.it_interval.tv_nsec = 0;
+    period.it_value = period.it_interval;
+    timerfd_settime(timer_fd, 0, &period, NULL);
+    event.data.u32 = CAPTURE_SERVER_TIMER_ID;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &event);
+    if (true == clock_enable)
+    {
+        period.it_interval.tv_sec = CAPTURE_SERVER_PING_PERIOD / 1000u;
+        period.it_interval.tv_nsec = (CAPTURE_SERVER_PING_PERIOD % 1000u) * 1000000L;
+        period.it_value = period.it_interval;
+        timerfd_settime(ping_fd, 0, &period, NULL);
+        event.data.u32 = CAPTURE_SERVER_PING_ID;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ping_fd, &event);
+    }
+    /* Fails if the standard input is a regular file, the commands are then
+     * not read */
+    event.data.u32 = CAPTURE_SERVER_INPUT_ID;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, STDIN_FILENO, &event);
+
+    /* epoll_wait is interrupted instead of restarted */
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    start = now_s();
+    while (0 == stopping)
+    {
+        count = epoll_wait(epoll_fd, events, CAPTURE_SERVER_MAX_EVENTS, -1);
+        for (int i = 0; i < count; i++)
+        {
+            uint32_t id = events[i].data.u32;
+            if (CAPTURE_SERVER_TIMER_ID == id)
+            {
+                if (read(timer_fd, &expirations, sizeof(expirations)) > 0)
+                {
+                    report(now_s() - start);
+                }
+            }
+            else if (CAPTURE_SERVER_PING_ID == id)
+            {
+                if (read(ping_fd, &expirations, sizeof(expirations)) > 0)
+                {
+                    ping_devices();
+                }
+            }
+            else if (CAPTURE_SERVER_INPUT_ID == id)
+            {
+                read_input(epoll_fd);
+            }
+            else if (0u != (id & CAPTURE_SERVER_LISTENER_ID))
+            {
+                accept_devices(listeners[id & ~CAPTURE_SERVER_LISTENER_ID]);
+            }
+            else if (true == devices[id].connecting)
+            {
+                start_device(&devices[id]);
+            }
+            else
+            {
+                read_device(&devices[id]);
+            }
+        }
+    }
+
+    report(now_s() - start);
+    for (uint32_t i = 0; i < device_count; i++)
+    {
+        close_device(&devices[i]);
+        fclose(devices[i].output);
+        if (NULL != devices[i].clock_output)
+        {
+            fclose(devices[i].clock_output);
+        }
+        close_segment(&devices[i]);
+        free(devices[i].output_buffer);
+        record_reader_free(&devices[i].reader);
+    }
+    for (uint32_t i = 0; i < listener_count; i++)
+    {
+        close(listeners[i]);
+    }
+    close(timer_fd);
+    close(ping_fd);
+    close(epoll_fd);
+
+    return 0;
+}
+
+/*******************************************************************************
+* Function Name: add_device
+********************************************************************************
+* Summary:
+*    Creates the output and parse state of a device, and opens it if it is
+*    not already connected.
+*
+* Return:
+*     0 on success, -1 if the device limit is reached or the output cannot be
+*     created. A device that cannot be opened yet is opened again later.
+*
+*******************************************************************************/
+static int add_device(capture_kind_t kind, const char *endpoint, int fd, const char *name)
+{
+    capture_device_t *device;
+    char path[1024];
+
+    if (device_count >= CAPTURE_SERVER_MAX_DEVICES)
+    {
+        errno = ENOSPC;
+        return -1;
+    }
+    device = &devices[device_count];
+    memset(device, 0, sizeof(*device));
+    device->kind = kind;
+    device->endpoint = endpoint;
+    device->fd = -1;
+    snprintf(device->name, sizeof(device->name), "%s", name);
+
+    snprintf(path, sizeof(path), "%s_%u.bin", prefix, device_count);
+    device->output = fopen(path, "wb");
+    device->output_buffer = malloc(CAPTURE_SERVER_OUTPUT_BUFFER);
+    if ((NULL == device->output) || (NULL == device->output_buffer) ||
+        (0 != record_reader_init(&device->reader, deliver_record, device)))
+    {
+        return -1;
+    }
+    setvbuf(device->output, device->output_buffer, _IOFBF, CAPTURE_SERVER_OUTPUT_BUFFER);
+    if (true == clock_enable)
+    {
+        snprintf(path, sizeof(path), "%s_%u.clock", prefix, device_count);
+        device->clock_output = fopen(path, "w");
+        if (NULL == device->clock_output)
+        {
+            return -1;
+        }
+    }
+    printf("%s -> %s\n", device->name, path);
+    device_count++;
+
+    device->fd = fd;
+    if (fd >= 0)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    open_device(device);
+
+    return 0;
+}
+
+/*******************************************************************************
+* Function Name: open_device
+********************************************************************************
+* Summary:
+*    Opens the endpoint of a device if it is not connected and adds it to the
+*    event loop. TCP connections complete in the event loop, without blocking
+*    the other devices.
+*
+* Return:
+*     0 if the device is connected or connecting.
+*
+*******************************************************************************/
+static int open_device(capture_device_t *device)
+{
+    struct epoll_event event = { .events = EPOLLIN };
+
+    if (device->fd < 0)
+    {
+        if (CAPTURE_SERIAL == device->kind)
+        {
+            device->fd = serial_port_open(device->endpoint, baud_rate);
+        }
+        else if (CAPTURE_TCP == device->kind)
+        {
+            device->fd = connect_tcp(&device->endpoint[4], &device->connecting);
+        }
+        if (device->fd < 0)
+        {
+            return -1;
+        }
+        fcntl(device->fd, F_SETFL, fcntl(device->fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    event.events = (true == device->connecting) ? EPOLLOUT : EPOLLIN;
+    event.data.u32 = (uint32_t)(device - devices);
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, device->fd, &event);
+    if (false == device->connecting)
+    {
+        start_device(device);
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+* Function Name: start_device
+********************************************************************************
+* Summary:
+*    Starts the stream of a device once it is connected: the parser restarts
+*    and the initial commands are sent.
+*
+*******************************************************************************/
+static void start_device(capture_device_t *device)
+{
+    struct epoll_event event = { .events = EPOLLIN };
+    socklen_t length = sizeof(int);
+    int error = 0;
+
+    if (true == device->connecting)
+    {
+        device->connecting = false;
+        getsockopt(device->fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        if (0 != error)
+        {
+            close_device(device);
+            return;
+        }
+        event.data.u32 = (uint32_t)(device - devices);
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, device->fd, &event);
+    }
+
+    device->connections++;
+    record_reader_restart(&device->reader);
+    clock_sync_init(&device->clock);
+
+    /* The credits count the bytes since the start of the stream. The board
+     * may have kept running while the endpoint was closed, so its count is
+     * restarted along with the one of the connection. */
+    device->granted = window;
+    device->stream_start = device->received;
+    if (((true == schema) && (0 != send_command(device, HOST_COMMAND_SCHEMA, "", 0u))) ||
+        ((0u != window) &&
+         ((0 != send_command(device, HOST_COMMAND_CREDIT_RESET, "", 0u)) ||
+          (0 != send_command(device, HOST_COMMAND_CREDIT, &window, sizeof(window))))))
+    {
+        device->errors++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: close_device
+********************************************************************************
+* Summary:
+*    Closes the endpoint of a device and flushes its output.
+*
+*******************************************************************************/
+static void close_device(capture_device_t *device)
+{
+    if (device->fd >= 0)
+    {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, device->fd, NULL);
+        close(device->fd);
+        device->fd = -1;
+        device->connecting = false;
+    }
+    fflush(device->output);
+}
+
+/*******************************************************************************
+* Function Name: read_device
+********************************************************************************
+* Summary:
+*    Reads the bytes available from a device, writes them to its output and
+*    parses them. A new credit is sent each time a quarter of the window has
+*    been written.
+*
+*******************************************************************************/
+static void read_device(capture_device_t *device)
+{
+    static uint8_t buffer[CAPTURE_SERVER_READ_SIZE];
+    ssize_t count;
+    uint32_t received;
+
+    if (device->fd < 0)
+    {
+        return;
+    }
+
+    count = read(device->fd, buffer, sizeof(buffer));
+    if (count <= 0)
+    {
+        if ((count < 0) && ((EAGAIN == errno) || (EINTR == errno)))
+        {
+            return;
+        }
+        if (count < 0)
+        {
+            device->errors++;
+        }
+        close_device(device);
+        return;
+    }
+
+    device->read_time = realtime_s();
+    fwrite(buffer, 1, (size_t)count, device->output);
+    record_reader_feed(&device->reader, buffer, (size_t)count);
+    device->received += (uint64_t)count;
+
+    /* The credit only moves forward once the data is written */
+    received = (uint32_t)(device->received - device->stream_start);
+    if ((0u != window) && ((received + window - device->granted) >= (window / 4u)))
+    {
+        fflush(device->output);
+        device->granted = received + window;
+        if (0 != send_command(device, HOST_COMMAND_CREDIT, &device->granted,
+                              sizeof(device->granted)))
+        {
+            device->errors++;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: deliver_record
+********************************************************************************
+* Summary:
+*    Handles a record of a device: the clock records are added to its clock
+*    estimate, the last schema record is kept, and with -m the records are
+*    written to the segment being captured.
+*
+*******************************************************************************/
+static void deliver_record(void *context, const stream_record_header_t *header,
+                           const uint8_t *payload)
+{
+    capture_device_t *device = context;
+
+    switch (header->type)
+    {
+        case STREAM_RECORD_CLOCK:
+            add_exchange(device, header, payload);
+            break;
+
+        case STREAM_RECORD_SCHEMA:
+            if ((STREAM_RECORD_HEADER_SIZE + header->length) <= sizeof(device->schema))
+            {
+                memcpy(device->schema, header, STREAM_RECORD_HEADER_SIZE);
+                memcpy(&device->schema[STREAM_RECORD_HEADER_SIZE], payload, header->length);
+                device->schema_size = STREAM_RECORD_HEADER_SIZE + header->length;
+            }
+            break;
+
+        case STREAM_RECORD_MARKER:
+            if (true == split)
+            {
+                split_segment(device, header, payload);
+                return;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (NULL != device->segment)
+    {
+        fwrite(header, 1, STREAM_RECORD_HEADER_SIZE, device->segment);
+        fwrite(payload, 1, header->length, device->segment);
+    }
+}
+
+/*******************************************************************************
+* Function Name: add_exchange
+********************************************************************************
+* Summary:
+*    Adds a clock record to the clock estimate of a device and writes the
+*    exchange, as "host_sent device_received device_sent host_received", the
+*    host times in seconds and the device times in microseconds.
+*
+*******************************************************************************/
+static void add_exchange(capture_device_t *device, const stream_record_header_t *header,
+                         const uint8_t *payload)
+{
+    stream_clock_t clock;
+    double sent;
+
+    if (sizeof(clock) != header->length)
+    {
+        return;
+    }
+
+    memcpy(&clock, payload, sizeof(clock));
+    if ((true == clock_sync_reply(&device->clock, clock.ping, clock.received, header->timestamp,
+                                  device->read_time, &sent)) &&
+        (NULL != device->clock_output))
+    {
+        fprintf(device->clock_output, "%.6f %u %u %.6f\n", sent, clock.received,
+                header->timestamp, device->read_time);
+    }
+}
+
+/*******************************************************************************
+* Function Name: split_segment
+********************************************************************************
+* Summary:
+*    Starts a new segment file at a start or label marker, and ends it at a
+*    stop marker. The marker is written to the segment it delimits.
+*
+*******************************************************************************/
+static void split_segment(capture_device_t *device, const stream_record_header_t *header,
+                          const uint8_t *payload)
+{
+    stream_marker_t marker;
+    const char *label = (const char *)&payload[sizeof(marker)];
+
+    if (header->length < sizeof(marker))
+    {
+        return;
+    }
+    memcpy(&marker, payload, sizeof(marker));
+    if ((sizeof(marker) + marker.length) > header->length)
+    {
+        return;
+    }
+
+    if (STREAM_MARKER_STOP != marker.kind)
+    {
+        close_segment(device);
+        open_segment(device, header->sequence, label, marker.length);
+    }
+    printf("%s: session %u %s %.*s\n", device->name, marker.session,
+           (STREAM_MARKER_START == marker.kind) ? "start" :
+           (STREAM_MARKER_STOP == marker.kind) ? "stop" : "label", (int)marker.length, label);
+
+    if (NULL != device->segment)
+    {
+        fwrite(header, 1, STREAM_RECORD_HEADER_SIZE, device->segment);
+        fwrite(payload, 1, header->length, device->segment);
+    }
+    if (STREAM_MARKER_STOP == marker.kind)
+    {
+        close_segment(device);
+    }
+}
+
+/*******************************************************************************
+* Function Name: open_segment
+********************************************************************************
+* Summary:
+*    Creates the file of the next segment of a device, named after its label
+*    (<prefix>_<device>_<segment>[_<label>].bin), and writes the last schema
+*    record first so the segment can be decoded on its own. The schema record
+*    is numbered just before the marker, so no record of the segment appears
+*    to be missing.
+*
+*******************************************************************************/
+static void open_segment(capture_device_t *device, uint16_t sequence, const char *label,
+                         uint8_t length)
+{
+    stream_record_header_t header;
+    char path[1024];
+    int size;
+
+    device->segments++;
+    size = snprintf(path, sizeof(path), "%s_%u_%u", prefix, (uint32_t)(device - devices),
+                    device->segments);
+    if ((0u != length) && ((size_t)size + length + 6u) < sizeof(path))
+    {
+        /* Only keep the characters safe in a file name */
+        path[size++] = '_';
+        for (uint8_t i = 0; i < length; i++)
+        {
+            char c = label[i];
+            bool safe = ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) ||
+                        ((c >= '0') && (c <= '9')) || (c == '-') || (c == '.');
+            path[size++] = safe ? c : '_';
+        }
+    }
+    snprintf(&path[size], sizeof(path) - (size_t)size, ".bin");
+
+    device->segment = fopen(path, "wb");
+    if (NULL == device->segment)
+    {
+        perror(path);
+        device->errors++;
+        return;
+    }
+    printf("%s -> %s\n", device->name, path);
+
+    if (0u != device->schema_size)
+    {
+        memcpy(&header, device->schema, sizeof(header));
+        header.sequence = (uint16_t)(sequence - 1u);
+        fwrite(&header, 1, sizeof(header), device->segment);
+        fwrite(&device->schema[sizeof(header)], 1, device->schema_size - sizeof(header),
+               device->segment);
+    }
+}
+
+/*******************************************************************************
+* Function Name: close_segment
+********************************************************************************
+* Summary:
+*    Closes the segment file of a device, if any.
+*
+*******************************************************************************/
+static void close_segment(capture_device_t *device)
+{
+    if (NULL != device->segment)
+    {
+        fclose(device->segment);
+        device->segment = NULL;
+    }
+}
+
+/*******************************************************************************
+* Function Name: ping_devices
+********************************************************************************
+* Summary:
+*    Sends a ping to each connected device.
+*
+*******************************************************************************/
+static void ping_devices(void)
+{
+    for (uint32_t i = 0; i < device_count; i++)
+    {
+        capture_device_t *device = &devices[i];
+        uint32_t id;
+
+        if ((device->fd < 0) || (true == device->connecting))
+        {
+            continue;
+        }
+        id = clock_sync_ping(&device->clock, realtime_s());
+        if (0 != send_command(device, HOST_COMMAND_PING, &id, sizeof(id)))
+        {
+            device->errors++;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: read_input
+********************************************************************************
+* Summary:
+*    Reads the command lines typed on the standard input and sends them to
+*    all the devices. The standard input is no longer read once closed.
+*
+*******************************************************************************/
+static void read_input(int epoll)
+{
+    static char line[CAPTURE_SERVER_INPUT_SIZE];
+    static size_t fill;
+    ssize_t count = read(STDIN_FILENO, &line[fill], sizeof(line) - 1u - fill);
+    char *end;
+
+    if (count <= 0)
+    {
+        epoll_ctl(epoll, EPOLL_CTL_DEL, STDIN_FILENO, NULL);
+        return;
+    }
+    fill += (size_t)count;
+    line[fill] = '\0';
+
+    while (NULL != (end = strchr(line, '\n')))
+    {
+        const char *argument;
+        size_t length;
+
+        *end = '\0';
+        argument = strchr(line, ' ');
+        argument = (NULL == argument) ? "" : &argument[1];
+        length = strlen(argument);
+        length = (length < STREAM_MARKER_LABEL_SIZE) ? length : STREAM_MARKER_LABEL_SIZE;
+
+        if (0 == strncmp(line, "start", 5))
+        {
+            send_all(HOST_COMMAND_START, argument, (uint8_t)length);
+        }
+        else if (0 == strncmp(line, "stop", 4))
+        {
+            send_all(HOST_COMMAND_STOP, "", 0u);
+        }
+        else if ((0 == strncmp(line, "label", 5)) && (0u != length))
+        {
+            send_all(HOST_COMMAND_LABEL, argument, (uint8_t)length);
+        }
+        else if ('\0' != line[0])
+        {
+            printf("commands: start [label], stop, label <label>\n");
+        }
+
+        fill -= (size_t)(&end[1] - line);
+        memmove(line, &end[1], fill + 1u);
+    }
+
+    /* A line longer than the buffer is dropped */
+    if (fill == (sizeof(line) - 1u))
+    {
+        fill = 0;
+    }
+}
+
+/*******************************************************************************
+* Function Name: send_all
+********************************************************************************
+* Summary:
+*    Sends a command to each connected device.
+*
+*******************************************************************************/
+static void send_all(host_command_type_t type, const void *payload, uint8_t length)
+{
+    for (uint32_t i = 0; i < device_count; i++)
+    {
+        capture_device_t *device = &devices[i];
+
+        if ((device->fd >= 0) && (false == device->connecting) &&
+            (0 != send_command(device, type, payload, length)))
+        {
+            device->errors++;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: send_command
+********************************************************************************
+* Summary:
+*    Sends a command to a device. The commands are small, so a device that
+*    cannot take one at once is counted as an error.
+*
+*******************************************************************************/
+static int send_command(capture_device_t *device, host_command_type_t type,
+                        const void *payload, uint8_t length)
+{
+    uint8_t command[HOST_COMMAND_SIZE(HOST_COMMAND_MAX_PAYLOAD)];
+    uint32_t size = host_command_write(command, type, payload, length);
+
+    return (write(device->fd, command, size) == (ssize_t)size) ? 0 : -1;
+}
+
+/*******************************************************************************
+* Function Name: open_listener
+********************************************************************************
+* Summary:
+*    Listens on a TCP port for devices to connect.
+*
+* Return:
+*     0 on success, -1 on an error.
+*
+*******************************************************************************/
+static int open_listener(const char *port)
+{
+    struct sockaddr_in6 address;
+    struct epoll_event event = { .events = EPOLLIN };
+    int enable = 1;
+    int fd;
+
+    if (listener_count >= CAPTURE_SERVER_MAX_LISTENERS)
+    {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    fd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    memset(&address, 0, sizeof(address));
+    address.sin6_family = AF_INET6;
+    address.sin6_addr = in6addr_any;
+    address.sin6_port = htons((uint16_t)strtoul(port, NULL, 10));
+    if ((fd < 0) || (0 != setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable))) ||
+        (0 != bind(fd, (struct sockaddr *)&address, sizeof(address))) ||
+        (0 != listen(fd, SOMAXCONN)))
+    {
+        return -1;
+    }
+
+    event.data.u32 = CAPTURE_SERVER_LISTENER_ID | listener_count;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    listeners[listener_count++] = fd;
+
+    return 0;
+}
+
+/*******************************************************************************
+* Function Name: accept_devices
+********************************************************************************
+* Summary:
+*    Adds the devices that connected to a listener.
+*
+*******************************************************************************/
+static void accept_devices(int listener)
+{
+    struct sockaddr_storage address;
+    socklen_t length = sizeof(address);
+    char host[48];
+    char service[8];
+    char name[64];
+    int fd;
+
+    while ((fd = accept(listener, (struct sockaddr *)&address, &length)) >= 0)
+    {
+        if (0 != getnameinfo((struct sockaddr *)&address, length, host, sizeof(host), service,
+                             sizeof(service), NI_NUMERICHOST | NI_NUMERICSERV))
+        {
+            snprintf(host, sizeof(host), "?");
+            snprintf(service, sizeof(service), "?");
+        }
+        snprintf(name, sizeof(name), "%s:%s", host, service);
+
+        if (0 != add_device(CAPTURE_ACCEPTED, NULL, fd, name))
+        {
+            perror(name);
+            close(fd);
+        }
+        length = sizeof(address);
+    }
+}
+
+/*******************************************************************************
+* Function Name: connect_tcp
+********************************************************************************
+* Summary:
+*    Starts connecting to a device at host:port, without blocking.
+*
+* Return:
+*     The socket, or -1 on an error. connecting is set while the connection
+*     is in progress.
+*
+*******************************************************************************/
+static int connect_tcp(const char *endpoint, bool *connecting)
+{
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *addresses;
+    const char *separator = strrchr(endpoint, ':');
+    char host[256];
+    int enable = 1;
+    int fd = -1;
+
+    if ((NULL == separator) || ((size_t)(separator - endpoint) >= sizeof(host)))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    memcpy(host, endpoint, (size_t)(separator - endpoint));
+    host[separator - endpoint] = '\0';
+
+    if (0 != getaddrinfo(host, &separator[1], &hints, &addresses))
+    {
+        return -1;
+    }
+    for (struct addrinfo *address = addresses; NULL != address; address = address->ai_next)
+    {
+        fd = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK,
+                    address->ai_protocol);
+        if ((fd >= 0) && ((0 == connect(fd, address->ai_addr, address->ai_addrlen)) ||
+                          (EINPROGRESS == errno)))
+        {
+            *connecting = (EINPROGRESS == errno);
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+            break;
+        }
+        if (fd >= 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+
+    return fd;
+}
+
+/*******************************************************************************
+* Function Name: report
+********************************************************************************
+* Summary:
+*    Prints the throughput since the last report and the loss of each device,
+*    and opens again the devices that were disconnected.
+*
+*******************************************************************************/
+static void report(double elapsed)
+{
+    static double last;
+    double period = elapsed - last;
+    uint64_t total = 0;
+
+    printf("%.0f s: %u devices\n", elapsed, device_count);
+    printf("  %-24s %-5s %10s %10s %9s %8s %8s %8s %6s %8s %7s\n", "device", "state", "KB/s",
+           "MB", "records", "missing", "skipped", "mismatch", "errors", "drift", "rtt");
+    for (uint32_t i = 0; i < device_count; i++)
+    {
+        capture_device_t *device = &devices[i];
+        double rate = (period > 0.0) ? (double)(device->received - device->reported) / period : 0.0;
+
+        printf("  %-24.24s %-5s %10.1f %10.2f %9u %8u %8u %8u %6u", device->name,
+               (device->fd < 0) ? "down" : (device->connecting ? "conn" : "up"), rate / 1024.0,
+               (double)device->received / 1048576.0, device->reader.records,
+               device->reader.missing, device->reader.skipped, device->reader.mismatched,
+               device->errors);
+        if (true == device->clock.valid)
+        {
+            /* Drift in ppm, shortest round trip in ms */
+            printf(" %8.2f %7.2f\n", clock_sync_drift_ppm(&device->clock),
+                   device->clock.delay * 1000.0);
+        }
+        else
+        {
+            printf(" %8s %7s\n", "-", "-");
+        }
+        total += device->received - device->reported;
+        device->reported = device->received;
+
+        if ((device->fd < 0) && (CAPTURE_ACCEPTED != device->kind) && (0 == stopping))
+        {
+            open_device(device);
+        }
+    }
+    printf("  total %.1f KB/s\n", (period > 0.0) ? (double)total / period / 1024.0 : 0.0);
+    fflush(stdout);
+    last = elapsed;
+}
+
+/*******************************************************************************
+* Function Name: stop
+********************************************************************************
+* Summary:
+*    Stops the capture on SIGINT or SIGTERM.
+*
+*******************************************************************************/
+static void stop(int signal_number)
+{
+    (void)signal_number;
+
+    stopping = 1;
+}
+
+/*******************************************************************************
+* Function Name: now_s
+********************************************************************************
+* Summary:
+*    Returns a monotonic time in seconds.
+*
+*******************************************************************************/
+static double now_s(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+/*******************************************************************************
+* Function Name: realtime_s
+********************************************************************************
+* Summary:
+*    Returns the wall clock time in seconds, shared by the captures of other
+*    hosts synchronized with NTP or PTP.
+*
+*******************************************************************************/
+static double realtime_s(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_REALTIME, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+/* [] END OF FILE */
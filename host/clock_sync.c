@@ -0,0 +1,292 @@
+/******************************************************************************
+* File Name:   clock_sync.c
+*
+* Description: Estimates the offset and the drift of the clock of a device
+*              against the host clock, from ping exchanges: the host sends a
+*              ping command at t1, the device receives it at t2 and answers
+*              with a clock record sent at t3, received by the host at t4. The
+*              exchanges with the shortest round trips are the least delayed
+*              by the transport, so the model is fitted to the fastest half
+*              of the last CLOCK_SYNC_WINDOW exchanges. The device timestamps
+*              (32-bit microseconds, wrapping every 71 minutes) are then
+*              converted to host time.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "clock_sync.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* The drift is only estimated over exchanges spread over this many seconds,
+ * the jitter of the transport makes shorter spans meaningless */
+#define CLOCK_SYNC_MIN_SPAN         (10.0)
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static void clock_sync_fit(clock_sync_t *sync);
+static int clock_sync_compare(const void *a, const void *b);
+
+/*******************************************************************************
+* Function Name: clock_sync_init
+********************************************************************************
+* Summary:
+*    Sets up an estimator with no exchange.
+*
+*******************************************************************************/
+void clock_sync_init(clock_sync_t *sync)
+{
+    memset(sync, 0, sizeof(*sync));
+    sync->rate = 1.0;
+}
+
+/*******************************************************************************
+* Function Name: clock_sync_ping
+********************************************************************************
+* Summary:
+*    Registers a ping sent at host_sent. The oldest ping still waiting is
+*    taken as lost when there are too many.
+*
+* Return:
+*     The identifier to send in the ping command.
+*
+*******************************************************************************/
+uint32_t clock_sync_ping(clock_sync_t *sync, double host_sent)
+{
+    uint32_t id = ++sync->next_id;
+    uint32_t slot = id % CLOCK_SYNC_PENDING;
+
+    if (0u != sync->pending_id[slot])
+    {
+        sync->lost++;
+    }
+    sync->pending_id[slot] = id;
+    sync->pending_sent[slot] = host_sent;
+
+    return id;
+}
+
+/*******************************************************************************
+* Function Name: clock_sync_reply
+********************************************************************************
+* Summary:
+*    Adds the exchange of a clock record received at host_received.
+*
+* Parameters:
+*   sync: estimator
+*   id: ping answered
+*   device_received: device time the ping was received, in microseconds
+*   device_sent: device time the answer was sent, in microseconds
+*   host_received: host time the answer was received, in seconds
+*   host_sent: receives the host time the ping was sent, in seconds
+*
+* Return:
+*     true if the ping was waiting for an answer.
+*
+*******************************************************************************/
+bool clock_sync_reply(clock_sync_t *sync, uint32_t id, uint32_t device_received,
+                      uint32_t device_sent, double host_received, double *host_sent)
+{
+    uint32_t slot = id % CLOCK_SYNC_PENDING;
+
+    if ((0u == id) || (id != sync->pending_id[slot]))
+    {
+        return false;
+    }
+    sync->pending_id[slot] = 0;
+    *host_sent = sync->pending_sent[slot];
+
+    clock_sync_add(sync, *host_sent, device_received, device_sent, host_received);
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: clock_sync_add
+********************************************************************************
+* Summary:
+*    Adds an exchange and fits the model again. Also used to replay the
+*    exchanges saved during a capture.
+*
+*******************************************************************************/
+void clock_sync_add(clock_sync_t *sync, double host_sent, uint32_t device_received,
+                    uint32_t device_sent, double host_received)
+{
+    clock_sync_sample_t *sample = &sync->sample[sync->count % CLOCK_SYNC_WINDOW];
+    double received = clock_sync_unwrap(sync, device_received);
+    double sent = clock_sync_unwrap(sync, device_sent);
+
+    sample->device = 0.5 * (received + sent);
+    sample->host = 0.5 * (host_sent + host_received);
+    sample->delay = (host_received - host_sent) - (sent - received);
+    sync->device_last = (int64_t)(sent * 1e6 + 0.5);
+    sync->count++;
+
+    clock_sync_fit(sync);
+}
+
+/*******************************************************************************
+* Function Name: clock_sync_unwrap
+********************************************************************************
+* Summary:
+*    Converts a device time to seconds, taking it as the wrap of the 32-bit
+*    microsecond counter closest to the last exchange.
+*
+*******************************************************************************/
+double clock_sync_unwrap(clock_sync_t *sync, uint32_t device_us)
+{
+    if (false == sync->started)
+    {
+        sync->started = true;
+        sync->device_last = device_us;
+    }
+
+    return (double)(sync->device_last + (int32_t)(device_us - (uint32_t)sync->device_last)) * 1e-6;
+}
+
+/*******************************************************************************
+* Function Name: clock_sync_to_host
+********************************************************************************
+* Summary:
+*    Converts a device time to host time, in seconds. Before the first
+*    exchange the device time is returned unchanged.
+*
+*******************************************************************************/
+double clock_sync_to_host(clock_sync_t *sync, uint32_t device_us)
+{
+    double device = clock_sync_unwrap(sync, device_us);
+
+    if (false == sync->valid)
+    {
+        return device;
+    }
+    return sync->host_ref + sync->rate * (device - sync->device_ref);
+}
+
+/*******************************************************************************
+* Function Name: clock_sync_drift_ppm
+********************************************************************************
+* Summary:
+*    Returns how much faster the device clock runs than the host clock, in
+*    parts per million.
+*
+*******************************************************************************/
+double clock_sync_drift_ppm(const clock_sync_t *sync)
+{
+    return (1.0 / sync->rate - 1.0) * 1e6;
+}
+
+/*******************************************************************************
+* Function Name: clock_sync_fit
+********************************************************************************
+* Summary:
+*    Fits host = host_ref + rate x (device - device_ref) by least squares to
+*    the exchanges of the window with a delay up to the median. The rate is
+*    kept at 1 until these exchanges span CLOCK_SYNC_MIN_SPAN seconds.
+*
+*******************************************************************************/
+static void clock_sync_fit(clock_sync_t *sync)
+{
+    uint32_t count = (sync->count < CLOCK_SYNC_WINDOW) ? sync->count : CLOCK_SYNC_WINDOW;
+    double delays[CLOCK_SYNC_WINDOW];
+    double threshold;
+    double device_mean = 0.0;
+    double host_mean = 0.0;
+    double first = 0.0;
+    double last = 0.0;
+    double sxx = 0.0;
+    double sxy = 0.0;
+    uint32_t used = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        delays[i] = sync->sample[i].delay;
+    }
+    qsort(delays, count, sizeof(delays[0]), clock_sync_compare);
+    threshold = delays[(count - 1u) / 2u];
+    sync->delay = delays[0];
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const clock_sync_sample_t *sample = &sync->sample[i];
+        if (sample->delay <= threshold)
+        {
+            device_mean += sample->device;
+            host_mean += sample->host;
+            first = ((0u == used) || (sample->device < first)) ? sample->device : first;
+            last = ((0u == used) || (sample->device > last)) ? sample->device : last;
+            used++;
+        }
+    }
+    device_mean /= (double)used;
+    host_mean /= (double)used;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const clock_sync_sample_t *sample = &sync->sample[i];
+        if (sample->delay <= threshold)
+        {
+            sxx += (sample->device - device_mean) * (sample->device - device_mean);
+            sxy += (sample->device - device_mean) * (sample->host - host_mean);
+        }
+    }
+
+    sync->device_ref = device_mean;
+    sync->host_ref = host_mean;
+    sync->rate = (((last - first) >= CLOCK_SYNC_MIN_SPAN) && (sxx > 0.0)) ? (sxy / sxx) : 1.0;
+    sync->valid = true;
+}
+
+/*******************************************************************************
+* Function Name: clock_sync_compare
+********************************************************************************
+* Summary:
+*    Orders two delays for qsort.
+*
+*******************************************************************************/
+static int clock_sync_compare(const void *a, const void *b)
+{
+    double first = *(const double *)a;
+    double second = *(const double *)b;
+
+    return (first > second) - (first < second);
+}
+
+/* [] END OF FILE */
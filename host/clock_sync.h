@@ -0,0 +1,109 @@
+/******************************************************************************
+* File Name:   clock_sync.h
+*
+* Description: This file contains the function prototypes and types used in
+*   clock_sync.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef HOST_CLOCK_SYNC_H_
+#define HOST_CLOCK_SYNC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Constants
+ *****************************************************************************/
+/* Number of the last exchanges the clock model is fitted to */
+#define CLOCK_SYNC_WINDOW           (64u)
+
+/* Number of pings waiting for a reply, older ones are taken as lost */
+#define CLOCK_SYNC_PENDING          (8u)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* One exchange: the device time in the middle of the time it held the ping,
+ * the host time in the middle of the round trip, and the round trip delay
+ * without the time the ping was held by the device */
+typedef struct
+{
+    double device;              /* Seconds, unwrapped */
+    double host;                /* Seconds */
+    double delay;               /* Seconds */
+} clock_sync_sample_t;
+
+typedef struct
+{
+    uint32_t next_id;
+    uint32_t pending_id[CLOCK_SYNC_PENDING];
+    double pending_sent[CLOCK_SYNC_PENDING];
+
+    clock_sync_sample_t sample[CLOCK_SYNC_WINDOW];
+    uint32_t count;             /* Exchanges completed, the last
+                                 * CLOCK_SYNC_WINDOW are kept */
+
+    bool started;
+    int64_t device_last;        /* Last device time of an exchange, unwrapped,
+                                 * in microseconds */
+
+    bool valid;                 /* Model: host = host_ref + rate x (device -
+                                 * device_ref), device times unwrapped */
+    double device_ref;
+    double host_ref;
+    double rate;
+    double delay;               /* Smallest delay of the window */
+
+    uint32_t lost;              /* Pings not answered */
+} clock_sync_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void clock_sync_init(clock_sync_t *sync);
+uint32_t clock_sync_ping(clock_sync_t *sync, double host_sent);
+bool clock_sync_reply(clock_sync_t *sync, uint32_t id, uint32_t device_received,
+                      uint32_t device_sent, double host_received, double *host_sent);
+void clock_sync_add(clock_sync_t *sync, double host_sent, uint32_t device_received,
+                    uint32_t device_sent, double host_received);
+double clock_sync_unwrap(clock_sync_t *sync, uint32_t device_us);
+double clock_sync_to_host(clock_sync_t *sync, uint32_t device_us);
+double clock_sync_drift_ppm(const clock_sync_t *sync);
+
+
+#endif /* HOST_CLOCK_SYNC_H_ */
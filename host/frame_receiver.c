@@ -0,0 +1,306 @@
+/******************************************************************************
+* File Name:   frame_receiver.c
+*
+* Description: This file implements the host side of the selective repeat
+*              retransmission (STREAM_RELIABLE_ENABLE). The frames are checked,
+*              put back in order and their payloads delivered; the frames
+*              missing or corrupted are asked for again with NACKs.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_receiver.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Largest payload accepted, larger lengths are taken as a false sync */
+#define FRAME_RECEIVER_MAX_PAYLOAD  (32u * 1024u)
+#define FRAME_RECEIVER_BUFFER_SIZE  (2u * (RELIABLE_FRAME_HEADER_SIZE + FRAME_RECEIVER_MAX_PAYLOAD))
+
+/* A missing frame is asked for again after this many frames */
+#define FRAME_RECEIVER_RENACK       (RELIABLE_WINDOW / 4u)
+
+/* Sequence numbers per NACK command */
+#define FRAME_RECEIVER_NACK_MAX     (16u)
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static void frame_receiver_frame(frame_receiver_t *receiver, const reliable_frame_header_t *header,
+                                 const uint8_t *payload);
+static void frame_receiver_flush(frame_receiver_t *receiver, bool skip);
+
+/*******************************************************************************
+* Function Name: frame_receiver_init
+********************************************************************************
+* Summary:
+*    Sets up a receiver.
+*
+* Return:
+*     0 on success, -1 if the memory could not be allocated.
+*
+*******************************************************************************/
+int frame_receiver_init(frame_receiver_t *receiver, frame_receiver_deliver_t deliver,
+                        frame_receiver_nack_t nack, void *context)
+{
+    memset(receiver, 0, sizeof(*receiver));
+    receiver->deliver = deliver;
+    receiver->nack = nack;
+    receiver->context = context;
+
+    receiver->buffer = malloc(FRAME_RECEIVER_BUFFER_SIZE);
+    return (NULL == receiver->buffer) ? -1 : 0;
+}
+
+/*******************************************************************************
+* Function Name: frame_receiver_feed
+********************************************************************************
+* Summary:
+*    Parses the bytes received. After a CRC error the parser resynchronizes
+*    on the next sync word.
+*
+*******************************************************************************/
+void frame_receiver_feed(frame_receiver_t *receiver, const uint8_t *data, size_t count)
+{
+    reliable_frame_header_t header;
+    size_t offset;
+    size_t chunk;
+    uint16_t crc;
+
+    while (count > 0u)
+    {
+        chunk = FRAME_RECEIVER_BUFFER_SIZE - receiver->fill;
+        chunk = (chunk < count) ? chunk : count;
+        memcpy(&receiver->buffer[receiver->fill], data, chunk);
+        receiver->fill += chunk;
+        data += chunk;
+        count -= chunk;
+
+        offset = 0;
+        while ((receiver->fill - offset) >= RELIABLE_FRAME_HEADER_SIZE)
+        {
+            memcpy(&header, &receiver->buffer[offset], sizeof(header));
+            if ((RELIABLE_FRAME_SYNC != header.sync) ||
+                (header.length > FRAME_RECEIVER_MAX_PAYLOAD))
+            {
+                offset++;
+                continue;
+            }
+            if ((receiver->fill - offset) < (RELIABLE_FRAME_HEADER_SIZE + header.length))
+            {
+                break;
+            }
+
+            crc = reliable_crc(0xFFFFu, &receiver->buffer[offset + 2u], 6u);
+            crc = reliable_crc(crc, &receiver->buffer[offset + RELIABLE_FRAME_HEADER_SIZE],
+                               header.length);
+            if (crc != header.crc)
+            {
+                receiver->crc_errors++;
+                offset++;
+                continue;
+            }
+
+            frame_receiver_frame(receiver, &header,
+                                 &receiver->buffer[offset + RELIABLE_FRAME_HEADER_SIZE]);
+            offset += RELIABLE_FRAME_HEADER_SIZE + header.length;
+        }
+
+        memmove(receiver->buffer, &receiver->buffer[offset], receiver->fill - offset);
+        receiver->fill -= offset;
+    }
+}
+
+/*******************************************************************************
+* Function Name: frame_receiver_free
+********************************************************************************
+* Summary:
+*    Delivers the frames still held, skipping the missing ones, and releases
+*    the memory.
+*
+*******************************************************************************/
+void frame_receiver_free(frame_receiver_t *receiver)
+{
+    uint32_t held = 0;
+
+    for (uint32_t i = 0; i < RELIABLE_WINDOW; i++)
+    {
+        held += (true == receiver->slot[i].present) ? 1u : 0u;
+    }
+    while (held > 0u)
+    {
+        if (true == receiver->slot[receiver->expected % RELIABLE_WINDOW].present)
+        {
+            held--;
+        }
+        frame_receiver_flush(receiver, true);
+    }
+    free(receiver->buffer);
+    receiver->buffer = NULL;
+}
+
+/*******************************************************************************
+* Function Name: frame_receiver_frame
+********************************************************************************
+* Summary:
+*    Stores a valid frame, asks for the frames missing before it and delivers
+*    the frames now in order.
+*
+*******************************************************************************/
+static void frame_receiver_frame(frame_receiver_t *receiver, const reliable_frame_header_t *header,
+                                 const uint8_t *payload)
+{
+    uint16_t nack[FRAME_RECEIVER_NACK_MAX];
+    size_t nack_count = 0;
+    frame_receiver_slot_t *slot;
+    uint16_t distance;
+
+    receiver->frames++;
+    if (0u != (header->flags & RELIABLE_FLAG_RETRANSMIT))
+    {
+        receiver->retransmitted++;
+    }
+
+    if (false == receiver->started)
+    {
+        receiver->started = true;
+        receiver->expected = header->sequence;
+    }
+
+    distance = (uint16_t)(header->sequence - receiver->expected);
+    if (distance >= 0x8000u)
+    {
+        /* Already delivered */
+        return;
+    }
+
+    /* The device holds the last RELIABLE_WINDOW frames only */
+    while (distance >= RELIABLE_WINDOW)
+    {
+        frame_receiver_flush(receiver, true);
+        distance = (uint16_t)(header->sequence - receiver->expected);
+    }
+
+    slot = &receiver->slot[header->sequence % RELIABLE_WINDOW];
+    if (false == slot->present)
+    {
+        slot->present = true;
+        slot->lost = (0u != (header->flags & RELIABLE_FLAG_LOST));
+        slot->length = header->length;
+        slot->data = malloc(header->length + 1u);
+        if (NULL != slot->data)
+        {
+            memcpy(slot->data, payload, header->length);
+        }
+        slot->nacked = 0;
+    }
+
+    /* Ask for the frames missing before this one */
+    for (uint16_t i = 0; i < distance; i++)
+    {
+        uint16_t sequence = (uint16_t)(receiver->expected + i);
+        frame_receiver_slot_t *missing = &receiver->slot[sequence % RELIABLE_WINDOW];
+
+        if ((false == missing->present) &&
+            ((0u == missing->nacked) ||
+             ((receiver->frames - missing->nacked) >= FRAME_RECEIVER_RENACK)))
+        {
+            missing->nacked = receiver->frames;
+            nack[nack_count++] = sequence;
+            if (FRAME_RECEIVER_NACK_MAX == nack_count)
+            {
+                receiver->nack(receiver->context, nack, nack_count);
+                nack_count = 0;
+            }
+        }
+    }
+    if (0u != nack_count)
+    {
+        receiver->nack(receiver->context, nack, nack_count);
+    }
+
+    while (true == receiver->slot[receiver->expected % RELIABLE_WINDOW].present)
+    {
+        frame_receiver_flush(receiver, false);
+    }
+}
+
+/*******************************************************************************
+* Function Name: frame_receiver_flush
+********************************************************************************
+* Summary:
+*    Delivers the expected frame and moves to the next one. When skip is set,
+*    a missing frame is given up.
+*
+*******************************************************************************/
+static void frame_receiver_flush(frame_receiver_t *receiver, bool skip)
+{
+    frame_receiver_slot_t *slot = &receiver->slot[receiver->expected % RELIABLE_WINDOW];
+
+    if (true == slot->present)
+    {
+        if ((true == slot->lost) || (NULL == slot->data))
+        {
+            receiver->lost++;
+        }
+        else
+        {
+            receiver->deliver(receiver->context, slot->data, slot->length);
+        }
+        free(slot->data);
+    }
+    else if (true == skip)
+    {
+        if (false == receiver->started)
+        {
+            return;
+        }
+        receiver->lost++;
+    }
+    else
+    {
+        return;
+    }
+
+    memset(slot, 0, sizeof(*slot));
+    receiver->expected++;
+}
+
+/* [] END OF FILE */
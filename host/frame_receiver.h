@@ -0,0 +1,99 @@
+/******************************************************************************
+* File Name:   frame_receiver.h
+*
+* Description: This file contains the function prototypes and types used in
+*   frame_receiver.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef HOST_FRAME_RECEIVER_H_
+#define HOST_FRAME_RECEIVER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "reliable.h"
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Called with the payload of each frame, in order */
+typedef void (*frame_receiver_deliver_t)(void *context, const uint8_t *data, size_t count);
+/* Called with the sequence numbers of the frames to ask for again */
+typedef void (*frame_receiver_nack_t)(void *context, const uint16_t *sequence, size_t count);
+
+/* Frame received ahead of a missing one */
+typedef struct
+{
+    uint8_t *data;
+    uint16_t length;
+    bool present;
+    bool lost;                  /* The device no longer held the frame */
+    uint32_t nacked;            /* Frame count when the frame was last asked
+                                 * for, 0 if never */
+} frame_receiver_slot_t;
+
+typedef struct
+{
+    frame_receiver_deliver_t deliver;
+    frame_receiver_nack_t nack;
+    void *context;
+
+    uint8_t *buffer;            /* Bytes not parsed yet */
+    size_t fill;
+
+    frame_receiver_slot_t slot[RELIABLE_WINDOW];
+    uint16_t expected;          /* Next frame to deliver */
+    bool started;
+
+    uint32_t frames;            /* Frames received, statistics follow */
+    uint32_t crc_errors;
+    uint32_t retransmitted;
+    uint32_t lost;
+} frame_receiver_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+int frame_receiver_init(frame_receiver_t *receiver, frame_receiver_deliver_t deliver,
+                        frame_receiver_nack_t nack, void *context);
+void frame_receiver_feed(frame_receiver_t *receiver, const uint8_t *data, size_t count);
+void frame_receiver_free(frame_receiver_t *receiver);
+
+
+#endif /* HOST_FRAME_RECEIVER_H_ */
@@ -0,0 +1,72 @@
+/******************************************************************************
+* File Name:   cy_result.h
+*
+* Description: Minimal replacement of the core library result definitions, so
+*   that the data streaming library and the host tools can be built on a host
+*   machine.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef HOST_CY_RESULT_H_
+#define HOST_CY_RESULT_H_
+
+#include <stdint.h>
+
+typedef uint32_t cy_rslt_t;
+
+#define CY_RSLT_SUCCESS                             ((cy_rslt_t)0x00000000U)
+
+#define CY_RSLT_TYPE_POSITION                       (16U)
+#define CY_RSLT_TYPE_MASK                           (0x0003U)
+#define CY_RSLT_MODULE_POSITION                     (18U)
+#define CY_RSLT_MODULE_MASK                         (0x3FFFU)
+#define CY_RSLT_CODE_POSITION                       (0U)
+#define CY_RSLT_CODE_MASK                           (0xFFFFU)
+
+#define CY_RSLT_TYPE_INFO                           (0U)
+#define CY_RSLT_TYPE_WARNING                        (1U)
+#define CY_RSLT_TYPE_ERROR                          (2U)
+#define CY_RSLT_TYPE_FATAL                          (3U)
+
+#define CY_RSLT_MODULE_ABSTRACTION_DATA_STREAMING   (0x01A0U)
+
+#define CY_RSLT_CREATE(type, module, code) \
+    ((((module) & CY_RSLT_MODULE_MASK) << CY_RSLT_MODULE_POSITION) | \
+     (((code) & CY_RSLT_CODE_MASK) << CY_RSLT_CODE_POSITION) | \
+     (((type) & CY_RSLT_TYPE_MASK) << CY_RSLT_TYPE_POSITION))
+
+#endif /* HOST_CY_RESULT_H_ */
@@ -0,0 +1,277 @@
+/******************************************************************************
+* File Name:   ipc_ring.c
+*
+* Description: This file implements a lock-free ring of records between two
+*              cores, placed in shared memory. One core (the producer)
+*              reserves and commits records, the other (the consumer) peeks
+*              and releases them. Each index is written by a single core, so
+*              no IPC lock or semaphore is taken on either side.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "ipc_ring.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Length written instead of a record at the end of the storage, when the next
+ * record does not fit there and starts at the beginning of the storage */
+#define IPC_RING_WRAP           (0xFFFFFFFFu)
+
+/* Wakes the other core from __WFE once a record is committed */
+#if defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_7EM__)
+#include "cmsis_compiler.h"
+#define IPC_RING_NOTIFY()       __SEV()
+#else
+#define IPC_RING_NOTIFY()
+#endif
+
+/*******************************************************************************
+* Function Name: ipc_ring_init
+********************************************************************************
+* Summary:
+*   Sets up an empty ring on the given storage. Called by one core before the
+*   other is started, or uses the ring.
+*
+* Parameters:
+*   ring: ring to set up, in shared memory
+*   storage: records of the ring, in shared memory, aligned on 4 bytes
+*   size: size of the storage, a power of two
+*
+* Return:
+*   false if the storage cannot be used.
+*
+*******************************************************************************/
+bool ipc_ring_init(ipc_ring_t *ring, uint8_t *storage, uint32_t size)
+{
+    if ((NULL == storage) || (size < (2u * IPC_RING_HEADER_SIZE)) ||
+        (0u != (size & (size - 1u))) || (0u != ((uintptr_t)storage & 3u)))
+    {
+        return false;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    atomic_store_explicit(&ring->head, 0u, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, 0u, memory_order_relaxed);
+    ring->storage = storage;
+    ring->size = size;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: ipc_ring_reserve
+********************************************************************************
+* Summary:
+*   Reserves the space of a record, to be written in place and committed. The
+*   record stays invisible to the consumer until then. Producer only.
+*
+* Parameters:
+*   ring: ring to write
+*   size: largest size of the record, in bytes
+*
+* Return:
+*   Where to write the record, or NULL if the ring is full.
+*
+*******************************************************************************/
+void *ipc_ring_reserve(ipc_ring_t *ring, uint32_t size)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t space = IPC_RING_RECORD_SPACE(size);
+    uint32_t offset = head & (ring->size - 1u);
+    uint32_t skip = 0;
+
+    if (space > (ring->size / 2u))
+    {
+        return NULL;
+    }
+
+    /* A record is never split: when it does not fit before the end of the
+     * storage, the rest of the storage is skipped */
+    if (space > (ring->size - offset))
+    {
+        skip = ring->size - offset;
+    }
+
+    if (((head - tail) + skip + space) > ring->size)
+    {
+        return NULL;
+    }
+
+    if (0u != skip)
+    {
+        *(uint32_t *)&ring->storage[offset] = IPC_RING_WRAP;
+        offset = 0;
+    }
+    ring->reserve_skip = skip;
+
+    return &ring->storage[offset + IPC_RING_HEADER_SIZE];
+}
+
+/*******************************************************************************
+* Function Name: ipc_ring_commit
+********************************************************************************
+* Summary:
+*   Hands the record reserved last to the consumer, and wakes the other core.
+*   Producer only.
+*
+* Parameters:
+*   ring: ring to write
+*   size: size of the record written, no larger than the size reserved
+*
+*******************************************************************************/
+void ipc_ring_commit(ipc_ring_t *ring, uint32_t size)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed) +
+                    ring->reserve_skip;
+
+    *(uint32_t *)&ring->storage[head & (ring->size - 1u)] = size;
+
+    /* The record and its length are written before the head moves past them */
+    atomic_store_explicit(&ring->head, head + IPC_RING_RECORD_SPACE(size),
+                          memory_order_release);
+    IPC_RING_NOTIFY();
+}
+
+/*******************************************************************************
+* Function Name: ipc_ring_push
+********************************************************************************
+* Summary:
+*   Copies a record into the ring. Producer only.
+*
+* Parameters:
+*   ring: ring to write
+*   data: record to copy
+*   size: size of the record, in bytes
+*
+* Return:
+*   false if the ring is full.
+*
+*******************************************************************************/
+bool ipc_ring_push(ipc_ring_t *ring, const void *data, uint32_t size)
+{
+    void *record = ipc_ring_reserve(ring, size);
+
+    if (NULL == record)
+    {
+        return false;
+    }
+
+    memcpy(record, data, size);
+    ipc_ring_commit(ring, size);
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: ipc_ring_peek
+********************************************************************************
+* Summary:
+*   Returns the oldest record, read in place until it is released. Consumer
+*   only.
+*
+* Parameters:
+*   ring: ring to read
+*   size: set to the size of the record
+*
+* Return:
+*   The record, or NULL if the ring is empty.
+*
+*******************************************************************************/
+const void *ipc_ring_peek(ipc_ring_t *ring, uint32_t *size)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t offset = tail & (ring->size - 1u);
+    uint32_t skip = 0;
+
+    if (head == tail)
+    {
+        return NULL;
+    }
+
+    if (IPC_RING_WRAP == *(const uint32_t *)&ring->storage[offset])
+    {
+        skip = ring->size - offset;
+        offset = 0;
+    }
+    ring->peek_skip = skip;
+    *size = *(const uint32_t *)&ring->storage[offset];
+
+    return &ring->storage[offset + IPC_RING_HEADER_SIZE];
+}
+
+/*******************************************************************************
+* Function Name: ipc_ring_release
+********************************************************************************
+* Summary:
+*   Hands the space of the record peeked last back to the producer. Consumer
+*   only.
+*
+* Parameters:
+*   ring: ring to read
+*
+*******************************************************************************/
+void ipc_ring_release(ipc_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed) +
+                    ring->peek_skip;
+    uint32_t size = *(const uint32_t *)&ring->storage[tail & (ring->size - 1u)];
+
+    /* The record is read before the tail moves past it */
+    atomic_store_explicit(&ring->tail, tail + IPC_RING_RECORD_SPACE(size),
+                          memory_order_release);
+}
+
+/*******************************************************************************
+* Function Name: ipc_ring_is_empty
+********************************************************************************
+* Summary:
+*   Tells whether there is no record to peek. Consumer only; the consumer core
+*   can wait with __WFE while the ring is empty.
+*
+*******************************************************************************/
+bool ipc_ring_is_empty(ipc_ring_t *ring)
+{
+    return (atomic_load_explicit(&ring->head, memory_order_acquire) ==
+            atomic_load_explicit(&ring->tail, memory_order_relaxed));
+}
+
+/* [] END OF FILE */
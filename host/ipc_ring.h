@@ -0,0 +1,102 @@
+/******************************************************************************
+* File Name:   ipc_ring.h
+*
+* Description: This file contains the ring format and function prototypes
+*   used in ipc_ring.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef HOST_IPC_RING_H_
+#define HOST_IPC_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/******************************************************************************
+ * Constants
+ *****************************************************************************/
+/* Bytes taken by the length of each record in the ring */
+#define IPC_RING_HEADER_SIZE    (4u)
+
+/* Space taken in the ring by a record of size bytes */
+#define IPC_RING_RECORD_SPACE(size) (IPC_RING_HEADER_SIZE + (((size) + 3u) & ~3u))
+
+/* The indexes written by each core are kept apart, so that a core does not
+ * write a cache line or bus word read by the other in a loop */
+#define IPC_RING_LINE_SIZE      (32u)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Queue of variable size records between a producer and a consumer running
+ * on different cores (or threads), without locking. The ring and its storage
+ * are placed in memory shared by both cores, at the same address for both.
+ * Each record is contiguous in the storage, so it can be written and read in
+ * place, and can take up to half the storage. */
+typedef struct
+{
+    /* Written by the producer */
+    _Atomic uint32_t head;      /* Bytes committed since the start */
+    uint32_t reserve_skip;      /* Bytes skipped at the end of the storage by
+                                 * the record reserved */
+    uint8_t  producer_pad[IPC_RING_LINE_SIZE - 8u];
+
+    /* Written by the consumer */
+    _Atomic uint32_t tail;      /* Bytes released since the start */
+    uint32_t peek_skip;         /* Bytes skipped at the end of the storage by
+                                 * the record peeked */
+    uint8_t  consumer_pad[IPC_RING_LINE_SIZE - 8u];
+
+    /* Set up before the other core starts */
+    uint8_t *storage;
+    uint32_t size;              /* Power of two, multiple of 4 */
+} ipc_ring_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+bool ipc_ring_init(ipc_ring_t *ring, uint8_t *storage, uint32_t size);
+void *ipc_ring_reserve(ipc_ring_t *ring, uint32_t size);
+void ipc_ring_commit(ipc_ring_t *ring, uint32_t size);
+bool ipc_ring_push(ipc_ring_t *ring, const void *data, uint32_t size);
+const void *ipc_ring_peek(ipc_ring_t *ring, uint32_t *size);
+void ipc_ring_release(ipc_ring_t *ring);
+bool ipc_ring_is_empty(ipc_ring_t *ring);
+
+
+#endif /* HOST_IPC_RING_H_ */
@@ -0,0 +1,301 @@
+/******************************************************************************
+* File Name:   ipc_ring_test.c
+*
+* Description: Host tool that runs the shared-memory ring of the dual-core
+*              split (ipc_ring.c) between two threads, as the two cores
+*              would: the producer pushes records of random sizes carrying a
+*              sequence number and a pattern, some of them written in place,
+*              and the consumer checks each of them in order. The ring is
+*              kept small, so that it fills and wraps all the time.
+*
+*              Usage: ipc_ring_test [-r records] [-s ring_size] [-m max_record]
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ipc_ring.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define IPC_RING_TEST_DEFAULT_RECORDS   (10000000u)
+#define IPC_RING_TEST_DEFAULT_SIZE      (4096u)
+#define IPC_RING_TEST_DEFAULT_MAX       (600u)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* State of a run, shared by the two threads */
+typedef struct
+{
+    ipc_ring_t ring;
+    uint32_t records;
+    uint32_t max_record;
+    uint64_t bytes;
+    uint64_t errors;
+    uint64_t full;
+    uint64_t empty;
+} ipc_ring_test_t;
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static void *producer_thread(void *argument);
+static void *consumer_thread(void *argument);
+static uint32_t record_size(uint32_t sequence, uint32_t max_record);
+static uint8_t pattern(uint32_t sequence, uint32_t index);
+static double now_s(void);
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+*    Runs the producer and the consumer and prints the throughput and the
+*    records found corrupted or out of order.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    static ipc_ring_test_t test;
+    uint32_t ring_size = IPC_RING_TEST_DEFAULT_SIZE;
+    pthread_t producer;
+    pthread_t consumer;
+    uint8_t *storage;
+    double start;
+    double elapsed;
+    int option;
+
+    test.records = IPC_RING_TEST_DEFAULT_RECORDS;
+    test.max_record = IPC_RING_TEST_DEFAULT_MAX;
+    while ((option = getopt(argc, argv, "r:s:m:")) != -1)
+    {
+        switch (option)
+        {
+            case 'r':
+                test.records = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                ring_size = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                test.max_record = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-r records] [-s ring_size] [-m max_record]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    storage = aligned_alloc(64, ring_size);
+    if ((NULL == storage) || (false == ipc_ring_init(&test.ring, storage, ring_size)))
+    {
+        fprintf(stderr, "invalid ring size (must be a power of two)\n");
+        return 1;
+    }
+    if ((test.max_record < sizeof(uint32_t)) ||
+        (IPC_RING_RECORD_SPACE(test.max_record) > (ring_size / 2u)))
+    {
+        fprintf(stderr, "invalid record size (4 bytes to half the ring)\n");
+        return 1;
+    }
+
+    printf("%u records of 4 to %u bytes, ring of %u bytes\n", test.records, test.max_record,
+           ring_size);
+    start = now_s();
+    pthread_create(&consumer, NULL, consumer_thread, &test);
+    pthread_create(&producer, NULL, producer_thread, &test);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    elapsed = now_s() - start;
+
+    printf("%8.1f Mrecords/s, %8.1f MB/s, %llu errors, %llu waits full, %llu waits empty\n",
+           (double)test.records / elapsed / 1e6, (double)test.bytes / elapsed / 1048576.0,
+           (unsigned long long)test.errors, (unsigned long long)test.full,
+           (unsigned long long)test.empty);
+    free(storage);
+
+    return ((0u == test.errors) && (true == ipc_ring_is_empty(&test.ring))) ? 0 : 1;
+}
+
+/*******************************************************************************
+* Function Name: producer_thread
+********************************************************************************
+* Summary:
+*    Pushes the records, every other one written in place, and retries while
+*    the ring is full.
+*
+*******************************************************************************/
+static void *producer_thread(void *argument)
+{
+    ipc_ring_test_t *test = argument;
+    uint8_t *record = malloc(test->max_record);
+
+    for (uint32_t sequence = 0; sequence < test->records; sequence++)
+    {
+        uint32_t size = record_size(sequence, test->max_record);
+
+        if (0u != (sequence & 1u))
+        {
+            /* Reserved at the largest size, committed at the actual one */
+            uint8_t *place;
+            while (NULL == (place = ipc_ring_reserve(&test->ring, test->max_record)))
+            {
+                test->full++;
+                sched_yield();
+            }
+            memcpy(place, &sequence, sizeof(sequence));
+            for (uint32_t index = sizeof(sequence); index < size; index++)
+            {
+                place[index] = pattern(sequence, index);
+            }
+            ipc_ring_commit(&test->ring, size);
+        }
+        else
+        {
+            memcpy(record, &sequence, sizeof(sequence));
+            for (uint32_t index = sizeof(sequence); index < size; index++)
+            {
+                record[index] = pattern(sequence, index);
+            }
+            while (false == ipc_ring_push(&test->ring, record, size))
+            {
+                test->full++;
+                sched_yield();
+            }
+        }
+    }
+
+    free(record);
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: consumer_thread
+********************************************************************************
+* Summary:
+*    Checks the records in place, in order, until the last one is released.
+*
+*******************************************************************************/
+static void *consumer_thread(void *argument)
+{
+    ipc_ring_test_t *test = argument;
+
+    for (uint32_t sequence = 0; sequence < test->records; sequence++)
+    {
+        const uint8_t *record;
+        uint32_t received;
+        uint32_t size;
+
+        while (NULL == (record = ipc_ring_peek(&test->ring, &size)))
+        {
+            test->empty++;
+            sched_yield();
+        }
+
+        memcpy(&received, record, sizeof(received));
+        if ((received != sequence) || (size != record_size(sequence, test->max_record)))
+        {
+            test->errors++;
+        }
+        else
+        {
+            for (uint32_t index = sizeof(sequence); index < size; index++)
+            {
+                if (record[index] != pattern(sequence, index))
+                {
+                    test->errors++;
+                    break;
+                }
+            }
+        }
+        test->bytes += size;
+        ipc_ring_release(&test->ring);
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: record_size
+********************************************************************************
+* Summary:
+*    Size of a record, from 4 bytes to max_record, known to both threads.
+*
+*******************************************************************************/
+static uint32_t record_size(uint32_t sequence, uint32_t max_record)
+{
+    uint32_t hash = sequence * 2654435761u;
+
+    return sizeof(uint32_t) + ((hash >> 7) % (max_record - sizeof(uint32_t) + 1u));
+}
+
+/*******************************************************************************
+* Function Name: pattern
+********************************************************************************
+* Summary:
+*    Byte expected at an index of a record.
+*
+*******************************************************************************/
+static uint8_t pattern(uint32_t sequence, uint32_t index)
+{
+    return (uint8_t)((sequence * 31u) + (index * 7u));
+}
+
+/*******************************************************************************
+* Function Name: now_s
+********************************************************************************
+* Summary:
+*    Monotonic time, in seconds.
+*
+*******************************************************************************/
+static double now_s(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,199 @@
+/******************************************************************************
+* File Name:   log_dump.c
+*
+* Description: Host tool that lists the sessions of a log written by the log
+*              streaming interface (SD card image or file) and extracts the
+*              data of each session, as it would have been streamed.
+*
+*              Usage: log_dump <image> [block_size] [output_prefix]
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log_file.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define LOG_DUMP_DEFAULT_BLOCK_SIZE     (512u)
+/* The index block is read before the device size is known */
+#define LOG_DUMP_MAX_BLOCKS             (0xFFFFFFFFu)
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static int dump_session(log_file_t *file, const mtb_data_streaming_log_session_t *session,
+                        FILE *output);
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+*    Lists the sessions and writes each one to <output_prefix>_<n>.bin.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    log_file_t file;
+    mtb_data_streaming_log_index_t index;
+    uint32_t block_size = LOG_DUMP_DEFAULT_BLOCK_SIZE;
+    const char *prefix = NULL;
+    uint8_t *block;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <image> [block_size] [output_prefix]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 2)
+    {
+        block_size = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3)
+    {
+        prefix = argv[3];
+    }
+
+    if (CY_RSLT_SUCCESS != log_file_open(&file, argv[1], block_size, LOG_DUMP_MAX_BLOCKS))
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    block = malloc(block_size);
+    if ((NULL == block) || (CY_RSLT_SUCCESS != file.blockdev.read(file.blockdev.context, 0, block, 1)))
+    {
+        fprintf(stderr, "cannot read the index\n");
+        return 1;
+    }
+
+    memcpy(&index, block, sizeof(index));
+    if ((MTB_DATA_STREAMING_LOG_MAGIC != index.magic) || (block_size != index.block_size))
+    {
+        fprintf(stderr, "no log found (or block size is not %u)\n", block_size);
+        return 1;
+    }
+
+    printf("%u session(s), block size %u\n", index.session_count, index.block_size);
+    for (uint32_t number = 0; number < index.session_count; number++)
+    {
+        mtb_data_streaming_log_session_t session;
+        memcpy(&session, &block[sizeof(index) + number * sizeof(session)], sizeof(session));
+        printf("session %u: block %u, %u bytes\n", number, session.first_block, session.length);
+
+        if (NULL != prefix)
+        {
+            char name[1024];
+            snprintf(name, sizeof(name), "%s_%u.bin", prefix, number);
+            FILE *output = fopen(name, "wb");
+            if (NULL == output)
+            {
+                perror(name);
+                return 1;
+            }
+            int records = dump_session(&file, &session, output);
+            fclose(output);
+            if (records < 0)
+            {
+                fprintf(stderr, "session %u: corrupted record\n", number);
+            }
+            else
+            {
+                printf("  %d record(s) written to %s\n", records, name);
+            }
+        }
+    }
+
+    free(block);
+    log_file_close(&file);
+
+    return 0;
+}
+
+/*******************************************************************************
+* Function Name: dump_session
+********************************************************************************
+* Summary:
+*    Writes the data of every record of a session to a file.
+*
+* Return:
+*     The number of records, or -1 if a record header is corrupted.
+*
+*******************************************************************************/
+static int dump_session(log_file_t *file, const mtb_data_streaming_log_session_t *session,
+                        FILE *output)
+{
+    uint32_t block_size = file->blockdev.block_size;
+    uint32_t blocks = (session->length + block_size - 1u) / block_size;
+    uint8_t *data = malloc((size_t)blocks * block_size + 1u);
+    uint32_t offset = 0;
+    int records = 0;
+
+    if ((NULL == data) ||
+        (CY_RSLT_SUCCESS != file->blockdev.read(file->blockdev.context, session->first_block,
+                                                data, blocks)))
+    {
+        free(data);
+        return -1;
+    }
+
+    while ((offset + sizeof(mtb_data_streaming_log_record_t)) <= session->length)
+    {
+        mtb_data_streaming_log_record_t record;
+        memcpy(&record, &data[offset], sizeof(record));
+        offset += sizeof(record);
+
+        if ((MTB_DATA_STREAMING_LOG_RECORD_SYNC != record.sync) ||
+            (record.length > (session->length - offset)))
+        {
+            records = -1;
+            break;
+        }
+
+        fwrite(&data[offset], 1, record.length, output);
+        offset += record.length;
+        records++;
+    }
+
+    free(data);
+    return records;
+}
+
+/* [] END OF FILE */
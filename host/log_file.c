@@ -0,0 +1,170 @@
+/******************************************************************************
+* File Name:   log_file.c
+*
+* Description: This file implements a block device backed by a regular file,
+*              so that the log streaming interface can be run and tested on a
+*              host machine, and SD card images can be read back.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "log_file.h"
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static cy_rslt_t log_file_read(void *context, uint32_t block, uint8_t *data, uint32_t count);
+static cy_rslt_t log_file_write(void *context, uint32_t block, const uint8_t *data,
+                                uint32_t count);
+
+/*******************************************************************************
+* Function Name: log_file_open
+********************************************************************************
+* Summary:
+*    Opens (or creates) a file to use as a block device. The file grows as
+*    blocks are written; blocks past the end of the file read as zeros.
+*
+* Parameters:
+*   file: file block device object
+*   path: path of the file
+*   block_size: size of a block in bytes
+*   block_count: number of blocks of the device
+*
+* Return:
+*     CY_RSLT_SUCCESS, or MTB_DATA_STREAMING_XFER_ERR if the file cannot be
+*     opened.
+*
+*******************************************************************************/
+cy_rslt_t log_file_open(log_file_t *file, const char *path, uint32_t block_size,
+                        uint32_t block_count)
+{
+    file->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (file->fd < 0)
+    {
+        return MTB_DATA_STREAMING_XFER_ERR;
+    }
+
+    file->blockdev.read = log_file_read;
+    file->blockdev.write = log_file_write;
+    file->blockdev.context = file;
+    file->blockdev.block_size = block_size;
+    file->blockdev.block_count = block_count;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: log_file_close
+********************************************************************************
+* Summary:
+*    Closes the file of a block device.
+*
+*******************************************************************************/
+void log_file_close(log_file_t *file)
+{
+    if (file->fd >= 0)
+    {
+        close(file->fd);
+        file->fd = -1;
+    }
+}
+
+/*******************************************************************************
+* Function Name: log_file_read
+********************************************************************************
+* Summary:
+*    Block device read operation.
+*
+*******************************************************************************/
+static cy_rslt_t log_file_read(void *context, uint32_t block, uint8_t *data, uint32_t count)
+{
+    log_file_t *file = (log_file_t *)context;
+    size_t size = (size_t)count * file->blockdev.block_size;
+    off_t offset = (off_t)block * file->blockdev.block_size;
+    size_t done = 0;
+
+    while (done < size)
+    {
+        ssize_t result = pread(file->fd, &data[done], size - done, offset + (off_t)done);
+        if (result < 0)
+        {
+            return MTB_DATA_STREAMING_XFER_ERR;
+        }
+        if (0 == result)
+        {
+            /* Past the end of the file */
+            memset(&data[done], 0, size - done);
+            break;
+        }
+        done += (size_t)result;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: log_file_write
+********************************************************************************
+* Summary:
+*    Block device write operation.
+*
+*******************************************************************************/
+static cy_rslt_t log_file_write(void *context, uint32_t block, const uint8_t *data,
+                                uint32_t count)
+{
+    log_file_t *file = (log_file_t *)context;
+    size_t size = (size_t)count * file->blockdev.block_size;
+    off_t offset = (off_t)block * file->blockdev.block_size;
+    size_t done = 0;
+
+    while (done < size)
+    {
+        ssize_t result = pwrite(file->fd, &data[done], size - done, offset + (off_t)done);
+        if (result <= 0)
+        {
+            return MTB_DATA_STREAMING_XFER_ERR;
+        }
+        done += (size_t)result;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,405 @@
+/******************************************************************************
+* File Name:   record_dump.c
+*
+* Description: Host tool that decodes a stream of records captured from the
+*              device (STREAM_RECORDS_ENABLE or voice activity detection). The
+*              layout of the data blocks is read from the schema records, so
+*              the captures of any build are decoded without per-build
+*              settings. The values of the data blocks can be written to a CSV
+*              file, in the units given by the schema. Given the clock
+*              exchanges saved by capture_server -t, the timestamps are
+*              written in host time, so the captures of several devices can
+*              be aligned. With -g, they are written in the time of the
+*              master board of a synchronized capture, from the edges of the
+*              sync line reported by the device.
+*
+*              Usage: record_dump [-c csv_output] [-k clock_file | -g] <capture|->
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "clock_sync.h"
+#include "record_reader.h"
+#include "trigger_align.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define RECORD_DUMP_BUFFER_SIZE     (4096u)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Statistics of a channel */
+typedef struct
+{
+    uint32_t blocks;
+    uint32_t half_blocks;
+    uint32_t gaps;
+    uint64_t gap_samples;
+} record_dump_channel_t;
+
+typedef struct
+{
+    record_reader_t reader;
+    record_dump_channel_t channel[STREAM_CHANNEL_COUNT];
+    FILE *csv;
+    FILE *exchanges;            /* Clock exchanges, with -k only */
+    clock_sync_t clock;
+    bool align;                 /* With -g only */
+    trigger_align_t trigger;
+} record_dump_t;
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static void deliver(void *context, const stream_record_header_t *header, const uint8_t *payload);
+static void print_schema(const record_reader_t *reader);
+static void write_values(record_dump_t *dump, const stream_record_header_t *header,
+                         const uint8_t *payload);
+static void replay_exchanges(record_dump_t *dump, uint32_t timestamp);
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+*    Decodes the capture and prints the statistics of each channel.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    static record_dump_t dump;
+    uint8_t buffer[RECORD_DUMP_BUFFER_SIZE];
+    const char *path;
+    FILE *input;
+    size_t count;
+    int option;
+
+    while ((option = getopt(argc, argv, "c:k:g")) != -1)
+    {
+        switch (option)
+        {
+            case 'c':
+                dump.csv = fopen(optarg, "w");
+                if (NULL == dump.csv)
+                {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 'k':
+                dump.exchanges = fopen(optarg, "r");
+                if (NULL == dump.exchanges)
+                {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 'g':
+                dump.align = true;
+                break;
+            default:
+                optind = argc;
+                break;
+        }
+    }
+    if (((argc - optind) != 1) || ((true == dump.align) && (NULL != dump.exchanges)))
+    {
+        fprintf(stderr, "usage: %s [-c csv_output] [-k clock_file | -g] <capture|->\n", argv[0]);
+        return 1;
+    }
+    path = argv[optind];
+
+    input = (0 == strcmp(path, "-")) ? stdin : fopen(path, "rb");
+    if (NULL == input)
+    {
+        perror(path);
+        return 1;
+    }
+    if (0 != record_reader_init(&dump.reader, deliver, &dump))
+    {
+        perror("record_reader_init");
+        return 1;
+    }
+    clock_sync_init(&dump.clock);
+    trigger_align_init(&dump.trigger);
+
+    while ((count = fread(buffer, 1, sizeof(buffer), input)) > 0u)
+    {
+        record_reader_feed(&dump.reader, buffer, count);
+    }
+
+    if (false == dump.reader.described)
+    {
+        printf("no schema record received\n");
+    }
+    for (uint8_t channel = 0; channel < STREAM_CHANNEL_COUNT; channel++)
+    {
+        const record_dump_channel_t *stats = &dump.channel[channel];
+        if ((0u != stats->blocks) || (0u != stats->gaps))
+        {
+            printf("channel %u: %u blocks (%u at half precision), %u gaps of %llu samples\n",
+                   channel, stats->blocks, stats->half_blocks, stats->gaps,
+                   (unsigned long long)stats->gap_samples);
+        }
+    }
+    printf("%u records, %u missing, %u not matching the schema, %u bytes skipped\n",
+           dump.reader.records, dump.reader.missing, dump.reader.mismatched, dump.reader.skipped);
+
+    record_reader_free(&dump.reader);
+    if (stdin != input)
+    {
+        fclose(input);
+    }
+    if (NULL != dump.csv)
+    {
+        fclose(dump.csv);
+    }
+    if (0u != dump.trigger.edges)
+    {
+        printf("%u sync edges, %u missed, last period %.3f ms of the device clock\n",
+               dump.trigger.edges, dump.trigger.missed,
+               (double)dump.trigger.period / (dump.trigger.rate * 1000.0));
+    }
+    if (NULL != dump.exchanges)
+    {
+        printf("clock drift %.2f ppm over %u exchanges\n", clock_sync_drift_ppm(&dump.clock),
+               dump.clock.count);
+        fclose(dump.exchanges);
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+* Function Name: deliver
+********************************************************************************
+* Summary:
+*    Counts a record, prints the schema records and the session markers, and
+*    writes the values of the data blocks.
+*
+*******************************************************************************/
+static void deliver(void *context, const stream_record_header_t *header, const uint8_t *payload)
+{
+    record_dump_t *dump = context;
+    record_dump_channel_t *stats = &dump->channel[header->channel];
+    stream_trigger_t trigger;
+    stream_marker_t marker;
+    uint32_t samples;
+
+    switch (header->type)
+    {
+        case STREAM_RECORD_SCHEMA:
+            printf("schema at %u us:\n", header->timestamp);
+            print_schema(&dump->reader);
+            break;
+
+        case STREAM_RECORD_GAP:
+            if (header->length >= sizeof(samples))
+            {
+                memcpy(&samples, payload, sizeof(samples));
+                stats->gaps++;
+                stats->gap_samples += samples;
+            }
+            break;
+
+        case STREAM_RECORD_MARKER:
+            if (header->length < sizeof(marker))
+            {
+                break;
+            }
+            memcpy(&marker, payload, sizeof(marker));
+            if ((sizeof(marker) + marker.length) <= header->length)
+            {
+                printf("session %u %s at %u us %.*s\n", marker.session,
+                       (STREAM_MARKER_START == marker.kind) ? "start" :
+                       (STREAM_MARKER_STOP == marker.kind) ? "stop" : "label",
+                       header->timestamp, (int)marker.length, (const char *)&payload[sizeof(marker)]);
+            }
+            break;
+
+        case STREAM_RECORD_TRIGGER:
+            if (header->length >= sizeof(trigger))
+            {
+                memcpy(&trigger, payload, sizeof(trigger));
+                trigger_align_add(&dump->trigger, &trigger);
+            }
+            break;
+
+        case STREAM_RECORD_DATA_HALF:
+            stats->half_blocks++;
+            /* Fall through */
+        case STREAM_RECORD_DATA:
+            stats->blocks++;
+            write_values(dump, header, payload);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*******************************************************************************
+* Function Name: print_schema
+********************************************************************************
+* Summary:
+*    Prints the fields of each channel described.
+*
+*******************************************************************************/
+static void print_schema(const record_reader_t *reader)
+{
+    static const char *samples[] = { "?", "int16", "float32" };
+    static const char *units[] = { "", "g", "uT", "hPa", "degC", "FS", "log2" };
+
+    if (0u != (reader->flags & STREAM_SCHEMA_GATED))
+    {
+        printf("  blocks gated by activity\n");
+    }
+    if (0u != (reader->flags & STREAM_SCHEMA_COMPRESSED))
+    {
+        printf("  blocks can be sent at half precision\n");
+    }
+
+    for (uint8_t channel = 0; channel < STREAM_CHANNEL_COUNT; channel++)
+    {
+        const record_reader_channel_t *description = &reader->channel[channel];
+        if (0u == description->count)
+        {
+            continue;
+        }
+
+        printf("  channel %u: blocks of %u bytes\n", channel, description->block_size);
+        for (uint8_t i = 0; i < description->count; i++)
+        {
+            const stream_schema_field_t *field = &description->field[i];
+            printf("    field %u: %u x %u %s at %.3f Hz, scale %g %s\n", field->field,
+                   field->rows, field->columns,
+                   (field->sample < 3u) ? samples[field->sample] : "?",
+                   (double)field->rate / 1000.0, (double)field->scale,
+                   (field->unit < 7u) ? units[field->unit] : "?");
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: write_values
+********************************************************************************
+* Summary:
+*    Writes the channel, sequence number, timestamp and values of a data
+*    block as a line of the CSV file. The timestamp is in microseconds of the
+*    device clock, or in seconds of the host clock with the clock exchanges,
+*    or in seconds of the master clock since the first sync edge with -g.
+*
+*******************************************************************************/
+static void write_values(record_dump_t *dump, const stream_record_header_t *header,
+                         const uint8_t *payload)
+{
+    const record_reader_channel_t *description = &dump->reader.channel[header->channel];
+    uint32_t values = 0;
+
+    if ((NULL == dump->csv) || (0u == description->block_size))
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < description->count; i++)
+    {
+        values += (uint32_t)description->field[i].rows * description->field[i].columns;
+    }
+
+    if (true == dump->align)
+    {
+        fprintf(dump->csv, "%u,%u,%.6f", header->channel, header->sequence,
+                trigger_align_to_master(&dump->trigger, header->timestamp));
+    }
+    else if (NULL != dump->exchanges)
+    {
+        replay_exchanges(dump, header->timestamp);
+        fprintf(dump->csv, "%u,%u,%.6f", header->channel, header->sequence,
+                clock_sync_to_host(&dump->clock, header->timestamp));
+    }
+    else
+    {
+        fprintf(dump->csv, "%u,%u,%u", header->channel, header->sequence, header->timestamp);
+    }
+    for (uint32_t index = 0; index < values; index++)
+    {
+        fprintf(dump->csv, ",%g", (double)record_reader_value(&dump->reader, header, payload, index));
+    }
+    fprintf(dump->csv, "\n");
+}
+
+/*******************************************************************************
+* Function Name: replay_exchanges
+********************************************************************************
+* Summary:
+*    Adds the clock exchanges completed by the device time of a record, as
+*    they were when the record was captured. The first exchange is added
+*    ahead of the records that precede it.
+*
+*******************************************************************************/
+static void replay_exchanges(record_dump_t *dump, uint32_t timestamp)
+{
+    static bool next_valid;
+    static double host_sent;
+    static double host_received;
+    static uint32_t device_received;
+    static uint32_t device_sent;
+
+    for (;;)
+    {
+        if ((false == next_valid) &&
+            (4 == fscanf(dump->exchanges, "%lf %u %u %lf", &host_sent, &device_received,
+                         &device_sent, &host_received)))
+        {
+            next_valid = true;
+        }
+        if ((false == next_valid) ||
+            ((0u != dump->clock.count) && ((int32_t)(device_sent - timestamp) > 0)))
+        {
+            return;
+        }
+        clock_sync_add(&dump->clock, host_sent, device_received, device_sent, host_received);
+        next_valid = false;
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,375 @@
+/******************************************************************************
+* File Name:   record_reader.c
+*
+* Description: Parses the records streamed by the device (see
+*              source/stream_record.h). The layout of the data blocks is taken
+*              from the schema records, so the values of any build can be
+*              decoded without knowing how it was configured.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "record_reader.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Largest payload accepted, larger lengths are taken as a false sync */
+#define RECORD_READER_MAX_PAYLOAD   (16u * 1024u)
+#define RECORD_READER_BUFFER_SIZE   (2u * (STREAM_RECORD_HEADER_SIZE + RECORD_READER_MAX_PAYLOAD))
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static void record_reader_record(record_reader_t *reader, const stream_record_header_t *header,
+                                 const uint8_t *payload);
+static void record_reader_schema(record_reader_t *reader, const uint8_t *payload,
+                                 uint16_t length);
+static float record_reader_half(uint16_t half);
+
+/*******************************************************************************
+* Function Name: record_reader_init
+********************************************************************************
+* Summary:
+*    Sets up a reader.
+*
+* Return:
+*     0 on success, -1 if the memory could not be allocated.
+*
+*******************************************************************************/
+int record_reader_init(record_reader_t *reader, record_reader_deliver_t deliver, void *context)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->deliver = deliver;
+    reader->context = context;
+
+    reader->buffer = malloc(RECORD_READER_BUFFER_SIZE);
+    return (NULL == reader->buffer) ? -1 : 0;
+}
+
+/*******************************************************************************
+* Function Name: record_reader_feed
+********************************************************************************
+* Summary:
+*    Parses the bytes received. Bytes that do not start a record are skipped
+*    until the next sync word.
+*
+*******************************************************************************/
+void record_reader_feed(record_reader_t *reader, const uint8_t *data, size_t count)
+{
+    stream_record_header_t header;
+    size_t offset;
+    size_t chunk;
+
+    while (count > 0u)
+    {
+        chunk = RECORD_READER_BUFFER_SIZE - reader->fill;
+        chunk = (chunk < count) ? chunk : count;
+        memcpy(&reader->buffer[reader->fill], data, chunk);
+        reader->fill += chunk;
+        data += chunk;
+        count -= chunk;
+
+        offset = 0;
+        while ((reader->fill - offset) >= STREAM_RECORD_HEADER_SIZE)
+        {
+            memcpy(&header, &reader->buffer[offset], sizeof(header));
+            if ((STREAM_RECORD_SYNC != header.sync) || (header.channel >= STREAM_CHANNEL_COUNT) ||
+                (header.length > RECORD_READER_MAX_PAYLOAD))
+            {
+                reader->skipped++;
+                offset++;
+                continue;
+            }
+            if ((reader->fill - offset) < (STREAM_RECORD_HEADER_SIZE + header.length))
+            {
+                break;
+            }
+
+            record_reader_record(reader, &header, &reader->buffer[offset + STREAM_RECORD_HEADER_SIZE]);
+            offset += STREAM_RECORD_HEADER_SIZE + header.length;
+        }
+
+        memmove(reader->buffer, &reader->buffer[offset], reader->fill - offset);
+        reader->fill -= offset;
+    }
+}
+
+/*******************************************************************************
+* Function Name: record_reader_restart
+********************************************************************************
+* Summary:
+*    Drops the bytes of an incomplete record and restarts the sequences, for
+*    a stream that starts again. The schema and the statistics are kept.
+*
+*******************************************************************************/
+void record_reader_restart(record_reader_t *reader)
+{
+    reader->fill = 0;
+    memset(reader->started, 0, sizeof(reader->started));
+}
+
+/*******************************************************************************
+* Function Name: record_reader_free
+********************************************************************************
+* Summary:
+*    Releases the memory. The bytes of an incomplete record are dropped.
+*
+*******************************************************************************/
+void record_reader_free(record_reader_t *reader)
+{
+    free(reader->buffer);
+    reader->buffer = NULL;
+}
+
+/*******************************************************************************
+* Function Name: record_reader_sample_size
+********************************************************************************
+* Summary:
+*    Returns the size of a value in bytes, at full or half precision (see
+*    shedding_compress), or 0 if the type is unknown.
+*
+*******************************************************************************/
+uint32_t record_reader_sample_size(uint8_t sample, bool half)
+{
+    switch (sample)
+    {
+        case STREAM_SAMPLE_INT16:
+            return (true == half) ? 1u : 2u;
+        case STREAM_SAMPLE_FLOAT32:
+            return (true == half) ? 2u : 4u;
+        default:
+            return 0u;
+    }
+}
+
+/*******************************************************************************
+* Function Name: record_reader_value
+********************************************************************************
+* Summary:
+*    Returns a value of a data block, in the units of its field. The values
+*    are numbered across the fields of the block, in order.
+*
+* Parameters:
+*   reader: reader that received the schema of the channel
+*   header: header of a DATA or DATA_HALF record matching the schema
+*   payload: payload of the record
+*   index: index of the value in the block
+*
+* Return:
+*     The value, or NAN if the block has no such value.
+*
+*******************************************************************************/
+float record_reader_value(const record_reader_t *reader, const stream_record_header_t *header,
+                          const uint8_t *payload, uint32_t index)
+{
+    const record_reader_channel_t *channel = &reader->channel[header->channel % STREAM_CHANNEL_COUNT];
+    bool half = (STREAM_RECORD_DATA_HALF == header->type);
+    uint32_t offset = 0;
+
+    for (uint8_t i = 0; i < channel->count; i++)
+    {
+        const stream_schema_field_t *field = &channel->field[i];
+        uint32_t values = (uint32_t)field->rows * field->columns;
+        uint32_t size = record_reader_sample_size(field->sample, half);
+
+        if (index >= values)
+        {
+            index -= values;
+            offset += values * size;
+            continue;
+        }
+
+        offset += index * size;
+        if ((offset + size) > header->length)
+        {
+            break;
+        }
+
+        payload += offset;
+        if (STREAM_SAMPLE_FLOAT32 == field->sample)
+        {
+            float value;
+            uint16_t bits;
+            if (true == half)
+            {
+                memcpy(&bits, payload, sizeof(bits));
+                value = record_reader_half(bits);
+            }
+            else
+            {
+                memcpy(&value, payload, sizeof(value));
+            }
+            return value * field->scale;
+        }
+        else
+        {
+            int16_t value;
+            if (true == half)
+            {
+                value = (int16_t)((int8_t)payload[0] * 256);
+            }
+            else
+            {
+                memcpy(&value, payload, sizeof(value));
+            }
+            return (float)value * field->scale;
+        }
+    }
+
+    return NAN;
+}
+
+/*******************************************************************************
+* Function Name: record_reader_record
+********************************************************************************
+* Summary:
+*    Checks a record against the sequence and the schema of its channel and
+*    delivers it.
+*
+*******************************************************************************/
+static void record_reader_record(record_reader_t *reader, const stream_record_header_t *header,
+                                 const uint8_t *payload)
+{
+    uint8_t channel = header->channel;
+    const record_reader_channel_t *schema = &reader->channel[channel];
+
+    reader->records++;
+    if (true == reader->started[channel])
+    {
+        reader->missing += (uint16_t)(header->sequence - reader->expected[channel]);
+    }
+    reader->started[channel] = true;
+    reader->expected[channel] = (uint16_t)(header->sequence + 1u);
+
+    if (STREAM_RECORD_SCHEMA == header->type)
+    {
+        record_reader_schema(reader, payload, header->length);
+    }
+    else if ((0u != schema->block_size) &&
+             (((STREAM_RECORD_DATA == header->type) && (header->length != schema->block_size)) ||
+              ((STREAM_RECORD_DATA_HALF == header->type) && (header->length != schema->block_size / 2u))))
+    {
+        reader->mismatched++;
+    }
+
+    if (NULL != reader->deliver)
+    {
+        reader->deliver(reader->context, header, payload);
+    }
+}
+
+/*******************************************************************************
+* Function Name: record_reader_schema
+********************************************************************************
+* Summary:
+*    Replaces the description of the channels with the one of a schema
+*    record. Malformed schemas and unknown versions are ignored.
+*
+*******************************************************************************/
+static void record_reader_schema(record_reader_t *reader, const uint8_t *payload,
+                                 uint16_t length)
+{
+    stream_schema_header_t header;
+    stream_schema_field_t field;
+
+    if (length < sizeof(header))
+    {
+        return;
+    }
+    memcpy(&header, payload, sizeof(header));
+    if ((STREAM_SCHEMA_VERSION != header.version) ||
+        (length < (sizeof(header) + header.count * sizeof(field))))
+    {
+        return;
+    }
+
+    memset(reader->channel, 0, sizeof(reader->channel));
+    for (uint8_t i = 0; i < header.count; i++)
+    {
+        memcpy(&field, &payload[sizeof(header) + i * sizeof(field)], sizeof(field));
+        if (field.channel >= STREAM_CHANNEL_COUNT)
+        {
+            continue;
+        }
+
+        record_reader_channel_t *channel = &reader->channel[field.channel];
+        if (channel->count < STREAM_SCHEMA_MAX_FIELDS)
+        {
+            channel->field[channel->count++] = field;
+            channel->block_size += (uint32_t)field.rows * field.columns *
+                                   record_reader_sample_size(field.sample, false);
+        }
+    }
+
+    reader->flags = header.flags;
+    reader->described = true;
+}
+
+/*******************************************************************************
+* Function Name: record_reader_half
+********************************************************************************
+* Summary:
+*    Converts an IEEE 754 binary16 value to a float.
+*
+*******************************************************************************/
+static float record_reader_half(uint16_t half)
+{
+    int32_t exponent = (half >> 10) & 0x1F;
+    float mantissa = (float)(half & 0x3FF);
+    float value;
+
+    if (0 == exponent)
+    {
+        value = ldexpf(mantissa, -24);
+    }
+    else if (0x1F == exponent)
+    {
+        value = (0.0f == mantissa) ? INFINITY : NAN;
+    }
+    else
+    {
+        value = ldexpf(mantissa + 1024.0f, exponent - 25);
+    }
+
+    return (0u != (half & 0x8000u)) ? -value : value;
+}
+
+/* [] END OF FILE */
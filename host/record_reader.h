@@ -0,0 +1,102 @@
+/******************************************************************************
+* File Name:   record_reader.h
+*
+* Description: This file contains the function prototypes and types used in
+*   record_reader.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef HOST_RECORD_READER_H_
+#define HOST_RECORD_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stream_record.h"
+#include "stream_schema.h"
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Called with each record, in order. The schema of the stream is already
+ * updated when a schema record is delivered. */
+typedef void (*record_reader_deliver_t)(void *context, const stream_record_header_t *header,
+                                        const uint8_t *payload);
+
+/* Fields of the blocks of a channel */
+typedef struct
+{
+    uint8_t count;
+    stream_schema_field_t field[STREAM_SCHEMA_MAX_FIELDS];
+    uint32_t block_size;        /* Size of a data block in bytes, 0 if the
+                                 * channel is not described */
+} record_reader_channel_t;
+
+typedef struct
+{
+    record_reader_deliver_t deliver;
+    void *context;
+
+    uint8_t *buffer;            /* Bytes not parsed yet */
+    size_t fill;
+
+    bool described;             /* A schema record was received */
+    uint8_t flags;              /* STREAM_SCHEMA_x */
+    record_reader_channel_t channel[STREAM_CHANNEL_COUNT];
+    uint16_t expected[STREAM_CHANNEL_COUNT];
+    bool started[STREAM_CHANNEL_COUNT];
+
+    uint32_t records;           /* Records received, statistics follow */
+    uint32_t skipped;           /* Bytes skipped to resynchronize */
+    uint32_t missing;           /* Records missing from the sequences */
+    uint32_t mismatched;        /* Data records not matching the schema */
+} record_reader_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+int record_reader_init(record_reader_t *reader, record_reader_deliver_t deliver, void *context);
+void record_reader_feed(record_reader_t *reader, const uint8_t *data, size_t count);
+void record_reader_restart(record_reader_t *reader);
+void record_reader_free(record_reader_t *reader);
+uint32_t record_reader_sample_size(uint8_t sample, bool half);
+float record_reader_value(const record_reader_t *reader, const stream_record_header_t *header,
+                          const uint8_t *payload, uint32_t index);
+
+
+#endif /* HOST_RECORD_READER_H_ */
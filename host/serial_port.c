@@ -0,0 +1,138 @@
+/******************************************************************************
+* File Name:   serial_port.c
+*
+* Description: This file opens the serial port (KitProg3 UART or USB CDC) the
+*              device streams to, in raw mode.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "serial_port.h"
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static speed_t serial_port_speed(uint32_t baud_rate);
+
+/*******************************************************************************
+* Function Name: serial_port_open
+********************************************************************************
+* Summary:
+*    Opens a serial port in raw mode, 8 data bits, no parity, one stop bit and
+*    no flow control. Reads return as soon as some data is received.
+*
+* Parameters:
+*   path: device of the port, such as /dev/ttyACM0
+*   baud_rate: baud rate, ignored by USB CDC devices
+*
+* Return:
+*     The file descriptor of the port, -1 on error (errno is set).
+*
+*******************************************************************************/
+int serial_port_open(const char *path, uint32_t baud_rate)
+{
+    struct termios options;
+    speed_t speed = serial_port_speed(baud_rate);
+    int fd;
+
+    if (B0 == speed)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (0 != tcgetattr(fd, &options))
+    {
+        /* Not a terminal, such as a pipe used for testing */
+        return fd;
+    }
+
+    cfmakeraw(&options);
+    options.c_cflag |= CLOCAL | CREAD;
+    options.c_cflag &= ~(CSTOPB | CRTSCTS);
+    options.c_cc[VMIN] = 1;
+    options.c_cc[VTIME] = 0;
+    cfsetispeed(&options, speed);
+    cfsetospeed(&options, speed);
+
+    if (0 != tcsetattr(fd, TCSANOW, &options))
+    {
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+
+    return fd;
+}
+
+/*******************************************************************************
+* Function Name: serial_port_speed
+********************************************************************************
+* Summary:
+*    Converts a baud rate to its termios constant, B0 if not supported.
+*
+*******************************************************************************/
+static speed_t serial_port_speed(uint32_t baud_rate)
+{
+    switch (baud_rate)
+    {
+        case 115200u:   return B115200;
+        case 230400u:   return B230400;
+#if defined(B460800)
+        case 460800u:   return B460800;
+#endif
+#if defined(B921600)
+        case 921600u:   return B921600;
+#endif
+#if defined(B1000000)
+        case 1000000u:  return B1000000;
+#endif
+        default:        return B0;
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,238 @@
+/******************************************************************************
+* File Name:   spi_receive.c
+*
+* Description: Host tool for a Linux board acting as SPI master (spidev) that
+*              reads the data streamed by the device over its SPI slave
+*              interface (STREAM_TRANSPORT=SPI_SLAVE) and writes it to a file.
+*              Frames are read back to back while the device reports data
+*              available, and polled otherwise. Stops on Ctrl+C.
+*
+*              Usage: spi_receive [-f frame_size] [-s speed_hz] [-p poll_us]
+*                                 <spidev> <output>
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <fcntl.h>
+#include <linux/spi/spidev.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mtb_data_streaming_spi_slave.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define SPI_RECEIVE_DEFAULT_FRAME_SIZE  (1024u)
+#define SPI_RECEIVE_DEFAULT_SPEED_HZ    (16000000u)
+#define SPI_RECEIVE_DEFAULT_POLL_US     (500u)
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static void stop(int signal_number);
+static double now_s(void);
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static volatile sig_atomic_t running = 1;
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+*    Reads the frames of the device until interrupted, and prints the
+*    throughput.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    uint32_t frame_size = SPI_RECEIVE_DEFAULT_FRAME_SIZE;
+    uint32_t speed = SPI_RECEIVE_DEFAULT_SPEED_HZ;
+    uint32_t poll_us = SPI_RECEIVE_DEFAULT_POLL_US;
+    mtb_data_streaming_spi_slave_header_t header;
+    uint64_t received = 0;
+    uint64_t frames = 0;
+    uint64_t resyncs = 0;
+    uint8_t mode = SPI_MODE_0;
+    uint8_t bits = 8;
+    uint8_t *tx;
+    uint8_t *rx;
+    FILE *output;
+    double start;
+    int option;
+    int fd;
+
+    while ((option = getopt(argc, argv, "f:s:p:")) != -1)
+    {
+        switch (option)
+        {
+            case 'f':
+                frame_size = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                speed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'p':
+                poll_us = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                optind = argc;
+                break;
+        }
+    }
+    if (((argc - optind) != 2) || (frame_size <= MTB_DATA_STREAMING_SPI_SLAVE_HEADER_SIZE))
+    {
+        fprintf(stderr, "usage: %s [-f frame_size] [-s speed_hz] [-p poll_us] <spidev> <output>\n",
+                argv[0]);
+        return 1;
+    }
+
+    fd = open(argv[optind], O_RDWR);
+    if ((fd < 0) || (ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0) ||
+        (ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) ||
+        (ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0))
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+    output = fopen(argv[optind + 1], "wb");
+    if (NULL == output)
+    {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+
+    /* The frames sent carry no data: the device ignores them */
+    tx = calloc(frame_size, 1);
+    rx = malloc(frame_size);
+    if ((NULL == tx) || (NULL == rx))
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    signal(SIGINT, stop);
+    start = now_s();
+    while (running)
+    {
+        struct spi_ioc_transfer transfer;
+
+        memset(&transfer, 0, sizeof(transfer));
+        transfer.tx_buf = (uintptr_t)tx;
+        transfer.rx_buf = (uintptr_t)rx;
+        transfer.len = frame_size;
+        transfer.speed_hz = speed;
+        transfer.bits_per_word = bits;
+        if (ioctl(fd, SPI_IOC_MESSAGE(1), &transfer) < 0)
+        {
+            perror("transfer");
+            break;
+        }
+        frames++;
+
+        memcpy(&header, rx, sizeof(header));
+        if ((MTB_DATA_STREAMING_SPI_SLAVE_SYNC != header.sync) ||
+            (header.length > (frame_size - MTB_DATA_STREAMING_SPI_SLAVE_HEADER_SIZE)))
+        {
+            /* Device not ready, or frame sizes that do not match */
+            resyncs++;
+            usleep(poll_us);
+            continue;
+        }
+
+        if (fwrite(&rx[MTB_DATA_STREAMING_SPI_SLAVE_HEADER_SIZE], 1, header.length, output) !=
+            header.length)
+        {
+            perror("write");
+            break;
+        }
+        received += header.length;
+
+        if ((0u == header.length) && (0u == header.available))
+        {
+            usleep(poll_us);
+        }
+    }
+
+    double elapsed = now_s() - start;
+    printf("%llu bytes in %llu frames, %.2f Mbit/s, %llu frames out of sync\n",
+           (unsigned long long)received, (unsigned long long)frames,
+           (double)received * 8.0 / elapsed / 1e6, (unsigned long long)resyncs);
+
+    fclose(output);
+    close(fd);
+    free(tx);
+    free(rx);
+    return 0;
+}
+
+/*******************************************************************************
+* Function Name: stop
+********************************************************************************
+* Summary:
+*    Ends the reception on Ctrl+C.
+*
+*******************************************************************************/
+static void stop(int signal_number)
+{
+    (void)signal_number;
+    running = 0;
+}
+
+/*******************************************************************************
+* Function Name: now_s
+********************************************************************************
+* Summary:
+*    Returns a monotonic time in seconds.
+*
+*******************************************************************************/
+static double now_s(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+/* [] END OF FILE */
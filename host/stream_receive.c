@@ -0,0 +1,298 @@
+/******************************************************************************
+* File Name:   stream_receive.c
+*
+* Description: Host tool that receives the data streamed by the device over a
+*              serial port and writes it to a file. When a window is given,
+*              the tool grants the device credits for that many bytes ahead
+*              of what it has written (STREAM_FLOW_CONTROL_ENABLE), so the
+*              device holds its data instead of overflowing the host buffers
+*              when the tool falls behind. With -r, the data is received in
+*              frames (STREAM_RELIABLE_ENABLE): the frames missing are asked
+*              for again and the payloads are written in order. With -s, a
+*              schema record is asked for first.
+*
+*              Usage: stream_receive [-b baud_rate] [-w window] [-r] [-s] <port> <output>
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "serial_port.h"
+#include "frame_receiver.h"
+#include "host_command.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define STREAM_RECEIVE_DEFAULT_BAUD_RATE    (1000000u)
+#define STREAM_RECEIVE_BUFFER_SIZE          (4096u)
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static int send_credit_reset(int fd);
+static int send_credit(int fd, uint32_t limit);
+static int send_schema_request(int fd);
+static void write_payload(void *context, const uint8_t *data, size_t count);
+static void send_nack(void *context, const uint16_t *sequence, size_t count);
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+static int port_fd;
+static FILE *output;
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+*    Receives the stream until the port is closed or an error occurs. A new
+*    credit is sent each time a quarter of the window has been written.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    uint8_t buffer[STREAM_RECEIVE_BUFFER_SIZE];
+    uint32_t baud_rate = STREAM_RECEIVE_DEFAULT_BAUD_RATE;
+    uint32_t window = 0;
+    uint32_t received = 0;
+    uint32_t granted = 0;
+    bool reliable = false;
+    bool schema = false;
+    frame_receiver_t receiver;
+    const char *port;
+    const char *path;
+    ssize_t count;
+    int option;
+    int fd;
+
+    while ((option = getopt(argc, argv, "b:w:rs")) != -1)
+    {
+        switch (option)
+        {
+            case 'b':
+                baud_rate = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                window = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                reliable = true;
+                break;
+            case 's':
+                schema = true;
+                break;
+            default:
+                optind = argc;
+                break;
+        }
+    }
+    if ((argc - optind) != 2)
+    {
+        fprintf(stderr, "usage: %s [-b baud_rate] [-w window] [-r] [-s] <port> <output>\n", argv[0]);
+        return 1;
+    }
+    port = argv[optind];
+    path = argv[optind + 1];
+
+    fd = serial_port_open(port, baud_rate);
+    if (fd < 0)
+    {
+        perror(port);
+        return 1;
+    }
+    port_fd = fd;
+
+    output = fopen(path, "wb");
+    if (NULL == output)
+    {
+        perror(path);
+        return 1;
+    }
+
+    if ((true == reliable) && (0 != frame_receiver_init(&receiver, write_payload, send_nack, NULL)))
+    {
+        perror(path);
+        return 1;
+    }
+
+    if ((true == schema) && (0 != send_schema_request(fd)))
+    {
+        perror(port);
+        return 1;
+    }
+
+    if (0u != window)
+    {
+        /* The device may have been streaming before the port was opened */
+        granted = window;
+        if ((0 != send_credit_reset(fd)) || (0 != send_credit(fd, granted)))
+        {
+            perror(port);
+            return 1;
+        }
+    }
+
+    while ((count = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        if (true == reliable)
+        {
+            frame_receiver_feed(&receiver, buffer, (size_t)count);
+        }
+        else
+        {
+            write_payload(NULL, buffer, (size_t)count);
+        }
+        received += (uint32_t)count;
+
+        /* The credit only moves forward once the data is written */
+        if ((0u != window) && ((received + window - granted) >= (window / 4u)))
+        {
+            fflush(output);
+            granted = received + window;
+            if (0 != send_credit(fd, granted))
+            {
+                perror(port);
+                return 1;
+            }
+        }
+    }
+
+    if (true == reliable)
+    {
+        frame_receiver_free(&receiver);
+        printf("%u frames, %u CRC errors, %u retransmitted, %u lost\n", receiver.frames,
+               receiver.crc_errors, receiver.retransmitted, receiver.lost);
+    }
+    fclose(output);
+    close(fd);
+    printf("%u bytes received\n", received);
+
+    return 0;
+}
+
+/*******************************************************************************
+* Function Name: write_payload
+********************************************************************************
+* Summary:
+*    Writes data received to the output file.
+*
+*******************************************************************************/
+static void write_payload(void *context, const uint8_t *data, size_t count)
+{
+    (void)context;
+
+    if (fwrite(data, 1, count, output) != count)
+    {
+        perror("write");
+        exit(1);
+    }
+}
+
+/*******************************************************************************
+* Function Name: send_nack
+********************************************************************************
+* Summary:
+*    Asks the device to send frames again.
+*
+*******************************************************************************/
+static void send_nack(void *context, const uint16_t *sequence, size_t count)
+{
+    uint8_t command[HOST_COMMAND_SIZE(HOST_COMMAND_MAX_PAYLOAD)];
+    uint32_t size;
+
+    (void)context;
+
+    size = host_command_write(command, HOST_COMMAND_NACK, sequence,
+                              (uint8_t)(count * sizeof(uint16_t)));
+    if (write(port_fd, command, size) != (ssize_t)size)
+    {
+        perror("nack");
+    }
+}
+
+/*******************************************************************************
+* Function Name: send_credit_reset
+********************************************************************************
+* Summary:
+*    Restarts the count of the bytes the credits of the device refer to.
+*
+*******************************************************************************/
+static int send_credit_reset(int fd)
+{
+    uint8_t command[HOST_COMMAND_SIZE(0u)];
+    uint32_t size = host_command_write(command, HOST_COMMAND_CREDIT_RESET, "", 0u);
+
+    return (write(fd, command, size) == (ssize_t)size) ? 0 : -1;
+}
+
+/*******************************************************************************
+* Function Name: send_credit
+********************************************************************************
+* Summary:
+*    Sends a credit command allowing the device to send up to limit bytes
+*    since the start of the stream.
+*
+*******************************************************************************/
+static int send_credit(int fd, uint32_t limit)
+{
+    uint8_t command[HOST_COMMAND_SIZE(sizeof(limit))];
+    uint32_t size = host_command_write(command, HOST_COMMAND_CREDIT, &limit, sizeof(limit));
+
+    return (write(fd, command, size) == (ssize_t)size) ? 0 : -1;
+}
+
+/*******************************************************************************
+* Function Name: send_schema_request
+********************************************************************************
+* Summary:
+*    Asks the device for a schema record.
+*
+*******************************************************************************/
+static int send_schema_request(int fd)
+{
+    uint8_t command[HOST_COMMAND_SIZE(0u)];
+    uint32_t size = host_command_write(command, HOST_COMMAND_SCHEMA, "", 0u);
+
+    return (write(fd, command, size) == (ssize_t)size) ? 0 : -1;
+}
+
+/* [] END OF FILE */
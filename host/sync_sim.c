@@ -0,0 +1,262 @@
+/******************************************************************************
+* File Name:   sync_sim.c
+*
+* Description: Host tool that drives the sync trigger of the firmware
+*              (source/sync_trigger.c) with simulated GPIO events, to check
+*              the alignment of a synchronized capture without boards. The
+*              master drives an edge every SYNC_TRIGGER_PERIOD_MS of its
+*              clock. Each board has its own clock offset and drift and takes
+*              the edges with a random interrupt latency; its main loop
+*              reports them every millisecond, and stalls for a while to
+*              overflow the queue of edges. The samples of each board are
+*              timestamped by its clock, converted to master time by
+*              trigger_align.c, and compared to the time they were taken.
+*
+*              Usage: sync_sim [-b boards] [-s seconds] [-r sample_rate]
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "sync_trigger.h"
+#include "trigger_align.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define SYNC_SIM_DEFAULT_BOARDS     (4u)
+#define SYNC_SIM_DEFAULT_SECONDS    (120u)
+#define SYNC_SIM_DEFAULT_RATE       (16000u)
+/* Drift of the board clocks, in ppm */
+#define SYNC_SIM_MAX_DRIFT          (50.0)
+/* Interrupt latency, in microseconds, sometimes delayed by the time base */
+#define SYNC_SIM_MIN_LATENCY        (0.5)
+#define SYNC_SIM_MAX_LATENCY        (3.0)
+#define SYNC_SIM_PREEMPTED_LATENCY  (10.0)
+/* Main loop period, and stall of the main loop of each board, in seconds */
+#define SYNC_SIM_LOOP_PERIOD        (0.001)
+#define SYNC_SIM_STALL_START        (30.0)
+#define SYNC_SIM_STALL_LENGTH       (12.5)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Clock of a board: device time = offset + (1 + drift) x master time */
+typedef struct
+{
+    double offset;              /* Microseconds */
+    double drift;
+} sync_sim_clock_t;
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static double run_board(uint32_t board, double seconds, uint32_t sample_rate,
+                        uint32_t *missed, double *first_error);
+static uint32_t device_time(const sync_sim_clock_t *clock, double master);
+static double uniform(double low, double high);
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+*    Simulates each board and prints its largest alignment error.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    uint32_t boards = SYNC_SIM_DEFAULT_BOARDS;
+    uint32_t seconds = SYNC_SIM_DEFAULT_SECONDS;
+    uint32_t sample_rate = SYNC_SIM_DEFAULT_RATE;
+    double sample_period;
+    double worst = 0.0;
+    int option;
+
+    while ((option = getopt(argc, argv, "b:s:r:")) != -1)
+    {
+        switch (option)
+        {
+            case 'b':
+                boards = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                seconds = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                sample_rate = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-b boards] [-s seconds] [-r sample_rate]\n", argv[0]);
+                return 1;
+        }
+    }
+    if ((0u == boards) || (0u == sample_rate))
+    {
+        fprintf(stderr, "invalid number of boards or sample rate\n");
+        return 1;
+    }
+
+    srand(1);
+    sample_period = 1e6 / (double)sample_rate;
+    printf("%u boards, %u s, edges every %u ms, samples every %.1f us\n", boards, seconds,
+           SYNC_TRIGGER_PERIOD_MS, sample_period);
+    for (uint32_t board = 0; board < boards; board++)
+    {
+        uint32_t missed;
+        double first_error;
+        double error = run_board(board, (double)seconds, sample_rate, &missed, &first_error);
+
+        printf("board %u: largest error %.2f us, %.2f us before the second edge, "
+               "%u edges missed\n", board, error, first_error, missed);
+        worst = (error > worst) ? error : worst;
+        worst = (first_error > worst) ? first_error : worst;
+    }
+    printf("largest error %.2f us, %.3f sample period\n", worst, worst / sample_period);
+
+    return (worst < sample_period) ? 0 : 1;
+}
+
+/*******************************************************************************
+* Function Name: run_board
+********************************************************************************
+* Summary:
+*    Simulates a board for the given time after the first edge.
+*
+* Return:
+*     The largest error of the master time of its samples, in microseconds,
+*     once the rate of its clock is measured. first_error receives the
+*     largest error before.
+*
+*******************************************************************************/
+static double run_board(uint32_t board, double seconds, uint32_t sample_rate,
+                        uint32_t *missed, double *first_error)
+{
+    /* The first board is the master, the others drift against it */
+    sync_sim_clock_t clock =
+    {
+        .offset = uniform(0.0, 4294967296.0),
+        .drift = (0u == board) ? 0.0 : uniform(-SYNC_SIM_MAX_DRIFT, SYNC_SIM_MAX_DRIFT) * 1e-6,
+    };
+    double period = SYNC_TRIGGER_PERIOD_MS * 1e-3;
+    double start = uniform(0.0, 1.0);
+    double next_edge = start;
+    double sample_step = 1.0 / ((double)sample_rate * (1.0 + clock.drift));
+    double next_sample = uniform(0.0, sample_step);
+    double worst = 0.0;
+    trigger_align_t align;
+    stream_trigger_t trigger;
+
+    sync_trigger_init();
+    trigger_align_init(&align);
+    *first_error = 0.0;
+
+    for (double now = 0.0; now < (start + seconds); now += SYNC_SIM_LOOP_PERIOD)
+    {
+        bool stalled = (now >= (start + SYNC_SIM_STALL_START)) &&
+                       (now < (start + SYNC_SIM_STALL_START + SYNC_SIM_STALL_LENGTH));
+
+        /* Interrupts of the sync input */
+        while (next_edge <= now)
+        {
+            double latency = (0 == (rand() % 100)) ? SYNC_SIM_PREEMPTED_LATENCY :
+                             uniform(SYNC_SIM_MIN_LATENCY, SYNC_SIM_MAX_LATENCY);
+            sync_trigger_edge(device_time(&clock, next_edge + latency * 1e-6));
+            next_edge += period;
+        }
+
+        /* Main loop, the edges reach the host in trigger records */
+        while ((false == stalled) && (true == sync_trigger_pop(&trigger)))
+        {
+            trigger_align_add(&align, &trigger);
+        }
+
+        /* Samples taken since the last loop, timestamped by the board and
+         * sent from the main loop */
+        for (; (false == stalled) && (next_sample <= now); next_sample += sample_step)
+        {
+            double master = trigger_align_to_master(&align, device_time(&clock, next_sample));
+            double error = fabs(master - (next_sample - start)) * 1e6;
+
+            if (true == isnan(master))
+            {
+                continue;
+            }
+            if (align.edges < 2u)
+            {
+                *first_error = (error > *first_error) ? error : *first_error;
+            }
+            else if (error > worst)
+            {
+                worst = error;
+            }
+        }
+    }
+
+    *missed = align.missed;
+    return worst;
+}
+
+/*******************************************************************************
+* Function Name: device_time
+********************************************************************************
+* Summary:
+*    Returns the time of the board clock at a master time in seconds, as read
+*    by timebase_now_us.
+*
+*******************************************************************************/
+static uint32_t device_time(const sync_sim_clock_t *clock, double master)
+{
+    return (uint32_t)(uint64_t)floor(clock->offset + master * (1.0 + clock->drift) * 1e6);
+}
+
+/*******************************************************************************
+* Function Name: uniform
+********************************************************************************
+* Summary:
+*    Returns a random value between low and high.
+*
+*******************************************************************************/
+static double uniform(double low, double high)
+{
+    return low + (high - low) * ((double)rand() / (double)RAND_MAX);
+}
+
+/* [] END OF FILE */
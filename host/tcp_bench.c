@@ -0,0 +1,356 @@
+/******************************************************************************
+* File Name:   tcp_bench.c
+*
+* Description: Host tool that measures the throughput of the non-blocking TCP
+*              streaming interface over the loopback interface, against plain
+*              blocking sends of the same blocks. The data received is checked.
+*
+*              Usage: tcp_bench [-s block_size] [-m megabytes] [-q queue_size]
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mtb_data_streaming_tcp.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define TCP_BENCH_DEFAULT_BLOCK_SIZE    (1024u)
+#define TCP_BENCH_DEFAULT_MEGABYTES     (256u)
+#define TCP_BENCH_DEFAULT_QUEUE_SIZE    (64u * 1024u)
+#define TCP_BENCH_RECEIVE_SIZE          (64u * 1024u)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Receiving end of a run */
+typedef struct
+{
+    int listener;
+    uint64_t received;
+    uint64_t errors;
+} tcp_bench_sink_t;
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static void *sink_thread(void *argument);
+static void fill_block(uint8_t *block, uint64_t offset, uint32_t size);
+static int run(int listener, uint32_t block_size, uint64_t total, uint32_t queue_size,
+               bool streaming);
+static void xfer_done(const void *tag, cy_rslt_t result);
+static double now_s(void);
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static volatile bool bench_busy;
+static cy_rslt_t bench_result;
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+*    Runs the blocking and the non-blocking sends and prints their throughput.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    uint32_t block_size = TCP_BENCH_DEFAULT_BLOCK_SIZE;
+    uint32_t megabytes = TCP_BENCH_DEFAULT_MEGABYTES;
+    uint32_t queue_size = TCP_BENCH_DEFAULT_QUEUE_SIZE;
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    int listener;
+    int option;
+
+    while ((option = getopt(argc, argv, "s:m:q:")) != -1)
+    {
+        switch (option)
+        {
+            case 's':
+                block_size = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                megabytes = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'q':
+                queue_size = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-s block_size] [-m megabytes] [-q queue_size]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (0u == block_size)
+    {
+        fprintf(stderr, "invalid block size\n");
+        return 1;
+    }
+
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    if ((listener < 0) || (0 != bind(listener, (struct sockaddr *)&address, sizeof(address))) ||
+        (0 != listen(listener, 1)) ||
+        (0 != getsockname(listener, (struct sockaddr *)&address, &length)))
+    {
+        perror("listen");
+        return 1;
+    }
+
+    printf("%u MB in blocks of %u bytes, queue of %u bytes\n", megabytes, block_size,
+           queue_size);
+    if ((0 != run(listener, block_size, (uint64_t)megabytes << 20, queue_size, false)) ||
+        (0 != run(listener, block_size, (uint64_t)megabytes << 20, queue_size, true)))
+    {
+        return 1;
+    }
+
+    close(listener);
+    return 0;
+}
+
+/*******************************************************************************
+* Function Name: run
+********************************************************************************
+* Summary:
+*    Sends total bytes to a sink over the loopback interface, with blocking
+*    sends or through the streaming interface, and prints the throughput.
+*
+* Return:
+*     0 if all the data was received intact.
+*
+*******************************************************************************/
+static int run(int listener, uint32_t block_size, uint64_t total, uint32_t queue_size,
+               bool streaming)
+{
+    tcp_bench_sink_t sink = { .listener = listener, .received = 0, .errors = 0 };
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    uint8_t *block = malloc(block_size);
+    uint64_t sent = 0;
+    uint64_t waits = 0;
+    pthread_t thread;
+    double start;
+    int fd;
+
+    getsockname(listener, (struct sockaddr *)&address, &length);
+    pthread_create(&thread, NULL, sink_thread, &sink);
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if ((NULL == block) || (fd < 0) ||
+        (0 != connect(fd, (struct sockaddr *)&address, sizeof(address))))
+    {
+        perror("connect");
+        return 1;
+    }
+
+    start = now_s();
+    if (false == streaming)
+    {
+        while (sent < total)
+        {
+            uint32_t size = ((total - sent) < block_size) ? (uint32_t)(total - sent) : block_size;
+            fill_block(block, sent, size);
+            for (uint32_t offset = 0; offset < size; )
+            {
+                ssize_t bytes = send(fd, &block[offset], size - offset, MSG_NOSIGNAL);
+                if (bytes <= 0)
+                {
+                    perror("send");
+                    return 1;
+                }
+                offset += (uint32_t)bytes;
+            }
+            sent += size;
+        }
+    }
+    else
+    {
+        mtb_data_streaming_tcp_t tcp = { .socket = fd, .buffer = malloc(queue_size),
+                                         .buffer_size = queue_size };
+        mtb_data_streaming_interface_t iface;
+
+        if (CY_RSLT_SUCCESS != mtb_data_streaming_setup_tcp(&tcp, xfer_done, &iface))
+        {
+            fprintf(stderr, "invalid queue size (must be a power of two)\n");
+            return 1;
+        }
+
+        bench_busy = false;
+        bench_result = CY_RSLT_SUCCESS;
+        while ((sent < total) || (true == bench_busy) || (0u != mtb_data_streaming_tcp_queued(&tcp)))
+        {
+            if ((false == bench_busy) && (sent < total))
+            {
+                uint32_t size = ((total - sent) < block_size) ? (uint32_t)(total - sent) : block_size;
+                fill_block(block, sent, size);
+                bench_busy = true;
+                mtb_data_streaming_send(&iface, block, size, NULL);
+                sent += size;
+            }
+
+            if ((CY_RSLT_SUCCESS != mtb_data_streaming_tcp_process(&iface)) ||
+                (CY_RSLT_SUCCESS != bench_result))
+            {
+                fprintf(stderr, "transfer failed\n");
+                return 1;
+            }
+
+            /* Wait for the socket to be ready when the queue is full, or
+             * once everything is queued */
+            if ((true == bench_busy) || (sent == total))
+            {
+                struct pollfd ready = { .fd = fd, .events = POLLOUT };
+                poll(&ready, 1, 100);
+                waits++;
+            }
+        }
+        free(tcp.buffer);
+    }
+
+    shutdown(fd, SHUT_WR);
+    pthread_join(thread, NULL);
+    double elapsed = now_s() - start;
+    close(fd);
+    free(block);
+
+    printf("%-12s %8.1f MB/s, %llu bytes received, %llu errors",
+           streaming ? "non-blocking" : "blocking", (double)total / elapsed / 1048576.0,
+           (unsigned long long)sink.received, (unsigned long long)sink.errors);
+    if (true == streaming)
+    {
+        printf(", %llu waits for POLLOUT", (unsigned long long)waits);
+    }
+    printf("\n");
+
+    return ((sink.received == total) && (0u == sink.errors)) ? 0 : 1;
+}
+
+/*******************************************************************************
+* Function Name: sink_thread
+********************************************************************************
+* Summary:
+*    Accepts a connection and checks the data received until it is closed.
+*
+*******************************************************************************/
+static void *sink_thread(void *argument)
+{
+    tcp_bench_sink_t *sink = argument;
+    uint8_t *buffer = malloc(TCP_BENCH_RECEIVE_SIZE);
+    uint8_t *expected = malloc(TCP_BENCH_RECEIVE_SIZE);
+    int fd = accept(sink->listener, NULL, NULL);
+    ssize_t count;
+
+    while ((fd >= 0) && ((count = recv(fd, buffer, TCP_BENCH_RECEIVE_SIZE, 0)) > 0))
+    {
+        fill_block(expected, sink->received, (uint32_t)count);
+        if (0 != memcmp(buffer, expected, (size_t)count))
+        {
+            sink->errors++;
+        }
+        sink->received += (uint64_t)count;
+    }
+
+    close(fd);
+    free(buffer);
+    free(expected);
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: fill_block
+********************************************************************************
+* Summary:
+*    Writes the test pattern of the stream bytes [offset, offset + size).
+*
+*******************************************************************************/
+static void fill_block(uint8_t *block, uint64_t offset, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++)
+    {
+        uint64_t position = offset + i;
+        block[i] = (uint8_t)(position + (position >> 11));
+    }
+}
+
+/*******************************************************************************
+* Function Name: xfer_done
+********************************************************************************
+* Summary:
+*    Completion callback of the streaming interface.
+*
+*******************************************************************************/
+static void xfer_done(const void *tag, cy_rslt_t result)
+{
+    (void)tag;
+
+    bench_result = result;
+    bench_busy = false;
+}
+
+/*******************************************************************************
+* Function Name: now_s
+********************************************************************************
+* Summary:
+*    Returns a monotonic time in seconds.
+*
+*******************************************************************************/
+static double now_s(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+/* [] END OF FILE */
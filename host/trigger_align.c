@@ -0,0 +1,132 @@
+/******************************************************************************
+* File Name:   trigger_align.c
+*
+* Description: Converts the timestamps of a device to the time of the master
+*              board of a synchronized capture, from the edges of the sync
+*              line latched by the device (trigger records). The master
+*              drives an edge every period of its clock, so the time of edge
+*              n is n x period since the first edge. A timestamp is placed
+*              from the last edge before it, at the rate of the device clock
+*              measured over the last TRIGGER_ALIGN_WINDOW edges, so the
+*              drift of the device clock is corrected at every edge while the
+*              latency of the interrupts is averaged out of the rate. Until
+*              the second edge, the device clock is taken as exact.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+
+#include "trigger_align.h"
+
+/*******************************************************************************
+* Function Name: trigger_align_init
+********************************************************************************
+* Summary:
+*    Sets up an alignment with no edge.
+*
+*******************************************************************************/
+void trigger_align_init(trigger_align_t *align)
+{
+    memset(align, 0, sizeof(*align));
+    align->rate = 1.0;
+}
+
+/*******************************************************************************
+* Function Name: trigger_align_add
+********************************************************************************
+* Summary:
+*    Adds an edge reported by the device. The rate is measured over the
+*    edges missed in between, if any.
+*
+*******************************************************************************/
+void trigger_align_add(trigger_align_t *align, const stream_trigger_t *trigger)
+{
+    uint32_t first;
+    int32_t elapsed;
+
+    if (false == align->started)
+    {
+        align->missed += trigger->edge;
+    }
+    else if (trigger->edge > align->edge[align->last])
+    {
+        align->missed += trigger->edge - align->edge[align->last] - 1u;
+    }
+    else
+    {
+        /* The device restarted, its clock and edge numbers too */
+        align->count = 0;
+    }
+
+    align->started = true;
+    align->last = (align->last + 1u) % TRIGGER_ALIGN_WINDOW;
+    align->edge[align->last] = trigger->edge;
+    align->time[align->last] = trigger->time;
+    align->count += (align->count < TRIGGER_ALIGN_WINDOW) ? 1u : 0u;
+    align->period = trigger->period;
+    align->edges++;
+
+    first = (align->last + TRIGGER_ALIGN_WINDOW + 1u - align->count) % TRIGGER_ALIGN_WINDOW;
+    elapsed = (int32_t)(trigger->time - align->time[first]);
+    align->rate = (elapsed > 0) ?
+                  ((double)(trigger->edge - align->edge[first]) * trigger->period / (double)elapsed) :
+                  1.0;
+}
+
+/*******************************************************************************
+* Function Name: trigger_align_to_master
+********************************************************************************
+* Summary:
+*    Converts a device time to master time.
+*
+* Return:
+*     Seconds since the first edge, or NAN before an edge is reported.
+*
+*******************************************************************************/
+double trigger_align_to_master(const trigger_align_t *align, uint32_t device_us)
+{
+    if (false == align->started)
+    {
+        return NAN;
+    }
+
+    return ((double)align->edge[align->last] * align->period +
+            (double)(int32_t)(device_us - align->time[align->last]) * align->rate) * 1e-6;
+}
+
+/* [] END OF FILE */
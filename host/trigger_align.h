@@ -0,0 +1,84 @@
+/******************************************************************************
+* File Name:   trigger_align.h
+*
+* Description: This file contains the alignment state and the function
+*              prototypes used in trigger_align.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef HOST_TRIGGER_ALIGN_H_
+#define HOST_TRIGGER_ALIGN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stream_record.h"
+
+/******************************************************************************
+ * Constants
+ *****************************************************************************/
+/* Number of the last edges the rate of the device clock is measured over */
+#define TRIGGER_ALIGN_WINDOW        (16u)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Last edges of the sync line reported by a device */
+typedef struct
+{
+    bool started;
+    uint32_t edge[TRIGGER_ALIGN_WINDOW];    /* Numbers of the last edges */
+    uint32_t time[TRIGGER_ALIGN_WINDOW];    /* Device times of the last edges,
+                                             * in microseconds */
+    uint32_t count;             /* Edges of the window */
+    uint32_t last;              /* Index of the last edge */
+    uint32_t period;            /* Interval between the edges, microseconds */
+    double rate;                /* Master time per device time, measured
+                                 * over the edges of the window */
+    uint32_t edges;             /* Edges reported */
+    uint32_t missed;            /* Edges not reported by the device */
+} trigger_align_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void trigger_align_init(trigger_align_t *align);
+void trigger_align_add(trigger_align_t *align, const stream_trigger_t *trigger);
+double trigger_align_to_master(const trigger_align_t *align, uint32_t device_us);
+
+
+#endif /* HOST_TRIGGER_ALIGN_H_ */
@@ -24,6 +24,8 @@
 * limitations under the License.
 *******************************************************************************/
 
+#include <stdbool.h>
+#include <string.h>
 #include "mtb_data_streaming.h"
 
 typedef union
@@ -37,9 +39,6 @@ typedef union
     #if defined(CYHAL_DRIVER_AVAILABLE_SPI)
     cyhal_spi_t*                        spi;
     #endif
-    #if defined(COMPONENT_MW_SECURE_SOCKETS)
-    cy_socket_t                         tcp;
-    #endif
     #if defined(CYHAL_DRIVER_AVAILABLE_UART)
     cyhal_uart_t*                       uart;
     #endif
@@ -50,9 +49,12 @@ typedef union
 
 typedef struct
 {
-    mtb_data_streaming_obj_t        obj_inst;
-    mtb_data_streaming_xfer_done_t  callback;
-    void*                           call_tag;
+    mtb_data_streaming_obj_t            obj_inst;
+    mtb_data_streaming_xfer_done_t      callback;
+    void*                               call_tag;
+    const mtb_data_streaming_segment_t* segments;       // Segments of a vectored send left to send
+    size_t                              segment_count;
+    void*                               rx;             // Continuous receive (UART)
 } mtb_data_streaming_context_t;
 
 /*
@@ -87,79 +89,370 @@ static inline void _check_size(void)
 #endif
 
 
+#if defined(CYHAL_DRIVER_AVAILABLE_I2C) || defined(CYHAL_DRIVER_AVAILABLE_SPI) || \
+    defined(CYHAL_DRIVER_AVAILABLE_UART) || defined(COMPONENT_MW_EMUSB_DEVICE)
+/* Starts the asynchronous transfer of one segment of a vectored send */
+typedef cy_rslt_t (* mtb_data_streaming_write_t)(mtb_data_streaming_context_t* context,
+                                                 uint8_t* data, size_t count);
+
+//--------------------------------------------------------------------------------------------------
+// _send_next
+//
+// Starts the transfer of the next non-empty segment of a vectored send. Returns false once all the
+// segments are sent, or when the transfer could not be started (rslt is then set to the error).
+//--------------------------------------------------------------------------------------------------
+static bool _send_next(mtb_data_streaming_context_t* context, mtb_data_streaming_write_t write,
+                       cy_rslt_t* rslt)
+{
+    while (0u != context->segment_count)
+    {
+        const mtb_data_streaming_segment_t* segment = context->segments;
+        context->segments++;
+        context->segment_count--;
+
+        if (0u != segment->count)
+        {
+            *rslt = write(context, segment->data, segment->count);
+            if (CY_RSLT_SUCCESS == *rslt)
+            {
+                return true;
+            }
+            context->segment_count = 0;
+        }
+    }
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// _sendv
+//
+// Vectored send for the interfaces whose driver only takes a contiguous buffer: the segments are
+// sent by chained asynchronous transfers, the completion callback starting the next one.
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t _sendv(mtb_data_streaming_context_t* context,
+                        const mtb_data_streaming_segment_t* segments, size_t segment_count,
+                        void* tag, mtb_data_streaming_write_t write)
+{
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+    uint32_t state = cyhal_system_critical_section_enter();
+    if (NULL == context->call_tag)
+    {
+        context->call_tag = tag;
+        cyhal_system_critical_section_exit(state);
+
+        context->segments = segments;
+        context->segment_count = segment_count;
+        if (!_send_next(context, write, &rslt))
+        {
+            context->call_tag = NULL;
+            if ((CY_RSLT_SUCCESS == rslt) && (NULL != context->callback))
+            {
+                // Nothing to send
+                context->callback(tag, CY_RSLT_SUCCESS);
+            }
+        }
+    }
+    else
+    {
+        cyhal_system_critical_section_exit(state);
+        rslt = MTB_DATA_STREAMING_IN_PROGRESS_ERR;
+    }
+    return rslt;
+}
+
+
+#endif // Chained transfers
+
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // BLE SUPPORT
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 #if defined(COMPONENT_MW_BTSTACK)
+#define _BLE_MAX_VALUE      (512u)  // Longest attribute value allowed by ATT
+
 //--------------------------------------------------------------------------------------------------
-// mtb_data_streaming_ble_cb
+// _ble_fill
+//
+// Builds the next notification of the send request in the next slot of the buffer, and returns its
+// size. Returns 0 once all the data of the request is in notifications.
 //--------------------------------------------------------------------------------------------------
-static void mtb_data_streaming_ble_cb(void* callback_arg)
+static uint16_t _ble_fill(mtb_data_streaming_context_t* context)
 {
-    mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)async_ctx->pContext;
-    mtb_data_streaming_xfer_done_t callback = context->callback;
-    void* tag = context->call_tag;
-    context->call_tag = NULL;
+    mtb_data_streaming_ble_t* ble = context->obj_inst.ble;
+    uint8_t* slot = &ble->buffer[(size_t)ble->next_slot * ble->slot_size];
+    size_t size = MTB_DATA_STREAMING_BLE_HEADER_SIZE;
 
-    if (NULL != callback)
+    while ((0u != context->segment_count) && (size < ble->slot_size))
     {
-        cy_rslt_t rslt = (0 == async_ctx->Status)
-            ? CY_RSLT_SUCCESS
-            : MTB_DATA_STREAMING_XFER_ERR;
-        callback(tag, rslt);
+        const mtb_data_streaming_segment_t* segment = context->segments;
+        size_t count = segment->count - ble->offset;
+        if (count > (ble->slot_size - size))
+        {
+            count = ble->slot_size - size;
+        }
+        memcpy(&slot[size], &segment->data[ble->offset], count);
+        size += count;
+        ble->offset += count;
+
+        if (ble->offset == segment->count)
+        {
+            context->segments++;
+            context->segment_count--;
+            ble->offset = 0;
+        }
     }
+    // Skip the empty segments at the end, for the last notification to be flagged as such
+    while ((0u != context->segment_count) && (0u == context->segments->count))
+    {
+        context->segments++;
+        context->segment_count--;
+    }
+
+    if ((MTB_DATA_STREAMING_BLE_HEADER_SIZE == size) && !ble->first)
+    {
+        return 0;
+    }
+    slot[0] = ble->sequence;
+    slot[1] = (ble->first ? MTB_DATA_STREAMING_BLE_FIRST : 0u) |
+              ((0u == context->segment_count) ? MTB_DATA_STREAMING_BLE_LAST : 0u);
+    ble->first = false;
+    return (uint16_t)size;
 }
 
 
 //--------------------------------------------------------------------------------------------------
-// mtb_data_streaming_ble_send
+// _ble_notify
 //--------------------------------------------------------------------------------------------------
-static cy_rslt_t mtb_data_streaming_ble_send(mtb_data_streaming_vcontext_t* vcontext,
-                                             /*const*/ uint8_t* data, size_t count, void* tag)
+static wiced_bt_gatt_status_t _ble_notify(mtb_data_streaming_ble_t* ble, uint8_t* data,
+                                          uint16_t count)
 {
-    cy_rslt_t rslt;
-    mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)vcontext;
+    wiced_bt_gatt_status_t status = WICED_BT_GATT_WRITE_REQ_REJECTED;
+    if (0u != (ble->client_config[0] & GATT_CLIENT_CONFIG_NOTIFICATION))
+    {
+        status = wiced_bt_gatt_server_send_notification(
+            ble->conn_id, ble->attribute, count, data, NULL);
+    }
+    else if (0u != (ble->client_config[0] & GATT_CLIENT_CONFIG_INDICATION))
+    {
+        status = wiced_bt_gatt_server_send_indication(
+            ble->conn_id, ble->attribute, count, data, NULL);
+    }
+    return status;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// _ble_pump
+//
+// Queues notifications in the stack until the slots of the buffer are all in flight, the stack is
+// congested or the request is all sent, and completes the request once its notifications are all
+// transmitted. It runs from the application (send) and from the stack (transmitted): a call made
+// while another one is running makes that one go around again instead.
+//--------------------------------------------------------------------------------------------------
+static void _ble_pump(mtb_data_streaming_context_t* context)
+{
+    mtb_data_streaming_ble_t* ble = context->obj_inst.ble;
 
     uint32_t state = cyhal_system_critical_section_enter();
-    if (NULL == context->call_tag)
+    if (ble->pumping)
     {
-        context->call_tag = tag;
+        ble->repump = true;
         cyhal_system_critical_section_exit(state);
+        return;
+    }
+    ble->pumping = true;
+    cyhal_system_critical_section_exit(state);
 
-        mtb_data_streaming_ble_t* ble = context->obj_inst.ble;
-
-        if (count <= ble->send_buffer_size)
+    bool again = true;
+    while (again)
+    {
+        uint8_t limit = (0u != (ble->client_config[0] & GATT_CLIENT_CONFIG_NOTIFICATION))
+            ? ble->slot_count
+            : 1u;
+        while (ble->sending && !ble->failed && (ble->in_flight < limit))
         {
-            memcpy(ble->send_buffer, data, count);
-
-            wiced_bt_gatt_status_t status = WICED_BT_GATT_WRITE_REQ_REJECTED;
-            if (0 == ble->client_config[0] & GATT_CLIENT_CONFIG_NOTIFICATION)
+            if (0u == ble->pending)
             {
-                status = wiced_bt_gatt_server_send_notification(
-                    ble->conn_id, ble->attribute, count, ble->send_buffer, NULL);
+                ble->pending = _ble_fill(context);
+                if (0u == ble->pending)
+                {
+                    break;
+                }
             }
-            else if (0 == ble->client_config[0] & GATT_CLIENT_CONFIG_INDICATION)
+
+            // Counted before queuing, the stack can report it transmitted before returning
+            state = cyhal_system_critical_section_enter();
+            ble->in_flight++;
+            cyhal_system_critical_section_exit(state);
+
+            wiced_bt_gatt_status_t status =
+                _ble_notify(ble, &ble->buffer[(size_t)ble->next_slot * ble->slot_size],
+                            ble->pending);
+            if (WICED_BT_GATT_SUCCESS != status)
             {
-                status = wiced_bt_gatt_server_send_indication(
-                    ble->conn_id, ble->attribute, count, ble->send_buffer, NULL);
-            }
+                state = cyhal_system_critical_section_enter();
+                ble->in_flight--;
+                cyhal_system_critical_section_exit(state);
 
-            rslt = (WICED_BT_GATT_SUCCESS == status)
-                ? CY_RSLT_SUCCESS
-                : MTB_DATA_STREAMING_XFER_ERR;
+                // A congested stack takes the notification again after the next transmission
+                ble->failed = (WICED_BT_GATT_CONGESTED != status);
+                break;
+            }
+            ble->pending = 0;
+            ble->sequence++;
+            ble->next_slot = (uint8_t)((ble->next_slot + 1u) % ble->slot_count);
         }
-        else
+
+        bool sent = (0u == ble->pending) && (0u == context->segment_count) && !ble->first;
+        if (ble->sending && (0u == ble->in_flight) && (ble->failed || sent))
         {
-            rslt = MTB_DATA_STREAMING_OVERFLOW_ERR;
+            mtb_data_streaming_xfer_done_t callback = context->callback;
+            void* tag = context->call_tag;
+            cy_rslt_t rslt = ble->failed ? MTB_DATA_STREAMING_XFER_ERR : CY_RSLT_SUCCESS;
+            ble->sending = false;
+            context->call_tag = NULL;
+            if (NULL != callback)
+            {
+                callback(tag, rslt);
+            }
         }
+
+        state = cyhal_system_critical_section_enter();
+        again = ble->repump;
+        ble->repump = false;
+        ble->pumping = again;
+        cyhal_system_critical_section_exit(state);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// _ble_claim
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t _ble_claim(mtb_data_streaming_context_t* context, void* tag)
+{
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+    uint32_t state = cyhal_system_critical_section_enter();
+    if (NULL == context->call_tag)
+    {
+        context->call_tag = tag;
     }
     else
     {
-        cyhal_system_critical_section_exit(state);
         rslt = MTB_DATA_STREAMING_IN_PROGRESS_ERR;
     }
+    cyhal_system_critical_section_exit(state);
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// _ble_start
+//
+// Starts a claimed send request: the segments are fragmented in notifications of the MTU.
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t _ble_start(mtb_data_streaming_context_t* context,
+                            const mtb_data_streaming_segment_t* segments, size_t segment_count)
+{
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+    mtb_data_streaming_ble_t* ble = context->obj_inst.ble;
+    void* tag = context->call_tag;
+
+    size_t count = 0;
+    for (size_t i = 0; i < segment_count; i++)
+    {
+        count += segments[i].count;
+    }
 
+    uint16_t mtu = (0u != ble->mtu) ? ble->mtu : MTB_DATA_STREAMING_BLE_DEFAULT_MTU;
+    size_t slot_size = mtu - MTB_DATA_STREAMING_BLE_ATT_HEADER;
+    if (slot_size > _BLE_MAX_VALUE)
+    {
+        slot_size = _BLE_MAX_VALUE;
+    }
+    size_t slot_count = ble->buffer_size / slot_size;
+    if (slot_count > UINT8_MAX)
+    {
+        slot_count = UINT8_MAX;
+    }
+
+    if (0u == (ble->client_config[0] &
+               (GATT_CLIENT_CONFIG_NOTIFICATION | GATT_CLIENT_CONFIG_INDICATION)))
+    {
+        context->call_tag = NULL;
+        rslt = MTB_DATA_STREAMING_XFER_ERR;
+    }
+    else if ((mtu <= (MTB_DATA_STREAMING_BLE_ATT_HEADER + MTB_DATA_STREAMING_BLE_HEADER_SIZE)) ||
+             (0u == slot_count))
+    {
+        context->call_tag = NULL;
+        rslt = MTB_DATA_STREAMING_OVERFLOW_ERR;
+    }
+    else if (0u == count)
+    {
+        // Nothing to send
+        context->call_tag = NULL;
+        if (NULL != context->callback)
+        {
+            context->callback(tag, CY_RSLT_SUCCESS);
+        }
+    }
+    else
+    {
+        context->segments = segments;
+        context->segment_count = segment_count;
+        ble->offset = 0;
+        ble->slot_size = (uint16_t)slot_size;
+        ble->slot_count = (uint8_t)slot_count;
+        ble->next_slot = 0;
+        ble->pending = 0;
+        ble->first = true;
+        ble->failed = false;
+        ble->sending = true;
+        _ble_pump(context);
+    }
+
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_ble_sendv
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_ble_sendv(mtb_data_streaming_vcontext_t* vcontext,
+                                              const mtb_data_streaming_segment_t* segments,
+                                              size_t segment_count, void* tag)
+{
+    mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)vcontext;
+
+    cy_rslt_t rslt = _ble_claim(context, tag);
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        rslt = _ble_start(context, segments, segment_count);
+    }
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_ble_send
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_ble_send(mtb_data_streaming_vcontext_t* vcontext,
+                                             /*const*/ uint8_t* data, size_t count, void* tag)
+{
+    mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)vcontext;
+    mtb_data_streaming_ble_t* ble = context->obj_inst.ble;
+
+    cy_rslt_t rslt = _ble_claim(context, tag);
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        // The segment must outlive the call, it is sent from the stack callbacks
+        ble->segment.data = data;
+        ble->segment.count = count;
+        rslt = _ble_start(context, &ble->segment, 1);
+    }
     return rslt;
 }
 
@@ -170,32 +463,50 @@ static cy_rslt_t mtb_data_streaming_ble_send(mtb_data_streaming_vcontext_t* vcon
 static cy_rslt_t mtb_data_streaming_ble_receive(mtb_data_streaming_vcontext_t* vcontext,
                                                 uint8_t* data, size_t count, void* tag)
 {
-    cy_rslt_t rslt;
     mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)vcontext;
+    mtb_data_streaming_ble_t* ble = context->obj_inst.ble;
 
-    uint32_t state = cyhal_system_critical_section_enter();
-    if (NULL == context->call_tag)
+    cy_rslt_t rslt = _ble_claim(context, tag);
+    if (CY_RSLT_SUCCESS == rslt)
     {
-        context->call_tag = tag;
-        cyhal_system_critical_section_exit(state);
-
+        context->call_tag = NULL;
         if (count <= ble->receive_buffer_size)
         {
             memcpy(data, ble->receive_buffer, count);
-            rslt =  CY_RSLT_SUCCESS;
+            if (NULL != context->callback)
+            {
+                context->callback(tag, CY_RSLT_SUCCESS);
+            }
         }
         else
         {
             rslt = MTB_DATA_STREAMING_UNDERFLOW_ERR;
         }
     }
-    else
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_ble_transmitted
+//--------------------------------------------------------------------------------------------------
+void mtb_data_streaming_ble_transmitted(mtb_data_streaming_interface_t* iface, const uint8_t* data)
+{
+    mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)&(iface->context);
+    mtb_data_streaming_ble_t* ble = context->obj_inst.ble;
+
+    // NULL is an indication confirmed, other buffers are notifications of the application
+    bool own = (NULL == data) ||
+               ((data >= ble->buffer) && (data < &ble->buffer[ble->buffer_size]));
+    uint32_t state = cyhal_system_critical_section_enter();
+    if (own && (0u != ble->in_flight))
     {
-        cyhal_system_critical_section_exit(state);
-        rslt = MTB_DATA_STREAMING_IN_PROGRESS_ERR;
+        ble->in_flight--;
     }
+    cyhal_system_critical_section_exit(state);
 
-    return rslt;
+    // Any transmission can end a congestion of the stack
+    _ble_pump(context);
 }
 
 
@@ -208,10 +519,18 @@ cy_rslt_t mtb_data_streaming_setup_ble(mtb_data_streaming_ble_t* ble,
 {
     iface->send     = mtb_data_streaming_ble_send;
     iface->receive  = mtb_data_streaming_ble_receive;
+    iface->sendv    = mtb_data_streaming_ble_sendv;
     mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)&(iface->context);
     context->obj_inst.ble  = ble;
     context->callback  = cb;
     context->call_tag  = NULL;
+    context->segment_count = 0;
+
+    ble->sequence   = 0;
+    ble->in_flight  = 0;
+    ble->sending    = false;
+    ble->pumping    = false;
+    ble->repump     = false;
 
     return CY_RSLT_SUCCESS;
 }
@@ -315,6 +634,7 @@ cy_rslt_t mtb_data_streaming_setup_i2c(cyhal_i2c_t* i2c, mtb_data_streaming_xfer
 {
     iface->send     = mtb_data_streaming_i2c_send;
     iface->receive  = mtb_data_streaming_i2c_receive;
+    iface->sendv    = NULL; // Vectored sends need the target address, which is not known
     mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)&(iface->context);
     context->obj_inst.i2c  = i2c;
     context->callback  = cb;
@@ -341,9 +661,24 @@ cy_rslt_t mtb_data_streaming_setup_i2c(cyhal_i2c_t* i2c, mtb_data_streaming_xfer
 //--------------------------------------------------------------------------------------------------
 // mtb_data_streaming_spi_cb
 //--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_spi_write(mtb_data_streaming_context_t* context,
+                                              uint8_t* data, size_t count);
+
 static void mtb_data_streaming_spi_cb(void* callback_arg, cyhal_spi_event_t event)
 {
     mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)callback_arg;
+    cy_rslt_t next = CY_RSLT_SUCCESS;
+
+    if ((CYHAL_SPI_IRQ_DONE == event) && _send_next(context, mtb_data_streaming_spi_write, &next))
+    {
+        return; // Next segment of a vectored send started
+    }
+    context->segment_count = 0;
+    if (CY_RSLT_SUCCESS != next)
+    {
+        event = CYHAL_SPI_IRQ_ERROR;
+    }
+
     mtb_data_streaming_xfer_done_t callback = context->callback;
     void* tag = context->call_tag;
     context->call_tag = NULL;
@@ -409,6 +744,28 @@ static cy_rslt_t mtb_data_streaming_spi_send(mtb_data_streaming_vcontext_t* cont
 }
 
 
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_write
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_spi_write(mtb_data_streaming_context_t* context,
+                                              uint8_t* data, size_t count)
+{
+    return cyhal_spi_transfer_async(context->obj_inst.spi, data, count, NULL, 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_sendv
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_spi_sendv(mtb_data_streaming_vcontext_t* context,
+                                              const mtb_data_streaming_segment_t* segments,
+                                              size_t segment_count, void* tag)
+{
+    return _sendv((mtb_data_streaming_context_t*)context, segments, segment_count, tag,
+                  mtb_data_streaming_spi_write);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // mtb_data_streaming_spi_receive
 //--------------------------------------------------------------------------------------------------
@@ -428,10 +785,12 @@ cy_rslt_t mtb_data_streaming_setup_spi(cyhal_spi_t* spi, mtb_data_streaming_xfer
 {
     iface->send     = mtb_data_streaming_spi_send;
     iface->receive  = mtb_data_streaming_spi_receive;
+    iface->sendv    = mtb_data_streaming_spi_sendv;
     mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)&(iface->context);
     context->obj_inst.spi  = spi;
     context->callback  = cb;
     context->call_tag  = NULL;
+    context->segment_count = 0;
 
     cyhal_spi_register_callback(spi, mtb_data_streaming_spi_cb, context);
     cyhal_spi_event_t events = (cyhal_spi_event_t)(CYHAL_SPI_IRQ_DONE | CYHAL_SPI_IRQ_ERROR);
@@ -445,129 +804,44 @@ cy_rslt_t mtb_data_streaming_setup_spi(cyhal_spi_t* spi, mtb_data_streaming_xfer
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// TCP SUPPORT
+// UART SUPPORT
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-#if defined(COMPONENT_MW_SECURE_SOCKETS)
+#if defined(CYHAL_DRIVER_AVAILABLE_UART)
 //--------------------------------------------------------------------------------------------------
-// mtb_data_streaming_tcp_send
+// mtb_data_streaming_uart_cb
 //--------------------------------------------------------------------------------------------------
-static cy_rslt_t mtb_data_streaming_tcp_send(mtb_data_streaming_vcontext_t* vcontext,
-                                             /*const*/ uint8_t* data, size_t count, void* tag)
+static cy_rslt_t mtb_data_streaming_uart_write(mtb_data_streaming_context_t* context,
+                                               uint8_t* data, size_t count);
+
+static void mtb_data_streaming_uart_rx_event(mtb_data_streaming_context_t* context,
+                                             cyhal_uart_event_t event);
+static size_t _uart_rx_available(mtb_data_streaming_context_t* context);
+static size_t _uart_rx_peek(mtb_data_streaming_context_t* context, uint8_t* data, size_t count);
+static void _uart_rx_consume(mtb_data_streaming_context_t* context, size_t count);
+
+static void mtb_data_streaming_uart_cb(void* callback_arg, cyhal_uart_event_t event)
 {
-    cy_rslt_t rslt;
-    mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)vcontext;
+    mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)callback_arg;
+    cy_rslt_t next = CY_RSLT_SUCCESS;
 
-    uint32_t state = cyhal_system_critical_section_enter();
-    if (NULL == context->call_tag)
+    if ((NULL != context->rx) &&
+        (0u != (event & (CYHAL_UART_IRQ_RX_DONE | CYHAL_UART_IRQ_RX_ERROR))))
     {
-        uint32_t sent;
-        rslt = cy_socket_send(context->obj_inst.tcp, data, count, CY_SOCKET_FLAGS_NONE, &sent);
-        if (CY_RSLT_SUCCESS != rslt)
-        {
-            if (result == CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED)
-            {
-                cy_socket_disconnect(context->obj_inst.tcp, 0);
-                cy_socket_delete(context->obj_inst.tcp);
-            }
-        }
-        else if (sent != count)
-        {
-            rslt = MTB_DATA_STREAMING_XFER_ERR;
-        }
-        else
-        {
-            mtb_data_streaming_xfer_done_t callback = context->callback;
-            if (NULL != callback)
-            {
-                callback(tag, CY_RSLT_SUCCESS);
-            }
-        }
-    }
-    else
-    {
-        rslt = MTB_DATA_STREAMING_IN_PROGRESS_ERR;
+        mtb_data_streaming_uart_rx_event(context, event);
+        return; // Continuous receive, no receive request involved
     }
-    cyhal_system_critical_section_exit(state);
-
-    return rslt;
-}
-
 
-//--------------------------------------------------------------------------------------------------
-// mtb_data_streaming_tcp_receive
-//--------------------------------------------------------------------------------------------------
-static cy_rslt_t mtb_data_streaming_tcp_receive(mtb_data_streaming_vcontext_t* vcontext,
-                                                uint8_t* data, size_t count, void* tag)
-{
-    cy_rslt_t rslt;
-    mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)vcontext;
-
-    uint32_t state = cyhal_system_critical_section_enter();
-    if (NULL == context->call_tag)
+    if ((CYHAL_UART_IRQ_TX_DONE == event) &&
+        _send_next(context, mtb_data_streaming_uart_write, &next))
     {
-        uint32_t received;
-        rslt = cy_socket_recv(context->obj_inst.tcp, data, count, CY_SOCKET_FLAGS_NONE, &received);
-        if (CY_RSLT_SUCCESS != rslt)
-        {
-            if (result == CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED)
-            {
-                cy_socket_disconnect(context->obj_inst.tcp, 0);
-                cy_socket_delete(context->obj_inst.tcp);
-            }
-        }
-        else if (received != count)
-        {
-            rslt = MTB_DATA_STREAMING_XFER_ERR;
-        }
-        else
-        {
-            mtb_data_streaming_xfer_done_t callback = context->callback;
-            if (NULL != callback)
-            {
-                callback(tag, CY_RSLT_SUCCESS);
-            }
-        }
+        return; // Next segment of a vectored send started
     }
-    else
+    context->segment_count = 0;
+    if (CY_RSLT_SUCCESS != next)
     {
-        rslt = MTB_DATA_STREAMING_IN_PROGRESS_ERR;
+        event = CYHAL_UART_IRQ_TX_ERROR;
     }
-    cyhal_system_critical_section_exit(state);
 
-    return rslt;
-}
-
-
-//--------------------------------------------------------------------------------------------------
-// mtb_data_streaming_setup_tcp
-//--------------------------------------------------------------------------------------------------
-cy_rslt_t mtb_data_streaming_setup_tcp(cy_socket_t tcp, mtb_data_streaming_xfer_done_t cb,
-                                       mtb_data_streaming_interface_t* iface)
-{
-    iface->send     = mtb_data_streaming_tcp_send;
-    iface->receive  = mtb_data_streaming_tcp_receive;
-    mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)&(iface->context);
-    context->obj_inst.tcp  = tcp;
-    context->callback  = cb;
-    context->call_tag  = NULL;
-
-    return CY_RSLT_SUCCESS;
-}
-
-
-#endif // if defined(COMPONENT_MW_SECURE_SOCKETS)
-
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// UART SUPPORT
-////////////////////////////////////////////////////////////////////////////////////////////////////
-#if defined(CYHAL_DRIVER_AVAILABLE_UART)
-//--------------------------------------------------------------------------------------------------
-// mtb_data_streaming_uart_cb
-//--------------------------------------------------------------------------------------------------
-static void mtb_data_streaming_uart_cb(void* callback_arg, cyhal_uart_event_t event)
-{
-    mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)callback_arg;
     mtb_data_streaming_xfer_done_t callback = context->callback;
     void* tag = context->call_tag;
     context->call_tag = NULL;
@@ -623,6 +897,28 @@ static cy_rslt_t mtb_data_streaming_uart_send(mtb_data_streaming_vcontext_t* vco
 }
 
 
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_uart_write
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_uart_write(mtb_data_streaming_context_t* context,
+                                               uint8_t* data, size_t count)
+{
+    return cyhal_uart_write_async(context->obj_inst.uart, data, count);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_uart_sendv
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_uart_sendv(mtb_data_streaming_vcontext_t* context,
+                                               const mtb_data_streaming_segment_t* segments,
+                                               size_t segment_count, void* tag)
+{
+    return _sendv((mtb_data_streaming_context_t*)context, segments, segment_count, tag,
+                  mtb_data_streaming_uart_write);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // mtb_data_streaming_uart_receive
 //--------------------------------------------------------------------------------------------------
@@ -637,6 +933,22 @@ static cy_rslt_t mtb_data_streaming_uart_receive(mtb_data_streaming_vcontext_t*
     {
         context->call_tag = tag;
         cyhal_system_critical_section_exit(state);
+        if (NULL != context->rx)
+        {
+            // Served from the ring of the continuous receive
+            context->call_tag = NULL;
+            if (_uart_rx_available(context) < count)
+            {
+                return MTB_DATA_STREAMING_UNDERFLOW_ERR;
+            }
+            (void)_uart_rx_peek(context, data, count);
+            _uart_rx_consume(context, count);
+            if (NULL != context->callback)
+            {
+                context->callback(tag, CY_RSLT_SUCCESS);
+            }
+            return CY_RSLT_SUCCESS;
+        }
         rslt = cyhal_uart_read_async(context->obj_inst.uart, data, count);
         if (CY_RSLT_SUCCESS != rslt)
         {
@@ -660,10 +972,13 @@ cy_rslt_t mtb_data_streaming_setup_uart(cyhal_uart_t* uart, mtb_data_streaming_x
 {
     iface->send     = mtb_data_streaming_uart_send;
     iface->receive  = mtb_data_streaming_uart_receive;
+    iface->sendv    = mtb_data_streaming_uart_sendv;
     mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)&(iface->context);
     context->obj_inst.uart  = uart;
     context->callback  = cb;
     context->call_tag  = NULL;
+    context->segment_count = 0;
+    context->rx        = NULL;
 
     cyhal_uart_register_callback(uart, mtb_data_streaming_uart_cb, context);
     cyhal_uart_event_t events = (cyhal_uart_event_t)(
@@ -675,6 +990,179 @@ cy_rslt_t mtb_data_streaming_setup_uart(cyhal_uart_t* uart, mtb_data_streaming_x
 }
 
 
+//--------------------------------------------------------------------------------------------------
+// _uart_rx_arm
+//
+// Starts the read of the next chunk if the application has consumed the data it overwrites.
+//--------------------------------------------------------------------------------------------------
+static void _uart_rx_arm(mtb_data_streaming_context_t* context)
+{
+    mtb_data_streaming_uart_rx_t* rx = (mtb_data_streaming_uart_rx_t*)context->rx;
+    uint32_t chunk = rx->buffer_size / MTB_DATA_STREAMING_UART_RX_CHUNKS;
+
+    if ((rx->received + chunk - rx->tail) <= rx->buffer_size)
+    {
+        // Set first: a read served from the receive buffer of the HAL completes from within
+        // cyhal_uart_read_async, and its interrupt handling arms the following chunk
+        rx->armed = true;
+        if (CY_RSLT_SUCCESS != cyhal_uart_read_async(context->obj_inst.uart,
+                                                     &rx->buffer[rx->received % rx->buffer_size],
+                                                     chunk))
+        {
+            rx->armed = false;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_uart_rx_event
+//--------------------------------------------------------------------------------------------------
+static void mtb_data_streaming_uart_rx_event(mtb_data_streaming_context_t* context,
+                                             cyhal_uart_event_t event)
+{
+    mtb_data_streaming_uart_rx_t* rx = (mtb_data_streaming_uart_rx_t*)context->rx;
+
+    if (0u != (event & CYHAL_UART_IRQ_RX_ERROR))
+    {
+        rx->errors++;
+    }
+    if (0u != (event & CYHAL_UART_IRQ_RX_DONE))
+    {
+        rx->received += rx->buffer_size / MTB_DATA_STREAMING_UART_RX_CHUNKS;
+        rx->armed = false;
+        _uart_rx_arm(context);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_uart_rx_start
+//--------------------------------------------------------------------------------------------------
+cy_rslt_t mtb_data_streaming_uart_rx_start(mtb_data_streaming_interface_t* iface,
+                                           mtb_data_streaming_uart_rx_t* rx)
+{
+    mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)&(iface->context);
+
+    if ((NULL == rx->buffer) || (rx->buffer_size < MTB_DATA_STREAMING_UART_RX_CHUNKS) ||
+        (0u != (rx->buffer_size & (rx->buffer_size - 1u))))
+    {
+        return MTB_DATA_STREAMING_UNSUPPORTED_ERR;
+    }
+    if (NULL != context->call_tag)
+    {
+        return MTB_DATA_STREAMING_IN_PROGRESS_ERR;
+    }
+
+    rx->received = 0;
+    rx->tail = 0;
+    rx->armed = false;
+    rx->errors = 0;
+    context->rx = rx;
+
+    _uart_rx_arm(context);
+    return rx->armed ? CY_RSLT_SUCCESS : MTB_DATA_STREAMING_XFER_ERR;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// _uart_rx_available
+//
+// The bytes of the chunk in progress are counted by the PDL driver the HAL reads with.
+//--------------------------------------------------------------------------------------------------
+static size_t _uart_rx_available(mtb_data_streaming_context_t* context)
+{
+    mtb_data_streaming_uart_rx_t* rx = (mtb_data_streaming_uart_rx_t*)context->rx;
+    cyhal_uart_t* uart = context->obj_inst.uart;
+    uint32_t received;
+    uint32_t partial;
+
+    do
+    {
+        // Read again if a chunk completed meanwhile
+        received = rx->received;
+        partial = rx->armed ? Cy_SCB_UART_GetNumReceived(uart->base, &(uart->context)) : 0u;
+    } while (received != rx->received);
+
+    return (size_t)(received + partial - rx->tail);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// _uart_rx_peek
+//--------------------------------------------------------------------------------------------------
+static size_t _uart_rx_peek(mtb_data_streaming_context_t* context, uint8_t* data, size_t count)
+{
+    mtb_data_streaming_uart_rx_t* rx = (mtb_data_streaming_uart_rx_t*)context->rx;
+    size_t available = _uart_rx_available(context);
+    if (count > available)
+    {
+        count = available;
+    }
+
+    uint32_t index = rx->tail % rx->buffer_size;
+    size_t chunk = rx->buffer_size - index;
+    if (chunk > count)
+    {
+        chunk = count;
+    }
+    memcpy(data, &rx->buffer[index], chunk);
+    memcpy(&data[chunk], rx->buffer, count - chunk);
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// _uart_rx_consume
+//--------------------------------------------------------------------------------------------------
+static void _uart_rx_consume(mtb_data_streaming_context_t* context, size_t count)
+{
+    mtb_data_streaming_uart_rx_t* rx = (mtb_data_streaming_uart_rx_t*)context->rx;
+    size_t available = _uart_rx_available(context);
+    if (count > available)
+    {
+        count = available;
+    }
+    rx->tail += (uint32_t)count;
+
+    // Restart the reads stopped for lack of room, the interrupt restarts them otherwise
+    uint32_t state = cyhal_system_critical_section_enter();
+    if (!rx->armed)
+    {
+        _uart_rx_arm(context);
+    }
+    cyhal_system_critical_section_exit(state);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_uart_rx_available
+//--------------------------------------------------------------------------------------------------
+size_t mtb_data_streaming_uart_rx_available(mtb_data_streaming_interface_t* iface)
+{
+    return _uart_rx_available((mtb_data_streaming_context_t*)&(iface->context));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_uart_rx_peek
+//--------------------------------------------------------------------------------------------------
+size_t mtb_data_streaming_uart_rx_peek(mtb_data_streaming_interface_t* iface, uint8_t* data,
+                                       size_t count)
+{
+    return _uart_rx_peek((mtb_data_streaming_context_t*)&(iface->context), data, count);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_uart_rx_consume
+//--------------------------------------------------------------------------------------------------
+void mtb_data_streaming_uart_rx_consume(mtb_data_streaming_interface_t* iface, size_t count)
+{
+    _uart_rx_consume((mtb_data_streaming_context_t*)&(iface->context), count);
+}
+
+
 #endif // if defined(CYHAL_DRIVER_AVAILABLE_UART)
 
 
@@ -685,23 +1173,50 @@ cy_rslt_t mtb_data_streaming_setup_uart(cyhal_uart_t* uart, mtb_data_streaming_x
 //--------------------------------------------------------------------------------------------------
 // mtb_data_streaming_usb_cb
 //--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_usb_write(mtb_data_streaming_context_t* context,
+                                              uint8_t* data, size_t count);
+
 static void mtb_data_streaming_usb_cb(USB_ASYNC_IO_CONTEXT* async_ctx)
 {
     mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)async_ctx->pContext;
+    cy_rslt_t rslt = (0 == async_ctx->Status)
+        ? CY_RSLT_SUCCESS
+        : MTB_DATA_STREAMING_XFER_ERR;
+
+    if ((CY_RSLT_SUCCESS == rslt) && _send_next(context, mtb_data_streaming_usb_write, &rslt))
+    {
+        return; // Next segment of a vectored send started
+    }
+    context->segment_count = 0;
+
     mtb_data_streaming_xfer_done_t callback = context->callback;
     void* tag = context->call_tag;
     context->call_tag = NULL;
 
     if (NULL != callback)
     {
-        cy_rslt_t rslt = (0 == async_ctx->Status)
-            ? CY_RSLT_SUCCESS
-            : MTB_DATA_STREAMING_XFER_ERR;
         callback(tag, rslt);
     }
 }
 
 
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_usb_write
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_usb_write(mtb_data_streaming_context_t* context,
+                                              uint8_t* data, size_t count)
+{
+    USB_ASYNC_IO_CONTEXT* async_ctx = &(context->obj_inst.usb->async_ctx);
+    async_ctx->NumBytesToTransfer = count;
+    async_ctx->pData = data;
+    async_ctx->pfOnComplete = mtb_data_streaming_usb_cb;
+    async_ctx->pContext = context;
+
+    USBD_CDC_WriteAsync(context->obj_inst.usb->handle, async_ctx, 0);
+    return CY_RSLT_SUCCESS;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // mtb_data_streaming_usb_send
 //--------------------------------------------------------------------------------------------------
@@ -717,14 +1232,7 @@ static cy_rslt_t mtb_data_streaming_usb_send(mtb_data_streaming_vcontext_t* vcon
         context->call_tag = tag;
         cyhal_system_critical_section_exit(state);
 
-        USB_ASYNC_IO_CONTEXT* async_ctx = &(context->obj_inst.usb->async_ctx);
-        async_ctx->NumBytesToTransfer = count;
-        async_ctx->pData = data;
-        async_ctx->pfOnComplete = mtb_data_streaming_usb_cb;
-        async_ctx->pContext = context;
-
-        USBD_CDC_WriteAsync(context->obj_inst.usb->handle, async_ctx, 0);
-        rslt = CY_RSLT_SUCCESS;
+        rslt = mtb_data_streaming_usb_write(context, data, count);
     }
     else
     {
@@ -736,6 +1244,18 @@ static cy_rslt_t mtb_data_streaming_usb_send(mtb_data_streaming_vcontext_t* vcon
 }
 
 
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_usb_sendv
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_usb_sendv(mtb_data_streaming_vcontext_t* context,
+                                              const mtb_data_streaming_segment_t* segments,
+                                              size_t segment_count, void* tag)
+{
+    return _sendv((mtb_data_streaming_context_t*)context, segments, segment_count, tag,
+                  mtb_data_streaming_usb_write);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // mtb_data_streaming_usb_receive
 //--------------------------------------------------------------------------------------------------
@@ -779,10 +1299,12 @@ cy_rslt_t mtb_data_streaming_setup_usb(mtb_data_streaming_usb_t* usb,
 {
     iface->send     = mtb_data_streaming_usb_send;
     iface->receive  = mtb_data_streaming_usb_receive;
+    iface->sendv    = mtb_data_streaming_usb_sendv;
     mtb_data_streaming_context_t* context = (mtb_data_streaming_context_t*)&(iface->context);
     context->obj_inst.usb = usb;
     context->callback  = cb;
     context->call_tag  = NULL;
+    context->segment_count = 0;
 
     return CY_RSLT_SUCCESS;
 }
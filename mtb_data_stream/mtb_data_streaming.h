@@ -26,6 +26,9 @@
 * limitations under the License.
 *******************************************************************************/
 
+#pragma once
+
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include "cy_result.h"
@@ -46,12 +49,14 @@ extern "C" {
  * release, or can be supported by the application itself.
  *
  * Available:
- *     BLE
+ *     BLE: Fragmented to the MTU, several notifications per connection event
  *     I2C
  *     SPI
- *     TCP
+ *     SPI slave: Ring buffer read in frames by a host bridge (mtb_data_streaming_spi_slave.h)
+ *     TCP: Non-blocking, with a send queue (mtb_data_streaming_tcp.h)
  *     UART
  *     USB: Communication Device Class (emusb-device)
+ *     Log: Block storage such as an SD card or external flash (mtb_data_streaming_log.h)
  *
  * \section section_data_streaming_getting_started Getting Started
  * This section provides steps for getting started with this library by providing examples
@@ -78,6 +83,8 @@ extern "C" {
  * -# The library can now be used to perform streaming operations.
  *      - Send operation.
  *        \snippet data_streaming_example.c snippet_mtb_data_streaming_send
+ *      - Send operation of data held in several buffers (such as a header and a payload), without
+ *        copying them together first. See \ref mtb_data_streaming_sendv.
  *      - Receive operation.
  *        \snippet data_streaming_example.c snippet_mtb_data_streaming_receive
  */
@@ -96,6 +103,9 @@ extern "C" {
 /** An underflow error occurred while attempting to process the data transfer. */
 #define MTB_DATA_STREAMING_UNDERFLOW_ERR             \
     (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_ABSTRACTION_DATA_STREAMING, 3))
+/** The operation is not supported by this interface. */
+#define MTB_DATA_STREAMING_UNSUPPORTED_ERR          \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_ABSTRACTION_DATA_STREAMING, 4))
 
 
 /** Function prototype for handling callback operations when data transfer operations are completed.
@@ -109,9 +119,16 @@ typedef void (* mtb_data_streaming_xfer_done_t)(const void* tag, cy_rslt_t rslt)
    implementation defined. */
 typedef struct
 {
-    void* placeholder[3]; // Implementation relies on 96 bytes (3 32 bits) of data
+    void* placeholder[6]; // Implementation relies on 6 pointers of data
 } mtb_data_streaming_vcontext_t;
 
+/** Segment of the data of a vectored send operation. */
+typedef struct
+{
+    /*const*/ uint8_t*  data;   /**< Data of the segment. */
+    size_t              count;  /**< The number of bytes in the segment. */
+} mtb_data_streaming_segment_t;
+
 /** Function prototype for sending data to the host machine. Send operations are all asynchronous
  * and will return immediately. When the operation is complete, the callback that was provided as
  * part of the setup function will be called.
@@ -128,6 +145,25 @@ typedef struct
 typedef cy_rslt_t (* mtb_data_streaming_send_t)(mtb_data_streaming_vcontext_t* context,
                                                 /*const*/ uint8_t* data, size_t count, void* tag);
 
+/** Function prototype for sending data held in several buffers to the host machine. The segments
+ * are sent in order, as if they were a single contiguous buffer, and the callback is called once
+ * when all of them have been sent. Interfaces copying the data or sending it synchronously gather
+ * the segments; the others send them by chained asynchronous transfers.
+ * \note Only one operation is allowed on a streaming interface at a time.
+ * \note The segment array and the data must remain valid until the operation is complete.
+ *
+ * @param[in]  context       Context object that stored on the \ref mtb_data_streaming_interface_t
+ *                           by the setup function
+ * @param[in]  segments      Segments of data to transmit to the host.
+ * @param[in]  segment_count The number of segments.
+ * @param[in]  tag           Arbitrary information to associate with this call. This will be
+ *                           provided as part of the callback when the operation completes.
+ * @return                   Result of the send operation.
+ */
+typedef cy_rslt_t (* mtb_data_streaming_sendv_t)(mtb_data_streaming_vcontext_t* context,
+                                                 const mtb_data_streaming_segment_t* segments,
+                                                 size_t segment_count, void* tag);
+
 /** Function prototype for receiving data from the block device. Receive operations are all
    asynchronous and will return immediately. When the operation is complete, the callback that was
  * provided as part of the setup function will be called.
@@ -149,6 +185,8 @@ typedef struct
 {
     mtb_data_streaming_send_t send;         /**< Function to send data to a host device. */
     mtb_data_streaming_receive_t receive;   /**< Function to receive data from a host device. */
+    mtb_data_streaming_sendv_t sendv;       /**< Function to send data held in several buffers,
+                                                 NULL if the interface does not support it. */
     mtb_data_streaming_vcontext_t context;  /**< Context data for performing operations. */
 } mtb_data_streaming_interface_t;
 
@@ -172,6 +210,43 @@ static inline cy_rslt_t mtb_data_streaming_send(mtb_data_streaming_interface_t*
 }
 
 
+/** Utility function for sending data held in several buffers to the host machine. The segments
+ * are sent in order, as if they were a single contiguous buffer, without copying them together
+ * first. When the operation is complete, the callback that was provided as part of the setup
+ * function will be called once. Interfaces set up by the application without a \ref
+ * mtb_data_streaming_interface_t::sendv function can only send a single segment.
+ * \note Only one operation (send or receive) is allowed on a streaming interface at a time.
+ * \note The segment array and the data must remain valid until the operation is complete.
+ *
+ * @param[in]  iface         The streaming interface that was initialized by calling one of the
+ *                           setup function
+ * @param[in]  segments      Segments of data to transmit to the host.
+ * @param[in]  segment_count The number of segments.
+ * @param[in]  tag           Arbitrary information to associate with this call. This will be
+ *                           provided as part of the callback when the operation completes.
+ * @return                   Result of the send operation.
+ */
+static inline cy_rslt_t mtb_data_streaming_sendv(mtb_data_streaming_interface_t* iface,
+                                                 const mtb_data_streaming_segment_t* segments,
+                                                 size_t segment_count, void* tag)
+{
+    cy_rslt_t rslt;
+    if (NULL != iface->sendv)
+    {
+        rslt = iface->sendv(&(iface->context), segments, segment_count, tag);
+    }
+    else if (1u == segment_count)
+    {
+        rslt = iface->send(&(iface->context), segments[0].data, segments[0].count, tag);
+    }
+    else
+    {
+        rslt = MTB_DATA_STREAMING_UNSUPPORTED_ERR;
+    }
+    return rslt;
+}
+
+
 /** Function prototype for receiving data from the host machine. Receive operations are all
    asynchronous and will return immediately. When the operation is complete, the callback that was
  * provided as part of the setup function will be called.
@@ -192,24 +267,70 @@ static inline cy_rslt_t mtb_data_streaming_receive(mtb_data_streaming_interface_
 }
 
 
+/** Size of the header at the start of each BLE notification: a sequence number incremented for
+ * each notification, then the \ref MTB_DATA_STREAMING_BLE_FIRST and \ref
+ * MTB_DATA_STREAMING_BLE_LAST flags.
+ */
+#define MTB_DATA_STREAMING_BLE_HEADER_SIZE  (2u)
+/** The notification carries the start of a send request */
+#define MTB_DATA_STREAMING_BLE_FIRST        (0x01u)
+/** The notification carries the end of a send request */
+#define MTB_DATA_STREAMING_BLE_LAST         (0x02u)
+/** ATT MTU of a connection before the MTU exchange */
+#define MTB_DATA_STREAMING_BLE_DEFAULT_MTU  (23u)
+/** Size of the ATT header of a notification, the rest of the MTU is the attribute value */
+#define MTB_DATA_STREAMING_BLE_ATT_HEADER   (3u)
+
 #if defined(COMPONENT_MW_BTSTACK)
-/** Configuration for a BLE instance. User is expected to set all values before calling \ref
- * mtb_data_streaming_setup_ble.
+#include "wiced_bt_gatt.h"
+
+/** Configuration for a BLE instance. User is expected to set all configuration values before
+ * calling \ref mtb_data_streaming_setup_ble, the remaining fields are managed by the library.
  */
 typedef struct
 {
     uint16_t    conn_id;        /**< The connection ID generated for the currently connected host */
     uint16_t    attribute;      /**< The characteristic attribute */
     uint8_t*    client_config;  /**< The configuration of the characteristic */
-    uint8_t*    buffer;         /**< The global buffer allocated for the attribute to send data */
+    uint8_t*    buffer;         /**< Buffer the notifications are sent from. It holds one
+                                     notification per (\ref mtu - 3) bytes, which can be in flight
+                                     at the same time. */
     uint32_t    buffer_size;    /**< The number of bytes available in the \ref buffer */
+    uint16_t    mtu;            /**< ATT MTU negotiated for the connection. The application updates
+                                     it when handling the MTU exchange, while no send is in
+                                     progress. 0 uses \ref MTB_DATA_STREAMING_BLE_DEFAULT_MTU. */
+    uint8_t*    receive_buffer; /**< The value of the attribute last written by the host */
+    uint32_t    receive_buffer_size;    /**< The number of bytes in the \ref receive_buffer */
+
+    mtb_data_streaming_segment_t segment;   /**< Segment of a single buffer send */
+    size_t      offset;         /**< Bytes of the first segment left already sent */
+    uint16_t    slot_size;      /**< Size of the notifications, MTU - 3 */
+    uint8_t     slot_count;     /**< Number of notifications the \ref buffer holds */
+    uint8_t     next_slot;      /**< Slot of the next notification */
+    uint16_t    pending;        /**< Size of the notification built in the next slot, refused by the
+                                     congested stack */
+    uint8_t     sequence;       /**< Sequence number of the next notification */
+    bool        first;          /**< The next notification starts the send request */
+    volatile uint8_t in_flight; /**< Notifications queued in the stack, not yet transmitted */
+    volatile bool failed;       /**< A notification could not be queued */
+    volatile bool sending;      /**< A send request is in progress */
+    volatile bool pumping;      /**< Notifications are being queued */
+    volatile bool repump;       /**< A transmission completed while notifications were queued */
 } mtb_data_streaming_ble_t;
 
 /** Sets up a streaming interface for BLE communication over the provided Bluetooth instance.
- * This expects that the BLE stack is already started. The BLE implementation is mostly just
- * a wrapper around a shared memory buffer. Receive requests simply return what was already placed
- * in the buffer. A send request will update the contents of the buffer and (if the device is
- * configured to support it) will send a notify/indicate signal.
+ * This expects that the BLE stack is already started and that the host enabled the notifications or
+ * indications of the characteristic.
+ *
+ * A send request is fragmented to the MTU of the connection: each notification carries
+ * MTB_DATA_STREAMING_BLE_HEADER_SIZE bytes of header and up to MTU - 5 bytes of data, so that the
+ * host can reassemble the request. As many notifications as the \ref buffer holds are queued in the
+ * stack at once, to be sent in the same connection events, and the next ones are queued as the
+ * stack reports them transmitted through \ref mtb_data_streaming_ble_transmitted. Indications
+ * need a confirmation from the host, so a single one is in flight. The callback is called once all
+ * the notifications of the request are transmitted.
+ *
+ * Receive requests simply return what was already placed in the \ref receive_buffer by the host.
  *
  * @param[in]  ble   Struct with the handle set to an already started BLE connection.
  * @param[in]  cb    Callback function to run when a transfer operation is complete.
@@ -219,13 +340,24 @@ typedef struct
 cy_rslt_t mtb_data_streaming_setup_ble(mtb_data_streaming_ble_t* ble,
                                        mtb_data_streaming_xfer_done_t cb,
                                        mtb_data_streaming_interface_t* iface);
+
+/** Reports a notification transmitted, or an indication confirmed, by the stack. The application
+ * calls it from its GATT callback for GATT_APP_BUFFER_TRANSMITTED_EVT with the buffer of the event,
+ * and for GATT_HANDLE_VALUE_CONF with NULL when indications are used. Buffers not belonging to the
+ * interface are ignored.
+ *
+ * @param[in]  iface The streaming interface set up by \ref mtb_data_streaming_setup_ble.
+ * @param[in]  data  The buffer of the transmitted notification.
+ */
+void mtb_data_streaming_ble_transmitted(mtb_data_streaming_interface_t* iface, const uint8_t* data);
 #endif // defined(COMPONENT_MW_BTSTACK)
 
 #if defined(CYHAL_DRIVER_AVAILABLE_I2C)
 #include "cyhal_i2c.h"
 
 /** Sets up a streaming interface for I2C communication over the provided I2C instance.
- * This expects that the I2C interface is already initialized.
+ * This expects that the I2C interface is already initialized. The interface has no
+ * mtb_data_streaming_interface_t::sendv function, so it sends a single segment at a time.
  *
  * @param[in]  i2c      Existing, pre-initialized, I2C interface to use for data transfers.
  * @param[in]  cb       Callback function to run when a transfer operation is complete.
@@ -251,21 +383,6 @@ cy_rslt_t mtb_data_streaming_setup_spi(cyhal_spi_t* spi, mtb_data_streaming_xfer
                                        mtb_data_streaming_interface_t* iface);
 #endif // defined(CYHAL_DRIVER_AVAILABLE_SPI)
 
-#if defined(COMPONENT_MW_SECURE_SOCKETS)
-#include "cy_secure_sockets.h"
-
-/** Sets up a streaming interface for TCP communication over the provided socket.
- * This expects that the TCP socket is already initialized.
- *
- * @param[in]  socket   Existing, pre-initialized, TCP socket handle.
- * @param[in]  cb       Callback function to run when a transfer operation is complete.
- * @param[out] iface    Streaming interface object to be populated by this setup function.
- * @return              Result of the setup operation.
- */
-cy_rslt_t mtb_data_streaming_setup_tcp(cy_socket_t* socket, mtb_data_streaming_xfer_done_t cb,
-                                       mtb_data_streaming_interface_t* iface);
-#endif // defined(COMPONENT_MW_SECURE_SOCKETS)
-
 #if defined(CYHAL_DRIVER_AVAILABLE_UART)
 #include "cyhal_uart.h"
 
@@ -279,6 +396,70 @@ cy_rslt_t mtb_data_streaming_setup_tcp(cy_socket_t* socket, mtb_data_streaming_x
  */
 cy_rslt_t mtb_data_streaming_setup_uart(cyhal_uart_t* uart, mtb_data_streaming_xfer_done_t cb,
                                         mtb_data_streaming_interface_t* iface);
+
+/** Number of chunks the continuous receive ring is read in */
+#define MTB_DATA_STREAMING_UART_RX_CHUNKS   (4u)
+
+/** Continuous receive of a UART interface. The user sets the buffer fields before calling \ref
+ * mtb_data_streaming_uart_rx_start, the remaining fields are managed by the library.
+ */
+typedef struct
+{
+    uint8_t*    buffer;             /**< Receive ring */
+    uint32_t    buffer_size;        /**< Size of \ref buffer in bytes, a power of two of at least
+                                         \ref MTB_DATA_STREAMING_UART_RX_CHUNKS bytes */
+
+    volatile uint32_t received;     /**< Bytes of the chunks completed, wraps around */
+    volatile uint32_t tail;         /**< Bytes consumed, wraps around */
+    volatile bool armed;            /**< A chunk is being received */
+    volatile uint32_t errors;       /**< Receive errors reported by the UART */
+} mtb_data_streaming_uart_rx_t;
+
+/** Starts receiving continuously into a ring. The ring is read in \ref
+ * MTB_DATA_STREAMING_UART_RX_CHUNKS chunks, each one an asynchronous read started again from the
+ * interrupt of the previous one, so no byte is missed between two reads. A chunk is only started
+ * once the application has consumed the data it overwrites: until then the received bytes wait in
+ * the UART FIFO and in the receive buffer of the UART configuration.
+ *
+ * The data is read with \ref mtb_data_streaming_uart_rx_available, \ref
+ * mtb_data_streaming_uart_rx_peek and \ref mtb_data_streaming_uart_rx_consume, which never wait.
+ * The bytes of the chunk in progress are available as soon as they are received, which stands for
+ * an idle line detection: a short message is seen without waiting for its chunk to fill. Receive
+ * requests of the interface then complete at once from the ring, or fail with \ref
+ * MTB_DATA_STREAMING_UNDERFLOW_ERR when it holds less data than requested.
+ *
+ * The UART must use the software (interrupt driven) asynchronous mode, the default.
+ *
+ * @param[in]  iface    The streaming interface set up by \ref mtb_data_streaming_setup_uart.
+ * @param[in]  rx       Continuous receive with the buffer fields set.
+ * @return              Result of the start of the first chunk.
+ */
+cy_rslt_t mtb_data_streaming_uart_rx_start(mtb_data_streaming_interface_t* iface,
+                                           mtb_data_streaming_uart_rx_t* rx);
+
+/** Returns the number of bytes received and not consumed yet.
+ *
+ * @param[in]  iface    The streaming interface receiving continuously.
+ * @return              The number of bytes available.
+ */
+size_t mtb_data_streaming_uart_rx_available(mtb_data_streaming_interface_t* iface);
+
+/** Copies the bytes received, without consuming them.
+ *
+ * @param[in]  iface    The streaming interface receiving continuously.
+ * @param[out] data     Buffer for the data.
+ * @param[in]  count    Size of the buffer.
+ * @return              The number of bytes copied, at most the number available.
+ */
+size_t mtb_data_streaming_uart_rx_peek(mtb_data_streaming_interface_t* iface, uint8_t* data,
+                                       size_t count);
+
+/** Consumes bytes received, making room for the next chunks.
+ *
+ * @param[in]  iface    The streaming interface receiving continuously.
+ * @param[in]  count    The number of bytes to consume, at most the number available.
+ */
+void mtb_data_streaming_uart_rx_consume(mtb_data_streaming_interface_t* iface, size_t count);
 #endif // defined(CYHAL_DRIVER_AVAILABLE_UART)
 
 #if defined(COMPONENT_MW_EMUSB_DEVICE)
@@ -0,0 +1,361 @@
+/*******************************************************************************
+* File Name: mtb_data_streaming_log.c
+*
+* Description:
+* Implementation of the block storage log streaming interface.
+*
+********************************************************************************
+* \copyright
+* Copyright 2023 Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <stdbool.h>
+#include <string.h>
+#include "mtb_data_streaming_log.h"
+
+typedef struct
+{
+    mtb_data_streaming_log_t*       log;
+    mtb_data_streaming_xfer_done_t  callback;
+    void*                           call_tag;
+} mtb_data_streaming_log_context_t;
+
+/*
+ * Same compile time check as in mtb_data_streaming.c, the log context must fit in
+ * mtb_data_streaming_vcontext_t.
+ * NOTE: This function should never be called, it is only for a compile time error check
+ */
+static inline void _check_log_size(void) __attribute__ ((deprecated));
+#if __ICCARM__
+#pragma diag_suppress=Pe177
+#elif __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+#endif
+//--------------------------------------------------------------------------------------------------
+// _check_log_size
+//--------------------------------------------------------------------------------------------------
+static inline void _check_log_size(void)
+{
+    uint8_t dummy = 1 /
+                    (sizeof(mtb_data_streaming_vcontext_t) >=
+                     sizeof(mtb_data_streaming_log_context_t));
+    (void)dummy;
+}
+
+
+#if __ICCARM__
+#pragma diag_default=Pe177
+#elif __clang__
+#pragma clang diagnostic pop
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_log_max_sessions
+//--------------------------------------------------------------------------------------------------
+static uint32_t mtb_data_streaming_log_max_sessions(const mtb_data_streaming_log_t* log)
+{
+    return (log->blockdev->block_size - sizeof(mtb_data_streaming_log_index_t)) /
+           sizeof(mtb_data_streaming_log_session_t);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_log_write_index
+//
+// Records the length of the current (last) session that is on the device and writes the index.
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_log_write_index(mtb_data_streaming_log_t* log)
+{
+    mtb_data_streaming_log_index_t index;
+    mtb_data_streaming_log_session_t session;
+    uint8_t* sessions = log->index_buffer + sizeof(index);
+
+    memcpy(&index, log->index_buffer, sizeof(index));
+    memcpy(&session, sessions + (index.session_count - 1u) * sizeof(session), sizeof(session));
+    session.length = log->session_length - log->fill;
+    memcpy(sessions + (index.session_count - 1u) * sizeof(session), &session, sizeof(session));
+
+    log->writes = 0;
+    return log->blockdev->write(log->blockdev->context, 0, log->index_buffer, 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_log_write_buffer
+//
+// Writes the complete blocks of the buffer. A partial block at the end is moved to the start of the
+// buffer, it will be written again once more data is appended.
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_log_write_buffer(mtb_data_streaming_log_t* log, bool partial)
+{
+    const mtb_data_streaming_blockdev_t* dev = log->blockdev;
+    uint32_t full_blocks = log->fill / dev->block_size;
+    uint32_t tail = log->fill % dev->block_size;
+    uint32_t blocks = full_blocks + ((partial && (0u != tail)) ? 1u : 0u);
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+
+    if (0u == blocks)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+    if ((log->next_block + blocks) > dev->block_count)
+    {
+        return MTB_DATA_STREAMING_OVERFLOW_ERR;
+    }
+
+    if (blocks > full_blocks)
+    {
+        /* Clear the unused part of the last block */
+        memset(&log->buffer[log->fill], 0, dev->block_size - tail);
+    }
+
+    rslt = dev->write(dev->context, log->next_block, log->buffer, blocks);
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        log->next_block += full_blocks;
+        if (0u != full_blocks)
+        {
+            memmove(log->buffer, &log->buffer[full_blocks * dev->block_size], tail);
+        }
+        log->fill = tail;
+        log->writes++;
+
+        if ((0u != log->index_interval) && (log->writes >= log->index_interval))
+        {
+            /* The partial block is not written yet */
+            rslt = mtb_data_streaming_log_write_index(log);
+        }
+    }
+
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_log_append
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_log_append(mtb_data_streaming_log_t* log, const uint8_t* data,
+                                               size_t count)
+{
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+
+    while ((0u != count) && (CY_RSLT_SUCCESS == rslt))
+    {
+        size_t chunk = log->buffer_size - log->fill;
+        if (chunk > count)
+        {
+            chunk = count;
+        }
+
+        memcpy(&log->buffer[log->fill], data, chunk);
+        log->fill += chunk;
+        log->session_length += chunk;
+        data += chunk;
+        count -= chunk;
+
+        if (log->fill == log->buffer_size)
+        {
+            rslt = mtb_data_streaming_log_write_buffer(log, false);
+        }
+    }
+
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_log_sendv
+//
+// The segments are appended to the buffer as a single record.
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_log_sendv(mtb_data_streaming_vcontext_t* vcontext,
+                                              const mtb_data_streaming_segment_t* segments,
+                                              size_t segment_count, void* tag)
+{
+    cy_rslt_t rslt;
+    mtb_data_streaming_log_context_t* context = (mtb_data_streaming_log_context_t*)vcontext;
+    mtb_data_streaming_log_t* log = context->log;
+    const mtb_data_streaming_blockdev_t* dev = log->blockdev;
+    size_t count = 0;
+
+    for (size_t i = 0; i < segment_count; i++)
+    {
+        count += segments[i].count;
+    }
+
+    mtb_data_streaming_log_record_t record =
+    {
+        .sync       = MTB_DATA_STREAMING_LOG_RECORD_SYNC,
+        .reserved   = 0,
+        .length     = (uint32_t)count,
+    };
+
+    /* Refuse records that cannot fit in the space left, so that the log stays parsable */
+    uint32_t used_blocks = log->next_block + (log->fill + sizeof(record) + count +
+                                              dev->block_size - 1u) / dev->block_size;
+    if (used_blocks > dev->block_count)
+    {
+        rslt = MTB_DATA_STREAMING_OVERFLOW_ERR;
+    }
+    else
+    {
+        rslt = mtb_data_streaming_log_append(log, (const uint8_t*)&record, sizeof(record));
+        for (size_t i = 0; (i < segment_count) && (CY_RSLT_SUCCESS == rslt); i++)
+        {
+            rslt = mtb_data_streaming_log_append(log, segments[i].data, segments[i].count);
+        }
+    }
+
+    if (NULL != context->callback)
+    {
+        context->callback(tag, rslt);
+    }
+
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_log_send
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_log_send(mtb_data_streaming_vcontext_t* vcontext,
+                                             /*const*/ uint8_t* data, size_t count, void* tag)
+{
+    mtb_data_streaming_segment_t segment = { .data = data, .count = count };
+    return mtb_data_streaming_log_sendv(vcontext, &segment, 1, tag);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_log_receive
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_log_receive(mtb_data_streaming_vcontext_t* vcontext,
+                                                uint8_t* data, size_t count, void* tag)
+{
+    (void)vcontext;
+    (void)data;
+    (void)count;
+    (void)tag;
+
+    return MTB_DATA_STREAMING_UNSUPPORTED_ERR;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_setup_log
+//--------------------------------------------------------------------------------------------------
+cy_rslt_t mtb_data_streaming_setup_log(mtb_data_streaming_log_t* log,
+                                       mtb_data_streaming_xfer_done_t cb,
+                                       mtb_data_streaming_interface_t* iface)
+{
+    const mtb_data_streaming_blockdev_t* dev = log->blockdev;
+    mtb_data_streaming_log_index_t index;
+    mtb_data_streaming_log_session_t session = { .first_block = 1u, .length = 0u };
+    uint8_t* sessions = log->index_buffer + sizeof(index);
+    cy_rslt_t rslt;
+
+    if ((0u == dev->block_size) || (0u != (log->buffer_size % dev->block_size)) ||
+        (log->buffer_size < dev->block_size) || (dev->block_count < 2u))
+    {
+        return MTB_DATA_STREAMING_UNSUPPORTED_ERR;
+    }
+
+    rslt = dev->read(dev->context, 0, log->index_buffer, 1);
+    if (CY_RSLT_SUCCESS != rslt)
+    {
+        return rslt;
+    }
+
+    memcpy(&index, log->index_buffer, sizeof(index));
+    if ((MTB_DATA_STREAMING_LOG_MAGIC != index.magic) ||
+        (MTB_DATA_STREAMING_LOG_VERSION != index.version) ||
+        (dev->block_size != index.block_size) ||
+        (index.session_count > mtb_data_streaming_log_max_sessions(log)))
+    {
+        /* Not a log, or an incompatible one: format the device */
+        memset(log->index_buffer, 0, dev->block_size);
+        index.magic         = MTB_DATA_STREAMING_LOG_MAGIC;
+        index.version       = MTB_DATA_STREAMING_LOG_VERSION;
+        index.session_count = 0;
+        index.block_size    = dev->block_size;
+        index.reserved      = 0;
+    }
+    else if (index.session_count == mtb_data_streaming_log_max_sessions(log))
+    {
+        return MTB_DATA_STREAMING_OVERFLOW_ERR;
+    }
+    else if (0u != index.session_count)
+    {
+        /* The new session starts after the last one */
+        mtb_data_streaming_log_session_t last;
+        memcpy(&last, sessions + (index.session_count - 1u) * sizeof(last), sizeof(last));
+        session.first_block = last.first_block +
+                              (last.length + dev->block_size - 1u) / dev->block_size;
+    }
+
+    if (session.first_block >= dev->block_count)
+    {
+        return MTB_DATA_STREAMING_OVERFLOW_ERR;
+    }
+
+    memcpy(sessions + index.session_count * sizeof(session), &session, sizeof(session));
+    index.session_count++;
+    memcpy(log->index_buffer, &index, sizeof(index));
+
+    log->fill           = 0;
+    log->next_block     = session.first_block;
+    log->session_length = 0;
+    log->writes         = 0;
+
+    rslt = mtb_data_streaming_log_write_index(log);
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        iface->send     = mtb_data_streaming_log_send;
+        iface->receive  = mtb_data_streaming_log_receive;
+        iface->sendv    = mtb_data_streaming_log_sendv;
+        mtb_data_streaming_log_context_t* context =
+            (mtb_data_streaming_log_context_t*)&(iface->context);
+        context->log       = log;
+        context->callback  = cb;
+        context->call_tag  = NULL;
+    }
+
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_log_flush
+//--------------------------------------------------------------------------------------------------
+cy_rslt_t mtb_data_streaming_log_flush(mtb_data_streaming_log_t* log)
+{
+    cy_rslt_t rslt = mtb_data_streaming_log_write_buffer(log, true);
+
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        /* The partial block is now on the device as well */
+        uint32_t pending = log->fill;
+        log->fill = 0;
+        rslt = mtb_data_streaming_log_write_index(log);
+        log->fill = pending;
+    }
+
+    return rslt;
+}
@@ -0,0 +1,146 @@
+/*******************************************************************************
+* File Name: mtb_data_streaming_log.h
+*
+* Description:
+* Provides a data streaming interface that records the data to block storage
+* (SD card, external flash, or a file on a host machine) instead of sending it
+* over a communication link.
+*
+********************************************************************************
+* \copyright
+* Copyright 2023 Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#pragma once
+
+#include "mtb_data_streaming.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * \addtogroup group_data_streaming_log Data Streaming Log
+ * \{
+ * The log interface implements \ref mtb_data_streaming_send_t by appending each block of data as a
+ * record to a log on a block device. Records are gathered in a RAM buffer and written with large,
+ * block aligned writes. Each call to \ref mtb_data_streaming_setup_log starts a new session.
+ *
+ * Layout of the block device:
+ *     Block 0:     Index, \ref mtb_data_streaming_log_index_t followed by one
+ *                  \ref mtb_data_streaming_log_session_t per session.
+ *     Block 1..N:  Sessions, stored one after the other. Each session starts on a block boundary and
+ *                  holds a sequence of records, each made of a \ref mtb_data_streaming_log_record_t
+ *                  header followed by the data.
+ *
+ * All values are stored little endian. The index is rewritten every
+ * \ref mtb_data_streaming_log_t.index_interval buffer writes and by
+ * \ref mtb_data_streaming_log_flush, so at most that much data is lost on a power failure.
+ */
+
+/** Value of \ref mtb_data_streaming_log_index_t.magic ("MTBL") */
+#define MTB_DATA_STREAMING_LOG_MAGIC        (0x4C42544Du)
+/** Version of the log layout */
+#define MTB_DATA_STREAMING_LOG_VERSION      (1u)
+/** Value of \ref mtb_data_streaming_log_record_t.sync */
+#define MTB_DATA_STREAMING_LOG_RECORD_SYNC  (0x5AA5u)
+
+/** Header of the index block */
+typedef struct
+{
+    uint32_t    magic;          /**< \ref MTB_DATA_STREAMING_LOG_MAGIC */
+    uint16_t    version;        /**< \ref MTB_DATA_STREAMING_LOG_VERSION */
+    uint16_t    session_count;  /**< Number of sessions that follow */
+    uint32_t    block_size;     /**< Block size of the device the log was written to */
+    uint32_t    reserved;       /**< Set to 0 */
+} mtb_data_streaming_log_index_t;
+
+/** Index entry of a session */
+typedef struct
+{
+    uint32_t    first_block;    /**< Block the session starts at */
+    uint32_t    length;         /**< Number of bytes (record headers included) in the session */
+} mtb_data_streaming_log_session_t;
+
+/** Header of a record */
+typedef struct
+{
+    uint16_t    sync;           /**< \ref MTB_DATA_STREAMING_LOG_RECORD_SYNC */
+    uint16_t    reserved;       /**< Set to 0 */
+    uint32_t    length;         /**< Number of data bytes following the header */
+} mtb_data_streaming_log_record_t;
+
+/** Block device operations. Block numbers and counts are in units of block_size. */
+typedef struct
+{
+    /** Reads count blocks starting at block into data */
+    cy_rslt_t   (* read)(void* context, uint32_t block, uint8_t* data, uint32_t count);
+    /** Writes count blocks starting at block from data */
+    cy_rslt_t   (* write)(void* context, uint32_t block, const uint8_t* data, uint32_t count);
+    void*       context;        /**< Passed to \ref read and \ref write */
+    uint32_t    block_size;     /**< Size of a block in bytes */
+    uint32_t    block_count;    /**< Number of blocks on the device */
+} mtb_data_streaming_blockdev_t;
+
+/** Log instance. The user sets the configuration fields, the remaining fields are managed by the
+ * library.
+ */
+typedef struct
+{
+    const mtb_data_streaming_blockdev_t* blockdev;  /**< Device the log is written to */
+    uint8_t*    buffer;         /**< Write buffer, a multiple of the block size. Aligning it to the
+                                     DMA requirements of the device avoids copies in the driver. */
+    uint32_t    buffer_size;    /**< Size of \ref buffer in bytes */
+    uint8_t*    index_buffer;   /**< Buffer of one block used to update the index */
+    uint32_t    index_interval; /**< Number of buffer writes between two index updates, 0 to only
+                                     update the index in \ref mtb_data_streaming_log_flush */
+
+    uint32_t    fill;           /**< Number of bytes in \ref buffer */
+    uint32_t    next_block;     /**< Block the buffer is written to */
+    uint32_t    session_length; /**< Number of bytes in the current session */
+    uint32_t    writes;         /**< Number of buffer writes since the index was updated */
+} mtb_data_streaming_log_t;
+
+/** Sets up a streaming interface that appends the data sent to a log on a block device. The index
+ * of the device is read and a new session is started after the existing ones. A device without a
+ * valid index is formatted. Receive operations are not supported. The segments of a vectored send
+ * are written as a single record.
+ *
+ * @param[in]  log      Log instance with the configuration fields set.
+ * @param[in]  cb       Callback function to run when a transfer operation is complete. It is called
+ *                      before the send function returns.
+ * @param[out] iface    Streaming interface object to be populated by this setup function.
+ * @return              Result of the setup operation.
+ */
+cy_rslt_t mtb_data_streaming_setup_log(mtb_data_streaming_log_t* log,
+                                       mtb_data_streaming_xfer_done_t cb,
+                                       mtb_data_streaming_interface_t* iface);
+
+/** Writes the buffered records and updates the index, so that all the data sent so far is on the
+ * device.
+ *
+ * @param[in]  log      Log instance.
+ * @return              Result of the flush operation.
+ */
+cy_rslt_t mtb_data_streaming_log_flush(mtb_data_streaming_log_t* log);
+
+/** \} group_data_streaming_log */
+
+#if defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,459 @@
+/*******************************************************************************
+* File Name: mtb_data_streaming_spi_slave.c
+*
+* Description:
+* Implementation of the SPI slave streaming interface.
+*
+********************************************************************************
+* \copyright
+* Copyright 2023 Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <string.h>
+#include "mtb_data_streaming_spi_slave.h"
+
+#if defined(CYHAL_DRIVER_AVAILABLE_SPI)
+
+typedef struct
+{
+    mtb_data_streaming_spi_slave_t* slave;
+    mtb_data_streaming_xfer_done_t  callback;
+    void*                           call_tag;
+} mtb_data_streaming_spi_slave_context_t;
+
+/*
+ * Same compile time check as in mtb_data_streaming.c, the SPI slave context must fit in
+ * mtb_data_streaming_vcontext_t.
+ * NOTE: This function should never be called, it is only for a compile time error check
+ */
+static inline void _check_spi_slave_size(void) __attribute__ ((deprecated));
+#if __ICCARM__
+#pragma diag_suppress=Pe177
+#elif __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+#endif
+//--------------------------------------------------------------------------------------------------
+// _check_spi_slave_size
+//--------------------------------------------------------------------------------------------------
+static inline void _check_spi_slave_size(void)
+{
+    uint8_t dummy = 1 /
+                    (sizeof(mtb_data_streaming_vcontext_t) >=
+                     sizeof(mtb_data_streaming_spi_slave_context_t));
+    (void)dummy;
+}
+
+
+#if __ICCARM__
+#pragma diag_default=Pe177
+#elif __clang__
+#pragma clang diagnostic pop
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_slave_fill
+//
+// Copies the data of the send request to the free space of the ring. Returns true once the whole
+// request is in the ring.
+//--------------------------------------------------------------------------------------------------
+static bool mtb_data_streaming_spi_slave_fill(mtb_data_streaming_spi_slave_t* slave)
+{
+    while (0u != slave->segment_count)
+    {
+        const mtb_data_streaming_segment_t* segment = slave->segments;
+        size_t left = segment->count - slave->offset;
+        uint32_t space = slave->buffer_size - (slave->head - slave->tail);
+        uint32_t index = slave->head % slave->buffer_size;
+        size_t chunk = slave->buffer_size - index;
+
+        if ((0u == space) && (0u != left))
+        {
+            return false;
+        }
+        if (chunk > space)
+        {
+            chunk = space;
+        }
+        if (chunk > left)
+        {
+            chunk = left;
+        }
+
+        memcpy(&slave->buffer[index], &segment->data[slave->offset], chunk);
+        slave->head += (uint32_t)chunk;
+        slave->offset += chunk;
+
+        if (slave->offset == segment->count)
+        {
+            slave->segments++;
+            slave->segment_count--;
+            slave->offset = 0;
+        }
+    }
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_slave_frame
+//
+// Moves as much data of the ring as fits to the frame, behind the header.
+//--------------------------------------------------------------------------------------------------
+static void mtb_data_streaming_spi_slave_frame(mtb_data_streaming_spi_slave_t* slave)
+{
+    mtb_data_streaming_spi_slave_header_t header;
+    uint32_t length = slave->head - slave->tail;
+    uint32_t room = slave->frame_size - MTB_DATA_STREAMING_SPI_SLAVE_HEADER_SIZE;
+    if (length > room)
+    {
+        length = room;
+    }
+
+    uint32_t index = slave->tail % slave->buffer_size;
+    uint32_t chunk = slave->buffer_size - index;
+    if (chunk > length)
+    {
+        chunk = length;
+    }
+    uint8_t* data = &slave->frame[MTB_DATA_STREAMING_SPI_SLAVE_HEADER_SIZE];
+    memcpy(data, &slave->buffer[index], chunk);
+    memcpy(&data[chunk], slave->buffer, length - chunk);
+    slave->tail += length;
+
+    header.sync = MTB_DATA_STREAMING_SPI_SLAVE_SYNC;
+    header.length = (uint16_t)length;
+    header.available = slave->head - slave->tail;
+    memcpy(slave->frame, &header, sizeof(header));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_slave_rx
+//
+// Keeps the data of the frame received from the host in the receive ring.
+//--------------------------------------------------------------------------------------------------
+static void mtb_data_streaming_spi_slave_rx(mtb_data_streaming_spi_slave_t* slave)
+{
+    mtb_data_streaming_spi_slave_header_t header;
+    memcpy(&header, slave->rx_frame, sizeof(header));
+
+    if ((NULL == slave->rx_buffer) || (MTB_DATA_STREAMING_SPI_SLAVE_SYNC != header.sync) ||
+        (header.length > (slave->frame_size - MTB_DATA_STREAMING_SPI_SLAVE_HEADER_SIZE)))
+    {
+        return; // Idle frame, or nothing to keep it in
+    }
+
+    const uint8_t* data = &slave->rx_frame[MTB_DATA_STREAMING_SPI_SLAVE_HEADER_SIZE];
+    uint32_t space = slave->rx_buffer_size - (slave->rx_head - slave->rx_tail);
+    uint32_t length = header.length;
+    if (length > space)
+    {
+        slave->rx_dropped += length - space;
+        length = space;
+    }
+    for (uint32_t i = 0; i < length; i++)
+    {
+        slave->rx_buffer[(slave->rx_head + i) % slave->rx_buffer_size] = data[i];
+    }
+    slave->rx_head += length;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_slave_arm
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_spi_slave_arm(mtb_data_streaming_spi_slave_t* slave)
+{
+    return cyhal_spi_transfer_async(slave->spi, slave->frame, slave->frame_size,
+                                    slave->rx_frame, slave->frame_size);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_slave_complete
+//--------------------------------------------------------------------------------------------------
+static void mtb_data_streaming_spi_slave_complete(mtb_data_streaming_spi_slave_context_t* context,
+                                                  cy_rslt_t rslt)
+{
+    mtb_data_streaming_xfer_done_t callback = context->callback;
+    void* tag = context->call_tag;
+    context->call_tag = NULL;
+
+    if (NULL != callback)
+    {
+        callback(tag, rslt);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_slave_cb
+//
+// A transaction of the host is over: the next frame is built and made ready, and the send and
+// receive requests moved on.
+//--------------------------------------------------------------------------------------------------
+static void mtb_data_streaming_spi_slave_cb(void* callback_arg, cyhal_spi_event_t event)
+{
+    mtb_data_streaming_spi_slave_context_t* context =
+        (mtb_data_streaming_spi_slave_context_t*)callback_arg;
+    mtb_data_streaming_spi_slave_t* slave = context->slave;
+
+    if (0u != (event & CYHAL_SPI_IRQ_DONE))
+    {
+        slave->frames++;
+        mtb_data_streaming_spi_slave_rx(slave);
+        mtb_data_streaming_spi_slave_frame(slave);
+    }
+    else
+    {
+        slave->errors++; // The same frame is sent again
+    }
+    cy_rslt_t rslt = mtb_data_streaming_spi_slave_arm(slave);
+
+    if (slave->sending)
+    {
+        if (CY_RSLT_SUCCESS != rslt)
+        {
+            slave->segment_count = 0;
+            slave->sending = false;
+            mtb_data_streaming_spi_slave_complete(context, MTB_DATA_STREAMING_XFER_ERR);
+        }
+        else if (mtb_data_streaming_spi_slave_fill(slave))
+        {
+            slave->sending = false;
+            mtb_data_streaming_spi_slave_complete(context, CY_RSLT_SUCCESS);
+        }
+    }
+    else if (slave->receiving &&
+             ((slave->rx_head - slave->rx_tail) >= slave->rx_count))
+    {
+        slave->receiving = false;
+        (void)mtb_data_streaming_spi_slave_read(slave, slave->rx_data, slave->rx_count);
+        mtb_data_streaming_spi_slave_complete(context, CY_RSLT_SUCCESS);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_slave_claim
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_spi_slave_claim(
+    mtb_data_streaming_spi_slave_context_t* context, void* tag)
+{
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+    uint32_t state = cyhal_system_critical_section_enter();
+    if ((NULL == context->call_tag) && !context->slave->sending && !context->slave->receiving)
+    {
+        context->call_tag = tag;
+    }
+    else
+    {
+        rslt = MTB_DATA_STREAMING_IN_PROGRESS_ERR;
+    }
+    cyhal_system_critical_section_exit(state);
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_slave_start
+//
+// Moves what fits of a claimed send request to the ring. The interrupt moves the rest as the host
+// makes room.
+//--------------------------------------------------------------------------------------------------
+static void mtb_data_streaming_spi_slave_start(mtb_data_streaming_spi_slave_context_t* context,
+                                               const mtb_data_streaming_segment_t* segments,
+                                               size_t segment_count)
+{
+    mtb_data_streaming_spi_slave_t* slave = context->slave;
+    slave->segments = segments;
+    slave->segment_count = segment_count;
+    slave->offset = 0;
+
+    bool queued = mtb_data_streaming_spi_slave_fill(slave);
+    if (!queued)
+    {
+        slave->sending = true;
+    }
+    else
+    {
+        mtb_data_streaming_spi_slave_complete(context, CY_RSLT_SUCCESS);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_slave_sendv
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_spi_slave_sendv(mtb_data_streaming_vcontext_t* vcontext,
+                                                    const mtb_data_streaming_segment_t* segments,
+                                                    size_t segment_count, void* tag)
+{
+    mtb_data_streaming_spi_slave_context_t* context =
+        (mtb_data_streaming_spi_slave_context_t*)vcontext;
+
+    cy_rslt_t rslt = mtb_data_streaming_spi_slave_claim(context, tag);
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        mtb_data_streaming_spi_slave_start(context, segments, segment_count);
+    }
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_slave_send
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_spi_slave_send(mtb_data_streaming_vcontext_t* vcontext,
+                                                   /*const*/ uint8_t* data, size_t count,
+                                                   void* tag)
+{
+    mtb_data_streaming_spi_slave_context_t* context =
+        (mtb_data_streaming_spi_slave_context_t*)vcontext;
+    mtb_data_streaming_spi_slave_t* slave = context->slave;
+
+    cy_rslt_t rslt = mtb_data_streaming_spi_slave_claim(context, tag);
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        // The segment must outlive the call, the interrupt may finish the request
+        slave->segment.data = data;
+        slave->segment.count = count;
+        mtb_data_streaming_spi_slave_start(context, &slave->segment, 1);
+    }
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_slave_receive
+//
+// Completes at once when the receive ring holds enough data, otherwise from the interrupt.
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_spi_slave_receive(mtb_data_streaming_vcontext_t* vcontext,
+                                                      uint8_t* data, size_t count, void* tag)
+{
+    mtb_data_streaming_spi_slave_context_t* context =
+        (mtb_data_streaming_spi_slave_context_t*)vcontext;
+    mtb_data_streaming_spi_slave_t* slave = context->slave;
+
+    if ((NULL == slave->rx_buffer) || (count > slave->rx_buffer_size))
+    {
+        return MTB_DATA_STREAMING_UNSUPPORTED_ERR;
+    }
+
+    cy_rslt_t rslt = mtb_data_streaming_spi_slave_claim(context, tag);
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        uint32_t state = cyhal_system_critical_section_enter();
+        bool ready = ((slave->rx_head - slave->rx_tail) >= count);
+        if (!ready)
+        {
+            slave->rx_data = data;
+            slave->rx_count = count;
+            slave->receiving = true;
+        }
+        cyhal_system_critical_section_exit(state);
+
+        if (ready)
+        {
+            (void)mtb_data_streaming_spi_slave_read(slave, data, count);
+            mtb_data_streaming_spi_slave_complete(context, CY_RSLT_SUCCESS);
+        }
+    }
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_spi_slave_read
+//--------------------------------------------------------------------------------------------------
+size_t mtb_data_streaming_spi_slave_read(mtb_data_streaming_spi_slave_t* slave, uint8_t* data,
+                                         size_t count)
+{
+    size_t available = slave->rx_head - slave->rx_tail;
+    if (count > available)
+    {
+        count = available;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        data[i] = slave->rx_buffer[(slave->rx_tail + i) % slave->rx_buffer_size];
+    }
+    slave->rx_tail += (uint32_t)count;
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_setup_spi_slave
+//--------------------------------------------------------------------------------------------------
+cy_rslt_t mtb_data_streaming_setup_spi_slave(mtb_data_streaming_spi_slave_t* slave,
+                                             mtb_data_streaming_xfer_done_t cb,
+                                             mtb_data_streaming_interface_t* iface)
+{
+    if ((NULL == slave->buffer) || (0u == slave->buffer_size) ||
+        (0u != (slave->buffer_size & (slave->buffer_size - 1u))) ||
+        ((NULL != slave->rx_buffer) &&
+         ((0u == slave->rx_buffer_size) ||
+          (0u != (slave->rx_buffer_size & (slave->rx_buffer_size - 1u))))) ||
+        (NULL == slave->frame) || (NULL == slave->rx_frame) ||
+        (slave->frame_size <= MTB_DATA_STREAMING_SPI_SLAVE_HEADER_SIZE))
+    {
+        return MTB_DATA_STREAMING_UNSUPPORTED_ERR;
+    }
+
+    slave->head         = 0;
+    slave->tail         = 0;
+    slave->rx_head      = 0;
+    slave->rx_tail      = 0;
+    slave->segment_count = 0;
+    slave->sending      = false;
+    slave->receiving    = false;
+    slave->frames       = 0;
+    slave->errors       = 0;
+    slave->rx_dropped   = 0;
+
+    iface->send     = mtb_data_streaming_spi_slave_send;
+    iface->receive  = mtb_data_streaming_spi_slave_receive;
+    iface->sendv    = mtb_data_streaming_spi_slave_sendv;
+    mtb_data_streaming_spi_slave_context_t* context =
+        (mtb_data_streaming_spi_slave_context_t*)&(iface->context);
+    context->slave     = slave;
+    context->callback  = cb;
+    context->call_tag  = NULL;
+
+    cy_rslt_t rslt = cyhal_spi_set_async_mode(slave->spi, CYHAL_ASYNC_DMA,
+                                              CYHAL_DMA_PRIORITY_DEFAULT);
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        cyhal_spi_register_callback(slave->spi, mtb_data_streaming_spi_slave_cb, context);
+        cyhal_spi_event_t events = (cyhal_spi_event_t)(CYHAL_SPI_IRQ_DONE | CYHAL_SPI_IRQ_ERROR);
+        cyhal_spi_enable_event(slave->spi, events, CYHAL_ISR_PRIORITY_DEFAULT, true);
+
+        // Idle frame until data is sent
+        mtb_data_streaming_spi_slave_frame(slave);
+        rslt = mtb_data_streaming_spi_slave_arm(slave);
+    }
+
+    return rslt;
+}
+
+
+#endif // defined(CYHAL_DRIVER_AVAILABLE_SPI)
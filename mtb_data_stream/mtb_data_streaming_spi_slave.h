@@ -0,0 +1,141 @@
+/*******************************************************************************
+* File Name: mtb_data_streaming_spi_slave.h
+*
+* Description:
+* Provides a data streaming interface over an SPI slave, for an external host bridge that clocks
+* the streamed data out of a ring buffer of the device.
+*
+********************************************************************************
+* \copyright
+* Copyright 2023 Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#pragma once
+
+#include <stdbool.h>
+#include "mtb_data_streaming.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * \addtogroup group_data_streaming_spi_slave Data Streaming SPI Slave
+ * \{
+ * The device is an SPI slave and the host bridge (e.g. a Linux single board computer) is the
+ * master. The data sent is copied to a ring buffer owned by the interface, and a send request is
+ * complete once all its data is in the ring. The host reads the ring in frames of a fixed size:
+ * each of its transactions clocks exactly \ref mtb_data_streaming_spi_slave_t::frame_size bytes
+ * out of the device, a \ref mtb_data_streaming_spi_slave_header_t followed by the data. The
+ * header gives the number of bytes of data in the frame and the number of bytes left in the ring,
+ * so the host reads again right away while data is available, and polls otherwise.
+ *
+ * The frames are transferred by DMA. The next frame is built from the ring when a transaction is
+ * done, so the host leaves a short gap between two transactions (a few microseconds). In the same
+ * transactions the host sends frames of the same layout, whose data is kept in a receive ring.
+ *
+ * All the fields are little-endian.
+ */
+
+/** Sync word at the start of each frame */
+#define MTB_DATA_STREAMING_SPI_SLAVE_SYNC           (0xA55Au)
+/** Size of the header at the start of each frame */
+#define MTB_DATA_STREAMING_SPI_SLAVE_HEADER_SIZE    (8u)
+
+/** Header at the start of each frame, in both directions */
+typedef struct
+{
+    uint16_t    sync;           /**< \ref MTB_DATA_STREAMING_SPI_SLAVE_SYNC */
+    uint16_t    length;         /**< Bytes of data following the header */
+    uint32_t    available;      /**< Bytes left in the ring of the device after this frame, 0 in
+                                     the frames of the host */
+} mtb_data_streaming_spi_slave_header_t;
+
+#if defined(CYHAL_DRIVER_AVAILABLE_SPI)
+/** SPI slave instance. The user sets the configuration fields, the remaining fields are managed by
+ * the library.
+ */
+typedef struct
+{
+    cyhal_spi_t* spi;           /**< SPI block initialized as a slave, 8 bit words */
+    uint8_t*    buffer;         /**< Ring of the data to send */
+    uint32_t    buffer_size;    /**< Size of \ref buffer in bytes, a power of two */
+    uint8_t*    rx_buffer;      /**< Ring of the data received, NULL to ignore it */
+    uint32_t    rx_buffer_size; /**< Size of \ref rx_buffer in bytes, a power of two */
+    uint8_t*    frame;          /**< Frame clocked out by the host, \ref frame_size bytes */
+    uint8_t*    rx_frame;       /**< Frame clocked in by the host, \ref frame_size bytes */
+    uint16_t    frame_size;     /**< Bytes of each transaction of the host, header included */
+
+    volatile uint32_t head;     /**< Bytes written to the ring, wraps around */
+    volatile uint32_t tail;     /**< Bytes moved to frames, wraps around */
+    volatile uint32_t rx_head;  /**< Bytes written to the receive ring, wraps around */
+    volatile uint32_t rx_tail;  /**< Bytes read from the receive ring, wraps around */
+    mtb_data_streaming_segment_t segment;           /**< Segment of a single buffer send */
+    const mtb_data_streaming_segment_t* segments;   /**< Segments of the send request left */
+    size_t      segment_count;  /**< Number of segments of the send request left */
+    size_t      offset;         /**< Bytes of the first segment left already in the ring */
+    volatile bool sending;      /**< The rest of the send request is moved to the ring by the
+                                     transaction interrupt */
+    uint8_t*    rx_data;        /**< Buffer of the receive request */
+    size_t      rx_count;       /**< Size of the receive request */
+    volatile bool receiving;    /**< A receive request is in progress */
+    volatile uint32_t frames;   /**< Transactions done */
+    volatile uint32_t errors;   /**< Transactions failed, their frame is sent again */
+    volatile uint32_t rx_dropped;   /**< Bytes received that did not fit in the receive ring */
+} mtb_data_streaming_spi_slave_t;
+
+/** Sets up a streaming interface over an SPI slave, switches the SPI block to DMA transfers and
+ * makes the first frame ready for the host.
+ *
+ * @param[in]  slave    SPI slave instance with the configuration fields set.
+ * @param[in]  cb       Callback function to run when a transfer operation is complete. It is called
+ *                      from the SPI interrupt when the request did not fit in the ring at once.
+ * @param[out] iface    Streaming interface object to be populated by this setup function.
+ * @return              Result of the setup operation.
+ */
+cy_rslt_t mtb_data_streaming_setup_spi_slave(mtb_data_streaming_spi_slave_t* slave,
+                                             mtb_data_streaming_xfer_done_t cb,
+                                             mtb_data_streaming_interface_t* iface);
+
+/** Reads the data received from the host, without waiting.
+ *
+ * @param[in]  slave    SPI slave instance.
+ * @param[out] data     Buffer for the data.
+ * @param[in]  count    Size of the buffer.
+ * @return              The number of bytes read.
+ */
+size_t mtb_data_streaming_spi_slave_read(mtb_data_streaming_spi_slave_t* slave, uint8_t* data,
+                                         size_t count);
+
+/** Returns the number of bytes in the ring, not yet moved to a frame for the host.
+ *
+ * @param[in]  slave    SPI slave instance.
+ * @return              The number of bytes queued.
+ */
+static inline uint32_t mtb_data_streaming_spi_slave_queued(
+    const mtb_data_streaming_spi_slave_t* slave)
+{
+    return slave->head - slave->tail;
+}
+#endif // defined(CYHAL_DRIVER_AVAILABLE_SPI)
+
+/** \} group_data_streaming_spi_slave */
+
+#if defined(__cplusplus)
+}
+#endif
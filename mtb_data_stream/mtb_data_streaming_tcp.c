@@ -0,0 +1,438 @@
+/*******************************************************************************
+* File Name: mtb_data_streaming_tcp.c
+*
+* Description:
+* Implementation of the non-blocking TCP streaming interface.
+*
+********************************************************************************
+* \copyright
+* Copyright 2023 Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#if defined(COMPONENT_MW_SECURE_SOCKETS) || defined(MTB_DATA_STREAMING_TCP_POSIX)
+
+#include <string.h>
+#include "mtb_data_streaming_tcp.h"
+
+#if defined(MTB_DATA_STREAMING_TCP_POSIX)
+#include <errno.h>
+#include <sys/socket.h>
+#endif
+
+typedef struct
+{
+    mtb_data_streaming_tcp_t*       tcp;
+    mtb_data_streaming_xfer_done_t  callback;
+    void*                           call_tag;
+} mtb_data_streaming_tcp_context_t;
+
+/*
+ * Same compile time check as in mtb_data_streaming.c, the TCP context must fit in
+ * mtb_data_streaming_vcontext_t.
+ * NOTE: This function should never be called, it is only for a compile time error check
+ */
+static inline void _check_tcp_size(void) __attribute__ ((deprecated));
+#if __ICCARM__
+#pragma diag_suppress=Pe177
+#elif __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+#endif
+//--------------------------------------------------------------------------------------------------
+// _check_tcp_size
+//--------------------------------------------------------------------------------------------------
+static inline void _check_tcp_size(void)
+{
+    uint8_t dummy = 1 /
+                    (sizeof(mtb_data_streaming_vcontext_t) >=
+                     sizeof(mtb_data_streaming_tcp_context_t));
+    (void)dummy;
+}
+
+
+#if __ICCARM__
+#pragma diag_default=Pe177
+#elif __clang__
+#pragma clang diagnostic pop
+#endif
+
+
+#if defined(MTB_DATA_STREAMING_TCP_POSIX)
+// The host implementation is used by a single thread
+#define _tcp_lock()             (0u)
+#define _tcp_unlock(state)      ((void)(state))
+#else
+// Only protects the claim of a request, never a socket operation
+#define _tcp_lock()             cyhal_system_critical_section_enter()
+#define _tcp_unlock(state)      cyhal_system_critical_section_exit(state)
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_tcp_write
+//
+// Sends what the socket can take of the data without blocking.
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_tcp_write(mtb_data_streaming_socket_t socket,
+                                              const uint8_t* data, size_t count, size_t* sent)
+{
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+    #if defined(MTB_DATA_STREAMING_TCP_POSIX)
+    ssize_t bytes = send(socket, data, count, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (bytes < 0)
+    {
+        if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno))
+        {
+            rslt = MTB_DATA_STREAMING_XFER_ERR;
+        }
+        bytes = 0;
+    }
+    #else
+    uint32_t bytes = 0;
+    rslt = cy_socket_send(socket, data, count, CY_SOCKET_FLAGS_NONE, &bytes);
+    if (CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT == rslt)
+    {
+        rslt = CY_RSLT_SUCCESS; // The socket buffers are full
+    }
+    #endif
+    *sent = (size_t)bytes;
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_tcp_read
+//
+// Receives the data available, up to count bytes, without blocking.
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_tcp_read(mtb_data_streaming_socket_t socket, uint8_t* data,
+                                             size_t count, size_t* received)
+{
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+    #if defined(MTB_DATA_STREAMING_TCP_POSIX)
+    ssize_t bytes = recv(socket, data, count, MSG_DONTWAIT);
+    if (0 == bytes)
+    {
+        rslt = MTB_DATA_STREAMING_XFER_ERR; // Closed by the peer
+    }
+    else if (bytes < 0)
+    {
+        if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno))
+        {
+            rslt = MTB_DATA_STREAMING_XFER_ERR;
+        }
+        bytes = 0;
+    }
+    #else
+    uint32_t bytes = 0;
+    rslt = cy_socket_recv(socket, data, count, CY_SOCKET_FLAGS_NONE, &bytes);
+    if (CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT == rslt)
+    {
+        rslt = CY_RSLT_SUCCESS; // Nothing received yet
+    }
+    #endif
+    *received = (size_t)bytes;
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_tcp_fill
+//
+// Copies the data of the send request to the free space of the queue. Returns true once the whole
+// request is queued.
+//--------------------------------------------------------------------------------------------------
+static bool mtb_data_streaming_tcp_fill(mtb_data_streaming_tcp_t* tcp)
+{
+    while (0u != tcp->segment_count)
+    {
+        const mtb_data_streaming_segment_t* segment = tcp->segments;
+        size_t left = segment->count - tcp->offset;
+        uint32_t space = tcp->buffer_size - (tcp->head - tcp->tail);
+        uint32_t index = tcp->head % tcp->buffer_size;
+        size_t chunk = tcp->buffer_size - index;
+
+        if (0u == space)
+        {
+            return false;
+        }
+        if (chunk > space)
+        {
+            chunk = space;
+        }
+        if (chunk > left)
+        {
+            chunk = left;
+        }
+
+        memcpy(&tcp->buffer[index], &segment->data[tcp->offset], chunk);
+        tcp->head += (uint32_t)chunk;
+        tcp->offset += chunk;
+
+        if (tcp->offset == segment->count)
+        {
+            tcp->segments++;
+            tcp->segment_count--;
+            tcp->offset = 0;
+        }
+    }
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_tcp_drain
+//
+// Sends the queued data until the socket does not take more.
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_tcp_drain(mtb_data_streaming_tcp_t* tcp)
+{
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+    size_t sent = 1;
+
+    while ((CY_RSLT_SUCCESS == rslt) && (0u != sent) && (tcp->head != tcp->tail))
+    {
+        uint32_t index = tcp->tail % tcp->buffer_size;
+        size_t chunk = tcp->buffer_size - index;
+        if (chunk > (tcp->head - tcp->tail))
+        {
+            chunk = tcp->head - tcp->tail;
+        }
+
+        rslt = mtb_data_streaming_tcp_write(tcp->socket, &tcp->buffer[index], chunk, &sent);
+        tcp->tail += (uint32_t)sent;
+    }
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_tcp_complete
+//--------------------------------------------------------------------------------------------------
+static void mtb_data_streaming_tcp_complete(mtb_data_streaming_tcp_context_t* context,
+                                            cy_rslt_t rslt)
+{
+    mtb_data_streaming_xfer_done_t callback = context->callback;
+    void* tag = context->call_tag;
+    context->call_tag = NULL;
+
+    if (NULL != callback)
+    {
+        callback(tag, rslt);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_tcp_claim
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_tcp_claim(mtb_data_streaming_tcp_context_t* context, void* tag)
+{
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+    uint32_t state = _tcp_lock();
+    if ((NULL == context->call_tag) && !context->tcp->sending && !context->tcp->receiving)
+    {
+        context->call_tag = tag;
+    }
+    else
+    {
+        rslt = MTB_DATA_STREAMING_IN_PROGRESS_ERR;
+    }
+    _tcp_unlock(state);
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_tcp_sendv
+//
+// Only records the request, the data is queued by mtb_data_streaming_tcp_process.
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_tcp_sendv(mtb_data_streaming_vcontext_t* vcontext,
+                                              const mtb_data_streaming_segment_t* segments,
+                                              size_t segment_count, void* tag)
+{
+    mtb_data_streaming_tcp_context_t* context = (mtb_data_streaming_tcp_context_t*)vcontext;
+    mtb_data_streaming_tcp_t* tcp = context->tcp;
+
+    cy_rslt_t rslt = mtb_data_streaming_tcp_claim(context, tag);
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        tcp->segments = segments;
+        tcp->segment_count = segment_count;
+        tcp->offset = 0;
+        tcp->sending = true;
+    }
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_tcp_send
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_tcp_send(mtb_data_streaming_vcontext_t* vcontext,
+                                             /*const*/ uint8_t* data, size_t count, void* tag)
+{
+    mtb_data_streaming_tcp_context_t* context = (mtb_data_streaming_tcp_context_t*)vcontext;
+    mtb_data_streaming_tcp_t* tcp = context->tcp;
+
+    cy_rslt_t rslt = mtb_data_streaming_tcp_claim(context, tag);
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        tcp->segment.data = data;
+        tcp->segment.count = count;
+        tcp->segments = &tcp->segment;
+        tcp->segment_count = 1;
+        tcp->offset = 0;
+        tcp->sending = true;
+    }
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_tcp_receive
+//
+// Only records the request, the data is read by mtb_data_streaming_tcp_process.
+//--------------------------------------------------------------------------------------------------
+static cy_rslt_t mtb_data_streaming_tcp_receive(mtb_data_streaming_vcontext_t* vcontext,
+                                                uint8_t* data, size_t count, void* tag)
+{
+    mtb_data_streaming_tcp_context_t* context = (mtb_data_streaming_tcp_context_t*)vcontext;
+    mtb_data_streaming_tcp_t* tcp = context->tcp;
+
+    cy_rslt_t rslt = mtb_data_streaming_tcp_claim(context, tag);
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        tcp->rx_data = data;
+        tcp->rx_count = count;
+        tcp->rx_offset = 0;
+        tcp->receiving = true;
+    }
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_setup_tcp
+//--------------------------------------------------------------------------------------------------
+cy_rslt_t mtb_data_streaming_setup_tcp(mtb_data_streaming_tcp_t* tcp,
+                                       mtb_data_streaming_xfer_done_t cb,
+                                       mtb_data_streaming_interface_t* iface)
+{
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+
+    if ((NULL == tcp->buffer) || (0u == tcp->buffer_size) ||
+        (0u != (tcp->buffer_size & (tcp->buffer_size - 1u))))
+    {
+        return MTB_DATA_STREAMING_UNSUPPORTED_ERR;
+    }
+
+    #if !defined(MTB_DATA_STREAMING_TCP_POSIX)
+    uint32_t timeout = MTB_DATA_STREAMING_TCP_TIMEOUT_MS;
+    rslt = cy_socket_setsockopt(tcp->socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_SNDTIMEO,
+                                &timeout, sizeof(timeout));
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        rslt = cy_socket_setsockopt(tcp->socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO,
+                                    &timeout, sizeof(timeout));
+    }
+    #endif
+
+    if (CY_RSLT_SUCCESS == rslt)
+    {
+        tcp->head           = 0;
+        tcp->tail           = 0;
+        tcp->segment_count  = 0;
+        tcp->sending        = false;
+        tcp->receiving      = false;
+
+        iface->send     = mtb_data_streaming_tcp_send;
+        iface->receive  = mtb_data_streaming_tcp_receive;
+        iface->sendv    = mtb_data_streaming_tcp_sendv;
+        mtb_data_streaming_tcp_context_t* context =
+            (mtb_data_streaming_tcp_context_t*)&(iface->context);
+        context->tcp       = tcp;
+        context->callback  = cb;
+        context->call_tag  = NULL;
+    }
+
+    return rslt;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_data_streaming_tcp_process
+//--------------------------------------------------------------------------------------------------
+cy_rslt_t mtb_data_streaming_tcp_process(mtb_data_streaming_interface_t* iface)
+{
+    mtb_data_streaming_tcp_context_t* context =
+        (mtb_data_streaming_tcp_context_t*)&(iface->context);
+    mtb_data_streaming_tcp_t* tcp = context->tcp;
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+
+    if (tcp->sending)
+    {
+        // Queue what fits, send, then queue the rest in the space freed
+        bool queued = mtb_data_streaming_tcp_fill(tcp);
+        rslt = mtb_data_streaming_tcp_drain(tcp);
+        if (!queued && (CY_RSLT_SUCCESS == rslt))
+        {
+            queued = mtb_data_streaming_tcp_fill(tcp);
+        }
+
+        if (queued || (CY_RSLT_SUCCESS != rslt))
+        {
+            tcp->segment_count = 0;
+            tcp->sending = false;
+            mtb_data_streaming_tcp_complete(context, (CY_RSLT_SUCCESS == rslt)
+                ? CY_RSLT_SUCCESS
+                : MTB_DATA_STREAMING_XFER_ERR);
+        }
+    }
+    else
+    {
+        rslt = mtb_data_streaming_tcp_drain(tcp);
+    }
+
+    if (tcp->receiving)
+    {
+        size_t received = 0;
+        cy_rslt_t rx_rslt = mtb_data_streaming_tcp_read(tcp->socket, &tcp->rx_data[tcp->rx_offset],
+                                                        tcp->rx_count - tcp->rx_offset,
+                                                        &received);
+        tcp->rx_offset += received;
+
+        if ((tcp->rx_offset == tcp->rx_count) || (CY_RSLT_SUCCESS != rx_rslt))
+        {
+            tcp->receiving = false;
+            mtb_data_streaming_tcp_complete(context, (CY_RSLT_SUCCESS == rx_rslt)
+                ? CY_RSLT_SUCCESS
+                : MTB_DATA_STREAMING_XFER_ERR);
+        }
+        if (CY_RSLT_SUCCESS == rslt)
+        {
+            rslt = rx_rslt;
+        }
+    }
+
+    return rslt;
+}
+
+
+#endif // defined(COMPONENT_MW_SECURE_SOCKETS) || defined(MTB_DATA_STREAMING_TCP_POSIX)
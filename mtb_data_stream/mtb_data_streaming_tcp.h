@@ -0,0 +1,128 @@
+/*******************************************************************************
+* File Name: mtb_data_streaming_tcp.h
+*
+* Description:
+* Provides a non-blocking data streaming interface over a connected TCP socket,
+* using the secure sockets library on the device or POSIX sockets on a host
+* machine.
+*
+********************************************************************************
+* \copyright
+* Copyright 2023 Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#pragma once
+
+#include <stdbool.h>
+#include "mtb_data_streaming.h"
+
+#if defined(MTB_DATA_STREAMING_TCP_POSIX)
+typedef int mtb_data_streaming_socket_t;
+#else
+#include "cy_secure_sockets.h"
+typedef cy_socket_t mtb_data_streaming_socket_t;
+#endif
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * \addtogroup group_data_streaming_tcp Data Streaming TCP
+ * \{
+ * The TCP interface never blocks and never disables the interrupts around socket operations. A send
+ * request is copied to a send queue owned by the interface, and is complete once all its data is
+ * queued. The queue is drained to the socket without blocking by \ref
+ * mtb_data_streaming_tcp_process, which also completes the receive requests. The application calls
+ * it when the socket can take more data (on a host, when poll() reports POLLOUT) or periodically
+ * from its main loop or network task. The callbacks are called from \ref
+ * mtb_data_streaming_tcp_process.
+ *
+ * On the device the socket is used through the secure sockets library: its send and receive
+ * timeouts are set to \ref MTB_DATA_STREAMING_TCP_TIMEOUT_MS, a timeout meaning that the socket
+ * is not ready. Defining MTB_DATA_STREAMING_TCP_POSIX builds the interface over a POSIX socket for
+ * host machines instead.
+ *
+ * The socket is owned by the application, which closes it when a transfer fails.
+ */
+
+/** Send and receive timeout of the secure sockets, in milliseconds */
+#ifndef MTB_DATA_STREAMING_TCP_TIMEOUT_MS
+#define MTB_DATA_STREAMING_TCP_TIMEOUT_MS   (1u)
+#endif
+
+/** TCP instance. The user sets the configuration fields, the remaining fields are managed by the
+ * library.
+ */
+typedef struct
+{
+    mtb_data_streaming_socket_t socket; /**< Connected socket */
+    uint8_t*    buffer;                 /**< Send queue */
+    uint32_t    buffer_size;            /**< Size of \ref buffer in bytes, a power of two */
+
+    volatile uint32_t head;             /**< Bytes written to the queue, wraps around */
+    volatile uint32_t tail;             /**< Bytes sent from the queue, wraps around */
+    mtb_data_streaming_segment_t segment;           /**< Segment of a single buffer send */
+    const mtb_data_streaming_segment_t* segments;   /**< Segments of the send request left */
+    size_t      segment_count;          /**< Number of segments of the send request left */
+    size_t      offset;                 /**< Bytes of the first segment left already queued */
+    volatile bool sending;              /**< A send request is in progress */
+    uint8_t*    rx_data;                /**< Buffer of the receive request */
+    size_t      rx_count;               /**< Size of the receive request */
+    size_t      rx_offset;              /**< Bytes received for the receive request */
+    volatile bool receiving;            /**< A receive request is in progress */
+} mtb_data_streaming_tcp_t;
+
+/** Sets up a streaming interface for TCP communication over the provided socket.
+ * This expects that the TCP socket is already connected.
+ *
+ * @param[in]  tcp      TCP instance with the configuration fields set.
+ * @param[in]  cb       Callback function to run when a transfer operation is complete. It is called
+ *                      from \ref mtb_data_streaming_tcp_process.
+ * @param[out] iface    Streaming interface object to be populated by this setup function.
+ * @return              Result of the setup operation.
+ */
+cy_rslt_t mtb_data_streaming_setup_tcp(mtb_data_streaming_tcp_t* tcp,
+                                       mtb_data_streaming_xfer_done_t cb,
+                                       mtb_data_streaming_interface_t* iface);
+
+/** Moves the data of the send request to the queue, sends the queued data the socket can take and
+ * reads the data available for the receive request, without blocking. Completed requests are
+ * reported to the callback.
+ *
+ * @param[in]  iface    The streaming interface set up by \ref mtb_data_streaming_setup_tcp.
+ * @return              Result of the socket operations. On an error, the request in progress is
+ *                      completed with \ref MTB_DATA_STREAMING_XFER_ERR.
+ */
+cy_rslt_t mtb_data_streaming_tcp_process(mtb_data_streaming_interface_t* iface);
+
+/** Returns the number of bytes in the send queue, not yet taken by the socket.
+ *
+ * @param[in]  tcp      TCP instance.
+ * @return              The number of bytes queued.
+ */
+static inline uint32_t mtb_data_streaming_tcp_queued(const mtb_data_streaming_tcp_t* tcp)
+{
+    return tcp->head - tcp->tail;
+}
+
+/** \} group_data_streaming_tcp */
+
+#if defined(__cplusplus)
+}
+#endif
@@ -44,7 +44,12 @@
 #include "cybsp.h"
 
 #include "audio.h"
+#include "audio_features.h"
 #include "config.h"
+#include "pipeline.h"
+#include "stream_record.h"
+#include "timebase.h"
+#include "vad.h"
 
 /******************************************************************************
  * Macros
@@ -66,6 +71,13 @@ int16_t audio_buffer0[FRAME_SIZE] = {0};
 int16_t audio_buffer1[FRAME_SIZE] = {0};
 int16_t* active_rx_buffer;
 int16_t* full_rx_buffer;
+/* Time at which the full buffer was completed */
+volatile uint32_t full_rx_timestamp;
+
+#if AUDIO_VAD_ENABLE == 1
+/* Output of pdm_preprocessing_feed before gating */
+static int16_t vad_frame[AUDIO_DATA_SIZE];
+#endif
 
 /******************************************************************************
  * Global Variables
@@ -116,6 +128,18 @@ cy_rslt_t pdm_init(void)
 {
     cy_rslt_t result;
 
+#if AUDIO_OUTPUT_MODE != AUDIO_OUTPUT_RAW
+    /* Build the feature extraction tables */
+    if(false == audio_features_init(SAMPLE_RATE_HZ))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+#endif
+
+#if AUDIO_VAD_ENABLE == 1
+    vad_init();
+#endif
+
     /* Initialize the PDM clock */
     result = pdm_clock_init();
     if(CY_RSLT_SUCCESS != result)
@@ -240,6 +264,8 @@ void pdm_pcm_event_handler(void *arg, cyhal_pdm_pcm_event_t event)
         int16_t* temp = active_rx_buffer;
         active_rx_buffer = full_rx_buffer;
         full_rx_buffer = temp;
+        full_rx_timestamp = timebase_now_us();
+        pipeline_notify_from_isr(STREAM_CHANNEL_PDM);
 
     }
     /* Initiate the next pdm read */
@@ -250,19 +276,49 @@ void pdm_pcm_event_handler(void *arg, cyhal_pdm_pcm_event_t event)
 * Function Name: pdm_preprocessing_feed
 ********************************************************************************
 * Summary:
-*  This function returns the pdm data.
+*  This function returns the pdm data of the last full frame, as PCM samples
+*  and/or spectral features depending on AUDIO_OUTPUT_MODE.
 *
 * Parameters:
-*  preprocessed_data: Stores float PDM values
+*  preprocessed_data: Stores AUDIO_DATA_SIZE values, PCM samples first
 *
 *******************************************************************************/
 void pdm_preprocessing_feed(int16_t *preprocessed_data)
 {
-
+#if AUDIO_OUTPUT_MODE != AUDIO_OUTPUT_FEATURES
     for (uint32_t index = 0; index < FRAME_SIZE ; index ++)
     {
         preprocessed_data[index] = full_rx_buffer[index];
     }
+    preprocessed_data += FRAME_SIZE;
+#endif
+
+#if AUDIO_OUTPUT_MODE != AUDIO_OUTPUT_RAW
+    audio_features_process(full_rx_buffer, preprocessed_data);
+#endif
+}
+
+#if AUDIO_VAD_ENABLE == 1
+/*******************************************************************************
+* Function Name: pdm_vad_feed
+********************************************************************************
+* Summary:
+*  Same as pdm_preprocessing_feed, but only returns the frames with sound
+*  activity (and the pre-roll/post-roll frames around it), as records.
+*
+* Parameters:
+*  records: Stores up to VAD_BUFFER_SIZE bytes of records
+*
+* Return:
+*  The number of bytes to transmit, 0 if the frame is skipped.
+*
+*******************************************************************************/
+uint32_t pdm_vad_feed(uint8_t *records)
+{
+    pdm_preprocessing_feed(vad_frame);
+
+    return vad_gate(full_rx_buffer, vad_frame, full_rx_timestamp, records);
 }
+#endif
 
 /* [] END OF FILE */
@@ -45,6 +45,7 @@
 
 #include "cy_retarget_io.h"
 #include "stdbool.h"
+#include "config.h"
 
 /******************************************************************************
  * Constants
@@ -61,6 +62,7 @@ extern volatile bool pdm_pcm_flag;
 *******************************************************************************/
 cy_rslt_t pdm_init(void);
 void pdm_preprocessing_feed(int16_t *preprocessed_data);
+uint32_t pdm_vad_feed(uint8_t *records);
 
 
 #endif /* SOURCE_AUDIO_H_ */
@@ -0,0 +1,328 @@
+/******************************************************************************
+* File Name:   audio_features.c
+*
+* Description: This file implements the log-mel and MFCC feature extraction
+*   for the PDM frames. Only integer arithmetic is used once the tables are
+*   built, so the same code produces bit-identical features on the device and
+*   in the inference pipeline.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+
+#include "audio_features.h"
+#include "dsp.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Samples kept from the previous frame so the windows overlap across frames */
+#define AUDIO_FEATURE_HISTORY_SIZE  (AUDIO_FEATURE_WINDOW_SIZE - AUDIO_FEATURE_HOP_SIZE)
+/* Number of FFT bins from DC to Nyquist */
+#define AUDIO_FEATURE_FFT_BINS      (AUDIO_FEATURE_WINDOW_SIZE / 2 + 1)
+/* Every FFT bin contributes to at most two overlapping mel bands */
+#define AUDIO_FEATURE_MEL_WEIGHTS   (2 * AUDIO_FEATURE_FFT_BINS)
+/* Lowest frequency covered by the mel filter bank */
+#define AUDIO_FEATURE_MEL_LOW_HZ    (20.0)
+#define AUDIO_FEATURE_PI            (3.14159265358979323846)
+/* Log-mel values are log2 in Q8, MFCCs are in Q6 */
+#define AUDIO_FEATURE_LOG_SHIFT     (8)
+#define AUDIO_FEATURE_MFCC_SHIFT    (15 + 2)
+
+#if (FRAME_SIZE % AUDIO_FEATURE_HOP_SIZE) != 0
+#error "FRAME_SIZE must be a multiple of AUDIO_FEATURE_HOP_SIZE"
+#endif
+
+#if AUDIO_FEATURE_MFCC_COUNT > AUDIO_FEATURE_MEL_BANDS
+#error "AUDIO_FEATURE_MFCC_COUNT cannot exceed AUDIO_FEATURE_MEL_BANDS"
+#endif
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+static dsp_rfft_t feature_fft;
+static int16_t feature_window[AUDIO_FEATURE_WINDOW_SIZE];
+
+/* Previous samples followed by the current frame */
+static int16_t feature_signal[AUDIO_FEATURE_HISTORY_SIZE + FRAME_SIZE];
+static int16_t feature_frame[AUDIO_FEATURE_WINDOW_SIZE];
+static int16_t feature_spectrum[2 * AUDIO_FEATURE_WINDOW_SIZE];
+static uint32_t feature_power[AUDIO_FEATURE_FFT_BINS];
+
+/* Sparse triangular mel filter bank: band m covers mel_length[m] bins starting
+ * at mel_start[m], with weights (Q15) starting at mel_weights[mel_offset[m]] */
+static uint16_t mel_start[AUDIO_FEATURE_MEL_BANDS];
+static uint16_t mel_length[AUDIO_FEATURE_MEL_BANDS];
+static uint16_t mel_offset[AUDIO_FEATURE_MEL_BANDS];
+static int16_t mel_weights[AUDIO_FEATURE_MEL_WEIGHTS];
+
+#if AUDIO_FEATURE_TYPE == AUDIO_FEATURE_MFCC
+static int16_t log_mel[AUDIO_FEATURE_MEL_BANDS];
+/* Orthonormal DCT-II matrix in Q15 */
+static int16_t dct_matrix[AUDIO_FEATURE_MFCC_COUNT][AUDIO_FEATURE_MEL_BANDS];
+#endif
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static double hz_to_mel(double hz);
+static double mel_to_hz(double mel);
+static void mel_filter_bank_init(uint32_t sample_rate);
+static void feature_vector(const int16_t *samples, int16_t *output);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: audio_features_init
+********************************************************************************
+* Summary:
+*    Builds the window, mel filter bank and DCT tables and clears the sample
+*    history. Must be called before the first call to audio_features_process.
+*
+* Parameters:
+*   sample_rate: PDM sample rate in Hz
+*
+* Return:
+*     True if the feature extraction is ready.
+*
+*******************************************************************************/
+bool audio_features_init(uint32_t sample_rate)
+{
+    if (false == dsp_rfft_init(&feature_fft, AUDIO_FEATURE_WINDOW_SIZE))
+    {
+        return false;
+    }
+
+    dsp_hann_window_q15(feature_window, AUDIO_FEATURE_WINDOW_SIZE);
+    mel_filter_bank_init(sample_rate);
+
+#if AUDIO_FEATURE_TYPE == AUDIO_FEATURE_MFCC
+    for (uint32_t k = 0; k < AUDIO_FEATURE_MFCC_COUNT; k++)
+    {
+        double scale = sqrt(((0u == k) ? 1.0 : 2.0) / AUDIO_FEATURE_MEL_BANDS);
+
+        for (uint32_t m = 0; m < AUDIO_FEATURE_MEL_BANDS; m++)
+        {
+            double value = scale * cos(AUDIO_FEATURE_PI * k * (m + 0.5) / AUDIO_FEATURE_MEL_BANDS);
+            dct_matrix[k][m] = (int16_t)lround(value * 32767.0);
+        }
+    }
+#endif
+
+    memset(feature_signal, 0, sizeof(feature_signal));
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: audio_features_process
+********************************************************************************
+* Summary:
+*    Computes AUDIO_FEATURE_VECTORS feature vectors for one PDM frame. Windows
+*    overlap by AUDIO_FEATURE_HISTORY_SIZE samples, including across frame
+*    boundaries, so consecutive frames produce a continuous feature stream.
+*
+* Parameters:
+*   pcm: FRAME_SIZE PCM samples
+*   features: receives AUDIO_FEATURES_SIZE values, one vector after the other
+*
+*******************************************************************************/
+void audio_features_process(const int16_t *pcm, int16_t *features)
+{
+    memcpy(&feature_signal[AUDIO_FEATURE_HISTORY_SIZE], pcm, FRAME_SIZE * sizeof(int16_t));
+
+    for (uint32_t vector = 0; vector < AUDIO_FEATURE_VECTORS; vector++)
+    {
+        feature_vector(&feature_signal[vector * AUDIO_FEATURE_HOP_SIZE],
+                       &features[vector * AUDIO_FEATURE_VECTOR_SIZE]);
+    }
+
+    /* Keep the tail of the frame for the next call */
+    memmove(feature_signal, &feature_signal[FRAME_SIZE], AUDIO_FEATURE_HISTORY_SIZE * sizeof(int16_t));
+}
+
+/*******************************************************************************
+* Function Name: feature_vector
+********************************************************************************
+* Summary:
+*    Window, power spectrum, mel filter bank, log2 and optionally DCT of one
+*    analysis window.
+*
+* Parameters:
+*   samples: AUDIO_FEATURE_WINDOW_SIZE PCM samples
+*   output: receives AUDIO_FEATURE_VECTOR_SIZE values
+*
+*******************************************************************************/
+static void feature_vector(const int16_t *samples, int16_t *output)
+{
+    dsp_mult_q15(samples, feature_window, feature_frame, AUDIO_FEATURE_WINDOW_SIZE);
+    dsp_rfft_q15(&feature_fft, feature_frame, feature_spectrum);
+
+    for (uint32_t bin = 0; bin < AUDIO_FEATURE_FFT_BINS; bin++)
+    {
+        int32_t re = feature_spectrum[2 * bin];
+        int32_t im = feature_spectrum[2 * bin + 1];
+        feature_power[bin] = (uint32_t)(re * re) + (uint32_t)(im * im);
+    }
+
+#if AUDIO_FEATURE_TYPE == AUDIO_FEATURE_MFCC
+    int16_t *mel_output = log_mel;
+#else
+    int16_t *mel_output = output;
+#endif
+
+    for (uint32_t band = 0; band < AUDIO_FEATURE_MEL_BANDS; band++)
+    {
+        const uint32_t *power = &feature_power[mel_start[band]];
+        const int16_t *weight = &mel_weights[mel_offset[band]];
+        uint64_t energy = 1u;
+
+        for (uint32_t i = 0; i < mel_length[band]; i++)
+        {
+            energy += (uint64_t)power[i] * (uint16_t)weight[i];
+        }
+
+        mel_output[band] = (int16_t)(dsp_log2_q16(energy) >> AUDIO_FEATURE_LOG_SHIFT);
+    }
+
+#if AUDIO_FEATURE_TYPE == AUDIO_FEATURE_MFCC
+    for (uint32_t k = 0; k < AUDIO_FEATURE_MFCC_COUNT; k++)
+    {
+        int64_t sum = 0;
+
+        for (uint32_t m = 0; m < AUDIO_FEATURE_MEL_BANDS; m++)
+        {
+            sum += (int32_t)dct_matrix[k][m] * log_mel[m];
+        }
+
+        sum >>= AUDIO_FEATURE_MFCC_SHIFT;
+        if (sum > INT16_MAX)
+        {
+            sum = INT16_MAX;
+        }
+        else if (sum < INT16_MIN)
+        {
+            sum = INT16_MIN;
+        }
+        output[k] = (int16_t)sum;
+    }
+#endif
+}
+
+/*******************************************************************************
+* Function Name: mel_filter_bank_init
+********************************************************************************
+* Summary:
+*    Builds AUDIO_FEATURE_MEL_BANDS triangular filters equally spaced on the
+*    mel scale between AUDIO_FEATURE_MEL_LOW_HZ and the Nyquist frequency.
+*
+* Parameters:
+*   sample_rate: PDM sample rate in Hz
+*
+*******************************************************************************/
+static void mel_filter_bank_init(uint32_t sample_rate)
+{
+    double mel_low = hz_to_mel(AUDIO_FEATURE_MEL_LOW_HZ);
+    double mel_high = hz_to_mel(sample_rate / 2.0);
+    double bin_hz = (double)sample_rate / AUDIO_FEATURE_WINDOW_SIZE;
+    uint32_t offset = 0;
+
+    for (uint32_t band = 0; band < AUDIO_FEATURE_MEL_BANDS; band++)
+    {
+        double step = (mel_high - mel_low) / (AUDIO_FEATURE_MEL_BANDS + 1);
+        double left = mel_to_hz(mel_low + band * step);
+        double center = mel_to_hz(mel_low + (band + 1) * step);
+        double right = mel_to_hz(mel_low + (band + 2) * step);
+
+        mel_start[band] = 0;
+        mel_length[band] = 0;
+        mel_offset[band] = (uint16_t)offset;
+
+        for (uint32_t bin = 0; bin < AUDIO_FEATURE_FFT_BINS; bin++)
+        {
+            double hz = bin * bin_hz;
+            double weight;
+
+            if ((hz <= left) || (hz >= right))
+            {
+                continue;
+            }
+            weight = (hz <= center) ? (hz - left) / (center - left)
+                                    : (right - hz) / (right - center);
+
+            if (offset >= AUDIO_FEATURE_MEL_WEIGHTS)
+            {
+                break;
+            }
+            if (0u == mel_length[band])
+            {
+                mel_start[band] = (uint16_t)bin;
+            }
+            mel_weights[offset++] = (int16_t)lround(weight * 32767.0);
+            mel_length[band]++;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: hz_to_mel
+********************************************************************************
+* Summary:
+*    Converts a frequency to the (HTK) mel scale.
+*
+*******************************************************************************/
+static double hz_to_mel(double hz)
+{
+    return 2595.0 * log10(1.0 + hz / 700.0);
+}
+
+/*******************************************************************************
+* Function Name: mel_to_hz
+********************************************************************************
+* Summary:
+*    Converts a mel value back to a frequency.
+*
+*******************************************************************************/
+static double mel_to_hz(double mel)
+{
+    return 700.0 * (pow(10.0, mel / 2595.0) - 1.0);
+}
+
+/* [] END OF FILE */
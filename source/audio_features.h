@@ -0,0 +1,88 @@
+/******************************************************************************
+* File Name:   audio_features.h
+*
+* Description: This file contains the function prototypes and constants used
+*   in audio_features.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SOURCE_AUDIO_FEATURES_H_
+#define SOURCE_AUDIO_FEATURES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio.h"
+#include "config.h"
+
+/******************************************************************************
+ * Constants
+ *****************************************************************************/
+/* Analysis window (and FFT) length in samples */
+#define AUDIO_FEATURE_WINDOW_SIZE       (512)
+/* Step between two consecutive analysis windows in samples */
+#define AUDIO_FEATURE_HOP_SIZE          (256)
+/* Number of feature vectors computed per PDM frame */
+#define AUDIO_FEATURE_VECTORS           (FRAME_SIZE / AUDIO_FEATURE_HOP_SIZE)
+
+/* Number of values in one feature vector */
+#if AUDIO_FEATURE_TYPE == AUDIO_FEATURE_MFCC
+#define AUDIO_FEATURE_VECTOR_SIZE       (AUDIO_FEATURE_MFCC_COUNT)
+#else
+#define AUDIO_FEATURE_VECTOR_SIZE       (AUDIO_FEATURE_MEL_BANDS)
+#endif
+
+/* Number of int16 feature values produced per PDM frame */
+#define AUDIO_FEATURES_SIZE             (AUDIO_FEATURE_VECTORS * AUDIO_FEATURE_VECTOR_SIZE)
+
+/* Number of int16 values produced per frame by pdm_preprocessing_feed */
+#if AUDIO_OUTPUT_MODE == AUDIO_OUTPUT_FEATURES
+#define AUDIO_DATA_SIZE                 (AUDIO_FEATURES_SIZE)
+#elif AUDIO_OUTPUT_MODE == AUDIO_OUTPUT_RAW_AND_FEATURES
+#define AUDIO_DATA_SIZE                 (FRAME_SIZE + AUDIO_FEATURES_SIZE)
+#else
+#define AUDIO_DATA_SIZE                 (FRAME_SIZE)
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+bool audio_features_init(uint32_t sample_rate);
+void audio_features_process(const int16_t *pcm, int16_t *features);
+
+
+#endif /* SOURCE_AUDIO_FEATURES_H_ */
@@ -40,25 +40,70 @@
 * so agrees to indemnify Cypress against all liability.
 *******************************************************************************/
 
+#include <string.h>
+
 #include "bmm.h"
 
 #include "cyhal.h"
 #include "cybsp.h"
 #include "config.h"
+#include "i2c_bus.h"
+#include "pipeline.h"
+#include "stream_record.h"
+#include "timebase.h"
 #include "mtb_bmm350.h"
 /*******************************************************************************
 * Macros
 *******************************************************************************/
 #define I2C_TIMEOUT_MS (1U)
-#define bmm_SCAN_RATE       50
 #define bmm_TIMER_FREQUENCY 100000
 #define bmm_TIMER_PERIOD (bmm_TIMER_FREQUENCY/bmm_SCAN_RATE)
 #define bmm_TIMER_PRIORITY  3
+
+/* The data registers are read without blocking, and the compensation of the
+ * driver is applied to the bytes received */
+#if (SENSOR_ASYNC_READ_ENABLE == 1) && defined(TARGET_APP_CY8CKIT_062S2_AI)
+#define bmm_ASYNC_READ      1
+#else
+#define bmm_ASYNC_READ      0
+#endif
+
+/* Magnetic field x, y, z and temperature, 24 bits each, after the dummy bytes
+ * of the I2C reads */
+#define bmm_DATA_REGISTER   BMM350_REG_MAG_X_XLSB
+#define bmm_DATA_SIZE       (BMM350_MAG_TEMP_DATA_LEN + BMM350_DUMMY_BYTES)
+
+/* The registers are read before the next period */
+#define bmm_READ_DEADLINE_US    (1000000u / bmm_SCAN_RATE)
+
 #ifdef TARGET_APP_CY8CKIT_062S2_AI
-static cyhal_i2c_t i2c;
 float bmm_data[bmm_AXIS];
 mtb_bmm350_t dev;
 #endif
+
+#if bmm_ASYNC_READ == 1
+/* Register address sent and data registers received by the transaction
+ * queued at each period, due by the next period. The buffer is busy from the
+ * start of the transaction until its data is compensated. The reads of the
+ * BMM350 start with dummy bytes, so they cannot be batched. */
+static const uint8_t bmm_read_register = bmm_DATA_REGISTER;
+static uint8_t bmm_read_buffer[bmm_DATA_SIZE];
+static volatile bool bmm_read_busy;
+static void bmm_read_done(void *arg, bool success);
+static i2c_bus_transaction_t bmm_read_transaction =
+{
+    .address = MTB_BMM350_ADDRESS_SEC,
+    .tx_size = 1,
+    .rx_size = bmm_DATA_SIZE,
+    .tx = &bmm_read_register,
+    .rx = bmm_read_buffer,
+    .batch = false,
+    .done = bmm_read_done,
+};
+
+/* Register read function of the driver, used for any other register */
+static bmm350_read_fptr_t bmm_driver_read;
+#endif
 /* Global timer used for getting data */
 cyhal_timer_t bmm_timer;
 
@@ -67,6 +112,10 @@ cyhal_timer_t bmm_timer;
 *******************************************************************************/
 void bmm_interrupt_handler(void* callback_arg, cyhal_timer_event_t event);
 cy_rslt_t bmm_timer_init(void);
+#if bmm_ASYNC_READ == 1
+static BMM350_INTF_RET_TYPE bmm_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t length,
+                                     void *intf_ptr);
+#endif
 
 /*******************************************************************************
 * Function Name: bmm_init
@@ -88,32 +137,29 @@ cy_rslt_t bmm_init(void)
 #ifdef TARGET_APP_CY8CKIT_062S2_AI
     cy_rslt_t result;
 
-    /* Configure the I2C mode, the address, and the data rate */
-    cyhal_i2c_cfg_t i2c_config =
-    {
-            .is_slave = false,
-            .address = 0,
-            .frequencyhal_hz = 1000000,
-    };
-
-    /* Initialize I2C for BMM communication */
-    result = cyhal_i2c_init(&i2c, (cyhal_gpio_t)CYBSP_I2C_SDA, (cyhal_gpio_t)CYBSP_I2C_SCL, NULL);
+    /* Initialize the I2C bus shared by the sensors */
+    result = i2c_bus_init();
     if(CY_RSLT_SUCCESS != result)
     {
         return result;
     }
 
-    /* Configure the I2C */
-    result = cyhal_i2c_configure(&i2c, &i2c_config);
-    if(CY_RSLT_SUCCESS != result)
-    {
-        return result;
-    }
-    /* Initialize BMM350 */
-    result = mtb_bmm350_init_i2c(&dev, &i2c, MTB_BMM350_ADDRESS_SEC);
+    /* Initialize BMM350, holding the queue of the bus while the driver
+     * uses it */
+    i2c_bus_lock();
+    result = mtb_bmm350_init_i2c(&dev, i2c_bus_get(), MTB_BMM350_ADDRESS_SEC);
+    i2c_bus_unlock();
     cyhal_system_delay_ms(1000);
     bmm_flag = false;
 
+#if bmm_ASYNC_READ == 1
+    /* The driver reads the data registers from the last transaction, and the
+     * transactions are queued from the timer interrupt */
+    bmm_read_busy = false;
+    bmm_driver_read = dev.sensor.read;
+    dev.sensor.read = bmm_read;
+#endif
+
     /* Timer for data collection */
     result = bmm_timer_init();
     if(CY_RSLT_SUCCESS != result)
@@ -193,7 +239,10 @@ cy_rslt_t bmm_timer_init(void)
 ********************************************************************************
 * Summary:
 *   Interrupt handler for timer. Interrupt handler will get called at 50Hz and
-*   sets a flag that can be checked in main.
+*   sets a flag that can be checked in main. With bmm_ASYNC_READ, it queues
+*   the read of the data registers on the I2C bus instead, and the flag is set
+*   once they are read. A period is skipped while the previous data has not been
+*   compensated.
 *
 * Parameters:
 *     callback_arg: not used
@@ -206,14 +255,96 @@ void bmm_interrupt_handler(void *callback_arg, cyhal_timer_event_t event)
     (void) callback_arg;
     (void) event;
 
+#if bmm_ASYNC_READ == 1
+    if(false == bmm_read_busy)
+    {
+        bmm_read_busy = true;
+        bmm_read_transaction.deadline = timebase_now_us() + bmm_READ_DEADLINE_US;
+        if(false == i2c_bus_submit(&bmm_read_transaction))
+        {
+            bmm_read_busy = false;
+        }
+    }
+#else
     bmm_flag = true;
+    pipeline_notify_from_isr(STREAM_CHANNEL_BMM);
+#endif
+}
+
+#if bmm_ASYNC_READ == 1
+/*******************************************************************************
+* Function Name: bmm_read_done
+********************************************************************************
+* Summary:
+*   Completion handler of the read of the data registers. Sets the flag
+*   checked in main, or releases the buffer if the read failed.
+*
+* Parameters:
+*     arg: not used
+*     success: false if the read failed
+*
+*
+*******************************************************************************/
+static void bmm_read_done(void *arg, bool success)
+{
+    (void) arg;
+
+    if(true == success)
+    {
+        bmm_flag = true;
+        pipeline_notify_from_isr(STREAM_CHANNEL_BMM);
+    }
+    else
+    {
+        bmm_read_busy = false;
+    }
+}
+
+/*******************************************************************************
+* Function Name: bmm_read
+********************************************************************************
+* Summary:
+*   Register read function given to the driver. The data registers are copied
+*   from the last transaction, so the driver compensates them without
+*   accessing the bus; the other registers are read by the driver function,
+*   with the queue of the bus held.
+*
+* Parameters:
+*     reg_addr: first register
+*     reg_data: receives the registers, dummy bytes included
+*     length: number of bytes read, dummy bytes included
+*     intf_ptr: interface of the driver
+*
+* Return:
+*     The status of the read.
+*
+*******************************************************************************/
+static BMM350_INTF_RET_TYPE bmm_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t length,
+                                     void *intf_ptr)
+{
+    BMM350_INTF_RET_TYPE result;
+
+    if((true == bmm_read_busy) && (bmm_DATA_REGISTER == reg_addr) && (length <= bmm_DATA_SIZE))
+    {
+        memcpy(reg_data, bmm_read_buffer, length);
+        return BMM350_INTF_RET_SUCCESS;
+    }
+
+    i2c_bus_lock();
+    result = bmm_driver_read(reg_addr, reg_data, length, intf_ptr);
+    i2c_bus_unlock();
+
+    return result;
 }
+#endif
 
 /*******************************************************************************
 * Function Name: bmm_get_data
 ********************************************************************************
 * Summary:
-*   Reads Magnetometer data from the BMM and stores it in a buffer.
+*   Reads Magnetometer data from the BMM and stores it in a buffer. With
+*   bmm_ASYNC_READ, the data registers have already been read and are only
+*   compensated by the driver.
 *
 * Parameters:
 *     bmm_data: Stores BMM Magnetometer data
@@ -234,6 +365,9 @@ void bmm_get_data(float *bmm_data)
     bmm_data[0] = data1.sensor_data.y;
     bmm_data[1] = data1.sensor_data.x;
     bmm_data[2] = data1.sensor_data.z;
+#if bmm_ASYNC_READ == 1
+    bmm_read_busy = false;
+#endif
 
 #endif
 }
@@ -54,6 +54,8 @@ extern volatile bool bmm_flag;
  * Macros
  *****************************************************************************/
 #define bmm_AXIS 3
+/* Rate at which the magnetometer is sampled, in Hz */
+#define bmm_SCAN_RATE       50
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
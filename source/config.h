@@ -61,6 +61,146 @@
 /* Change below define to IMU_COLLECTION or PDM_COLLECTION */
 #define COLLECTION_MODE_SELECT IMU_COLLECTION
 
+/* Seconds of data kept while waiting for the kit button. When the button is
+ * pressed, this history is transmitted first, followed by the live data, so
+ * the beginning of the event is captured. 0 discards all data collected
+ * before the button is pressed. */
+#define HISTORY_SECONDS 0
+
+/* Memory shared by the history buffers of all channels, in bytes */
+#define HISTORY_POOL_SIZE (96 * 1024)
+
+/* Memory queuing the data produced while the transport is busy, in bytes.
+ * The queued blocks are transmitted in order once the transport is ready
+ * again, so a momentary stall of the link adds latency instead of losing
+ * data. Blocks that do not fit are dropped. 0 drops all the data produced
+ * while the transport is busy. */
+#define SPILL_BUFFER_SIZE (32 * 1024)
+
+/* Optional second spill tier in external RAM mapped in the address space,
+ * such as a QSPI PSRAM in XIP mode, used once the internal buffer is full.
+ * The application must map the memory before the collection starts.
+ * SPILL_EXTERNAL_SIZE 0 disables it. */
+#define SPILL_EXTERNAL_ADDRESS  0x18000000u
+#define SPILL_EXTERNAL_SIZE     0
+
+/* Set to 1 to send the data of all the channels as records (see
+ * stream_record.h), each with the time the data was collected, instead of
+ * the raw values. The PDM data is always sent as records when
+ * AUDIO_VAD_ENABLE is set. */
+#define STREAM_RECORDS_ENABLE 0
+
+/* Set to 1 to start the collection on a rising edge of a sync line shared by
+ * several boards, instead of the kit button. Every edge of the line is
+ * latched in microseconds and reported by a trigger record (see
+ * sync_trigger.h) when the stream is made of records, so the host can place
+ * the data of all the boards on a common timebase. */
+#define SYNC_TRIGGER_ENABLE         0
+
+/* Set to 1 on the board that drives the sync line. Its kit button starts a
+ * pulse train of SYNC_TRIGGER_PERIOD_MS on SYNC_TRIGGER_OUTPUT_PIN, which must
+ * also be wired to its own SYNC_TRIGGER_INPUT_PIN so that it latches the
+ * edges like the other boards. */
+#define SYNC_TRIGGER_MASTER         0
+
+/* Pins of the sync line */
+#define SYNC_TRIGGER_INPUT_PIN      CYBSP_D2
+#define SYNC_TRIGGER_OUTPUT_PIN     CYBSP_D3
+
+/* Interval between the edges driven by the master, and width of its pulses.
+ * All the boards must be built with the same interval. */
+#define SYNC_TRIGGER_PERIOD_MS      1000
+#define SYNC_TRIGGER_PULSE_US       100
+
+/* Set to 1 to only transmit the data the host has room for. The host grants
+ * credits with commands (see host_command.h) holding the total number of
+ * bytes it can receive since the start of the stream. The data is held in
+ * the spill buffer while the credits are used up. */
+#define STREAM_FLOW_CONTROL_ENABLE  0
+
+/* Number of bytes sent before the first credit is received. The host must
+ * keep at least the largest block of data (plus a record header) granted
+ * ahead of what it has received. */
+#define STREAM_FLOW_INITIAL_CREDIT  (4 * 1024)
+
+/* Set to 1 to send the data in numbered frames with a CRC (see reliable.h).
+ * The host asks for the frames it missed or received corrupted (NACK
+ * commands), and they are sent again while they are still held in a pool of
+ * STREAM_RELIABLE_POOL_SIZE bytes (up to the last 64 frames). */
+#define STREAM_RELIABLE_ENABLE      0
+
+/* Memory holding the frames sent, larger than the largest block of data */
+#define STREAM_RELIABLE_POOL_SIZE   (16 * 1024)
+
+/* Load shedding. When the transport cannot keep up, the spill buffer fills
+ * up and each channel degrades once the fill level reaches the threshold of
+ * its priority, according to its policy. It recovers once the fill level is
+ * below half the threshold. */
+#define SHED_PRIORITY_HIGH          0
+#define SHED_PRIORITY_NORMAL        1
+#define SHED_PRIORITY_LOW           2
+
+/* Spill buffer fill level, in percent, at which each priority degrades */
+#define SHED_THRESHOLD_HIGH         100
+#define SHED_THRESHOLD_NORMAL       50
+#define SHED_THRESHOLD_LOW          25
+
+#define SHED_POLICY_NONE            0   /* Keep all the blocks while they fit */
+#define SHED_POLICY_DECIMATE        1   /* Keep one block out of SHED_DECIMATION */
+#define SHED_POLICY_DROP_OLDEST     2   /* Drop the oldest block queued for each new one */
+#define SHED_POLICY_COMPRESS        3   /* Send the blocks at half precision, needs
+                                         * STREAM_RECORDS_ENABLE (decimates otherwise) */
+
+#define SHED_DECIMATION             4
+
+/* Priority and policy of each channel */
+#define IMU_PRIORITY                SHED_PRIORITY_NORMAL
+#define IMU_SHED_POLICY             SHED_POLICY_DECIMATE
+#define PDM_PRIORITY                SHED_PRIORITY_HIGH
+#define PDM_SHED_POLICY             SHED_POLICY_NONE
+#define BMM_PRIORITY                SHED_PRIORITY_LOW
+#define BMM_SHED_POLICY             SHED_POLICY_DECIMATE
+#define DPS_PRIORITY                SHED_PRIORITY_LOW
+#define DPS_SHED_POLICY             SHED_POLICY_DROP_OLDEST
+#define RADAR_PRIORITY              SHED_PRIORITY_NORMAL
+#define RADAR_SHED_POLICY           SHED_POLICY_COMPRESS
+
+/* Set to 1 to read the I2C sensors (BMI160/BMI270, BMM350, DPS368) without
+ * blocking: the sampling timer starts an interrupt driven transfer of their
+ * data registers, and the sensor flag is set once it completes, so the main
+ * loop never waits on the bus. 0 reads them through their drivers from the
+ * main loop. */
+#define SENSOR_ASYNC_READ_ENABLE    1
+
+/* Set by USE_FREERTOS=1 in the Makefile to read each sensor from its own
+ * FreeRTOS task instead of the main loop (see pipeline.h). The sensor tasks
+ * pass their blocks by pointer to the transmit task, which runs the rest of
+ * the main loop below the priority of all of them. */
+#ifndef RTOS_PIPELINE_ENABLE
+#define RTOS_PIPELINE_ENABLE        0
+#endif
+
+/* FreeRTOS priority of the task of each sensor, and of the transmit task.
+ * A sensor task preempts the tasks of lower priority while they read their
+ * sensor, so a long read of a slow sensor does not delay a faster one. */
+#define PDM_TASK_PRIORITY           5
+#define IMU_TASK_PRIORITY           4
+#define BMM_TASK_PRIORITY           4
+#define DPS_TASK_PRIORITY           3
+#define RADAR_TASK_PRIORITY         2
+#define PIPELINE_TRANSMIT_PRIORITY  1
+
+/* Buffers of each sensor task, at least 2. The task reads into one while the
+ * others wait for the transmit task; a block is dropped when none is free. */
+#define PIPELINE_BUFFER_COUNT       4
+
+/* Stack of each task, in words */
+#define PIPELINE_TASK_STACK_SIZE    1024
+
+/* Longest wait of the transmit task for a block, before it polls the
+ * transport and the host commands again, in milliseconds */
+#define PIPELINE_POLL_MS            1
+
 /* Set IMU_SAMPLE_RATE to one of the following
  * BMI160_ACCEL_ODR_400HZ / BMI2_ACC_ODR_400HZ
  * BMI160_ACCEL_ODR_200HZ / BMI2_ACC_ODR_200HZ
@@ -91,4 +231,85 @@
 /* Change below to SAMPLE_RATE_8_KHZ or SAMPLE_RATE_16_KHZ */
 #define PDM_SAMPLE_RATE SAMPLE_RATE_16_KHZ
 
+/* Audio output formats */
+#define AUDIO_OUTPUT_RAW                1
+#define AUDIO_OUTPUT_FEATURES           2
+#define AUDIO_OUTPUT_RAW_AND_FEATURES   3
+
+/* Change below to AUDIO_OUTPUT_RAW, AUDIO_OUTPUT_FEATURES or
+ * AUDIO_OUTPUT_RAW_AND_FEATURES.
+ * AUDIO_OUTPUT_FEATURES streams the spectral features of each PDM frame
+ * instead of the PCM samples. AUDIO_OUTPUT_RAW_AND_FEATURES streams the PCM
+ * samples followed by the features. */
+#define AUDIO_OUTPUT_MODE AUDIO_OUTPUT_RAW
+
+/* Audio feature types */
+#define AUDIO_FEATURE_LOG_MEL           1
+#define AUDIO_FEATURE_MFCC              2
+
+/* Change below to AUDIO_FEATURE_LOG_MEL or AUDIO_FEATURE_MFCC.
+ * AUDIO_FEATURE_LOG_MEL produces AUDIO_FEATURE_MEL_BANDS log2 mel energies in
+ * Q8 format per feature vector. AUDIO_FEATURE_MFCC produces
+ * AUDIO_FEATURE_MFCC_COUNT cepstral coefficients in Q6 format. */
+#define AUDIO_FEATURE_TYPE AUDIO_FEATURE_LOG_MEL
+
+/* Number of mel bands and of cepstral coefficients */
+#define AUDIO_FEATURE_MEL_BANDS         40
+#define AUDIO_FEATURE_MFCC_COUNT        13
+
+/* Set to 1 to only transmit the PDM frames with sound activity. The frames are
+ * then sent as records (see stream_record.h) and a gap record replaces each
+ * run of silent frames. */
+#define AUDIO_VAD_ENABLE                0
+
+/* Activity thresholds above the tracked noise floor, in log2 of the frame
+ * energy in Q8 format (256 = 3 dB). Activity starts above the on threshold,
+ * or above the off threshold when the frame has at least
+ * AUDIO_VAD_ZCR_THRESHOLD zero crossings (unvoiced sounds), and stops below
+ * the off threshold. */
+#define AUDIO_VAD_ON_THRESHOLD          (4 * 256)
+#define AUDIO_VAD_OFF_THRESHOLD         (2 * 256)
+#define AUDIO_VAD_ZCR_THRESHOLD         256
+
+/* Number of silent frames transmitted before the activity starts and after
+ * it stops */
+#define AUDIO_VAD_PREROLL_FRAMES        2
+#define AUDIO_VAD_POSTROLL_FRAMES       4
+
+/* Radar output formats */
+#define RADAR_OUTPUT_RAW            1
+#define RADAR_OUTPUT_RANGE_FFT      2
+#define RADAR_OUTPUT_RANGE_DOPPLER  3
+
+/* Change below to RADAR_OUTPUT_RAW, RADAR_OUTPUT_RANGE_FFT or
+ * RADAR_OUTPUT_RANGE_DOPPLER.
+ * RADAR_OUTPUT_RAW streams the ADC samples of the first chirp.
+ * RADAR_OUTPUT_RANGE_FFT streams the range profile (magnitude of the windowed
+ * FFT of each chirp) as int16 values in Q2.14 format.
+ * RADAR_OUTPUT_RANGE_DOPPLER streams a cropped range-Doppler map of the full
+ * frame as int16 values in Q2.14 format, one row of Doppler bins per range
+ * bin. */
+#define RADAR_OUTPUT_MODE RADAR_OUTPUT_RAW
+
+/* Set to 1 to average the range profiles of all chirps in a frame into a
+ * single profile, or 0 to stream one profile per chirp */
+#define RADAR_RANGE_AVERAGE_CHIRPS  1
+
+/* Moving target indication (clutter removal) for the range-Doppler map */
+#define RADAR_MTI_NONE              0   /* Keep static targets */
+#define RADAR_MTI_MEAN              1   /* Remove the mean over the chirps of a frame */
+#define RADAR_MTI_CLUTTER_MAP       2   /* Remove a clutter map averaged over frames */
+
+/* Change below to RADAR_MTI_NONE, RADAR_MTI_MEAN or RADAR_MTI_CLUTTER_MAP */
+#define RADAR_MTI_MODE RADAR_MTI_MEAN
+
+/* Clutter map update weight is 1 / 2^RADAR_MTI_CLUTTER_ALPHA_SHIFT per frame */
+#define RADAR_MTI_CLUTTER_ALPHA_SHIFT   4
+
+/* Range-Doppler map crop. Range bins start at RADAR_RD_RANGE_BIN_START (out of
+ * 64), Doppler bins are centered around zero velocity (out of 16). */
+#define RADAR_RD_RANGE_BIN_START    0
+#define RADAR_RD_RANGE_BIN_COUNT    32
+#define RADAR_RD_DOPPLER_BIN_COUNT  16
+
 #endif /* CONFIG_H */
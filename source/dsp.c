@@ -0,0 +1,497 @@
+/******************************************************************************
+* File Name:   dsp.c
+*
+* Description: This file implements the fixed-point signal processing helpers
+*              (FFT, magnitude, windowing) shared by the on-device feature
+*              stages. CMSIS-DSP is used when USE_CMSIS_DSP is defined in the
+*              Makefile, otherwise a portable implementation producing the
+*              same output format is used, which also builds on a host.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <math.h>
+#include "dsp.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define DSP_PI                      (3.14159265358979323846)
+#define DSP_Q15_ONE                 (32767.0)
+/* Resolution of the log2 lookup table */
+#define DSP_LOG2_TABLE_BITS         (5u)
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+/* log2(1 + i/32) in Q16, i = 0..32 */
+static const uint32_t log2_table[(1u << DSP_LOG2_TABLE_BITS) + 1u] =
+{
+         0u,   2909u,   5732u,   8473u,  11136u,  13727u,  16248u,  18704u,
+     21098u,  23433u,  25711u,  27936u,  30109u,  32234u,  34312u,  36346u,
+     38336u,  40286u,  42196u,  44068u,  45904u,  47705u,  49472u,  51207u,
+     52911u,  54584u,  56229u,  57845u,  59434u,  60997u,  62534u,  64047u,
+     65536u,
+};
+
+#if !defined(USE_CMSIS_DSP)
+/* Twiddle factors W(k) = cos(2*pi*k/N) - j*sin(2*pi*k/N) for the largest
+ * supported size. Smaller transforms index this table with a stride. */
+static int16_t twiddle_cos[DSP_FFT_MAX_SIZE / 2];
+static int16_t twiddle_sin[DSP_FFT_MAX_SIZE / 2];
+static bool    twiddle_ready = false;
+#endif
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static bool dsp_is_power_of_two(uint16_t size);
+#if !defined(USE_CMSIS_DSP)
+static void dsp_twiddle_init(void);
+static int16_t dsp_sat_q15(int32_t value);
+static uint32_t dsp_sqrt_u32(uint32_t value);
+static void dsp_cfft_radix2_q15(int16_t *data, uint16_t size);
+#endif
+
+/*******************************************************************************
+* Function Name: dsp_rfft_init
+********************************************************************************
+* Summary:
+*    Initializes a real FFT instance for the given size.
+*
+* Parameters:
+*   fft: instance to initialize
+*   size: number of real input samples, a power of two up to DSP_FFT_MAX_SIZE
+*
+* Return:
+*     True if the size is supported.
+*
+*******************************************************************************/
+bool dsp_rfft_init(dsp_rfft_t *fft, uint16_t size)
+{
+    if ((size < 4u) || (size > DSP_FFT_MAX_SIZE) || !dsp_is_power_of_two(size))
+    {
+        return false;
+    }
+
+    fft->size = size;
+#if defined(USE_CMSIS_DSP)
+    return (ARM_MATH_SUCCESS == arm_rfft_init_q15(&fft->instance, size, 0, 1));
+#else
+    dsp_twiddle_init();
+    return true;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: dsp_rfft_q15
+********************************************************************************
+* Summary:
+*    Computes the forward FFT of size real samples. Like arm_rfft_q15, the input
+*    buffer is used as scratch and is modified. The output holds size complex
+*    values (2 * size int16_t); bins above size/2 are the conjugate mirror.
+*
+* Parameters:
+*   fft: initialized instance
+*   input: size real Q15 samples, modified
+*   output: 2 * size int16_t, interleaved real and imaginary parts
+*
+*******************************************************************************/
+void dsp_rfft_q15(dsp_rfft_t *fft, int16_t *input, int16_t *output)
+{
+#if defined(USE_CMSIS_DSP)
+    arm_rfft_q15(&fft->instance, input, output);
+#else
+    uint16_t size = fft->size;
+    uint16_t half = size >> 1;
+    uint16_t stride = DSP_FFT_MAX_SIZE / size;
+
+    /* Even and odd samples form the real and imaginary parts of a half size
+     * complex sequence, so a size/2 complex FFT does most of the work. */
+    dsp_cfft_radix2_q15(input, half);
+
+    /* DC and Nyquist bins are purely real */
+    output[0] = dsp_sat_q15((int32_t)input[0] + input[1]);
+    output[1] = 0;
+    output[size] = dsp_sat_q15((int32_t)input[0] - input[1]);
+    output[size + 1] = 0;
+
+    for (uint16_t k = 1; k < half; k++)
+    {
+        int32_t a_re = input[2 * k];
+        int32_t a_im = input[2 * k + 1];
+        int32_t b_re = input[2 * (half - k)];
+        int32_t b_im = input[2 * (half - k) + 1];
+
+        /* Split into the spectra of the even and odd samples */
+        int32_t even_re = (a_re + b_re) >> 1;
+        int32_t even_im = (a_im - b_im) >> 1;
+        int32_t odd_re  = (a_im + b_im) >> 1;
+        int32_t odd_im  = (b_re - a_re) >> 1;
+
+        int32_t w_re = twiddle_cos[k * stride];
+        int32_t w_im = twiddle_sin[k * stride];
+
+        int32_t re = even_re + ((w_re * odd_re + w_im * odd_im) >> 15);
+        int32_t im = even_im + ((w_re * odd_im - w_im * odd_re) >> 15);
+
+        output[2 * k]     = dsp_sat_q15(re);
+        output[2 * k + 1] = dsp_sat_q15(im);
+
+        /* Conjugate mirror for the upper half of the spectrum */
+        output[2 * (size - k)]     = output[2 * k];
+        output[2 * (size - k) + 1] = dsp_sat_q15(-im);
+    }
+#endif
+}
+
+/*******************************************************************************
+* Function Name: dsp_cfft_init
+********************************************************************************
+* Summary:
+*    Initializes a complex FFT instance for the given size.
+*
+* Parameters:
+*   fft: instance to initialize
+*   size: number of complex samples, a power of two up to DSP_FFT_MAX_SIZE
+*
+* Return:
+*     True if the size is supported.
+*
+*******************************************************************************/
+bool dsp_cfft_init(dsp_cfft_t *fft, uint16_t size)
+{
+    if ((size < 2u) || (size > DSP_FFT_MAX_SIZE) || !dsp_is_power_of_two(size))
+    {
+        return false;
+    }
+
+    fft->size = size;
+#if defined(USE_CMSIS_DSP)
+    return (ARM_MATH_SUCCESS == arm_cfft_init_q15(&fft->instance, size));
+#else
+    dsp_twiddle_init();
+    return true;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: dsp_cfft_q15
+********************************************************************************
+* Summary:
+*    Computes the forward FFT of size complex samples in place.
+*
+* Parameters:
+*   fft: initialized instance
+*   data: 2 * size int16_t, interleaved real and imaginary parts
+*
+*******************************************************************************/
+void dsp_cfft_q15(dsp_cfft_t *fft, int16_t *data)
+{
+#if defined(USE_CMSIS_DSP)
+    arm_cfft_q15(&fft->instance, data, 0, 1);
+#else
+    dsp_cfft_radix2_q15(data, fft->size);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: dsp_cmplx_mag_q15
+********************************************************************************
+* Summary:
+*    Computes the magnitude of interleaved complex Q15 values. The result is in
+*    Q2.14 format, as produced by arm_cmplx_mag_q15.
+*
+* Parameters:
+*   input: 2 * count int16_t, interleaved real and imaginary parts
+*   output: count magnitudes
+*   count: number of complex values
+*
+*******************************************************************************/
+void dsp_cmplx_mag_q15(const int16_t *input, int16_t *output, uint32_t count)
+{
+#if defined(USE_CMSIS_DSP)
+    arm_cmplx_mag_q15(input, output, count);
+#else
+    for (uint32_t index = 0; index < count; index++)
+    {
+        int32_t re = input[2 * index];
+        int32_t im = input[2 * index + 1];
+        uint32_t power = (uint32_t)(re * re) + (uint32_t)(im * im);
+
+        output[index] = (int16_t)(dsp_sqrt_u32(power) >> 1);
+    }
+#endif
+}
+
+/*******************************************************************************
+* Function Name: dsp_hann_window_q15
+********************************************************************************
+* Summary:
+*    Fills a periodic Hann window in Q15 format.
+*
+* Parameters:
+*   window: size coefficients
+*   size: window length
+*
+*******************************************************************************/
+void dsp_hann_window_q15(int16_t *window, uint16_t size)
+{
+    for (uint16_t index = 0; index < size; index++)
+    {
+        double value = 0.5 - 0.5 * cos((2.0 * DSP_PI * index) / size);
+        window[index] = (int16_t)(value * DSP_Q15_ONE + 0.5);
+    }
+}
+
+/*******************************************************************************
+* Function Name: dsp_mult_q15
+********************************************************************************
+* Summary:
+*    Element-wise Q15 multiplication, used to apply a window.
+*
+* Parameters:
+*   input: count Q15 samples
+*   window: count Q15 coefficients
+*   output: count Q15 results, may alias input
+*   count: number of samples
+*
+*******************************************************************************/
+void dsp_mult_q15(const int16_t *input, const int16_t *window, int16_t *output,
+                  uint32_t count)
+{
+#if defined(USE_CMSIS_DSP)
+    arm_mult_q15(input, window, output, count);
+#else
+    for (uint32_t index = 0; index < count; index++)
+    {
+        output[index] = (int16_t)(((int32_t)input[index] * window[index]) >> 15);
+    }
+#endif
+}
+
+/*******************************************************************************
+* Function Name: dsp_log2_q16
+********************************************************************************
+* Summary:
+*    Base 2 logarithm in Q16 format using only integer arithmetic, so the result
+*    is identical on every platform. The mantissa is looked up in a table and
+*    linearly interpolated (maximum error below 0.0002).
+*
+* Parameters:
+*   value: input value, 0 returns 0
+*
+* Return:
+*     log2(value) in Q16 format.
+*
+*******************************************************************************/
+int32_t dsp_log2_q16(uint64_t value)
+{
+    int32_t exponent = 63;
+
+    if (0u == value)
+    {
+        return 0;
+    }
+
+    /* Normalize so that bit 63 is set */
+    for (uint32_t shift = 32; shift > 0u; shift >>= 1)
+    {
+        if (0u == (value >> (64u - shift)))
+        {
+            value <<= shift;
+            exponent -= (int32_t)shift;
+        }
+    }
+
+    uint32_t index = (uint32_t)(value >> (63u - DSP_LOG2_TABLE_BITS)) & ((1u << DSP_LOG2_TABLE_BITS) - 1u);
+    uint32_t fraction = (uint32_t)(value >> (63u - DSP_LOG2_TABLE_BITS - 16u)) & 0xFFFFu;
+    uint32_t low = log2_table[index];
+    uint32_t high = log2_table[index + 1u];
+
+    return (exponent * 65536) + (int32_t)(low + (((high - low) * fraction) >> 16));
+}
+
+/*******************************************************************************
+* Function Name: dsp_is_power_of_two
+*******************************************************************************/
+static bool dsp_is_power_of_two(uint16_t size)
+{
+    return (0u != size) && (0u == (size & (size - 1u)));
+}
+
+#if !defined(USE_CMSIS_DSP)
+/*******************************************************************************
+* Function Name: dsp_twiddle_init
+********************************************************************************
+* Summary:
+*    Fills the shared twiddle table on first use.
+*
+*******************************************************************************/
+static void dsp_twiddle_init(void)
+{
+    if (twiddle_ready)
+    {
+        return;
+    }
+
+    for (uint32_t k = 0; k < (DSP_FFT_MAX_SIZE / 2); k++)
+    {
+        double angle = (2.0 * DSP_PI * k) / DSP_FFT_MAX_SIZE;
+        twiddle_cos[k] = (int16_t)lround(cos(angle) * DSP_Q15_ONE);
+        twiddle_sin[k] = (int16_t)lround(sin(angle) * DSP_Q15_ONE);
+    }
+    twiddle_ready = true;
+}
+
+/*******************************************************************************
+* Function Name: dsp_sat_q15
+*******************************************************************************/
+static int16_t dsp_sat_q15(int32_t value)
+{
+    if (value > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+    if (value < INT16_MIN)
+    {
+        return INT16_MIN;
+    }
+    return (int16_t)value;
+}
+
+/*******************************************************************************
+* Function Name: dsp_sqrt_u32
+********************************************************************************
+* Summary:
+*    Integer square root, rounded down.
+*
+*******************************************************************************/
+static uint32_t dsp_sqrt_u32(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1uL << 30;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (0u != bit)
+    {
+        if (value >= (root + bit))
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return root;
+}
+
+/*******************************************************************************
+* Function Name: dsp_cfft_radix2_q15
+********************************************************************************
+* Summary:
+*    In-place radix-2 decimation in time FFT. Every stage scales by 1/2 so the
+*    result is scaled down by size, matching arm_cfft_q15.
+*
+* Parameters:
+*   data: 2 * size int16_t, interleaved real and imaginary parts
+*   size: number of complex samples, a power of two
+*
+*******************************************************************************/
+static void dsp_cfft_radix2_q15(int16_t *data, uint16_t size)
+{
+    /* Bit reversal permutation */
+    for (uint16_t i = 1, j = 0; i < size; i++)
+    {
+        uint16_t bit = size >> 1;
+        for (; 0u != (j & bit); bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+
+        if (i < j)
+        {
+            int16_t temp_re = data[2 * i];
+            int16_t temp_im = data[2 * i + 1];
+            data[2 * i]     = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j]     = temp_re;
+            data[2 * j + 1] = temp_im;
+        }
+    }
+
+    for (uint16_t length = 2; length <= size; length <<= 1)
+    {
+        uint16_t half = length >> 1;
+        uint16_t stride = DSP_FFT_MAX_SIZE / length;
+
+        for (uint16_t start = 0; start < size; start += length)
+        {
+            for (uint16_t k = 0; k < half; k++)
+            {
+                uint16_t top = start + k;
+                uint16_t bottom = top + half;
+                int32_t w_re = twiddle_cos[k * stride];
+                int32_t w_im = twiddle_sin[k * stride];
+                int32_t x_re = data[2 * bottom];
+                int32_t x_im = data[2 * bottom + 1];
+
+                /* t = x * conj(w), the table holds +sin */
+                int32_t t_re = (w_re * x_re + w_im * x_im) >> 15;
+                int32_t t_im = (w_re * x_im - w_im * x_re) >> 15;
+                int32_t a_re = data[2 * top];
+                int32_t a_im = data[2 * top + 1];
+
+                data[2 * top]        = dsp_sat_q15((a_re + t_re) >> 1);
+                data[2 * top + 1]    = dsp_sat_q15((a_im + t_im) >> 1);
+                data[2 * bottom]     = dsp_sat_q15((a_re - t_re) >> 1);
+                data[2 * bottom + 1] = dsp_sat_q15((a_im - t_im) >> 1);
+            }
+        }
+    }
+}
+#endif /* !defined(USE_CMSIS_DSP) */
+
+/* [] END OF FILE */
@@ -0,0 +1,95 @@
+/******************************************************************************
+* File Name:   dsp.h
+*
+* Description: This file contains the function prototypes and constants used
+*   in dsp.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SOURCE_DSP_H_
+#define SOURCE_DSP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(USE_CMSIS_DSP)
+#include "arm_math.h"
+#endif
+
+/******************************************************************************
+ * Constants
+ *****************************************************************************/
+/* Largest real FFT supported by the portable implementation */
+#define DSP_FFT_MAX_SIZE            (512u)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Real FFT instance. Transforms size real Q15 samples into size/2 + 1 complex
+ * bins, scaled down by size/2 (same output format as arm_rfft_q15). */
+typedef struct
+{
+    uint16_t size;
+#if defined(USE_CMSIS_DSP)
+    arm_rfft_instance_q15 instance;
+#endif
+} dsp_rfft_t;
+
+/* Complex FFT instance. Transforms size interleaved complex Q15 samples in
+ * place, scaled down by size (same output format as arm_cfft_q15). */
+typedef struct
+{
+    uint16_t size;
+#if defined(USE_CMSIS_DSP)
+    arm_cfft_instance_q15 instance;
+#endif
+} dsp_cfft_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+bool dsp_rfft_init(dsp_rfft_t *fft, uint16_t size);
+void dsp_rfft_q15(dsp_rfft_t *fft, int16_t *input, int16_t *output);
+bool dsp_cfft_init(dsp_cfft_t *fft, uint16_t size);
+void dsp_cfft_q15(dsp_cfft_t *fft, int16_t *data);
+void dsp_cmplx_mag_q15(const int16_t *input, int16_t *output, uint32_t count);
+void dsp_hann_window_q15(int16_t *window, uint16_t size);
+void dsp_mult_q15(const int16_t *input, const int16_t *window, int16_t *output,
+                  uint32_t count);
+int32_t dsp_log2_q16(uint64_t value);
+
+#endif /* SOURCE_DSP_H_ */
@@ -0,0 +1,183 @@
+/******************************************************************************
+* File Name:   history.c
+*
+* Description: This file implements the per channel history buffers. Blocks
+*              of data are kept from before the capture is triggered so that
+*              the beginning of the events is not lost, and are then sent
+*              ahead of the live data.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "history.h"
+#include "ring_buffer.h"
+#include "stream_record.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Each block is stored after its size (uint16) */
+#define HISTORY_BLOCK_OVERHEAD      (sizeof(uint16_t))
+
+/* Memory shared by the history buffers of all channels */
+#if HISTORY_SECONDS > 0
+#define HISTORY_POOL_BYTES          (HISTORY_POOL_SIZE)
+#else
+#define HISTORY_POOL_BYTES          (1u)
+#endif
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+static uint8_t history_pool[HISTORY_POOL_BYTES];
+static uint32_t history_pool_used;
+
+static ring_buffer_t history_ring[STREAM_CHANNEL_COUNT];
+
+/*******************************************************************************
+* Function Name: history_init
+********************************************************************************
+* Summary:
+*    Allocates the history buffer of a channel from the static pool, large
+*    enough to hold HISTORY_SECONDS of data. The buffer is reduced to what is
+*    left in the pool if needed.
+*
+* Parameters:
+*   channel: STREAM_CHANNEL_x
+*   block_size: largest block of data pushed at once, in bytes
+*   blocks_per_second: number of blocks produced per second
+*
+* Return:
+*     The size of the buffer allocated, in bytes.
+*
+*******************************************************************************/
+uint32_t history_init(uint8_t channel, uint32_t block_size, uint32_t blocks_per_second)
+{
+    uint32_t size = HISTORY_SECONDS * blocks_per_second * (block_size + HISTORY_BLOCK_OVERHEAD) + 1u;
+
+    if (size > (HISTORY_POOL_BYTES - history_pool_used))
+    {
+        size = HISTORY_POOL_BYTES - history_pool_used;
+    }
+
+    ring_buffer_init(&history_ring[channel % STREAM_CHANNEL_COUNT],
+                     &history_pool[history_pool_used], size);
+    history_pool_used += size;
+
+    return size;
+}
+
+/*******************************************************************************
+* Function Name: history_push
+********************************************************************************
+* Summary:
+*    Appends a block of data to the history of a channel. The oldest blocks
+*    are dropped to make room when the buffer is full.
+*
+* Parameters:
+*   channel: STREAM_CHANNEL_x
+*   data: block of data
+*   size: size of the block in bytes
+*
+*******************************************************************************/
+void history_push(uint8_t channel, const uint8_t *data, uint16_t size)
+{
+    ring_buffer_t *ring = &history_ring[channel % STREAM_CHANNEL_COUNT];
+    uint16_t oldest;
+
+    if ((size + HISTORY_BLOCK_OVERHEAD) >= ring->size)
+    {
+        return;
+    }
+
+    while (ring_buffer_free(ring) < (size + HISTORY_BLOCK_OVERHEAD))
+    {
+        ring_buffer_peek(ring, &oldest, sizeof(oldest));
+        ring_buffer_consume(ring, HISTORY_BLOCK_OVERHEAD + oldest);
+    }
+
+    ring_buffer_write(ring, &size, sizeof(size));
+    ring_buffer_write(ring, data, size);
+}
+
+/*******************************************************************************
+* Function Name: history_pop
+********************************************************************************
+* Summary:
+*    Removes the oldest block of data from the history of a channel.
+*
+* Parameters:
+*   channel: STREAM_CHANNEL_x
+*   data: receives the block
+*   size: size of data in bytes, must fit the largest block pushed
+*
+* Return:
+*     The size of the block, 0 if the history is empty.
+*
+*******************************************************************************/
+uint32_t history_pop(uint8_t channel, uint8_t *data, uint32_t size)
+{
+    ring_buffer_t *ring = &history_ring[channel % STREAM_CHANNEL_COUNT];
+    uint16_t block_size;
+
+    if (sizeof(block_size) != ring_buffer_peek(ring, &block_size, sizeof(block_size)))
+    {
+        return 0;
+    }
+
+    ring_buffer_consume(ring, HISTORY_BLOCK_OVERHEAD);
+    if (block_size > size)
+    {
+        ring_buffer_consume(ring, block_size);
+        return 0;
+    }
+
+    return ring_buffer_read(ring, data, block_size);
+}
+
+/*******************************************************************************
+* Function Name: history_is_empty
+********************************************************************************
+* Summary:
+*    Returns true when no block is waiting in the history of a channel.
+*
+*******************************************************************************/
+bool history_is_empty(uint8_t channel)
+{
+    return (0u == ring_buffer_used(&history_ring[channel % STREAM_CHANNEL_COUNT]));
+}
+
+/* [] END OF FILE */
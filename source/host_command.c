@@ -0,0 +1,176 @@
+/******************************************************************************
+* File Name:   host_command.c
+*
+* Description: This file implements the framing of the commands sent by the
+*              host to the device.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "host_command.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define HOST_COMMAND_HEADER_SIZE    (sizeof(host_command_header_t))
+#define HOST_COMMAND_CRC_POLYNOMIAL (0x07u)
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static uint8_t host_command_crc(uint8_t crc, const uint8_t *data, uint32_t count);
+
+/*******************************************************************************
+* Function Name: host_command_parse
+********************************************************************************
+* Summary:
+*    Feeds one received byte to the parser. Bytes before the sync word and
+*    commands with a wrong CRC are skipped.
+*
+* Parameters:
+*   parser: parser state
+*   byte: byte received
+*   command: receives the command once it is complete
+*
+* Return:
+*     true when a command was received.
+*
+*******************************************************************************/
+bool host_command_parse(host_command_parser_t *parser, uint8_t byte, host_command_t *command)
+{
+    uint8_t crc;
+
+    if (parser->count < HOST_COMMAND_HEADER_SIZE)
+    {
+        parser->header[parser->count++] = byte;
+
+        /* Sync word, little endian */
+        if (((1u == parser->count) && ((HOST_COMMAND_SYNC & 0xFFu) != byte)) ||
+            ((2u == parser->count) && ((HOST_COMMAND_SYNC >> 8) != byte)))
+        {
+            parser->count = ((HOST_COMMAND_SYNC & 0xFFu) == byte) ? 1u : 0u;
+            parser->header[0] = byte;
+        }
+        else if ((HOST_COMMAND_HEADER_SIZE == parser->count) &&
+                 (parser->header[3] > HOST_COMMAND_MAX_PAYLOAD))
+        {
+            parser->count = 0;
+        }
+        return false;
+    }
+
+    parser->command.type = parser->header[2];
+    parser->command.length = parser->header[3];
+    if (parser->count < (HOST_COMMAND_HEADER_SIZE + parser->command.length))
+    {
+        parser->command.payload[parser->count - HOST_COMMAND_HEADER_SIZE] = byte;
+        parser->count++;
+        return false;
+    }
+
+    /* Last byte is the CRC */
+    parser->count = 0;
+    crc = host_command_crc(0, &parser->header[2], 2u);
+    crc = host_command_crc(crc, parser->command.payload, parser->command.length);
+    if (crc != byte)
+    {
+        return false;
+    }
+
+    *command = parser->command;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: host_command_write
+********************************************************************************
+* Summary:
+*    Writes a command, used by the host.
+*
+* Parameters:
+*   buffer: receives HOST_COMMAND_SIZE(length) bytes
+*   type: command type
+*   payload: command payload
+*   length: payload length in bytes, up to HOST_COMMAND_MAX_PAYLOAD
+*
+* Return:
+*     The number of bytes written.
+*
+*******************************************************************************/
+uint32_t host_command_write(uint8_t *buffer, host_command_type_t type, const void *payload,
+                            uint8_t length)
+{
+    host_command_header_t header =
+    {
+        .sync   = HOST_COMMAND_SYNC,
+        .type   = (uint8_t)type,
+        .length = length,
+    };
+    uint8_t crc;
+
+    memcpy(buffer, &header, HOST_COMMAND_HEADER_SIZE);
+    memcpy(&buffer[HOST_COMMAND_HEADER_SIZE], payload, length);
+    crc = host_command_crc(0, &buffer[2], 2u + length);
+    buffer[HOST_COMMAND_HEADER_SIZE + length] = crc;
+
+    return HOST_COMMAND_SIZE(length);
+}
+
+/*******************************************************************************
+* Function Name: host_command_crc
+********************************************************************************
+* Summary:
+*    Updates a CRC-8 (polynomial 0x07, no reflection) with a block of bytes.
+*
+*******************************************************************************/
+static uint8_t host_command_crc(uint8_t crc, const uint8_t *data, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8u; bit++)
+        {
+            crc = (crc & 0x80u) ? (uint8_t)((crc << 1) ^ HOST_COMMAND_CRC_POLYNOMIAL)
+                                : (uint8_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,119 @@
+/******************************************************************************
+* File Name:   host_command.h
+*
+* Description: This file contains the function prototypes and constants used
+*   in host_command.c. The commands are sent by the host to the device; this
+*   file is also used by the host tools.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SOURCE_HOST_COMMAND_H_
+#define SOURCE_HOST_COMMAND_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Constants
+ *****************************************************************************/
+/* First two bytes of every command, used to resynchronize */
+#define HOST_COMMAND_SYNC           (0xC33Cu)
+
+/* Largest command payload in bytes */
+#define HOST_COMMAND_MAX_PAYLOAD    (32u)
+
+/* Size of a command with its header and CRC, in bytes */
+#define HOST_COMMAND_SIZE(length)   (sizeof(host_command_header_t) + (length) + 1u)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Command types */
+typedef enum
+{
+    HOST_COMMAND_CREDIT = 1,    /* Payload holds the total number of bytes
+                                 * the host can receive since the start of
+                                 * the stream (uint32) */
+    HOST_COMMAND_NACK   = 2,    /* Payload holds the sequence numbers (uint16)
+                                 * of the frames to send again */
+    HOST_COMMAND_SCHEMA = 3,    /* No payload, asks for a schema record */
+    HOST_COMMAND_PING   = 4,    /* Payload holds a ping identifier (uint32),
+                                 * answered by a clock record */
+    HOST_COMMAND_START  = 5,    /* Starts a session, the payload holds its
+                                 * label (optional) */
+    HOST_COMMAND_STOP   = 6,    /* No payload, stops the session */
+    HOST_COMMAND_LABEL  = 7,    /* Payload holds the label of a new segment
+                                 * of the session */
+    HOST_COMMAND_CREDIT_RESET = 8, /* No payload, restarts the count of the
+                                 * bytes the credits refer to, sent before
+                                 * the first credit of a connection */
+} host_command_type_t;
+
+/* Command header, all fields little endian. The payload follows, then a
+ * CRC-8 (polynomial 0x07) of the type, length and payload. */
+typedef struct
+{
+    uint16_t sync;              /* HOST_COMMAND_SYNC */
+    uint8_t  type;              /* host_command_type_t */
+    uint8_t  length;            /* Payload length in bytes */
+} host_command_header_t;
+
+/* Command received */
+typedef struct
+{
+    uint8_t type;
+    uint8_t length;
+    uint8_t payload[HOST_COMMAND_MAX_PAYLOAD];
+} host_command_t;
+
+/* Parser state, zero initialized */
+typedef struct
+{
+    uint8_t header[sizeof(host_command_header_t)];
+    uint8_t count;              /* Bytes of the current command received */
+    host_command_t command;
+} host_command_parser_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+bool host_command_parse(host_command_parser_t *parser, uint8_t byte, host_command_t *command);
+uint32_t host_command_write(uint8_t *buffer, host_command_type_t type, const void *payload,
+                            uint8_t length);
+
+
+#endif /* SOURCE_HOST_COMMAND_H_ */
@@ -0,0 +1,414 @@
+/******************************************************************************
+* File Name:   i2c_bus.c
+*
+* Description: This file owns the I2C bus shared by the sensors of the kit.
+*   The bus is initialized once, and the reads of all the drivers are queued
+*   and run one after the other from the I2C interrupt, the transaction due
+*   first going first. Reads of consecutive registers of a device are merged
+*   into one transfer. The drivers use the bus object directly while they are
+*   initialized, with the queue locked.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "cybsp.h"
+#include "config.h"
+#include "i2c_bus.h"
+#include "timebase.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define I2C_BUS_FREQUENCY       1000000
+#define I2C_BUS_PRIORITY        3
+
+/* Transactions queued and not started yet */
+#define I2C_BUS_QUEUE_SIZE      (8u)
+
+/* Largest number of transactions and of bytes read in one transfer */
+#define I2C_BUS_BATCH_COUNT     (4u)
+#define I2C_BUS_BATCH_SIZE      (32u)
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+static cyhal_i2c_t i2c_bus;
+static bool i2c_bus_ready = false;
+
+/* Transactions not started, in the order of their deadlines */
+static i2c_bus_transaction_t *i2c_bus_queue[I2C_BUS_QUEUE_SIZE];
+static uint32_t i2c_bus_queued;
+
+/* Transactions of the transfer in progress, and the bytes they read when
+ * there are several of them */
+static i2c_bus_transaction_t *i2c_bus_current[I2C_BUS_BATCH_COUNT];
+static uint32_t i2c_bus_current_count;
+static uint8_t i2c_bus_batch[I2C_BUS_BATCH_SIZE];
+static uint32_t i2c_bus_start_time;
+
+static volatile bool i2c_bus_busy;
+static volatile bool i2c_bus_locked;
+
+/* Transactions done after their deadline or failed, and time the bus was
+ * busy */
+static uint32_t i2c_bus_late_count;
+static uint32_t i2c_bus_error_count;
+static uint32_t i2c_bus_busy_time;
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static void i2c_bus_start(void);
+static void i2c_bus_complete(bool success);
+static void i2c_bus_remove(uint32_t index);
+static void i2c_bus_handler(void *callback_arg, cyhal_i2c_event_t event);
+
+/*******************************************************************************
+* Function Name: i2c_bus_init
+********************************************************************************
+* Summary:
+*   Initializes the bus at 1 MHz, on the first call only, so each driver can
+*   call it.
+*
+* Return:
+*     The status of the initialization.
+*
+*******************************************************************************/
+cy_rslt_t i2c_bus_init(void)
+{
+    cy_rslt_t result;
+    const cyhal_i2c_cfg_t i2c_config =
+    {
+        .is_slave = false,
+        .address = 0,
+        .frequencyhal_hz = I2C_BUS_FREQUENCY,
+    };
+
+    if (true == i2c_bus_ready)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    result = cyhal_i2c_init(&i2c_bus, CYBSP_I2C_SDA, CYBSP_I2C_SCL, NULL);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    result = cyhal_i2c_configure(&i2c_bus, &i2c_config);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    i2c_bus_queued = 0;
+    i2c_bus_busy = false;
+    i2c_bus_locked = false;
+    cyhal_i2c_register_callback(&i2c_bus, i2c_bus_handler, NULL);
+    cyhal_i2c_enable_event(&i2c_bus, (cyhal_i2c_event_t)(CYHAL_I2C_MASTER_RD_CMPLT_EVENT |
+                           CYHAL_I2C_MASTER_ERR_EVENT), I2C_BUS_PRIORITY, true);
+    i2c_bus_ready = true;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: i2c_bus_get
+********************************************************************************
+* Summary:
+*   Returns the bus object, given to the sensor drivers. The drivers may only
+*   use it with the queue locked.
+*
+*******************************************************************************/
+cyhal_i2c_t *i2c_bus_get(void)
+{
+    return &i2c_bus;
+}
+
+/*******************************************************************************
+* Function Name: i2c_bus_submit
+********************************************************************************
+* Summary:
+*   Queues a read behind the transactions due no later, and starts it if the
+*   bus is idle. Can be called from an interrupt.
+*
+* Parameters:
+*   transaction: read to queue, kept until its callback is called
+*
+* Return:
+*   false if the queue is full.
+*
+*******************************************************************************/
+bool i2c_bus_submit(i2c_bus_transaction_t *transaction)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+    uint32_t index = i2c_bus_queued;
+
+    if (I2C_BUS_QUEUE_SIZE == index)
+    {
+        cyhal_system_critical_section_exit(state);
+        return false;
+    }
+
+    while ((index > 0u) &&
+           ((int32_t)(i2c_bus_queue[index - 1u]->deadline - transaction->deadline) > 0))
+    {
+        i2c_bus_queue[index] = i2c_bus_queue[index - 1u];
+        index--;
+    }
+    i2c_bus_queue[index] = transaction;
+    i2c_bus_queued++;
+
+    if (false == i2c_bus_busy)
+    {
+        i2c_bus_start();
+    }
+    cyhal_system_critical_section_exit(state);
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: i2c_bus_lock
+********************************************************************************
+* Summary:
+*   Waits for the transfer in progress and holds the queue, so a driver can
+*   use the bus object with blocking calls. Called from the main loop only.
+*
+*******************************************************************************/
+void i2c_bus_lock(void)
+{
+    i2c_bus_locked = true;
+    while (true == i2c_bus_busy)
+    {
+    }
+}
+
+/*******************************************************************************
+* Function Name: i2c_bus_unlock
+********************************************************************************
+* Summary:
+*   Starts the transactions queued while the bus was locked.
+*
+*******************************************************************************/
+void i2c_bus_unlock(void)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+
+    i2c_bus_locked = false;
+    if (false == i2c_bus_busy)
+    {
+        i2c_bus_start();
+    }
+    cyhal_system_critical_section_exit(state);
+}
+
+/*******************************************************************************
+* Function Name: i2c_bus_start
+********************************************************************************
+* Summary:
+*   Starts the transaction due first, along with the queued reads of the
+*   following registers of the same device. Called with the bus idle and the
+*   interrupts masked, or from the I2C interrupt.
+*
+*******************************************************************************/
+static void i2c_bus_start(void)
+{
+    while ((false == i2c_bus_locked) && (0u != i2c_bus_queued))
+    {
+        i2c_bus_transaction_t *first = i2c_bus_queue[0];
+        uint32_t size = first->rx_size;
+        uint32_t index = 0;
+
+        i2c_bus_remove(0);
+        i2c_bus_current[0] = first;
+        i2c_bus_current_count = 1;
+
+        /* Take the reads that continue where the transfer ends, whatever
+         * their deadline, as long as they fit the batch buffer */
+        while ((true == first->batch) && (1u == first->tx_size) && (index < i2c_bus_queued) &&
+               (i2c_bus_current_count < I2C_BUS_BATCH_COUNT))
+        {
+            i2c_bus_transaction_t *next = i2c_bus_queue[index];
+
+            if ((true == next->batch) && (next->address == first->address) &&
+                (1u == next->tx_size) && (next->tx[0] == (uint8_t)(first->tx[0] + size)) &&
+                ((size + next->rx_size) <= I2C_BUS_BATCH_SIZE))
+            {
+                i2c_bus_remove(index);
+                i2c_bus_current[i2c_bus_current_count++] = next;
+                size += next->rx_size;
+                index = 0;
+            }
+            else
+            {
+                index++;
+            }
+        }
+
+        i2c_bus_busy = true;
+        i2c_bus_start_time = timebase_now_us();
+        if (CY_RSLT_SUCCESS == cyhal_i2c_master_transfer_async(&i2c_bus, first->address,
+                first->tx, first->tx_size,
+                (1u == i2c_bus_current_count) ? first->rx : i2c_bus_batch, size))
+        {
+            return;
+        }
+
+        /* The bus stays busy for the callbacks, which may submit again */
+        i2c_bus_complete(false);
+        i2c_bus_busy = false;
+    }
+}
+
+/*******************************************************************************
+* Function Name: i2c_bus_complete
+********************************************************************************
+* Summary:
+*   Hands the bytes read to the transactions of the transfer done, and calls
+*   their callbacks.
+*
+* Parameters:
+*   success: false if the transfer failed
+*
+*******************************************************************************/
+static void i2c_bus_complete(bool success)
+{
+    uint32_t now = timebase_now_us();
+    uint32_t offset = 0;
+
+    i2c_bus_busy_time += now - i2c_bus_start_time;
+    if (false == success)
+    {
+        i2c_bus_error_count++;
+    }
+
+    for (uint32_t i = 0; i < i2c_bus_current_count; i++)
+    {
+        i2c_bus_transaction_t *transaction = i2c_bus_current[i];
+
+        if ((true == success) && (1u < i2c_bus_current_count))
+        {
+            memcpy(transaction->rx, &i2c_bus_batch[offset], transaction->rx_size);
+        }
+        offset += transaction->rx_size;
+
+        if ((int32_t)(now - transaction->deadline) > 0)
+        {
+            i2c_bus_late_count++;
+        }
+        transaction->done(transaction->arg, success);
+    }
+    i2c_bus_current_count = 0;
+}
+
+/*******************************************************************************
+* Function Name: i2c_bus_remove
+********************************************************************************
+* Summary:
+*   Removes a transaction from the queue, keeping the order of the others.
+*
+*******************************************************************************/
+static void i2c_bus_remove(uint32_t index)
+{
+    i2c_bus_queued--;
+    for (uint32_t i = index; i < i2c_bus_queued; i++)
+    {
+        i2c_bus_queue[i] = i2c_bus_queue[i + 1u];
+    }
+}
+
+/*******************************************************************************
+* Function Name: i2c_bus_handler
+********************************************************************************
+* Summary:
+*   I2C interrupt handler. Completes the transfer done and starts the next
+*   one right away, so the queued reads run back to back.
+*
+* Parameters:
+*     callback_arg: not used
+*     event: I2C events
+*
+*******************************************************************************/
+static void i2c_bus_handler(void *callback_arg, cyhal_i2c_event_t event)
+{
+    (void) callback_arg;
+
+    i2c_bus_complete(0u == ((uint32_t)event & (uint32_t)CYHAL_I2C_MASTER_ERR_EVENT));
+    i2c_bus_busy = false;
+    i2c_bus_start();
+}
+
+/*******************************************************************************
+* Function Name: i2c_bus_late
+********************************************************************************
+* Summary:
+*   Returns the number of transactions done after their deadline.
+*
+*******************************************************************************/
+uint32_t i2c_bus_late(void)
+{
+    return i2c_bus_late_count;
+}
+
+/*******************************************************************************
+* Function Name: i2c_bus_errors
+********************************************************************************
+* Summary:
+*   Returns the number of transactions that failed.
+*
+*******************************************************************************/
+uint32_t i2c_bus_errors(void)
+{
+    return i2c_bus_error_count;
+}
+
+/*******************************************************************************
+* Function Name: i2c_bus_busy_us
+********************************************************************************
+* Summary:
+*   Returns the time the bus spent on transfers, in microseconds, to measure
+*   its utilization.
+*
+*******************************************************************************/
+uint32_t i2c_bus_busy_us(void)
+{
+    return i2c_bus_busy_time;
+}
+
+/* [] END OF FILE */
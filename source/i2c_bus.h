@@ -0,0 +1,87 @@
+/******************************************************************************
+* File Name:   i2c_bus.h
+*
+* Description: This file contains the transaction format and function
+*   prototypes used in i2c_bus.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SOURCE_I2C_BUS_H_
+#define SOURCE_I2C_BUS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cyhal.h"
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Called from the I2C interrupt once a transaction is done */
+typedef void (*i2c_bus_callback_t)(void *arg, bool success);
+
+/* Read queued on the bus: tx_size bytes (the first register) are written,
+ * then rx_size bytes are read after a repeated start. The transaction is
+ * owned by the driver, and must not be submitted again before it is done. */
+typedef struct
+{
+    uint8_t  address;           /* 7-bit address of the device */
+    uint8_t  tx_size;
+    uint16_t rx_size;
+    const uint8_t *tx;
+    uint8_t *rx;
+    uint32_t deadline;          /* Time the data is needed by, in microseconds */
+    bool     batch;             /* Can be read along with the following
+                                 * registers of the device, in one transfer */
+    i2c_bus_callback_t done;
+    void    *arg;
+} i2c_bus_transaction_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t i2c_bus_init(void);
+cyhal_i2c_t *i2c_bus_get(void);
+bool i2c_bus_submit(i2c_bus_transaction_t *transaction);
+void i2c_bus_lock(void);
+void i2c_bus_unlock(void);
+uint32_t i2c_bus_late(void);
+uint32_t i2c_bus_errors(void);
+uint32_t i2c_bus_busy_us(void);
+
+
+#endif /* SOURCE_I2C_BUS_H_ */
@@ -51,11 +51,21 @@
 #include "mtb_bmi160.h"
 #endif
 #include "config.h"
+#include "i2c_bus.h"
+#include "pipeline.h"
+#include "stream_record.h"
+#include "timebase.h"
 
 
 /*******************************************************************************
 * Macros
 *******************************************************************************/
+/* The accelerometer registers of the I2C sensors are read without blocking */
+#if (SENSOR_ASYNC_READ_ENABLE == 1) && (defined(CY_BMI_160_IMU_I2C) || defined(CY_BMI_270_IMU_I2C))
+    #define IMU_ASYNC_READ  1
+#else
+    #define IMU_ASYNC_READ  0
+#endif
 #ifdef CY_BMX_160_IMU_SPI
     #define IMU_SPI_FREQUENCY 10000000
 #endif
@@ -65,16 +75,21 @@
 #endif
 
 #ifdef CY_BMI_160_IMU_I2C
-    #define IMU_I2C_MASTER_DEFAULT_ADDRESS  0
-    #define IMU_I2C_FREQUENCY               1000000
+    #define IMU_I2C_ADDRESS                 MTB_BMI160_DEFAULT_ADDRESS
+    #define IMU_DATA_REGISTER               BMI160_ACCEL_DATA_ADDR
 #endif
 
 #ifdef CY_BMI_270_IMU_I2C
-    #define IMU_I2C_MASTER_DEFAULT_ADDRESS  0
-    #define IMU_I2C_FREQUENCY               1000000
+    #define IMU_I2C_ADDRESS                 MTB_BMI270_ADDRESS_DEFAULT
+    #define IMU_DATA_REGISTER               BMI2_ACC_X_LSB_ADDR
 #endif
 
-#define IMU_SCAN_RATE       50
+/* Accelerometer x, y and z, 16 bits little endian */
+#define IMU_DATA_SIZE       (2 * IMU_AXIS)
+
+/* The registers are read before the next period */
+#define IMU_READ_DEADLINE_US    (1000000u / IMU_SCAN_RATE)
+
 #define IMU_TIMER_FREQUENCY 100000
 #define IMU_TIMER_PERIOD (IMU_TIMER_FREQUENCY/IMU_SCAN_RATE)
 #define IMU_TIMER_PRIORITY  3
@@ -103,24 +118,38 @@
     /* BMI160 driver structures */
     mtb_bmi160_data_t data;
     mtb_bmi160_t sensor_bmi160;
-
-    /* I2C object for data transmission */
-    cyhal_i2c_t i2c;
 #endif
 
 #ifdef CY_BMI_270_IMU_I2C
     /* BMI270 driver structures */
     mtb_bmi270_data_t data;
     mtb_bmi270_t sensor_bmi270;
-
-    /* I2C object for data transmission */
-    cyhal_i2c_t i2c;
 #endif
 
 /* Global timer used for getting data */
 cyhal_timer_t imu_timer;
 
 float imu_data[IMU_AXIS];
+
+#if IMU_ASYNC_READ == 1
+/* Register address sent and accelerometer registers received by the
+ * transaction queued at each period, due by the next period. The buffer is
+ * busy from the start of the transaction until its data is converted. */
+static const uint8_t imu_read_register = IMU_DATA_REGISTER;
+static uint8_t imu_read_buffer[IMU_DATA_SIZE];
+static volatile bool imu_read_busy;
+static void imu_read_done(void *arg, bool success);
+static i2c_bus_transaction_t imu_read_transaction =
+{
+    .address = IMU_I2C_ADDRESS,
+    .tx_size = 1,
+    .rx_size = IMU_DATA_SIZE,
+    .tx = &imu_read_register,
+    .rx = imu_read_buffer,
+    .batch = true,
+    .done = imu_read_done,
+};
+#endif
 /*******************************************************************************
 * Local Function Prototypes
 *******************************************************************************/
@@ -202,30 +231,17 @@ cy_rslt_t imu_init(void)
 #endif
 
 #ifdef CY_BMI_160_IMU_I2C
-    /* Configure the I2C mode, the address, and the data rate */
-    cyhal_i2c_cfg_t i2c_config =
-    {
-            CYHAL_I2C_MODE_MASTER,
-            IMU_I2C_MASTER_DEFAULT_ADDRESS,
-            IMU_I2C_FREQUENCY
-    };
-
-    /* Initialize I2C for IMU communication */
-    result = cyhal_i2c_init(&i2c, CYBSP_I2C_SDA, CYBSP_I2C_SCL, NULL);
-    if(CY_RSLT_SUCCESS != result)
-    {
-        return result;
-    }
-
-    /* Configure the I2C */
-    result = cyhal_i2c_configure(&i2c, &i2c_config);
+    /* Initialize the I2C bus shared by the sensors, and hold its queue
+     * while the driver uses it */
+    result = i2c_bus_init();
     if(CY_RSLT_SUCCESS != result)
     {
         return result;
     }
+    i2c_bus_lock();
 
     /* Initialize the IMU */
-    result = mtb_bmi160_init_i2c(&sensor_bmi160, &i2c, MTB_BMI160_DEFAULT_ADDRESS);
+    result = mtb_bmi160_init_i2c(&sensor_bmi160, i2c_bus_get(), MTB_BMI160_DEFAULT_ADDRESS);
     if(CY_RSLT_SUCCESS != result)
     {
         return result;
@@ -248,30 +264,17 @@ cy_rslt_t imu_init(void)
 
 #ifdef CY_BMI_270_IMU_I2C
     struct bmi2_sens_config config = {0};
-    /* Configure the I2C mode, the address, and the data rate */
-    cyhal_i2c_cfg_t i2c_config =
-    {
-            CYHAL_I2C_MODE_MASTER,
-            IMU_I2C_MASTER_DEFAULT_ADDRESS,
-            IMU_I2C_FREQUENCY
-    };
-
-    /* Initialize I2C for IMU communication */
-    result = cyhal_i2c_init(&i2c, CYBSP_I2C_SDA, CYBSP_I2C_SCL, NULL);
-    if(CY_RSLT_SUCCESS != result)
-    {
-        return result;
-    }
-
-    /* Configure the I2C */
-    result = cyhal_i2c_configure(&i2c, &i2c_config);
+    /* Initialize the I2C bus shared by the sensors, and hold its queue
+     * while the driver uses it */
+    result = i2c_bus_init();
     if(CY_RSLT_SUCCESS != result)
     {
         return result;
     }
+    i2c_bus_lock();
 
     /* Initialize the IMU */
-    result = mtb_bmi270_init_i2c(&sensor_bmi270, &i2c, MTB_BMI270_ADDRESS_DEFAULT);
+    result = mtb_bmi270_init_i2c(&sensor_bmi270, i2c_bus_get(), MTB_BMI270_ADDRESS_DEFAULT);
     if(CY_RSLT_SUCCESS != result)
     {
         return result;
@@ -292,6 +295,16 @@ cy_rslt_t imu_init(void)
 #endif
     imu_flag = false;
 
+#if defined(CY_BMI_160_IMU_I2C) || defined(CY_BMI_270_IMU_I2C)
+    /* The driver is done with the bus. With IMU_ASYNC_READ, the data
+     * registers are now read by transactions queued from the timer
+     * interrupt. */
+#if IMU_ASYNC_READ == 1
+    imu_read_busy = false;
+#endif
+    i2c_bus_unlock();
+#endif
+
     /* Timer for data collection */
     result = imu_timer_init();
     if(CY_RSLT_SUCCESS != result)
@@ -368,7 +381,10 @@ cy_rslt_t imu_timer_init(void)
 ********************************************************************************
 * Summary:
 *   Interrupt handler for timer. Interrupt handler will get called at 50Hz and
-*   sets a flag that can be checked in main.
+*   sets a flag that can be checked in main. With IMU_ASYNC_READ, it queues
+*   the read of the accelerometer registers on the I2C bus instead, and the
+*   flag is set once they are read. A period is skipped while the previous
+*   data has not been converted.
 *
 * Parameters:
 *     callback_arg: not used
@@ -381,14 +397,59 @@ void imu_interrupt_handler(void *callback_arg, cyhal_timer_event_t event)
     (void) callback_arg;
     (void) event;
 
+#if IMU_ASYNC_READ == 1
+    if(false == imu_read_busy)
+    {
+        imu_read_busy = true;
+        imu_read_transaction.deadline = timebase_now_us() + IMU_READ_DEADLINE_US;
+        if(false == i2c_bus_submit(&imu_read_transaction))
+        {
+            imu_read_busy = false;
+        }
+    }
+#else
     imu_flag = true;
+    pipeline_notify_from_isr(STREAM_CHANNEL_IMU);
+#endif
+}
+
+#if IMU_ASYNC_READ == 1
+/*******************************************************************************
+* Function Name: imu_read_done
+********************************************************************************
+* Summary:
+*   Completion handler of the read of the accelerometer registers. Sets the
+*   flag checked in main, or releases the buffer if the read failed.
+*
+* Parameters:
+*     arg: not used
+*     success: false if the read failed
+*
+*
+*******************************************************************************/
+static void imu_read_done(void *arg, bool success)
+{
+    (void) arg;
+
+    if(true == success)
+    {
+        imu_flag = true;
+        pipeline_notify_from_isr(STREAM_CHANNEL_IMU);
+    }
+    else
+    {
+        imu_read_busy = false;
+    }
 }
+#endif
 
 /*******************************************************************************
 * Function Name: imu_get_data
 ********************************************************************************
 * Summary:
-*   Reads accelerometer data from the IMU and stores it in a buffer.
+*   Reads accelerometer data from the IMU and stores it in a buffer. With
+*   IMU_ASYNC_READ, the registers have already been read and are only
+*   converted.
 *
 * Parameters:
 *     imu_data: Stores IMU accelerometer data
@@ -397,6 +458,15 @@ void imu_interrupt_handler(void *callback_arg, cyhal_timer_event_t event)
 *******************************************************************************/
 void imu_get_data(float *imu_data)
 {
+#if IMU_ASYNC_READ == 1
+    for(uint32_t axis = 0; axis < IMU_AXIS; axis++)
+    {
+        int16_t value = (int16_t)((uint16_t)imu_read_buffer[2 * axis] |
+                                  ((uint16_t)imu_read_buffer[2 * axis + 1] << 8));
+        imu_data[axis] = ((float)value) / (float)0x1000;
+    }
+    imu_read_busy = false;
+#else
     /* Read data from IMU sensor */
 #ifdef CY_BMX_160_IMU_SPI
     cy_rslt_t result;
@@ -446,4 +516,5 @@ void imu_get_data(float *imu_data)
     imu_data[1] = ((float)data.accel.y) / (float)0x1000;
     imu_data[2] = ((float)data.accel.z) / (float)0x1000;
 #endif
+#endif /* IMU_ASYNC_READ */
 }
@@ -55,6 +55,8 @@ extern volatile bool imu_flag;
  * Macros
  *****************************************************************************/
 #define IMU_AXIS 3
+/* Rate at which the IMU is sampled, in Hz */
+#define IMU_SCAN_RATE       50
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
@@ -43,14 +43,113 @@
 #include "cyhal.h"
 #include "cybsp.h"
 #include "stdlib.h"
+#include <string.h>
 
 #include "imu.h"
 #include "audio.h"
+#include "audio_features.h"
 #include "bmm.h"
 #include "pressure.h"
 #include "radar.h"
 #include "config.h"
 #include "streaming.h"
+#include "reliable.h"
+#include "timebase.h"
+#include "vad.h"
+#include "history.h"
+#include "spill.h"
+#include "shedding.h"
+#include "stream_record.h"
+#include "stream_schema.h"
+#include "sync_trigger.h"
+#include "session.h"
+#include "pipeline.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Channel streamed, flag set by its interrupt, priority of its task in the
+ * RTOS build, largest block of data collected at once, number of blocks per
+ * second and type of the values */
+#if COLLECTION_MODE_SELECT == IMU_COLLECTION
+#define STREAM_CHANNEL          STREAM_CHANNEL_IMU
+#define STREAM_FLAG             imu_flag
+#define STREAM_TASK_PRIORITY    IMU_TASK_PRIORITY
+#define STREAM_DATA_SIZE        (4 * IMU_AXIS)
+#define STREAM_BLOCK_RATE       IMU_SCAN_RATE
+#define STREAM_SAMPLE_TYPE      SHEDDING_SAMPLE_FLOAT32
+#elif COLLECTION_MODE_SELECT == PDM_COLLECTION
+#define STREAM_CHANNEL          STREAM_CHANNEL_PDM
+#define STREAM_FLAG             pdm_pcm_flag
+#define STREAM_TASK_PRIORITY    PDM_TASK_PRIORITY
+#if AUDIO_VAD_ENABLE == 1
+#define STREAM_DATA_SIZE        VAD_BUFFER_SIZE
+#else
+#define STREAM_DATA_SIZE        (2 * AUDIO_DATA_SIZE)
+#endif
+#define STREAM_BLOCK_RATE       ((PDM_SAMPLE_RATE + FRAME_SIZE - 1) / FRAME_SIZE)
+#define STREAM_SAMPLE_TYPE      SHEDDING_SAMPLE_INT16
+#elif COLLECTION_MODE_SELECT == BMM_COLLECTION
+#define STREAM_CHANNEL          STREAM_CHANNEL_BMM
+#define STREAM_FLAG             bmm_flag
+#define STREAM_TASK_PRIORITY    BMM_TASK_PRIORITY
+#define STREAM_DATA_SIZE        (4 * bmm_AXIS)
+#define STREAM_BLOCK_RATE       bmm_SCAN_RATE
+#define STREAM_SAMPLE_TYPE      SHEDDING_SAMPLE_FLOAT32
+#elif COLLECTION_MODE_SELECT == DPS_COLLECTION
+#define STREAM_CHANNEL          STREAM_CHANNEL_DPS
+#define STREAM_FLAG             DPS_flag
+#define STREAM_TASK_PRIORITY    DPS_TASK_PRIORITY
+#define STREAM_DATA_SIZE        (4 * 2)
+#define STREAM_BLOCK_RATE       DPS_SCAN_RATE
+#define STREAM_SAMPLE_TYPE      SHEDDING_SAMPLE_FLOAT32
+#elif COLLECTION_MODE_SELECT == RADAR_COLLECTION
+#define STREAM_CHANNEL          STREAM_CHANNEL_RADAR
+#define STREAM_FLAG             radar_flag
+#define STREAM_TASK_PRIORITY    RADAR_TASK_PRIORITY
+#define STREAM_DATA_SIZE        (2 * RADAR_DATA_SIZE)
+#define STREAM_BLOCK_RATE       RADAR_SCAN_RATE
+#define STREAM_SAMPLE_TYPE      SHEDDING_SAMPLE_INT16
+#endif
+
+/* Blocks are wrapped in records when STREAM_RECORDS_ENABLE is set, unless
+ * they are records already */
+#if (STREAM_RECORDS_ENABLE == 1) && \
+    !((COLLECTION_MODE_SELECT == PDM_COLLECTION) && (AUDIO_VAD_ENABLE == 1))
+#define STREAM_WRAP_RECORDS     1
+#define STREAM_BLOCK_SIZE       (STREAM_RECORD_HEADER_SIZE + STREAM_DATA_SIZE)
+#else
+#define STREAM_WRAP_RECORDS     0
+#define STREAM_BLOCK_SIZE       STREAM_DATA_SIZE
+#endif
+
+/* Control records are sent when the stream is made of records: a schema
+ * record at the start of the stream and when the host asks for it, and a
+ * clock record in answer to each ping */
+#if (STREAM_RECORDS_ENABLE == 1) || \
+    ((COLLECTION_MODE_SELECT == PDM_COLLECTION) && (AUDIO_VAD_ENABLE == 1))
+#define STREAM_CONTROL_ENABLE   1
+#else
+#define STREAM_CONTROL_ENABLE   0
+#endif
+
+/* Each block is sent in a single frame, streaming_sendv drops the blocks
+ * whose frame does not fit in the pool */
+#if STREAM_RELIABLE_ENABLE == 1
+_Static_assert((STREAM_BLOCK_SIZE + RELIABLE_FRAME_HEADER_SIZE) <= STREAM_RELIABLE_POOL_SIZE,
+               "STREAM_RELIABLE_POOL_SIZE cannot hold a frame of STREAM_BLOCK_SIZE bytes");
+#endif
+
+/* The sync input preempts the sensor interrupts but not the time base, so
+ * the time read in its handler includes all the elapsed periods */
+#define SYNC_TRIGGER_PRIORITY   2
+
+/* Presses of the kit button closer than this are bounces, in microseconds */
+#define SESSION_DEBOUNCE_US     (200000u)
+
+/* Interval between the flushes of the transport (the log of the microSD
+ * card) while nothing is queued, in microseconds */
+#define STREAM_FLUSH_INTERVAL_US (2000000u)
 
 /*******************************************************************************
 * Global Variables
@@ -62,23 +161,127 @@ volatile bool bmm_flag;
 volatile bool radar_flag;
 volatile bool send_data = false;
 
+/* Presses of the kit button and time of the last one, each starting or
+ * stopping a session */
+static volatile uint32_t session_presses;
+static volatile uint32_t session_press_time;
+static uint32_t session_presses_handled;
+
+#if SYNC_TRIGGER_ENABLE == 1
+/* Set by the first edge of the sync line, which starts a session, and time
+ * of the edge */
+static volatile bool session_sync_start = false;
+static volatile uint32_t session_sync_time;
+#endif
+
+/* Block being transmitted. The sensor buffers are refilled while the
+ * transfer is in progress, so each block is copied here first. */
+static uint8_t stream_transmit[STREAM_BLOCK_SIZE];
+
+/* Streaming interface, used by the transmit task in the RTOS build */
+static mtb_data_streaming_interface_t stream_interface;
+
+/* Set when a session stops, until the data sent is flushed, and time of the
+ * last flush */
+static bool stream_flush_pending = false;
+static uint32_t stream_flush_time;
+
+/* Set while queued data is transmitted, so the transmit task goes on without
+ * waiting for the sensor task */
+static bool stream_draining = false;
+
+#if RTOS_PIPELINE_ENABLE == 1
+/* Blocks collected by the sensor task */
+CY_ALIGN(4) static uint8_t stream_pipeline_storage[PIPELINE_STORAGE_SIZE(STREAM_DATA_SIZE)];
+#else
+/* Block collected from the sensor */
+CY_ALIGN(4) static uint8_t stream_block[STREAM_DATA_SIZE];
+#endif
+
+#if STREAM_WRAP_RECORDS == 1
+/* Record built from the block collected */
+static uint8_t stream_record[STREAM_BLOCK_SIZE];
+
+/* Header of the record being transmitted, sent ahead of the payload in
+ * stream_transmit without copying them together */
+static uint8_t stream_transmit_header[STREAM_RECORD_HEADER_SIZE];
+static mtb_data_streaming_segment_t stream_segments[2];
+#endif
+
+/* Schema record, sent ahead of the data blocks while pending */
+#if STREAM_CONTROL_ENABLE == 1
+static uint8_t stream_schema[STREAM_RECORD_HEADER_SIZE + STREAM_SCHEMA_SIZE];
+static bool stream_schema_pending = true;
+#else
+static bool stream_schema_pending = false;
+#endif
+
+/* Clock record answering the last ping, sent as soon as possible so the host
+ * can measure the round trip */
+#if STREAM_CONTROL_ENABLE == 1
+static uint8_t stream_clock[STREAM_RECORD_HEADER_SIZE + sizeof(stream_clock_t)];
+static stream_clock_t stream_clock_reply;
+static bool stream_clock_pending = false;
+#endif
+
+/* Trigger record reporting an edge of the sync line */
+#if (STREAM_CONTROL_ENABLE == 1) && (SYNC_TRIGGER_ENABLE == 1)
+static uint8_t stream_trigger[STREAM_RECORD_HEADER_SIZE + sizeof(stream_trigger_t)];
+#endif
+
+/* Marker record waiting for room in the spill buffer, and marker record
+ * being transmitted */
+#if STREAM_CONTROL_ENABLE == 1
+static uint8_t stream_marker[SESSION_MARKER_SIZE];
+static uint32_t stream_marker_size;
+static uint8_t stream_marker_transmit[SESSION_MARKER_SIZE];
+#endif
+
+#if (SYNC_TRIGGER_ENABLE == 1) && (SYNC_TRIGGER_MASTER == 1)
+/* Pulse train driven on the sync line */
+static cyhal_pwm_t sync_pwm;
+#endif
+
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
 void gpio_interrupt_handler(void* handler_arg, cyhal_gpio_event_t event);
+#if SYNC_TRIGGER_ENABLE == 1
+void sync_interrupt_handler(void* handler_arg, cyhal_gpio_event_t event);
+#endif
+static void stream_init(mtb_data_streaming_interface_t* stream);
+static void stream_task(void* arg);
+static uint32_t collect_block(uint8_t* data);
+static void transmit_data(mtb_data_streaming_interface_t* stream, uint8_t* data, uint32_t size);
+static void process_command(const host_command_t* command);
+static void process_session(void);
+#if STREAM_WRAP_RECORDS == 1
+static void join_record(const uint8_t* payload, uint32_t size);
+#endif
 
 cyhal_gpio_callback_data_t cb_data =
 {
     .callback     = gpio_interrupt_handler,
     .callback_arg = NULL
 };
+
+#if SYNC_TRIGGER_ENABLE == 1
+cyhal_gpio_callback_data_t sync_cb_data =
+{
+    .callback     = sync_interrupt_handler,
+    .callback_arg = NULL
+};
+#endif
 /*******************************************************************************
 * Function Name: main
 ********************************************************************************
 * Summary:
-*  This is the main function. It sets up either the PDM or IMU based on the
-*  config.h file. main continuously checks flags, signaling that data is ready
-*  to be streamed over UART or USB and initiates the transfer.
+*  This is the main function. It sets up the board and the time base, and
+*  runs the main loop (stream_task), which sets up either the PDM or IMU based
+*  on the config.h file, continuously checks flags, signaling that data is
+*  ready to be streamed over UART or USB and initiates the transfer. In the
+*  RTOS build, it creates the sensor task and the transmit task, and starts
+*  the scheduler.
 *
 * Parameters:
 *  void
@@ -106,51 +309,100 @@ int main(void)
     cyhal_gpio_register_callback(CYBSP_USER_BTN, &cb_data);
     cyhal_gpio_enable_event(CYBSP_USER_BTN, CYHAL_GPIO_IRQ_FALL, 3, true);
 
+    /* Start the time base used to timestamp the records */
+    result = timebase_init();
+    if (result != CY_RSLT_SUCCESS)
+    {
+        CY_ASSERT(0);
+    }
+
+#if SYNC_TRIGGER_ENABLE == 1
+    /* Latch the rising edges of the sync line, the first one starts the
+     * data transfer */
+    sync_trigger_init();
+    cyhal_gpio_init(SYNC_TRIGGER_INPUT_PIN, CYHAL_GPIO_DIR_INPUT, CYHAL_GPIO_DRIVE_PULLDOWN, 0);
+    cyhal_gpio_register_callback(SYNC_TRIGGER_INPUT_PIN, &sync_cb_data);
+    cyhal_gpio_enable_event(SYNC_TRIGGER_INPUT_PIN, CYHAL_GPIO_IRQ_RISE, SYNC_TRIGGER_PRIORITY, true);
+
+#if SYNC_TRIGGER_MASTER == 1
+    /* Set up the pulse train started by the button */
+    result = cyhal_pwm_init(&sync_pwm, SYNC_TRIGGER_OUTPUT_PIN, NULL);
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = cyhal_pwm_set_period(&sync_pwm, SYNC_TRIGGER_PERIOD_MS * 1000u,
+                                      SYNC_TRIGGER_PULSE_US);
+    }
+    if (result != CY_RSLT_SUCCESS)
+    {
+        CY_ASSERT(0);
+    }
+#endif
+#endif
+
+#if RTOS_PIPELINE_ENABLE == 1
+    /* The sensor is read by its own task, and the main loop runs in the
+     * transmit task */
+    const pipeline_sensor_t sensor =
+    {
+        .channel = STREAM_CHANNEL,
+        .priority = STREAM_TASK_PRIORITY,
+        .block_size = STREAM_DATA_SIZE,
+        .deadline_us = 1000000u / STREAM_BLOCK_RATE,
+        .read = collect_block,
+        .storage = stream_pipeline_storage,
+    };
+    result = pipeline_add_sensor(&sensor);
+    if(CY_RSLT_SUCCESS != result)
+    {
+        CY_ASSERT(0);
+    }
+    pipeline_start(stream_task, &stream_interface);
+#else
+    stream_task(&stream_interface);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: stream_init
+********************************************************************************
+* Summary:
+*  Sets up the streaming interface, the sensor selected in config.h and the
+*  queues of the data. Called by stream_task before its loop: in the RTOS
+*  build, the drivers wait on RTOS objects, so they are set up once the
+*  scheduler is running.
+*
+* Parameters:
+*  stream: Pass in the stream object
+*
+*******************************************************************************/
+static void stream_init(mtb_data_streaming_interface_t* stream)
+{
+    cy_rslt_t result;
+
     /* Initialize the streaming interface */
-    mtb_data_streaming_interface_t  stream;
-    streaming_init(&stream);
+    streaming_init(stream);
 
 #if COLLECTION_MODE_SELECT == IMU_COLLECTION
-    /* Initialize IMU transmit buffers */
-    uint8_t transmit_imu[4 * IMU_AXIS] = {0};
-    float *imu_raw_data = (float*) transmit_imu;
-
     /* Start the imu and timer */
     result = imu_init();
 #endif
 
 #if COLLECTION_MODE_SELECT == PDM_COLLECTION
-    /* Initialize PDM transmit buffers */
-    uint8_t transmit_pdm[2 * FRAME_SIZE] = {0};
-    int16_t *pdm_raw_data = (int16_t *) transmit_pdm;
-
     /* Configure PDM, PDM clocks, and PDM event */
     result = pdm_init();
 #endif
 
 #if COLLECTION_MODE_SELECT == BMM_COLLECTION
-    /* Initialize IMU transmit buffers */
-    uint8_t transmit_bmm[4 * bmm_AXIS] = {0};
-    float *bmm_raw_data = (float*) transmit_bmm;
-
     /* Start the imu and timer */
     result = bmm_init();
 #endif
 
 #if COLLECTION_MODE_SELECT == DPS_COLLECTION
-    int8 val = 0;
-    /* Initialize Pressure transmit buffers */
-    uint8_t transmit_DPS[4 * 2]={0};
-    float *dps_raw_data = (float*) transmit_DPS;
     /* Configure DPS sensor */
     result = DPS_init();
 #endif
 
 #if COLLECTION_MODE_SELECT == RADAR_COLLECTION
-    /* Initialize IMU transmit buffers */
-    uint8_t transmit_radar[300] = {0};
-    int16_t *radar_raw_data = (int16_t*) transmit_radar;
-
     /* Start the imu and timer */
     result = radar_init();
 #endif
@@ -162,80 +414,458 @@ int main(void)
         NVIC_SystemReset();
     }
 
-    /* Wait until the kit button is pressed */
-    while(false == send_data);
+    /* Data produced while the transport is busy is queued in the spill
+     * buffer */
+    spill_init();
+    session_init();
+
+#if HISTORY_SECONDS > 0
+    /* Data collected between the sessions is kept in the history */
+    history_init(STREAM_CHANNEL, STREAM_BLOCK_SIZE, STREAM_BLOCK_RATE);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: stream_task
+********************************************************************************
+* Summary:
+*  Main loop, run after stream_init. Processes the host commands and the
+*  sessions, sends the control records, transmits the blocks collected from
+*  the sensor and drains the queued data. In the RTOS build, it is the
+*  transmit task, and the blocks are collected by the sensor task; it waits
+*  for them when nothing is left to transmit. Does not return.
+*
+* Parameters:
+*  arg: Pass in the stream object
+*
+*******************************************************************************/
+static void stream_task(void* arg)
+{
+    mtb_data_streaming_interface_t* stream = arg;
+    uint32_t transmit_size;
+    uint8_t transmit_channel;
+    host_command_t command;
+#if (STREAM_CONTROL_ENABLE == 1) && (SYNC_TRIGGER_ENABLE == 1)
+    stream_trigger_t trigger;
+#endif
+#if RTOS_PIPELINE_ENABLE == 1
+    pipeline_block_t* block;
+#endif
+
+    stream_init(stream);
 
     for(;;)
     {
-
-        /* Transmit IMU data or PDM data based on config.h */
-#if COLLECTION_MODE_SELECT == IMU_COLLECTION
-        if(true == imu_flag)
+        /* Process the commands received from the host */
+        while(true == streaming_receive_command(&command))
         {
-            imu_flag = false;
-            /* Store IMU data */
-            imu_get_data(imu_raw_data);
+            process_command(&command);
+        }
+        process_session();
+        streaming_process(stream);
 
-            /* Transmit data over UART */
-            mtb_data_streaming_send(&stream, transmit_imu, sizeof(transmit_imu), NULL);
+#if STREAM_CONTROL_ENABLE == 1
+        /* Answer the last ping ahead of the data blocks */
+        if((true == stream_clock_pending) &&
+           (true == streaming_can_send(sizeof(stream_clock))))
+        {
+            stream_clock_pending = false;
+            transmit_size = stream_record_write(stream_clock, STREAM_RECORD_CLOCK,
+                                                STREAM_CHANNEL_NONE, &stream_clock_reply,
+                                                sizeof(stream_clock_reply), timebase_now_us());
+            streaming_send(stream, stream_clock, transmit_size);
         }
 #endif
 
-#if COLLECTION_MODE_SELECT == PDM_COLLECTION
-        if(true == pdm_pcm_flag)
+#if (STREAM_CONTROL_ENABLE == 1) && (SYNC_TRIGGER_ENABLE == 1)
+        /* Report the edges of the sync line */
+        if((true == streaming_can_send(sizeof(stream_trigger))) &&
+           (true == sync_trigger_pop(&trigger)))
         {
-            pdm_pcm_flag = false;
-            /* Store PDM data */
-            pdm_preprocessing_feed(pdm_raw_data);
-            /* Transmit data over UART */
-            mtb_data_streaming_send(&stream, transmit_pdm, sizeof(transmit_pdm), NULL);
+            transmit_size = stream_record_write(stream_trigger, STREAM_RECORD_TRIGGER,
+                                                STREAM_CHANNEL_NONE, &trigger,
+                                                sizeof(trigger), timebase_now_us());
+            streaming_send(stream, stream_trigger, transmit_size);
         }
 #endif
 
-#if COLLECTION_MODE_SELECT == BMM_COLLECTION
-        if(true == bmm_flag)
+#if STREAM_CONTROL_ENABLE == 1
+        /* Queue the session markers behind the data collected before them */
+        if(0u == stream_marker_size)
         {
-            bmm_flag= false;
-            /* Store IMU data */
-            bmm_get_data(bmm_raw_data);
-
-            /* Transmit data over UART */
-            mtb_data_streaming_send(&stream, transmit_bmm, sizeof(transmit_bmm), NULL);
+            stream_marker_size = session_pop(stream_marker);
+        }
+        if(0u != stream_marker_size)
+        {
+            if((true == spill_is_empty()) && (true == streaming_can_send(stream_marker_size)))
+            {
+                memcpy(stream_marker_transmit, stream_marker, stream_marker_size);
+                streaming_send(stream, stream_marker_transmit, stream_marker_size);
+                stream_marker_size = 0;
+            }
+            else if(true == spill_push(STREAM_CHANNEL_NONE, stream_marker, (uint16_t)stream_marker_size))
+            {
+                stream_marker_size = 0;
+            }
         }
 #endif
 
-#if COLLECTION_MODE_SELECT == DPS_COLLECTION
-        if(true == DPS_flag)
+#if RTOS_PIPELINE_ENABLE == 1
+        /* Transmit the blocks collected by the sensor task. Wait for one
+         * until the next poll, unless queued data is being drained. */
+        if(true == pipeline_receive(&block, (true == stream_draining) ? 0u : PIPELINE_POLL_MS))
         {
-            DPS_flag = false;
-            /* Store Pressure data */
-            val = dps_get_data(dps_raw_data);
-            if(1 == val)
+            do
+            {
+                transmit_data(stream, block->data, block->size);
+                pipeline_release(block);
+            } while(true == pipeline_receive(&block, 0u));
+        }
+#else
+        /* Transmit the data of the sensor selected in config.h */
+        if(true == STREAM_FLAG)
+        {
+            transmit_size = collect_block(stream_block);
+            if(0u != transmit_size)
             {
                 /* Transmit data over UART */
-                mtb_data_streaming_send(&stream, transmit_DPS, sizeof(transmit_DPS), NULL);
+                transmit_data(stream, stream_block, transmit_size);
             }
         }
 #endif
 
+        /* Once a session is started, transmit the history followed by the
+         * spilled data, one block at a time. The schema record goes first.
+         * The spilled data is still transmitted after the session stops. */
+#if STREAM_CONTROL_ENABLE == 1
+        if((true == send_data) && (true == stream_schema_pending) &&
+           (true == streaming_can_send(sizeof(stream_schema))))
+        {
+            stream_schema_pending = false;
+            transmit_size = stream_schema_write(stream_schema, timebase_now_us());
+            streaming_send(stream, stream_schema, transmit_size);
+        }
+#endif
+        stream_draining = false;
+        if((false == stream_schema_pending) && (true == streaming_can_send(STREAM_BLOCK_SIZE)))
+        {
+#if HISTORY_SECONDS > 0
+            transmit_size = (true == send_data) ?
+                            history_pop(STREAM_CHANNEL, stream_transmit, sizeof(stream_transmit)) : 0u;
+            if(0u == transmit_size)
+#endif
+            {
+                transmit_size = spill_pop(&transmit_channel, stream_transmit, sizeof(stream_transmit));
+            }
+            if(0u != transmit_size)
+            {
+                streaming_send(stream, stream_transmit, transmit_size);
+                stream_draining = true;
+            }
+        }
+
+        /* Flush the data once all of it is handed to the transport: when a
+         * session stops, after its STOP marker, and periodically */
+        if((true == spill_is_empty()) && (true == streaming_ready()) &&
+#if STREAM_CONTROL_ENABLE == 1
+           (0u == stream_marker_size) &&
+#endif
+           ((true == stream_flush_pending) ||
+            ((timebase_now_us() - stream_flush_time) >= STREAM_FLUSH_INTERVAL_US)))
+        {
+            stream_flush_pending = false;
+            stream_flush_time = timebase_now_us();
+            streaming_flush();
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: collect_block
+********************************************************************************
+* Summary:
+*  Clears the flag of the sensor and reads the data it signalled. Called from
+*  the main loop, or from the sensor task in the RTOS build.
+*
+* Parameters:
+*  data: Block to fill, aligned on 4 bytes
+*
+* Return:
+*  The size of the block in bytes, 0 if there is nothing to transmit
+*
+*******************************************************************************/
+static uint32_t collect_block(uint8_t* data)
+{
+    STREAM_FLAG = false;
+
+#if COLLECTION_MODE_SELECT == IMU_COLLECTION
+    /* Store IMU data */
+    imu_get_data((float*) data);
+    return 4 * IMU_AXIS;
+#endif
+
+#if COLLECTION_MODE_SELECT == PDM_COLLECTION
+#if AUDIO_VAD_ENABLE == 1
+    /* Store PDM data of the frames with sound activity */
+    return pdm_vad_feed(data);
+#else
+    /* Store PDM data */
+    pdm_preprocessing_feed((int16_t*) data);
+    return 2 * AUDIO_DATA_SIZE;
+#endif
+#endif
+
+#if COLLECTION_MODE_SELECT == BMM_COLLECTION
+    /* Store magnetometer data */
+    bmm_get_data((float*) data);
+    return 4 * bmm_AXIS;
+#endif
+
+#if COLLECTION_MODE_SELECT == DPS_COLLECTION
+    /* Store Pressure data */
+    return (1 == dps_get_data((float*) data)) ? (4 * 2) : 0u;
+#endif
+
 #if COLLECTION_MODE_SELECT == RADAR_COLLECTION
-        if(true == radar_flag)
+    /* Store radar data */
+    radar_get_data((int16_t*) data);
+    return 2 * RADAR_DATA_SIZE;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: transmit_data
+********************************************************************************
+* Summary:
+*  Transmits a block of data right away when the transport is ready and
+*  nothing is queued ahead of it (including a pending schema record),
+*  otherwise adds it to the spill buffer. When the spill buffer fills up, the
+*  block is degraded according to the channel policy (see shedding.c).
+*  Between sessions, the block is added to the history instead when
+*  HISTORY_SECONDS is set, or dropped. The queued data is transmitted from
+*  the main loop.
+*
+* Parameters:
+*  stream: Pass in the stream object
+*  data: Block of data
+*  size: Size of the block in bytes
+*
+*******************************************************************************/
+static void transmit_data(mtb_data_streaming_interface_t* stream, uint8_t* data, uint32_t size)
+{
+#if HISTORY_SECONDS == 0
+    if(false == send_data)
+    {
+        return;
+    }
+#endif
+
+    shedding_action_t action = shedding_update(STREAM_CHANNEL, (1 == STREAM_WRAP_RECORDS));
+
+#if STREAM_WRAP_RECORDS == 1
+    /* Records are numbered before shedding, so the host sees the blocks
+     * dropped as gaps in the sequence numbers. Only the header is written
+     * here, the payload is copied once to where it is sent or queued from. */
+    uint8_t* payload = data;
+
+    if(SHEDDING_COMPRESS == action)
+    {
+        payload = &stream_record[STREAM_RECORD_HEADER_SIZE];
+        size = shedding_compress(STREAM_SAMPLE_TYPE, data, (uint16_t)size, payload);
+        stream_record_write(stream_record, STREAM_RECORD_DATA_HALF, STREAM_CHANNEL, NULL,
+                            (uint16_t)size, timebase_now_us());
+    }
+    else
+    {
+        stream_record_write(stream_record, STREAM_RECORD_DATA, STREAM_CHANNEL, NULL,
+                            (uint16_t)size, timebase_now_us());
+    }
+    data = stream_record;
+    size += STREAM_RECORD_HEADER_SIZE;
+#endif
+
+    if(SHEDDING_SKIP == action)
+    {
+        return;
+    }
+
+#if HISTORY_SECONDS > 0
+    if(false == send_data)
+    {
+#if STREAM_WRAP_RECORDS == 1
+        join_record(payload, size);
+#endif
+        history_push(STREAM_CHANNEL, data, (uint16_t)size);
+        return;
+    }
+    if((true == streaming_can_send(size)) && (true == spill_is_empty()) &&
+       (true == history_is_empty(STREAM_CHANNEL)) && (false == stream_schema_pending))
+#else
+    if((true == streaming_can_send(size)) && (true == spill_is_empty()) &&
+       (false == stream_schema_pending))
+#endif
+    {
+#if STREAM_WRAP_RECORDS == 1
+        /* The header and the payload are sent as two segments */
+        memcpy(stream_transmit_header, stream_record, STREAM_RECORD_HEADER_SIZE);
+        memcpy(stream_transmit, payload, size - STREAM_RECORD_HEADER_SIZE);
+        stream_segments[0].data = stream_transmit_header;
+        stream_segments[0].count = STREAM_RECORD_HEADER_SIZE;
+        stream_segments[1].data = stream_transmit;
+        stream_segments[1].count = size - STREAM_RECORD_HEADER_SIZE;
+        streaming_sendv(stream, stream_segments, 2u);
+#else
+        memcpy(stream_transmit, data, size);
+        streaming_send(stream, stream_transmit, size);
+#endif
+    }
+    else
+    {
+#if STREAM_WRAP_RECORDS == 1
+        join_record(payload, size);
+#endif
+        if(SHEDDING_DROP_OLDEST == action)
         {
-            radar_flag = false;
-            /* Store PDM data */
-            radar_get_data(radar_raw_data);
-            /* Transmit data over UART */
-            mtb_data_streaming_send(&stream, transmit_radar, sizeof(transmit_radar), NULL);
+            spill_drop_oldest(STREAM_CHANNEL);
         }
+        spill_push(STREAM_CHANNEL, data, (uint16_t)size);
+    }
+}
+
+#if STREAM_WRAP_RECORDS == 1
+/*******************************************************************************
+* Function Name: join_record
+********************************************************************************
+* Summary:
+*  Copies the payload after the header in stream_record, for the record to
+*  be queued in a single piece.
+*
+* Parameters:
+*  payload: Payload of the record
+*  size: Size of the record in bytes
+*
+*******************************************************************************/
+static void join_record(const uint8_t* payload, uint32_t size)
+{
+    if(payload != &stream_record[STREAM_RECORD_HEADER_SIZE])
+    {
+        memcpy(&stream_record[STREAM_RECORD_HEADER_SIZE], payload,
+               size - STREAM_RECORD_HEADER_SIZE);
+    }
+}
 #endif
+
+/*******************************************************************************
+* Function Name: process_command
+********************************************************************************
+* Summary:
+*  Applies a command received from the host.
+*
+* Parameters:
+*  command: Command received
+*
+*******************************************************************************/
+static void process_command(const host_command_t* command)
+{
+    uint32_t value;
+
+    switch(command->type)
+    {
+        case HOST_COMMAND_CREDIT:
+            if(sizeof(value) == command->length)
+            {
+                memcpy(&value, command->payload, sizeof(value));
+                streaming_grant(value);
+            }
+            break;
+
+        case HOST_COMMAND_CREDIT_RESET:
+            streaming_credit_reset();
+            break;
+
+        case HOST_COMMAND_NACK:
+            for(uint8_t i = 0; (i + sizeof(uint16_t)) <= command->length; i += sizeof(uint16_t))
+            {
+                streaming_nack((uint16_t)(command->payload[i] | (command->payload[i + 1] << 8)));
+            }
+            break;
+
+        case HOST_COMMAND_SCHEMA:
+            stream_schema_pending = (1 == STREAM_CONTROL_ENABLE);
+            break;
+
+#if STREAM_CONTROL_ENABLE == 1
+        case HOST_COMMAND_PING:
+            if(sizeof(stream_clock_reply.ping) == command->length)
+            {
+                stream_clock_reply.received = timebase_now_us();
+                memcpy(&stream_clock_reply.ping, command->payload, sizeof(stream_clock_reply.ping));
+                stream_clock_pending = true;
+            }
+            break;
+#endif
+
+        case HOST_COMMAND_START:
+            session_start(timebase_now_us(), (const char*)command->payload, command->length);
+            send_data = session_active();
+            break;
+
+        case HOST_COMMAND_STOP:
+            session_stop(timebase_now_us());
+            send_data = session_active();
+            stream_flush_pending = true;
+            break;
+
+        case HOST_COMMAND_LABEL:
+            session_label(timebase_now_us(), (const char*)command->payload, command->length);
+            break;
+
+        default:
+            break;
     }
 }
 
+/*******************************************************************************
+* Function Name: process_session
+********************************************************************************
+* Summary:
+*  Starts or stops a session for each press of the kit button, starts one on
+*  the first edge of the sync line unless the host started one already, and
+*  transmits the data while a session is running.
+*
+*******************************************************************************/
+static void process_session(void)
+{
+#if SYNC_TRIGGER_ENABLE == 1
+    if(true == session_sync_start)
+    {
+        session_sync_start = false;
+        if(false == session_active())
+        {
+            session_start(session_sync_time, NULL, 0u);
+        }
+    }
+#endif
+    while(session_presses_handled != session_presses)
+    {
+        session_presses_handled++;
+        session_toggle(session_press_time);
+        if(false == session_active())
+        {
+            stream_flush_pending = true;
+        }
+    }
+    send_data = session_active();
+}
+
 /*******************************************************************************
 * Function Name: gpio_interrupt_handler
 ********************************************************************************
 * Summary:
-*  When the on kit button is pressed, this sets a flag and exits.
+*  When the on kit button is pressed, this counts the press and exits. Each
+*  press starts or stops a session. With SYNC_TRIGGER_ENABLE, the session
+*  starts on the sync line instead, and the button of the master starts
+*  driving it.
 *
 * Parameters:
 *  void
@@ -249,8 +879,55 @@ void gpio_interrupt_handler(void* handler_arg, cyhal_gpio_event_t event)
     (void) handler_arg;
     (void) event;
 
-    /* Set flag */
-    send_data = true;
+#if SYNC_TRIGGER_ENABLE == 1
+#if SYNC_TRIGGER_MASTER == 1
+    /* Restarting the pulse train would shift the edges */
+    if(0u == sync_trigger_edges())
+    {
+        cyhal_pwm_start(&sync_pwm);
+    }
+#endif
+#else
+    uint32_t time = timebase_now_us();
+
+    /* Count the press, ignoring the bounces */
+    if((time - session_press_time) >= SESSION_DEBOUNCE_US)
+    {
+        session_press_time = time;
+        session_presses++;
+    }
+#endif
 }
 
+#if SYNC_TRIGGER_ENABLE == 1
+/*******************************************************************************
+* Function Name: sync_interrupt_handler
+********************************************************************************
+* Summary:
+*  Latches each rising edge of the sync line and starts a session on the
+*  first one.
+*
+* Parameters:
+*  handler_arg: not used
+*  event: not used
+*
+*******************************************************************************/
+void sync_interrupt_handler(void* handler_arg, cyhal_gpio_event_t event)
+{
+    (void) handler_arg;
+    (void) event;
+
+    /* Take the time first, the latency of the interrupt is the same on
+     * all the boards */
+    uint32_t time = timebase_now_us();
+
+    if(0u == sync_trigger_edges())
+    {
+        session_sync_time = time;
+        session_sync_start = true;
+    }
+    sync_trigger_edge(time);
+}
+#endif
+
 /* [] END OF FILE */
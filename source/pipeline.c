@@ -0,0 +1,344 @@
+/******************************************************************************
+* File Name:   pipeline.c
+*
+* Description: This file implements the task based acquisition used when the
+*              application is built with FreeRTOS. Each sensor is read by its
+*              own task, at the priority configured for it, on the signal of
+*              its interrupt. The blocks it reads are taken from its own set
+*              of buffers, and only their pointers are queued to the
+*              transmit task, which hands them back once the data is
+*              transmitted or queued. The latency of each block, from the
+*              sensor signal to its transmission, is measured per channel.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "config.h"
+#include "pipeline.h"
+
+#if RTOS_PIPELINE_ENABLE == 1
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "stream_record.h"
+#include "timebase.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Blocks queued to the transmit task, from all the sensors */
+#define PIPELINE_READY_SIZE     (STREAM_CHANNEL_COUNT * PIPELINE_BUFFER_COUNT)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Task reading a sensor */
+typedef struct
+{
+    pipeline_sensor_t sensor;
+    TaskHandle_t task;
+    QueueHandle_t free;         /* Blocks handed back by the transmit task */
+    pipeline_block_t blocks[PIPELINE_BUFFER_COUNT];
+
+    /* Written by the sensor interrupt */
+    volatile uint32_t signal_time;
+    volatile bool early;        /* Signalled before the scheduler started */
+
+    /* Written by the sensor task */
+    uint32_t dropped;
+
+    /* Written by the transmit task */
+    uint32_t latency_max;
+    uint32_t late;
+} pipeline_channel_t;
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+static pipeline_channel_t pipeline_channel[STREAM_CHANNEL_COUNT];
+static QueueHandle_t pipeline_ready;
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static void pipeline_sensor_task(void *arg);
+
+/*******************************************************************************
+* Function Name: pipeline_add_sensor
+********************************************************************************
+* Summary:
+*   Creates the task reading a sensor, and the queue of its free blocks.
+*   Called from main, before the scheduler is started.
+*
+* Parameters:
+*   sensor: sensor to read, copied
+*
+* Return:
+*     The status of the creation.
+*
+*******************************************************************************/
+cy_rslt_t pipeline_add_sensor(const pipeline_sensor_t *sensor)
+{
+    pipeline_channel_t *channel = &pipeline_channel[sensor->channel % STREAM_CHANNEL_COUNT];
+    uint32_t stride = (sensor->block_size + 3u) & ~3u;
+
+    if (NULL == pipeline_ready)
+    {
+        pipeline_ready = xQueueCreate(PIPELINE_READY_SIZE, sizeof(pipeline_block_t *));
+    }
+    channel->free = xQueueCreate(PIPELINE_BUFFER_COUNT, sizeof(pipeline_block_t *));
+    if ((NULL == pipeline_ready) || (NULL == channel->free))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    channel->sensor = *sensor;
+    for (uint32_t index = 0; index < PIPELINE_BUFFER_COUNT; index++)
+    {
+        pipeline_block_t *block = &channel->blocks[index];
+
+        block->channel = sensor->channel;
+        block->data = &sensor->storage[index * stride];
+        xQueueSend(channel->free, &block, 0);
+    }
+
+    if (pdPASS != xTaskCreate(pipeline_sensor_task, "sensor", PIPELINE_TASK_STACK_SIZE,
+                              channel, sensor->priority, &channel->task))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: pipeline_start
+********************************************************************************
+* Summary:
+*   Creates the transmit task, below the priority of all the sensor tasks, and
+*   starts the scheduler. Does not return.
+*
+* Parameters:
+*   transmit: function of the transmit task
+*   arg: passed to the function
+*
+*******************************************************************************/
+void pipeline_start(void (*transmit)(void *arg), void *arg)
+{
+    if (pdPASS != xTaskCreate(transmit, "transmit", PIPELINE_TASK_STACK_SIZE, arg,
+                              PIPELINE_TRANSMIT_PRIORITY, NULL))
+    {
+        CY_ASSERT(0);
+    }
+
+    vTaskStartScheduler();
+
+    /* Not enough memory for the idle task */
+    CY_ASSERT(0);
+}
+
+/*******************************************************************************
+* Function Name: pipeline_notify_from_isr
+********************************************************************************
+* Summary:
+*   Wakes the task of a sensor once its data is ready, in place of the flag
+*   checked by the main loop. Called from the sensor interrupt, which must not
+*   be above configMAX_SYSCALL_INTERRUPT_PRIORITY.
+*
+* Parameters:
+*   channel: STREAM_CHANNEL_x of the sensor
+*
+*******************************************************************************/
+void pipeline_notify_from_isr(uint8_t channel)
+{
+    pipeline_channel_t *state = &pipeline_channel[channel % STREAM_CHANNEL_COUNT];
+    BaseType_t woken = pdFALSE;
+
+    state->signal_time = timebase_now_us();
+
+    /* The sensors are started before their tasks are created; their first
+     * signal is handled once the task starts */
+    if (NULL == state->task)
+    {
+        state->early = true;
+        return;
+    }
+
+    vTaskNotifyGiveFromISR(state->task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/*******************************************************************************
+* Function Name: pipeline_receive
+********************************************************************************
+* Summary:
+*   Takes the oldest block read by the sensor tasks. Transmit task only.
+*
+* Parameters:
+*   block: set to the block, to be released once transmitted
+*   timeout_ms: time to wait for a block, in milliseconds
+*
+* Return:
+*   false if no block was read before the timeout.
+*
+*******************************************************************************/
+bool pipeline_receive(pipeline_block_t **block, uint32_t timeout_ms)
+{
+    return (pdTRUE == xQueueReceive(pipeline_ready, block, pdMS_TO_TICKS(timeout_ms)));
+}
+
+/*******************************************************************************
+* Function Name: pipeline_release
+********************************************************************************
+* Summary:
+*   Measures the latency of a block transmitted or queued, and hands it back
+*   to its sensor task. Transmit task only.
+*
+* Parameters:
+*   block: block received
+*
+*******************************************************************************/
+void pipeline_release(pipeline_block_t *block)
+{
+    pipeline_channel_t *channel = &pipeline_channel[block->channel % STREAM_CHANNEL_COUNT];
+    uint32_t latency = timebase_now_us() - block->time;
+
+    if (latency > channel->latency_max)
+    {
+        channel->latency_max = latency;
+    }
+    if (latency > channel->sensor.deadline_us)
+    {
+        channel->late++;
+    }
+
+    xQueueSend(channel->free, &block, 0);
+}
+
+/*******************************************************************************
+* Function Name: pipeline_latency_max_us
+********************************************************************************
+* Summary:
+*   Returns the largest latency of the blocks of a channel, from the sensor
+*   signal to the transmission, in microseconds.
+*
+*******************************************************************************/
+uint32_t pipeline_latency_max_us(uint8_t channel)
+{
+    return pipeline_channel[channel % STREAM_CHANNEL_COUNT].latency_max;
+}
+
+/*******************************************************************************
+* Function Name: pipeline_late
+********************************************************************************
+* Summary:
+*   Returns the number of blocks of a channel transmitted after the deadline
+*   of the sensor.
+*
+*******************************************************************************/
+uint32_t pipeline_late(uint8_t channel)
+{
+    return pipeline_channel[channel % STREAM_CHANNEL_COUNT].late;
+}
+
+/*******************************************************************************
+* Function Name: pipeline_dropped
+********************************************************************************
+* Summary:
+*   Returns the number of blocks of a channel dropped because all its buffers
+*   were waiting for the transmit task.
+*
+*******************************************************************************/
+uint32_t pipeline_dropped(uint8_t channel)
+{
+    return pipeline_channel[channel % STREAM_CHANNEL_COUNT].dropped;
+}
+
+/*******************************************************************************
+* Function Name: pipeline_sensor_task
+********************************************************************************
+* Summary:
+*   Reads the sensor on each signal. The task always holds a block to read
+*   into, and queues it once a free one can take its place; otherwise the
+*   data read is dropped, so the sensor keeps running.
+*
+* Parameters:
+*   arg: channel of the sensor
+*
+*******************************************************************************/
+static void pipeline_sensor_task(void *arg)
+{
+    pipeline_channel_t *channel = arg;
+    pipeline_block_t *block;
+    pipeline_block_t *next;
+
+    xQueueReceive(channel->free, &block, portMAX_DELAY);
+
+    for (;;)
+    {
+        if (true == channel->early)
+        {
+            channel->early = false;
+        }
+        else
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+
+        block->time = channel->signal_time;
+        block->size = channel->sensor.read(block->data);
+        if (0u == block->size)
+        {
+            continue;
+        }
+
+        if (pdTRUE == xQueueReceive(channel->free, &next, 0))
+        {
+            xQueueSend(pipeline_ready, &block, 0);
+            block = next;
+        }
+        else
+        {
+            channel->dropped++;
+        }
+    }
+}
+
+#endif /* RTOS_PIPELINE_ENABLE == 1 */
+
+/* [] END OF FILE */
@@ -0,0 +1,110 @@
+/******************************************************************************
+* File Name:   pipeline.h
+*
+* Description: This file contains the sensor and block formats and function
+*   prototypes used in pipeline.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SOURCE_PIPELINE_H_
+#define SOURCE_PIPELINE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cyhal.h"
+#include "config.h"
+
+/******************************************************************************
+ * Constants
+ *****************************************************************************/
+/* Storage of the blocks of a sensor task, in bytes. Each block starts on 4
+ * bytes, so it can be read as float or int16 values. */
+#define PIPELINE_STORAGE_SIZE(block_size) \
+    (PIPELINE_BUFFER_COUNT * (((block_size) + 3u) & ~3u))
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Block of data collected by a sensor task. Only its pointer is queued to the
+ * transmit task, which hands it back once the data is transmitted or
+ * queued. */
+typedef struct
+{
+    uint8_t  channel;           /* STREAM_CHANNEL_x */
+    uint32_t size;              /* Bytes of data */
+    uint32_t time;              /* Time the sensor signalled the data, in
+                                 * microseconds */
+    uint8_t *data;
+} pipeline_block_t;
+
+/* Clears the flag of the sensor and reads the data it signalled into data.
+ * Returns the size of the data, 0 if there is none. */
+typedef uint32_t (*pipeline_read_t)(uint8_t *data);
+
+/* Sensor read by its own task */
+typedef struct
+{
+    uint8_t  channel;           /* STREAM_CHANNEL_x */
+    uint32_t priority;          /* FreeRTOS priority of the task */
+    uint32_t block_size;        /* Largest block read, in bytes */
+    uint32_t deadline_us;       /* Latency from the sensor signal to the
+                                 * transmission above which a block is late */
+    pipeline_read_t read;
+    uint8_t *storage;           /* PIPELINE_STORAGE_SIZE(block_size) bytes,
+                                 * aligned on 4 bytes */
+} pipeline_sensor_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+#if RTOS_PIPELINE_ENABLE == 1
+cy_rslt_t pipeline_add_sensor(const pipeline_sensor_t *sensor);
+void pipeline_start(void (*transmit)(void *arg), void *arg);
+void pipeline_notify_from_isr(uint8_t channel);
+bool pipeline_receive(pipeline_block_t **block, uint32_t timeout_ms);
+void pipeline_release(pipeline_block_t *block);
+uint32_t pipeline_latency_max_us(uint8_t channel);
+uint32_t pipeline_late(uint8_t channel);
+uint32_t pipeline_dropped(uint8_t channel);
+#else
+/* The sensors are read from the main loop, on their flags */
+#define pipeline_notify_from_isr(channel)
+#endif
+
+
+#endif /* SOURCE_PIPELINE_H_ */
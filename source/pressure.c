@@ -45,24 +45,89 @@
 #include "config.h"
 #include "xensiv_dps3xx_mtb.h"
 #include "pressure.h"
+#include "i2c_bus.h"
+#include "pipeline.h"
+#include "stream_record.h"
+#include "timebase.h"
 
 /*******************************************************************************
 * Macros
 *******************************************************************************/
 xensiv_dps3xx_t pressure_sensor;
 xensiv_dps3xx_config_t config;
-#define DPS_SCAN_RATE       50
 #define DPS_TIMER_FREQUENCY 100000
 #define DPS_TIMER_PERIOD (DPS_TIMER_FREQUENCY/DPS_SCAN_RATE)
 #define DPS_TIMER_PRIORITY  3
-cyhal_i2c_t i2c_obj;
 cyhal_timer_t dps_timer;
 
+/* The result registers are read without blocking and compensated with the
+ * calibration coefficients, read once at start-up */
+#if SENSOR_ASYNC_READ_ENABLE == 1
+#define DPS_ASYNC_READ      1
+#else
+#define DPS_ASYNC_READ      0
+#endif
+
+/* Pressure and temperature results, 24 bits big endian each */
+#define DPS_DATA_REGISTER   (0x00u)
+#define DPS_DATA_SIZE       (6u)
+
+/* Calibration coefficients */
+#define DPS_COEF_REGISTER   (0x10u)
+#define DPS_COEF_SIZE       (18u)
+
+#define DPS_I2C_TIMEOUT_MS  (10u)
+
+/* The registers are read before the next period */
+#define DPS_READ_DEADLINE_US    (1000000u / DPS_SCAN_RATE)
+
+#if DPS_ASYNC_READ == 1
+/* Calibration coefficients and scale factors of the raw results */
+typedef struct
+{
+    float c0, c1;
+    float c00, c10, c01, c11, c20, c21, c30;
+    float pressure_scale;
+    float temperature_scale;
+} dps_calibration_t;
+
+/* Scale factor of the raw results for each oversampling rate (1 to 128) */
+static const float dps_scale_factors[] =
+{
+    524288.0f, 1572864.0f, 3670016.0f, 7864320.0f,
+    253952.0f, 516096.0f, 1040384.0f, 2088960.0f
+};
+
+static dps_calibration_t dps_calibration;
+
+/* Register address sent and result registers received by the transaction
+ * queued at each period, due by the next period. The buffer is busy from the
+ * start of the transaction until its data is compensated. */
+static const uint8_t dps_read_register = DPS_DATA_REGISTER;
+static uint8_t dps_read_buffer[DPS_DATA_SIZE];
+static volatile bool dps_read_busy;
+static void dps_read_done(void *arg, bool success);
+static i2c_bus_transaction_t dps_read_transaction =
+{
+    .address = XENSIV_DPS3XX_I2C_ADDR_DEFAULT,
+    .tx_size = 1,
+    .rx_size = DPS_DATA_SIZE,
+    .tx = &dps_read_register,
+    .rx = dps_read_buffer,
+    .batch = true,
+    .done = dps_read_done,
+};
+#endif
+
 /*******************************************************************************
 * Local Function Prototypes
 *******************************************************************************/
 void dps_interrupt_handler(void* callback_arg, cyhal_timer_event_t event);
 cy_rslt_t dps_timer_init(void);
+#if DPS_ASYNC_READ == 1
+static cy_rslt_t dps_read_calibration(void);
+static int32_t dps_signed(uint32_t value, uint32_t bits);
+#endif
 
 /*******************************************************************************
 * Function Name: DPS_init
@@ -81,25 +146,17 @@ cy_rslt_t dps_timer_init(void);
 cy_rslt_t DPS_init(void)
 {
     cy_rslt_t result;
-    cyhal_i2c_cfg_t i2c_cfg = {
-        .is_slave = false,
-        .address = 0,
-        .frequencyhal_hz = 1000000,
-    };
-    /* Initialize I2C for pressure sensor */
-    result = cyhal_i2c_init(&i2c_obj, CYBSP_I2C_SDA, CYBSP_I2C_SCL, NULL);
-    if (result != CY_RSLT_SUCCESS)
-    {
-        CY_ASSERT(0);
-    }
-    result = cyhal_i2c_configure(&i2c_obj, &i2c_cfg);
+    /* Initialize the I2C bus shared by the sensors, and hold its queue while
+     * the driver uses it */
+    result = i2c_bus_init();
     if (result != CY_RSLT_SUCCESS)
     {
         CY_ASSERT(0);
     }
+    i2c_bus_lock();
 
     /* Initialize pressure sensor */
-    result = xensiv_dps3xx_mtb_init_i2c(&pressure_sensor, &i2c_obj, XENSIV_DPS3XX_I2C_ADDR_DEFAULT);
+    result = xensiv_dps3xx_mtb_init_i2c(&pressure_sensor, i2c_bus_get(), XENSIV_DPS3XX_I2C_ADDR_DEFAULT);
     if (result != CY_RSLT_SUCCESS)
     {
         CY_ASSERT(0);
@@ -114,6 +171,19 @@ cy_rslt_t DPS_init(void)
     result = xensiv_dps3xx_set_config(&pressure_sensor,&config);
 
     DPS_flag = false;
+
+#if DPS_ASYNC_READ == 1
+    /* The result registers are now read by transactions queued from the
+     * timer interrupt */
+    result = dps_read_calibration();
+    if(CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+    dps_read_busy = false;
+#endif
+    i2c_bus_unlock();
+
     /* Timer for data collection */
     result = dps_timer_init();
     if(CY_RSLT_SUCCESS != result)
@@ -188,7 +258,10 @@ cy_rslt_t dps_timer_init(void)
 ********************************************************************************
 * Summary:
 *   Interrupt handler for timer. Interrupt handler will get called at 50Hz and
-*   sets a flag that can be checked in main.
+*   sets a flag that can be checked in main. With DPS_ASYNC_READ, it queues
+*   the read of the result registers on the I2C bus instead, and the flag is
+*   set once they are read. A period is skipped while the previous data has not been
+*   compensated.
 *
 * Parameters:
 *     callback_arg: not used
@@ -201,13 +274,115 @@ void dps_interrupt_handler(void *callback_arg, cyhal_timer_event_t event)
     (void) callback_arg;
     (void) event;
 
+#if DPS_ASYNC_READ == 1
+    if(false == dps_read_busy)
+    {
+        dps_read_busy = true;
+        dps_read_transaction.deadline = timebase_now_us() + DPS_READ_DEADLINE_US;
+        if(false == i2c_bus_submit(&dps_read_transaction))
+        {
+            dps_read_busy = false;
+        }
+    }
+#else
     DPS_flag = true;
+    pipeline_notify_from_isr(STREAM_CHANNEL_DPS);
+#endif
 }
+
+#if DPS_ASYNC_READ == 1
+/*******************************************************************************
+* Function Name: dps_read_done
+********************************************************************************
+* Summary:
+*   Completion handler of the read of the result registers. Sets the flag
+*   checked in main, or releases the buffer if the read failed.
+*
+* Parameters:
+*     arg: not used
+*     success: false if the read failed
+*
+*
+*******************************************************************************/
+static void dps_read_done(void *arg, bool success)
+{
+    (void) arg;
+
+    if(true == success)
+    {
+        DPS_flag = true;
+        pipeline_notify_from_isr(STREAM_CHANNEL_DPS);
+    }
+    else
+    {
+        dps_read_busy = false;
+    }
+}
+
+/*******************************************************************************
+* Function Name: dps_read_calibration
+********************************************************************************
+* Summary:
+*   Reads the calibration coefficients of the sensor, and the scale factors of
+*   the oversampling rates configured. Called with the queue of the bus held.
+*
+* Return:
+*     The status of the read.
+*
+*******************************************************************************/
+static cy_rslt_t dps_read_calibration(void)
+{
+    uint8_t coef[DPS_COEF_SIZE];
+    cy_rslt_t result;
+
+    result = cyhal_i2c_master_mem_read(i2c_bus_get(), XENSIV_DPS3XX_I2C_ADDR_DEFAULT,
+                                       DPS_COEF_REGISTER, 1, coef, DPS_COEF_SIZE,
+                                       DPS_I2C_TIMEOUT_MS);
+    if(CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    /* c0 and c1 are 12 bits, c00 and c10 20 bits, the others 16 bits */
+    dps_calibration.c0  = (float)dps_signed(((uint32_t)coef[0] << 4) | (coef[1] >> 4), 12);
+    dps_calibration.c1  = (float)dps_signed(((uint32_t)(coef[1] & 0x0Fu) << 8) | coef[2], 12);
+    dps_calibration.c00 = (float)dps_signed(((uint32_t)coef[3] << 12) | ((uint32_t)coef[4] << 4) |
+                                            (coef[5] >> 4), 20);
+    dps_calibration.c10 = (float)dps_signed(((uint32_t)(coef[5] & 0x0Fu) << 16) |
+                                            ((uint32_t)coef[6] << 8) | coef[7], 20);
+    dps_calibration.c01 = (float)dps_signed(((uint32_t)coef[8] << 8) | coef[9], 16);
+    dps_calibration.c11 = (float)dps_signed(((uint32_t)coef[10] << 8) | coef[11], 16);
+    dps_calibration.c20 = (float)dps_signed(((uint32_t)coef[12] << 8) | coef[13], 16);
+    dps_calibration.c21 = (float)dps_signed(((uint32_t)coef[14] << 8) | coef[15], 16);
+    dps_calibration.c30 = (float)dps_signed(((uint32_t)coef[16] << 8) | coef[17], 16);
+
+    dps_calibration.pressure_scale = dps_scale_factors[config.pressure_oversample & 0x07u];
+    dps_calibration.temperature_scale = dps_scale_factors[config.temperature_oversample & 0x07u];
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: dps_signed
+********************************************************************************
+* Summary:
+*   Sign extends a two's complement value of the given number of bits.
+*
+*******************************************************************************/
+static int32_t dps_signed(uint32_t value, uint32_t bits)
+{
+    uint32_t sign = 1u << (bits - 1u);
+
+    return (int32_t)((value ^ sign) - sign);
+}
+#endif
 /*******************************************************************************
 * Function Name: dps_get_data
 ********************************************************************************
 * Summary:
-*   Reads data from the Pressure sensor and stores it in a buffer.
+*   Reads data from the Pressure sensor and stores it in a buffer. With
+*   DPS_ASYNC_READ, the result registers have already been read and are only
+*   compensated (pressure in hPa, temperature in degrees Celsius).
 *
 * Parameters:
 *     DPS_data: Stores Pressure sensor data
@@ -219,7 +394,25 @@ int8 dps_get_data(float *DPS_data)
     int8 result = 0;
     float pressure;
     float temperature;
+#if DPS_ASYNC_READ == 1
+    const dps_calibration_t *cal = &dps_calibration;
+    float raw_pressure = (float)dps_signed(((uint32_t)dps_read_buffer[0] << 16) |
+                                           ((uint32_t)dps_read_buffer[1] << 8) |
+                                           dps_read_buffer[2], 24) / cal->pressure_scale;
+    float raw_temperature = (float)dps_signed(((uint32_t)dps_read_buffer[3] << 16) |
+                                              ((uint32_t)dps_read_buffer[4] << 8) |
+                                              dps_read_buffer[5], 24) / cal->temperature_scale;
+    dps_read_busy = false;
+
+    temperature = cal->c0 * 0.5f + cal->c1 * raw_temperature;
+    pressure = (cal->c00 +
+                raw_pressure * (cal->c10 + raw_pressure * (cal->c20 + raw_pressure * cal->c30)) +
+                raw_temperature * cal->c01 +
+                raw_temperature * raw_pressure * (cal->c11 + raw_pressure * cal->c21)) / 100.0f;
+    result = CY_RSLT_SUCCESS;
+#else
     result=xensiv_dps3xx_read(&pressure_sensor, &pressure, &temperature);
+#endif
     if (CY_RSLT_SUCCESS == result)
     {
 
@@ -43,6 +43,13 @@
 #ifndef PRESSURE_H_
 #define PRESSURE_H_
 
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Rate at which the pressure sensor is sampled, in Hz */
+#define DPS_SCAN_RATE       50
+
+
 /******************************************************************************
  * Global Variables
  *****************************************************************************/
@@ -46,9 +46,13 @@
 #include "cyhal.h"
 #include "cybsp.h"
 #include <stdlib.h>
+#include <string.h>
 #include "cy_pdl.h"
 #include "xensiv_bgt60trxx_mtb.h"
 #include "radar_settings.h"
+#include "dsp.h"
+#include "pipeline.h"
+#include "stream_record.h"
 
 /*******************************************************************************
 * Macros
@@ -62,11 +66,30 @@
 
 #define NUM_CHIRPS_PER_FRAME                XENSIV_BGT60TRXX_CONF_NUM_CHIRPS_PER_FRAME
 #define NUM_SAMPLES_PER_CHIRP               XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP
-#define RADAR_SCAN_RATE       50
 #define RADAR_TIMER_FREQUENCY 100000
 #define RADAR_TIMER_PERIOD (RADAR_TIMER_FREQUENCY/RADAR_SCAN_RATE)
 #define RADAR_TIMER_PRIORITY  3
 
+/* The BGT60 ADC delivers 12 bit samples, scale them up to Q15 */
+#define RADAR_ADC_TO_Q15_SHIFT  3
+
+/* Extra precision bits of the clutter map */
+#define RADAR_CLUTTER_FRACTION_BITS 8
+
+#if (NUM_SAMPLES_PER_CHIRP != RADAR_NUM_SAMPLES_PER_CHIRP) || \
+    (NUM_CHIRPS_PER_FRAME != RADAR_NUM_CHIRPS_PER_FRAME)
+#error "radar.h frame geometry does not match radar_settings.h"
+#endif
+
+#if RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_DOPPLER
+#if (RADAR_RD_RANGE_BIN_START + RADAR_RD_RANGE_BIN_COUNT) > RADAR_NUM_RANGE_BINS
+#error "Range-Doppler crop exceeds the number of range bins"
+#endif
+#if RADAR_RD_DOPPLER_BIN_COUNT > RADAR_NUM_CHIRPS_PER_FRAME
+#error "Range-Doppler crop exceeds the number of Doppler bins"
+#endif
+#endif
+
 /*******************************************************************************
 * Global Variables
 *******************************************************************************/
@@ -79,11 +102,46 @@ static xensiv_bgt60trxx_mtb_t bgt60_obj;
 #endif
 uint16_t bgt60_buffer[NUM_SAMPLES_PER_FRAME] __attribute__((aligned(2)));
 
+#if RADAR_OUTPUT_MODE != RADAR_OUTPUT_RAW
+/* Range FFT stage */
+static dsp_rfft_t range_fft;
+static int16_t range_window[NUM_SAMPLES_PER_CHIRP];
+static int16_t chirp_buffer[NUM_SAMPLES_PER_CHIRP];
+static int16_t range_spectrum[2 * NUM_SAMPLES_PER_CHIRP];
+#endif
+
+#if (RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_FFT) && RADAR_RANGE_AVERAGE_CHIRPS
+static int16_t range_magnitude[RADAR_NUM_RANGE_BINS];
+static int32_t range_accumulator[RADAR_NUM_RANGE_BINS];
+#endif
+
+#if RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_DOPPLER
+/* Doppler FFT stage. The range spectra of all chirps are stored in place in
+ * bgt60_buffer, so only one range bin column is buffered at a time. */
+static dsp_cfft_t doppler_fft;
+static int16_t doppler_window[NUM_CHIRPS_PER_FRAME];
+static int16_t doppler_buffer[2 * NUM_CHIRPS_PER_FRAME];
+static int16_t doppler_magnitude[NUM_CHIRPS_PER_FRAME];
+#if RADAR_MTI_MODE == RADAR_MTI_CLUTTER_MAP
+static int32_t clutter_map[2 * RADAR_RD_RANGE_BIN_COUNT];
+#endif
+#endif
+
 /*******************************************************************************
 * Local Function Prototypes
 *******************************************************************************/
 void radar_interrupt_handler(void* callback_arg, cyhal_timer_event_t event);
 cy_rslt_t radar_timer_init(void);
+#if RADAR_OUTPUT_MODE != RADAR_OUTPUT_RAW
+static cy_rslt_t radar_dsp_init(void);
+static void radar_chirp_spectrum(const uint16_t *samples);
+#endif
+#if RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_FFT
+static void radar_range_fft(const uint16_t *frame, int16_t *range_data);
+#endif
+#if RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_DOPPLER
+static void radar_range_doppler(uint16_t *frame, int16_t *map_data);
+#endif
 
 /*******************************************************************************
 * Function Name: radar_init
@@ -141,6 +199,13 @@ cy_rslt_t radar_init(void)
             printf("ERROR: xensiv_bgt60trxx_mtb_init failed\n");
             return -1;
         }
+#if RADAR_OUTPUT_MODE != RADAR_OUTPUT_RAW
+        result = radar_dsp_init();
+        if(CY_RSLT_SUCCESS != result)
+        {
+            return result;
+        }
+#endif
         radar_flag = false;
         result = radar_timer_init();
         if(CY_RSLT_SUCCESS != result)
@@ -234,13 +299,16 @@ void radar_interrupt_handler(void *callback_arg, cyhal_timer_event_t event)
     (void) event;
 
     radar_flag = true;
+    pipeline_notify_from_isr(STREAM_CHANNEL_RADAR);
 }
 
 /*******************************************************************************
-* Function Name: radar_feed
+* Function Name: radar_get_data
 ********************************************************************************
 * Summary:
-*   Reads data from the radar sensor and stores it in a buffer.
+*   Reads data from the radar sensor and stores it in a buffer. Depending on
+*   RADAR_OUTPUT_MODE the buffer receives the raw samples of the first chirp,
+*   the range profile of the frame or its cropped range-Doppler map.
 *
 * Parameters:
 *     radar_data: Stores RADAR sensor data
@@ -254,11 +322,210 @@ void radar_get_data(int16_t *radar_data)
     result = xensiv_bgt60trxx_get_fifo_data(&bgt60_obj.dev,bgt60_buffer,NUM_SAMPLES_PER_FRAME);
     if (CY_RSLT_SUCCESS == result)
     {
+#if RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_FFT
+        radar_range_fft(bgt60_buffer, radar_data);
+#elif RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_DOPPLER
+        radar_range_doppler(bgt60_buffer, radar_data);
+#else
         for(uint32_t i =0;i< 128; i++)
         {
             radar_data[i] = bgt60_buffer[i];
         }
+#endif
+    }
+
+#endif
+}
+
+#if RADAR_OUTPUT_MODE != RADAR_OUTPUT_RAW
+/*******************************************************************************
+* Function Name: radar_dsp_init
+********************************************************************************
+* Summary:
+*   Prepares the windows and FFT instances used by the range and Doppler
+*   stages.
+*
+* Returns:
+*   The status of the initialization.
+*
+*******************************************************************************/
+static cy_rslt_t radar_dsp_init(void)
+{
+    if (!dsp_rfft_init(&range_fft, NUM_SAMPLES_PER_CHIRP))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+    dsp_hann_window_q15(range_window, NUM_SAMPLES_PER_CHIRP);
+
+#if RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_DOPPLER
+    if (!dsp_cfft_init(&doppler_fft, NUM_CHIRPS_PER_FRAME))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+    dsp_hann_window_q15(doppler_window, NUM_CHIRPS_PER_FRAME);
+#if RADAR_MTI_MODE == RADAR_MTI_CLUTTER_MAP
+    memset(clutter_map, 0, sizeof(clutter_map));
+#endif
+#endif
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: radar_chirp_spectrum
+********************************************************************************
+* Summary:
+*   Removes the DC offset of one chirp, applies the range window and computes
+*   its spectrum into range_spectrum.
+*
+* Parameters:
+*     samples: ADC samples of the chirp
+*
+*******************************************************************************/
+static void radar_chirp_spectrum(const uint16_t *samples)
+{
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < NUM_SAMPLES_PER_CHIRP; i++)
+    {
+        sum += samples[i];
+    }
+    int32_t mean = (int32_t)(sum / NUM_SAMPLES_PER_CHIRP);
+
+    for (uint32_t i = 0; i < NUM_SAMPLES_PER_CHIRP; i++)
+    {
+        chirp_buffer[i] = (int16_t)(((int32_t)samples[i] - mean) * (1 << RADAR_ADC_TO_Q15_SHIFT));
+    }
+
+    dsp_mult_q15(chirp_buffer, range_window, chirp_buffer, NUM_SAMPLES_PER_CHIRP);
+    dsp_rfft_q15(&range_fft, chirp_buffer, range_spectrum);
+}
+#endif /* RADAR_OUTPUT_MODE != RADAR_OUTPUT_RAW */
+
+#if RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_FFT
+/*******************************************************************************
+* Function Name: radar_range_fft
+********************************************************************************
+* Summary:
+*   Converts a frame of ADC samples into range profiles, keeping the magnitude
+*   of the first half of each chirp spectrum. The profiles are either averaged
+*   over all chirps or stored one after the other.
+*
+* Parameters:
+*     frame: ADC samples of one frame, chirp after chirp
+*     range_data: Stores the range bins in Q2.14 format
+*
+*******************************************************************************/
+static void radar_range_fft(const uint16_t *frame, int16_t *range_data)
+{
+#if RADAR_RANGE_AVERAGE_CHIRPS
+    memset(range_accumulator, 0, sizeof(range_accumulator));
+#endif
+
+    for (uint32_t chirp = 0; chirp < NUM_CHIRPS_PER_FRAME; chirp++)
+    {
+        radar_chirp_spectrum(&frame[chirp * NUM_SAMPLES_PER_CHIRP]);
+
+#if RADAR_RANGE_AVERAGE_CHIRPS
+        dsp_cmplx_mag_q15(range_spectrum, range_magnitude, RADAR_NUM_RANGE_BINS);
+        for (uint32_t bin = 0; bin < RADAR_NUM_RANGE_BINS; bin++)
+        {
+            range_accumulator[bin] += range_magnitude[bin];
+        }
+#else
+        dsp_cmplx_mag_q15(range_spectrum, &range_data[chirp * RADAR_NUM_RANGE_BINS],
+                          RADAR_NUM_RANGE_BINS);
+#endif
     }
 
+#if RADAR_RANGE_AVERAGE_CHIRPS
+    for (uint32_t bin = 0; bin < RADAR_NUM_RANGE_BINS; bin++)
+    {
+        range_data[bin] = (int16_t)(range_accumulator[bin] / NUM_CHIRPS_PER_FRAME);
+    }
 #endif
 }
+#endif /* RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_FFT */
+
+#if RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_DOPPLER
+/*******************************************************************************
+* Function Name: radar_range_doppler
+********************************************************************************
+* Summary:
+*   Converts a frame of ADC samples into a range-Doppler map. The range spectrum
+*   of every chirp overwrites the chirp's samples in the frame buffer, so the
+*   frame is reused as a [chirp][range bin] complex matrix. For each range bin
+*   inside the crop window, static clutter is removed (RADAR_MTI_MODE), the
+*   column is windowed and transformed across chirps, and the magnitudes of the
+*   Doppler bins around zero velocity are kept.
+*
+* Parameters:
+*     frame: ADC samples of one frame, chirp after chirp. Overwritten.
+*     map_data: Stores RADAR_RD_RANGE_BIN_COUNT rows of
+*               RADAR_RD_DOPPLER_BIN_COUNT Doppler bins in Q2.14 format
+*
+*******************************************************************************/
+static void radar_range_doppler(uint16_t *frame, int16_t *map_data)
+{
+    int16_t *range_matrix = (int16_t *)frame;
+    const uint32_t doppler_start = (NUM_CHIRPS_PER_FRAME - RADAR_RD_DOPPLER_BIN_COUNT) / 2;
+
+    /* Range FFT of every chirp, stored in place. A chirp of N real samples
+     * occupies exactly the space of its N/2 complex range bins. */
+    for (uint32_t chirp = 0; chirp < NUM_CHIRPS_PER_FRAME; chirp++)
+    {
+        radar_chirp_spectrum(&frame[chirp * NUM_SAMPLES_PER_CHIRP]);
+        memcpy(&range_matrix[chirp * 2 * RADAR_NUM_RANGE_BINS], range_spectrum,
+               2 * RADAR_NUM_RANGE_BINS * sizeof(int16_t));
+    }
+
+    for (uint32_t row = 0; row < RADAR_RD_RANGE_BIN_COUNT; row++)
+    {
+        uint32_t bin = RADAR_RD_RANGE_BIN_START + row;
+        int32_t clutter_re = 0;
+        int32_t clutter_im = 0;
+
+#if RADAR_MTI_MODE != RADAR_MTI_NONE
+        /* Average over the chirps is the static part of this range bin */
+        int32_t sum_re = 0;
+        int32_t sum_im = 0;
+        for (uint32_t chirp = 0; chirp < NUM_CHIRPS_PER_FRAME; chirp++)
+        {
+            sum_re += range_matrix[2 * (chirp * RADAR_NUM_RANGE_BINS + bin)];
+            sum_im += range_matrix[2 * (chirp * RADAR_NUM_RANGE_BINS + bin) + 1];
+        }
+        clutter_re = sum_re / NUM_CHIRPS_PER_FRAME;
+        clutter_im = sum_im / NUM_CHIRPS_PER_FRAME;
+#endif
+#if RADAR_MTI_MODE == RADAR_MTI_CLUTTER_MAP
+        /* Slowly adapting clutter estimate across frames */
+        clutter_map[2 * row] += ((clutter_re * (1 << RADAR_CLUTTER_FRACTION_BITS)) - clutter_map[2 * row])
+                                >> RADAR_MTI_CLUTTER_ALPHA_SHIFT;
+        clutter_map[2 * row + 1] += ((clutter_im * (1 << RADAR_CLUTTER_FRACTION_BITS)) - clutter_map[2 * row + 1])
+                                    >> RADAR_MTI_CLUTTER_ALPHA_SHIFT;
+        clutter_re = clutter_map[2 * row] >> RADAR_CLUTTER_FRACTION_BITS;
+        clutter_im = clutter_map[2 * row + 1] >> RADAR_CLUTTER_FRACTION_BITS;
+#endif
+
+        for (uint32_t chirp = 0; chirp < NUM_CHIRPS_PER_FRAME; chirp++)
+        {
+            int32_t re = range_matrix[2 * (chirp * RADAR_NUM_RANGE_BINS + bin)] - clutter_re;
+            int32_t im = range_matrix[2 * (chirp * RADAR_NUM_RANGE_BINS + bin) + 1] - clutter_im;
+
+            doppler_buffer[2 * chirp]     = (int16_t)((re * doppler_window[chirp]) >> 15);
+            doppler_buffer[2 * chirp + 1] = (int16_t)((im * doppler_window[chirp]) >> 15);
+        }
+
+        dsp_cfft_q15(&doppler_fft, doppler_buffer);
+        dsp_cmplx_mag_q15(doppler_buffer, doppler_magnitude, NUM_CHIRPS_PER_FRAME);
+
+        /* Shift zero velocity to the center and crop */
+        for (uint32_t column = 0; column < RADAR_RD_DOPPLER_BIN_COUNT; column++)
+        {
+            uint32_t doppler_bin = (doppler_start + column + (NUM_CHIRPS_PER_FRAME / 2))
+                                   % NUM_CHIRPS_PER_FRAME;
+            map_data[row * RADAR_RD_DOPPLER_BIN_COUNT + column] = doppler_magnitude[doppler_bin];
+        }
+    }
+}
+#endif /* RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_DOPPLER */
@@ -46,6 +46,31 @@
 #include "cy_result.h"
 #include "stdbool.h"
 #include "resource_map.h"
+#include "config.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Frame geometry, must match radar_settings.h */
+#define RADAR_NUM_SAMPLES_PER_CHIRP     (128)
+#define RADAR_NUM_CHIRPS_PER_FRAME      (16)
+#define RADAR_NUM_RANGE_BINS            (RADAR_NUM_SAMPLES_PER_CHIRP / 2)
+
+/* Rate at which the radar frames are read, in Hz */
+#define RADAR_SCAN_RATE                 50
+
+/* Number of int16 values written by radar_get_data */
+#if RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_FFT
+#if RADAR_RANGE_AVERAGE_CHIRPS
+#define RADAR_DATA_SIZE                 (RADAR_NUM_RANGE_BINS)
+#else
+#define RADAR_DATA_SIZE                 (RADAR_NUM_RANGE_BINS * RADAR_NUM_CHIRPS_PER_FRAME)
+#endif
+#elif RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_DOPPLER
+#define RADAR_DATA_SIZE                 (RADAR_RD_RANGE_BIN_COUNT * RADAR_RD_DOPPLER_BIN_COUNT)
+#else
+#define RADAR_DATA_SIZE                 (150)
+#endif
 
 /******************************************************************************
  * Global Variables
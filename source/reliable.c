@@ -0,0 +1,406 @@
+/******************************************************************************
+* File Name:   reliable.c
+*
+* Description: This file implements the selective repeat retransmission of
+*              the streamed data. Each block is sent in a numbered frame that
+*              is kept in a pool, so the frames the host reports missing
+*              (NACK) can be sent again while they are still held.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "reliable.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+#define RELIABLE_CRC_INITIAL        (0xFFFFu)
+
+/* Retransmissions waiting, a power of two */
+#define RELIABLE_NACK_QUEUE_SIZE    (16u)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Frame held in the pool */
+typedef struct
+{
+    uint32_t offset;            /* Position in the pool */
+    uint32_t size;              /* Frame size, header included, 0 if not held */
+    uint16_t sequence;
+} reliable_slot_t;
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+static uint8_t *reliable_pool;
+static uint32_t reliable_pool_size;
+static uint32_t reliable_pool_head;
+
+/* Frames held, indexed by sequence number */
+static reliable_slot_t reliable_slot[RELIABLE_WINDOW];
+static uint16_t reliable_sequence;
+
+/* Sequence numbers to send again */
+static uint16_t reliable_queue[RELIABLE_NACK_QUEUE_SIZE];
+static uint32_t reliable_queue_head;
+static uint32_t reliable_queue_tail;
+
+/* Frame sent in place of one that is no longer held */
+static uint8_t reliable_lost[RELIABLE_FRAME_HEADER_SIZE];
+
+/* CRC-16 of each byte value, polynomial 0x1021 */
+static const uint16_t reliable_crc_table[256] =
+{
+    0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+    0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu,
+    0x1231u, 0x0210u, 0x3273u, 0x2252u, 0x52B5u, 0x4294u, 0x72F7u, 0x62D6u,
+    0x9339u, 0x8318u, 0xB37Bu, 0xA35Au, 0xD3BDu, 0xC39Cu, 0xF3FFu, 0xE3DEu,
+    0x2462u, 0x3443u, 0x0420u, 0x1401u, 0x64E6u, 0x74C7u, 0x44A4u, 0x5485u,
+    0xA56Au, 0xB54Bu, 0x8528u, 0x9509u, 0xE5EEu, 0xF5CFu, 0xC5ACu, 0xD58Du,
+    0x3653u, 0x2672u, 0x1611u, 0x0630u, 0x76D7u, 0x66F6u, 0x5695u, 0x46B4u,
+    0xB75Bu, 0xA77Au, 0x9719u, 0x8738u, 0xF7DFu, 0xE7FEu, 0xD79Du, 0xC7BCu,
+    0x48C4u, 0x58E5u, 0x6886u, 0x78A7u, 0x0840u, 0x1861u, 0x2802u, 0x3823u,
+    0xC9CCu, 0xD9EDu, 0xE98Eu, 0xF9AFu, 0x8948u, 0x9969u, 0xA90Au, 0xB92Bu,
+    0x5AF5u, 0x4AD4u, 0x7AB7u, 0x6A96u, 0x1A71u, 0x0A50u, 0x3A33u, 0x2A12u,
+    0xDBFDu, 0xCBDCu, 0xFBBFu, 0xEB9Eu, 0x9B79u, 0x8B58u, 0xBB3Bu, 0xAB1Au,
+    0x6CA6u, 0x7C87u, 0x4CE4u, 0x5CC5u, 0x2C22u, 0x3C03u, 0x0C60u, 0x1C41u,
+    0xEDAEu, 0xFD8Fu, 0xCDECu, 0xDDCDu, 0xAD2Au, 0xBD0Bu, 0x8D68u, 0x9D49u,
+    0x7E97u, 0x6EB6u, 0x5ED5u, 0x4EF4u, 0x3E13u, 0x2E32u, 0x1E51u, 0x0E70u,
+    0xFF9Fu, 0xEFBEu, 0xDFDDu, 0xCFFCu, 0xBF1Bu, 0xAF3Au, 0x9F59u, 0x8F78u,
+    0x9188u, 0x81A9u, 0xB1CAu, 0xA1EBu, 0xD10Cu, 0xC12Du, 0xF14Eu, 0xE16Fu,
+    0x1080u, 0x00A1u, 0x30C2u, 0x20E3u, 0x5004u, 0x4025u, 0x7046u, 0x6067u,
+    0x83B9u, 0x9398u, 0xA3FBu, 0xB3DAu, 0xC33Du, 0xD31Cu, 0xE37Fu, 0xF35Eu,
+    0x02B1u, 0x1290u, 0x22F3u, 0x32D2u, 0x4235u, 0x5214u, 0x6277u, 0x7256u,
+    0xB5EAu, 0xA5CBu, 0x95A8u, 0x8589u, 0xF56Eu, 0xE54Fu, 0xD52Cu, 0xC50Du,
+    0x34E2u, 0x24C3u, 0x14A0u, 0x0481u, 0x7466u, 0x6447u, 0x5424u, 0x4405u,
+    0xA7DBu, 0xB7FAu, 0x8799u, 0x97B8u, 0xE75Fu, 0xF77Eu, 0xC71Du, 0xD73Cu,
+    0x26D3u, 0x36F2u, 0x0691u, 0x16B0u, 0x6657u, 0x7676u, 0x4615u, 0x5634u,
+    0xD94Cu, 0xC96Du, 0xF90Eu, 0xE92Fu, 0x99C8u, 0x89E9u, 0xB98Au, 0xA9ABu,
+    0x5844u, 0x4865u, 0x7806u, 0x6827u, 0x18C0u, 0x08E1u, 0x3882u, 0x28A3u,
+    0xCB7Du, 0xDB5Cu, 0xEB3Fu, 0xFB1Eu, 0x8BF9u, 0x9BD8u, 0xABBBu, 0xBB9Au,
+    0x4A75u, 0x5A54u, 0x6A37u, 0x7A16u, 0x0AF1u, 0x1AD0u, 0x2AB3u, 0x3A92u,
+    0xFD2Eu, 0xED0Fu, 0xDD6Cu, 0xCD4Du, 0xBDAAu, 0xAD8Bu, 0x9DE8u, 0x8DC9u,
+    0x7C26u, 0x6C07u, 0x5C64u, 0x4C45u, 0x3CA2u, 0x2C83u, 0x1CE0u, 0x0CC1u,
+    0xEF1Fu, 0xFF3Eu, 0xCF5Du, 0xDF7Cu, 0xAF9Bu, 0xBFBAu, 0x8FD9u, 0x9FF8u,
+    0x6E17u, 0x7E36u, 0x4E55u, 0x5E74u, 0x2E93u, 0x3EB2u, 0x0ED1u, 0x1EF0u,
+};
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static void reliable_header(uint8_t *frame, uint16_t sequence, uint16_t length, uint8_t flags);
+static reliable_slot_t *reliable_held(uint16_t sequence);
+
+/*******************************************************************************
+* Function Name: reliable_init
+********************************************************************************
+* Summary:
+*    Sets up the pool holding the frames sent.
+*
+* Parameters:
+*   pool: memory holding the frames, larger than the largest frame
+*   pool_size: size of the pool in bytes
+*
+*******************************************************************************/
+void reliable_init(uint8_t *pool, uint32_t pool_size)
+{
+    reliable_pool = pool;
+    reliable_pool_size = pool_size;
+    reliable_pool_head = 0;
+    reliable_sequence = 0;
+    reliable_queue_head = 0;
+    reliable_queue_tail = 0;
+    memset(reliable_slot, 0, sizeof(reliable_slot));
+}
+
+/*******************************************************************************
+* Function Name: reliable_payload
+********************************************************************************
+* Summary:
+*    Returns where the payload of the next frame is placed in the pool, so
+*    that it can be gathered there before calling reliable_frame.
+*
+* Parameters:
+*   count: payload size in bytes
+*
+* Return:
+*     The payload of the next frame, NULL if it does not fit in the pool.
+*
+*******************************************************************************/
+uint8_t *reliable_payload(uint32_t count)
+{
+    uint32_t size = RELIABLE_FRAME_HEADER_SIZE + count;
+    uint32_t head = reliable_pool_head;
+
+    if ((size > reliable_pool_size) || (count > UINT16_MAX))
+    {
+        return NULL;
+    }
+    if ((head + size) > reliable_pool_size)
+    {
+        head = 0;
+    }
+
+    return &reliable_pool[head + RELIABLE_FRAME_HEADER_SIZE];
+}
+
+/*******************************************************************************
+* Function Name: reliable_frame
+********************************************************************************
+* Summary:
+*    Builds the next frame in the pool. The pool is used as a circular
+*    buffer: the frames overwritten by the new one are no longer held.
+*
+* Parameters:
+*   data: payload of the frame, can be NULL if it was already written at
+*         the address returned by reliable_payload
+*   count: payload size in bytes
+*   frame: receives the frame to send
+*   sequence: receives the sequence number of the frame
+*
+* Return:
+*     The size of the frame, 0 if it does not fit in the pool.
+*
+*******************************************************************************/
+uint32_t reliable_frame(const uint8_t *data, uint32_t count, uint8_t **frame,
+                        uint16_t *sequence)
+{
+    uint32_t size = RELIABLE_FRAME_HEADER_SIZE + count;
+    reliable_slot_t *slot;
+
+    if ((size > reliable_pool_size) || (count > UINT16_MAX))
+    {
+        return 0;
+    }
+    if ((reliable_pool_head + size) > reliable_pool_size)
+    {
+        reliable_pool_head = 0;
+    }
+
+    /* Release the frames overlapping the new one */
+    for (uint32_t i = 0; i < RELIABLE_WINDOW; i++)
+    {
+        slot = &reliable_slot[i];
+        if ((0u != slot->size) && (slot->offset < (reliable_pool_head + size)) &&
+            (reliable_pool_head < (slot->offset + slot->size)))
+        {
+            slot->size = 0;
+        }
+    }
+
+    slot = &reliable_slot[reliable_sequence % RELIABLE_WINDOW];
+    slot->offset = reliable_pool_head;
+    slot->size = size;
+    slot->sequence = reliable_sequence;
+
+    *frame = &reliable_pool[reliable_pool_head];
+    if (NULL != data)
+    {
+        memcpy(&(*frame)[RELIABLE_FRAME_HEADER_SIZE], data, count);
+    }
+    reliable_header(*frame, reliable_sequence, (uint16_t)count, 0);
+
+    *sequence = reliable_sequence++;
+    reliable_pool_head += size;
+
+    return size;
+}
+
+/*******************************************************************************
+* Function Name: reliable_nack
+********************************************************************************
+* Summary:
+*    Queues a frame to be sent again. NACKs beyond the queue size are ignored,
+*    the host asks again for the frames still missing.
+*
+* Parameters:
+*   sequence: sequence number of the frame
+*
+*******************************************************************************/
+void reliable_nack(uint16_t sequence)
+{
+    if ((reliable_queue_head - reliable_queue_tail) < RELIABLE_NACK_QUEUE_SIZE)
+    {
+        reliable_queue[reliable_queue_head % RELIABLE_NACK_QUEUE_SIZE] = sequence;
+        reliable_queue_head++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: reliable_pending
+********************************************************************************
+* Summary:
+*    Returns true when frames are waiting to be sent again.
+*
+*******************************************************************************/
+bool reliable_pending(void)
+{
+    return (reliable_queue_head != reliable_queue_tail);
+}
+
+/*******************************************************************************
+* Function Name: reliable_retransmit_size
+********************************************************************************
+* Summary:
+*    Returns the size of the frame the next call to reliable_retransmit
+*    returns, so that the credits it needs can be checked first.
+*
+* Return:
+*     The size of the frame, 0 if no frame is waiting.
+*
+*******************************************************************************/
+uint32_t reliable_retransmit_size(void)
+{
+    reliable_slot_t *slot;
+
+    if (false == reliable_pending())
+    {
+        return 0;
+    }
+
+    slot = reliable_held(reliable_queue[reliable_queue_tail % RELIABLE_NACK_QUEUE_SIZE]);
+    return (NULL == slot) ? RELIABLE_FRAME_HEADER_SIZE : slot->size;
+}
+
+/*******************************************************************************
+* Function Name: reliable_retransmit
+********************************************************************************
+* Summary:
+*    Returns the next frame to send again, flagged as a retransmission. A
+*    frame no longer held is replaced by an empty frame flagged as lost, so
+*    the host stops waiting for it.
+*
+* Parameters:
+*   frame: receives the frame to send
+*   sequence: receives the sequence number of the frame
+*
+* Return:
+*     The size of the frame, 0 if no frame is waiting.
+*
+*******************************************************************************/
+uint32_t reliable_retransmit(uint8_t **frame, uint16_t *sequence)
+{
+    reliable_slot_t *slot;
+
+    if (false == reliable_pending())
+    {
+        return 0;
+    }
+
+    *sequence = reliable_queue[reliable_queue_tail % RELIABLE_NACK_QUEUE_SIZE];
+    reliable_queue_tail++;
+
+    slot = reliable_held(*sequence);
+    if (NULL == slot)
+    {
+        *frame = reliable_lost;
+        reliable_header(reliable_lost, *sequence, 0, RELIABLE_FLAG_LOST);
+        return RELIABLE_FRAME_HEADER_SIZE;
+    }
+
+    *frame = &reliable_pool[slot->offset];
+    reliable_header(*frame, *sequence, (uint16_t)(slot->size - RELIABLE_FRAME_HEADER_SIZE),
+                    RELIABLE_FLAG_RETRANSMIT);
+    return slot->size;
+}
+
+/*******************************************************************************
+* Function Name: reliable_held
+********************************************************************************
+* Summary:
+*    Returns the slot of a frame still held in the pool, NULL if the frame
+*    was overwritten or is outside of the window.
+*
+*******************************************************************************/
+static reliable_slot_t *reliable_held(uint16_t sequence)
+{
+    reliable_slot_t *slot = &reliable_slot[sequence % RELIABLE_WINDOW];
+
+    if ((0u == slot->size) || (sequence != slot->sequence) ||
+        ((uint16_t)(reliable_sequence - sequence - 1u) >= RELIABLE_WINDOW))
+    {
+        return NULL;
+    }
+
+    return slot;
+}
+
+/*******************************************************************************
+* Function Name: reliable_crc
+********************************************************************************
+* Summary:
+*    Updates a CRC-16 (CCITT polynomial, no reflection) with a block of bytes.
+*
+*******************************************************************************/
+uint16_t reliable_crc(uint16_t crc, const uint8_t *data, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        crc = (uint16_t)((crc << 8) ^ reliable_crc_table[(uint8_t)(crc >> 8) ^ data[i]]);
+    }
+
+    return crc;
+}
+
+/*******************************************************************************
+* Function Name: reliable_header
+********************************************************************************
+* Summary:
+*    Writes the header of a frame whose payload is in place.
+*
+*******************************************************************************/
+static void reliable_header(uint8_t *frame, uint16_t sequence, uint16_t length, uint8_t flags)
+{
+    reliable_frame_header_t header =
+    {
+        .sync     = RELIABLE_FRAME_SYNC,
+        .sequence = sequence,
+        .length   = length,
+        .flags    = flags,
+        .reserved = 0,
+        .crc      = 0,
+    };
+
+    memcpy(frame, &header, RELIABLE_FRAME_HEADER_SIZE);
+    header.crc = reliable_crc(RELIABLE_CRC_INITIAL, &frame[2], 6u);
+    header.crc = reliable_crc(header.crc, &frame[RELIABLE_FRAME_HEADER_SIZE], length);
+    memcpy(&frame[8], &header.crc, sizeof(header.crc));
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,97 @@
+/******************************************************************************
+* File Name:   reliable.h
+*
+* Description: This file contains the function prototypes and constants used
+*   in reliable.c. The frame format is also used by the host tools.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SOURCE_RELIABLE_H_
+#define SOURCE_RELIABLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Constants
+ *****************************************************************************/
+/* First two bytes of every frame, used by the host to resynchronize */
+#define RELIABLE_FRAME_SYNC         (0x6BB6u)
+
+/* Frame flags */
+#define RELIABLE_FLAG_RETRANSMIT    (0x01u)     /* Sent again after a NACK */
+#define RELIABLE_FLAG_LOST          (0x02u)     /* The frame is no longer held,
+                                                 * the payload is empty */
+
+/* Number of frames the host can ask for again, counting back from the last
+ * frame sent. A power of two. */
+#define RELIABLE_WINDOW             (64u)
+
+/* Size of the frame header in bytes */
+#define RELIABLE_FRAME_HEADER_SIZE  (sizeof(reliable_frame_header_t))
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Frame header, all fields little endian. The CRC-16 (CCITT, initial value
+ * 0xFFFF) covers the sequence, length, flags and reserved fields followed by
+ * the payload. */
+typedef struct
+{
+    uint16_t sync;              /* RELIABLE_FRAME_SYNC */
+    uint16_t sequence;          /* Frame counter */
+    uint16_t length;            /* Payload length in bytes */
+    uint8_t  flags;             /* RELIABLE_FLAG_x */
+    uint8_t  reserved;          /* Set to 0 */
+    uint16_t crc;
+} reliable_frame_header_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void reliable_init(uint8_t *pool, uint32_t pool_size);
+uint8_t *reliable_payload(uint32_t count);
+uint32_t reliable_frame(const uint8_t *data, uint32_t count, uint8_t **frame,
+                        uint16_t *sequence);
+void reliable_nack(uint16_t sequence);
+bool reliable_pending(void);
+uint32_t reliable_retransmit_size(void);
+uint32_t reliable_retransmit(uint8_t **frame, uint16_t *sequence);
+uint16_t reliable_crc(uint16_t crc, const uint8_t *data, uint32_t count);
+
+
+#endif /* SOURCE_RELIABLE_H_ */
@@ -0,0 +1,229 @@
+/******************************************************************************
+* File Name:   ring_buffer.c
+*
+* Description: This file implements a single producer, single consumer byte
+*              ring buffer.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "ring_buffer.h"
+
+/*******************************************************************************
+* Function Name: ring_buffer_init
+********************************************************************************
+* Summary:
+*    Initializes an empty ring buffer.
+*
+* Parameters:
+*   ring: ring buffer object
+*   storage: memory used by the ring buffer
+*   size: size of storage in bytes, the capacity is size - 1
+*
+*******************************************************************************/
+void ring_buffer_init(ring_buffer_t *ring, uint8_t *storage, uint32_t size)
+{
+    ring->storage = storage;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_used
+********************************************************************************
+* Summary:
+*    Returns the number of bytes that can be read.
+*
+*******************************************************************************/
+uint32_t ring_buffer_used(const ring_buffer_t *ring)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = ring->tail;
+
+    return (head >= tail) ? (head - tail) : (ring->size - tail + head);
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_free
+********************************************************************************
+* Summary:
+*    Returns the number of bytes that can be written.
+*
+*******************************************************************************/
+uint32_t ring_buffer_free(const ring_buffer_t *ring)
+{
+    return (0u == ring->size) ? 0u : (ring->size - 1u - ring_buffer_used(ring));
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_write
+********************************************************************************
+* Summary:
+*    Appends bytes to the ring buffer. Called by the producer only.
+*
+* Parameters:
+*   ring: ring buffer object
+*   data: bytes to write
+*   count: number of bytes to write
+*
+* Return:
+*     The number of bytes written, less than count if the buffer is full.
+*
+*******************************************************************************/
+uint32_t ring_buffer_write(ring_buffer_t *ring, const void *data, uint32_t count)
+{
+    uint32_t head = ring->head;
+    uint32_t free_bytes = ring_buffer_free(ring);
+
+    if (count > free_bytes)
+    {
+        count = free_bytes;
+    }
+
+    uint32_t first = ring->size - head;
+    if (first > count)
+    {
+        first = count;
+    }
+    memcpy(&ring->storage[head], data, first);
+    memcpy(ring->storage, (const uint8_t *)data + first, count - first);
+
+    head += count;
+    if (head >= ring->size)
+    {
+        head -= ring->size;
+    }
+    /* Publish the data only once it is in place */
+    ring->head = head;
+
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_peek
+********************************************************************************
+* Summary:
+*    Copies bytes from the front of the ring buffer without removing them.
+*    Called by the consumer only.
+*
+* Parameters:
+*   ring: ring buffer object
+*   data: receives the bytes
+*   count: number of bytes to copy
+*
+* Return:
+*     The number of bytes copied, less than count if not enough are available.
+*
+*******************************************************************************/
+uint32_t ring_buffer_peek(const ring_buffer_t *ring, void *data, uint32_t count)
+{
+    uint32_t tail = ring->tail;
+    uint32_t used = ring_buffer_used(ring);
+
+    if (count > used)
+    {
+        count = used;
+    }
+
+    uint32_t first = ring->size - tail;
+    if (first > count)
+    {
+        first = count;
+    }
+    memcpy(data, &ring->storage[tail], first);
+    memcpy((uint8_t *)data + first, ring->storage, count - first);
+
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_consume
+********************************************************************************
+* Summary:
+*    Removes bytes from the front of the ring buffer. Called by the consumer
+*    only.
+*
+* Parameters:
+*   ring: ring buffer object
+*   count: number of bytes to remove, at most ring_buffer_used
+*
+*******************************************************************************/
+void ring_buffer_consume(ring_buffer_t *ring, uint32_t count)
+{
+    uint32_t used = ring_buffer_used(ring);
+    uint32_t tail = ring->tail;
+
+    if (count > used)
+    {
+        count = used;
+    }
+
+    tail += count;
+    if (tail >= ring->size)
+    {
+        tail -= ring->size;
+    }
+    ring->tail = tail;
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_read
+********************************************************************************
+* Summary:
+*    Copies and removes bytes from the front of the ring buffer. Called by the
+*    consumer only.
+*
+* Parameters:
+*   ring: ring buffer object
+*   data: receives the bytes
+*   count: number of bytes to read
+*
+* Return:
+*     The number of bytes read.
+*
+*******************************************************************************/
+uint32_t ring_buffer_read(ring_buffer_t *ring, void *data, uint32_t count)
+{
+    count = ring_buffer_peek(ring, data, count);
+    ring_buffer_consume(ring, count);
+
+    return count;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,75 @@
+/******************************************************************************
+* File Name:   ring_buffer.h
+*
+* Description: This file contains the function prototypes and types used in
+*   ring_buffer.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SOURCE_RING_BUFFER_H_
+#define SOURCE_RING_BUFFER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Byte FIFO over a caller provided storage. One producer (writing head) and
+ * one consumer (writing tail) can use it concurrently without locking. One
+ * byte of the storage is kept free to tell a full buffer from an empty one. */
+typedef struct
+{
+    uint8_t *storage;
+    uint32_t size;
+    volatile uint32_t head;     /* Next byte written */
+    volatile uint32_t tail;     /* Next byte read */
+} ring_buffer_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void ring_buffer_init(ring_buffer_t *ring, uint8_t *storage, uint32_t size);
+uint32_t ring_buffer_used(const ring_buffer_t *ring);
+uint32_t ring_buffer_free(const ring_buffer_t *ring);
+uint32_t ring_buffer_write(ring_buffer_t *ring, const void *data, uint32_t count);
+uint32_t ring_buffer_peek(const ring_buffer_t *ring, void *data, uint32_t count);
+void ring_buffer_consume(ring_buffer_t *ring, uint32_t count);
+uint32_t ring_buffer_read(ring_buffer_t *ring, void *data, uint32_t count);
+
+
+#endif /* SOURCE_RING_BUFFER_H_ */
@@ -0,0 +1,153 @@
+/******************************************************************************
+* File Name:   sd_card.c
+*
+* Description: This file implements the block device interface used by the
+*              log streaming interface on top of the microSD card slot of the
+*              kit.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cyhal.h"
+#include "cybsp.h"
+
+#include "sd_card.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* SD card block size */
+#define SD_CARD_BLOCK_SIZE          (512u)
+/* microSD slot pins, defined by the BSP */
+#define SD_CARD_CMD                 CYBSP_SDHC_CMD
+#define SD_CARD_CLK                 CYBSP_SDHC_CLK
+#define SD_CARD_IO0                 CYBSP_SDHC_IO0
+#define SD_CARD_IO1                 CYBSP_SDHC_IO1
+#define SD_CARD_IO2                 CYBSP_SDHC_IO2
+#define SD_CARD_IO3                 CYBSP_SDHC_IO3
+#define SD_CARD_DETECT              CYBSP_SDHC_DETECT
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+static cyhal_sdhc_t sdhc_obj;
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static cy_rslt_t sd_card_read(void *context, uint32_t block, uint8_t *data, uint32_t count);
+static cy_rslt_t sd_card_write(void *context, uint32_t block, const uint8_t *data,
+                               uint32_t count);
+
+/*******************************************************************************
+* Function Name: sd_card_init
+********************************************************************************
+* Summary:
+*    Initializes the SD card in 4-bit mode and fills in the block device
+*    operations.
+*
+* Parameters:
+*   blockdev: block device to set up
+*
+* Return:
+*     The status of the initialization.
+*
+*******************************************************************************/
+cy_rslt_t sd_card_init(mtb_data_streaming_blockdev_t *blockdev)
+{
+    cy_rslt_t result;
+    uint32_t block_count;
+    const cyhal_sdhc_config_t sdhc_config =
+    {
+        .enableLedControl    = false,
+        .lowVoltageSignaling = false,
+        .isEmmc              = false,
+        .busWidth            = 4,
+    };
+
+    result = cyhal_sdhc_init(&sdhc_obj, &sdhc_config, SD_CARD_CMD, SD_CARD_CLK,
+                             SD_CARD_IO0, SD_CARD_IO1, SD_CARD_IO2, SD_CARD_IO3,
+                             NC, NC, NC, NC, SD_CARD_DETECT, NC, NC, NC, NC, NC, NULL);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    result = cyhal_sdhc_get_block_count(&sdhc_obj, &block_count);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    blockdev->read = sd_card_read;
+    blockdev->write = sd_card_write;
+    blockdev->context = &sdhc_obj;
+    blockdev->block_size = SD_CARD_BLOCK_SIZE;
+    blockdev->block_count = block_count;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: sd_card_read
+********************************************************************************
+* Summary:
+*    Block device read operation.
+*
+*******************************************************************************/
+static cy_rslt_t sd_card_read(void *context, uint32_t block, uint8_t *data, uint32_t count)
+{
+    size_t length = count;
+
+    return cyhal_sdhc_read(context, block, data, &length);
+}
+
+/*******************************************************************************
+* Function Name: sd_card_write
+********************************************************************************
+* Summary:
+*    Block device write operation.
+*
+*******************************************************************************/
+static cy_rslt_t sd_card_write(void *context, uint32_t block, const uint8_t *data,
+                               uint32_t count)
+{
+    size_t length = count;
+
+    return cyhal_sdhc_write(context, block, data, &length);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,256 @@
+/******************************************************************************
+* File Name:   session.c
+*
+* Description: This file implements the sessions of a capture. A session is
+*   started and stopped by the kit button or by host commands, and split
+*   into labeled segments by host commands. Each event is queued as a marker
+*   record with the time it happened, so the host can split its output into
+*   one file per segment while capturing.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "session.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Markers not transmitted yet, a power of two. Markers of events happening
+ * while the queue is full are lost, the events still apply. */
+#define SESSION_QUEUE_SIZE          (8u)
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+typedef struct
+{
+    uint32_t time;
+    stream_marker_t marker;
+    char label[STREAM_MARKER_LABEL_SIZE];
+} session_event_t;
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+static session_event_t session_queue[SESSION_QUEUE_SIZE];
+static uint32_t session_head;
+static uint32_t session_tail;
+static uint16_t session_number;
+static bool session_running;
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static void session_push(uint32_t time, stream_marker_kind_t kind, const char *label,
+                         uint8_t length);
+
+/*******************************************************************************
+* Function Name: session_init
+********************************************************************************
+* Summary:
+*   Stops the session and forgets the markers queued.
+*
+*******************************************************************************/
+void session_init(void)
+{
+    session_head = 0;
+    session_tail = 0;
+    session_number = 0;
+    session_running = false;
+}
+
+/*******************************************************************************
+* Function Name: session_start
+********************************************************************************
+* Summary:
+*   Starts a new session, after stopping the current one if any.
+*
+* Parameters:
+*   time: device time of the event in microseconds
+*   label: label of the session, not terminated, NULL if none
+*   length: label length in bytes
+*
+*******************************************************************************/
+void session_start(uint32_t time, const char *label, uint8_t length)
+{
+    session_stop(time);
+
+    session_number++;
+    session_running = true;
+    session_push(time, STREAM_MARKER_START, label, length);
+}
+
+/*******************************************************************************
+* Function Name: session_stop
+********************************************************************************
+* Summary:
+*   Stops the current session, if any.
+*
+* Parameters:
+*   time: device time of the event in microseconds
+*
+*******************************************************************************/
+void session_stop(uint32_t time)
+{
+    if (true == session_running)
+    {
+        session_running = false;
+        session_push(time, STREAM_MARKER_STOP, NULL, 0u);
+    }
+}
+
+/*******************************************************************************
+* Function Name: session_label
+********************************************************************************
+* Summary:
+*   Starts a new segment of the current session. Ignored between sessions.
+*
+* Parameters:
+*   time: device time of the event in microseconds
+*   label: label of the segment, not terminated
+*   length: label length in bytes
+*
+*******************************************************************************/
+void session_label(uint32_t time, const char *label, uint8_t length)
+{
+    if (true == session_running)
+    {
+        session_push(time, STREAM_MARKER_LABEL, label, length);
+    }
+}
+
+/*******************************************************************************
+* Function Name: session_toggle
+********************************************************************************
+* Summary:
+*   Starts a session without a label, or stops the current one, such as
+*   when the kit button is pressed.
+*
+* Parameters:
+*   time: device time of the event in microseconds
+*
+*******************************************************************************/
+void session_toggle(uint32_t time)
+{
+    if (true == session_running)
+    {
+        session_stop(time);
+    }
+    else
+    {
+        session_start(time, NULL, 0u);
+    }
+}
+
+/*******************************************************************************
+* Function Name: session_active
+********************************************************************************
+* Summary:
+*   Returns true while a session is running.
+*
+*******************************************************************************/
+bool session_active(void)
+{
+    return session_running;
+}
+
+/*******************************************************************************
+* Function Name: session_pop
+********************************************************************************
+* Summary:
+*   Writes the record of the oldest marker queued and removes it.
+*
+* Parameters:
+*   buffer: receives SESSION_MARKER_SIZE bytes at most
+*
+* Return:
+*   The size of the record in bytes, 0 if no marker is queued.
+*
+*******************************************************************************/
+uint32_t session_pop(uint8_t *buffer)
+{
+    session_event_t *event;
+    uint8_t *payload = &buffer[STREAM_RECORD_HEADER_SIZE];
+
+    if (session_tail == session_head)
+    {
+        return 0;
+    }
+
+    event = &session_queue[session_tail % SESSION_QUEUE_SIZE];
+    memcpy(payload, &event->marker, sizeof(event->marker));
+    memcpy(&payload[sizeof(event->marker)], event->label, event->marker.length);
+    session_tail++;
+
+    return stream_record_write(buffer, STREAM_RECORD_MARKER, STREAM_CHANNEL_NONE, NULL,
+                               (uint16_t)(sizeof(stream_marker_t) + event->marker.length),
+                               event->time);
+}
+
+/*******************************************************************************
+* Function Name: session_push
+********************************************************************************
+* Summary:
+*   Queues the marker of an event of the current session. The label is cut
+*   to STREAM_MARKER_LABEL_SIZE bytes.
+*
+*******************************************************************************/
+static void session_push(uint32_t time, stream_marker_kind_t kind, const char *label,
+                         uint8_t length)
+{
+    session_event_t *event;
+
+    if ((session_head - session_tail) >= SESSION_QUEUE_SIZE)
+    {
+        return;
+    }
+
+    event = &session_queue[session_head % SESSION_QUEUE_SIZE];
+    event->time = time;
+    event->marker.session = session_number;
+    event->marker.kind = (uint8_t)kind;
+    event->marker.length = (NULL == label) ? 0u :
+                           (length < STREAM_MARKER_LABEL_SIZE) ? length : STREAM_MARKER_LABEL_SIZE;
+    if (0u != event->marker.length)
+    {
+        memcpy(event->label, label, event->marker.length);
+    }
+    session_head++;
+}
+
+/* [] END OF FILE */
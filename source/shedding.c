@@ -0,0 +1,270 @@
+/******************************************************************************
+* File Name:   shedding.c
+*
+* Description: This file implements the load shedding of the streamed
+*              channels. When the transport cannot keep up, the spill buffer
+*              fills up and the channels degrade in order of priority, each
+*              according to its policy, so the bandwidth left goes to the
+*              most important data.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "shedding.h"
+#include "spill.h"
+#include "stream_record.h"
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+/* Priority and degradation policy of each channel */
+static const uint8_t shedding_priority[STREAM_CHANNEL_COUNT] =
+{
+    [STREAM_CHANNEL_IMU]    = IMU_PRIORITY,
+    [STREAM_CHANNEL_PDM]    = PDM_PRIORITY,
+    [STREAM_CHANNEL_BMM]    = BMM_PRIORITY,
+    [STREAM_CHANNEL_DPS]    = DPS_PRIORITY,
+    [STREAM_CHANNEL_RADAR]  = RADAR_PRIORITY,
+};
+
+static const uint8_t shedding_policy[STREAM_CHANNEL_COUNT] =
+{
+    [STREAM_CHANNEL_IMU]    = IMU_SHED_POLICY,
+    [STREAM_CHANNEL_PDM]    = PDM_SHED_POLICY,
+    [STREAM_CHANNEL_BMM]    = BMM_SHED_POLICY,
+    [STREAM_CHANNEL_DPS]    = DPS_SHED_POLICY,
+    [STREAM_CHANNEL_RADAR]  = RADAR_SHED_POLICY,
+};
+
+/* Spill buffer fill level, in percent, at which each priority degrades */
+static const uint8_t shedding_threshold[] =
+{
+    [SHED_PRIORITY_HIGH]    = SHED_THRESHOLD_HIGH,
+    [SHED_PRIORITY_NORMAL]  = SHED_THRESHOLD_NORMAL,
+    [SHED_PRIORITY_LOW]     = SHED_THRESHOLD_LOW,
+};
+
+static bool shedding_active[STREAM_CHANNEL_COUNT];
+static uint8_t shedding_count[STREAM_CHANNEL_COUNT];
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static uint16_t shedding_float_to_half(const uint8_t *value);
+
+/*******************************************************************************
+* Function Name: shedding_update
+********************************************************************************
+* Summary:
+*    Measures the spill buffer fill level and returns what to do with the
+*    next block of a channel. A channel degrades once the fill level reaches
+*    the threshold of its priority, and recovers once it is back below half
+*    the threshold.
+*
+* Parameters:
+*   channel: STREAM_CHANNEL_x
+*   compress_supported: true if the block can be sent at half precision,
+*                       otherwise SHED_POLICY_COMPRESS decimates the channel
+*
+* Return:
+*     The action to apply to the block.
+*
+*******************************************************************************/
+shedding_action_t shedding_update(uint8_t channel, bool compress_supported)
+{
+    uint8_t index = channel % STREAM_CHANNEL_COUNT;
+    uint32_t threshold = shedding_threshold[shedding_priority[index]];
+    uint32_t fill = (uint32_t)(((uint64_t)spill_used() * 100u) / spill_capacity());
+
+    if (fill >= threshold)
+    {
+        shedding_active[index] = true;
+    }
+    else if ((2u * fill) < threshold)
+    {
+        shedding_active[index] = false;
+    }
+
+    if (false == shedding_active[index])
+    {
+        return SHEDDING_KEEP;
+    }
+
+    switch (shedding_policy[index])
+    {
+        case SHED_POLICY_DROP_OLDEST:
+            return SHEDDING_DROP_OLDEST;
+
+        case SHED_POLICY_COMPRESS:
+            /* Without records the channel is decimated instead */
+            if (true == compress_supported)
+            {
+                return SHEDDING_COMPRESS;
+            }
+            /* Fall through */
+
+        case SHED_POLICY_DECIMATE:
+            shedding_count[index]++;
+            if (shedding_count[index] >= SHED_DECIMATION)
+            {
+                shedding_count[index] = 0;
+                return SHEDDING_KEEP;
+            }
+            return SHEDDING_SKIP;
+
+        default:
+            return SHEDDING_KEEP;
+    }
+}
+
+/*******************************************************************************
+* Function Name: shedding_is_active
+********************************************************************************
+* Summary:
+*    Returns true while a channel is degraded.
+*
+*******************************************************************************/
+bool shedding_is_active(uint8_t channel)
+{
+    return shedding_active[channel % STREAM_CHANNEL_COUNT];
+}
+
+/*******************************************************************************
+* Function Name: shedding_compress
+********************************************************************************
+* Summary:
+*    Encodes a block at half precision: float32 values as IEEE 754 binary16,
+*    int16 values as their 8 most significant bits (rounded).
+*
+* Parameters:
+*   sample: type of the values of the block
+*   data: block of data
+*   size: size of the block in bytes
+*   output: receives size / 2 bytes, can be the same as data
+*
+* Return:
+*     The size of the encoded block in bytes.
+*
+*******************************************************************************/
+uint16_t shedding_compress(shedding_sample_t sample, const uint8_t *data, uint16_t size,
+                           uint8_t *output)
+{
+    uint16_t count;
+    uint16_t half;
+    int16_t value;
+    int32_t rounded;
+
+    if (SHEDDING_SAMPLE_FLOAT32 == sample)
+    {
+        count = size / sizeof(float);
+        for (uint16_t i = 0; i < count; i++)
+        {
+            half = shedding_float_to_half(&data[i * sizeof(float)]);
+            memcpy(&output[i * sizeof(half)], &half, sizeof(half));
+        }
+        return count * sizeof(half);
+    }
+
+    count = size / sizeof(int16_t);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        memcpy(&value, &data[i * sizeof(value)], sizeof(value));
+        rounded = ((int32_t)value + 128) >> 8;
+        output[i] = (uint8_t)(int8_t)((rounded > INT8_MAX) ? INT8_MAX : rounded);
+    }
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: shedding_float_to_half
+********************************************************************************
+* Summary:
+*    Converts a float to IEEE 754 binary16, rounding to nearest even. Values
+*    out of range become infinite, values too small become zero.
+*
+*******************************************************************************/
+static uint16_t shedding_float_to_half(const uint8_t *value)
+{
+    uint32_t bits;
+    uint16_t sign;
+    int32_t exponent;
+    uint32_t mantissa;
+    uint32_t half;
+
+    memcpy(&bits, value, sizeof(bits));
+    sign = (uint16_t)((bits >> 16) & 0x8000u);
+    exponent = (int32_t)((bits >> 23) & 0xFFu) - 127 + 15;
+    mantissa = bits & 0x7FFFFFu;
+
+    if (0xFFu == ((bits >> 23) & 0xFFu))
+    {
+        /* Infinite or not a number */
+        return sign | 0x7C00u | ((0u != mantissa) ? 0x200u : 0u);
+    }
+    if (exponent >= 0x1F)
+    {
+        return sign | 0x7C00u;
+    }
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+        {
+            return sign;
+        }
+        /* Subnormal */
+        mantissa |= 0x800000u;
+        uint32_t shift = (uint32_t)(14 - exponent);
+        half = mantissa >> shift;
+        if (((mantissa >> (shift - 1u)) & 1u) &&
+            ((half & 1u) || (mantissa & ((1u << (shift - 1u)) - 1u))))
+        {
+            half++;
+        }
+        return sign | (uint16_t)half;
+    }
+
+    half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+    if ((mantissa & 0x1000u) && ((half & 1u) || (mantissa & 0xFFFu)))
+    {
+        /* Rounding can carry into the exponent, up to infinity */
+        half++;
+    }
+    return sign | (uint16_t)half;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,80 @@
+/******************************************************************************
+* File Name:   shedding.h
+*
+* Description: This file contains the function prototypes and constants used
+*   in shedding.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SOURCE_SHEDDING_H_
+#define SOURCE_SHEDDING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* What to do with the next block of a channel */
+typedef enum
+{
+    SHEDDING_KEEP,              /* Queue the block */
+    SHEDDING_SKIP,              /* Drop the block */
+    SHEDDING_DROP_OLDEST,       /* Queue the block and drop the oldest block
+                                 * of the channel still queued */
+    SHEDDING_COMPRESS,          /* Queue the block at half precision */
+} shedding_action_t;
+
+/* Sample types of the channel data, used by the compressed encoding */
+typedef enum
+{
+    SHEDDING_SAMPLE_FLOAT32,
+    SHEDDING_SAMPLE_INT16,
+} shedding_sample_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+shedding_action_t shedding_update(uint8_t channel, bool compress_supported);
+bool shedding_is_active(uint8_t channel);
+uint16_t shedding_compress(shedding_sample_t sample, const uint8_t *data, uint16_t size,
+                           uint8_t *output);
+
+
+#endif /* SOURCE_SHEDDING_H_ */
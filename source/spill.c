@@ -0,0 +1,341 @@
+/******************************************************************************
+* File Name:   spill.c
+*
+* Description: This file implements the spill buffer queuing the blocks of
+*              data produced while the transport is busy. The blocks of all
+*              channels are kept in a single FIFO so they are transmitted in
+*              the order they were produced.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "spill.h"
+#include "ring_buffer.h"
+#include "stream_record.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Memory of the internal tier */
+#if SPILL_BUFFER_SIZE > 0
+#define SPILL_BUFFER_BYTES          (SPILL_BUFFER_SIZE)
+#else
+#define SPILL_BUFFER_BYTES          (1u)
+#endif
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Each block is stored after this header */
+typedef struct
+{
+    uint16_t size;
+    uint8_t channel;
+    uint8_t reserved;
+} spill_entry_t;
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+static uint8_t spill_storage[SPILL_BUFFER_BYTES];
+static ring_buffer_t spill_internal;
+#if SPILL_EXTERNAL_SIZE > 0
+static ring_buffer_t spill_external;
+#endif
+static uint32_t spill_dropped_blocks;
+
+/* Blocks of each channel queued, and how many of the oldest ones are to be
+ * dropped instead of transmitted */
+static uint16_t spill_blocks[STREAM_CHANNEL_COUNT];
+static uint16_t spill_discard[STREAM_CHANNEL_COUNT];
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static bool spill_write(ring_buffer_t *ring, uint8_t channel, const uint8_t *data, uint16_t size);
+static uint32_t spill_read(ring_buffer_t *ring, uint8_t *channel, uint8_t *data, uint32_t size);
+
+/*******************************************************************************
+* Function Name: spill_init
+********************************************************************************
+* Summary:
+*    Sets up the internal tier of the spill buffer in SRAM and, when
+*    SPILL_EXTERNAL_SIZE is set, the external tier.
+*
+*******************************************************************************/
+void spill_init(void)
+{
+    ring_buffer_init(&spill_internal, spill_storage, sizeof(spill_storage));
+#if SPILL_EXTERNAL_SIZE > 0
+    ring_buffer_init(&spill_external, (uint8_t *)(SPILL_EXTERNAL_ADDRESS), SPILL_EXTERNAL_SIZE);
+#endif
+    spill_dropped_blocks = 0;
+    memset(spill_blocks, 0, sizeof(spill_blocks));
+    memset(spill_discard, 0, sizeof(spill_discard));
+}
+
+/*******************************************************************************
+* Function Name: spill_push
+********************************************************************************
+* Summary:
+*    Appends a block of data to the spill buffer. The external tier takes the
+*    blocks once the internal tier is full, until it is empty again, so the
+*    blocks always leave in the order they were pushed. A block that does not
+*    fit is dropped; the data already queued is never overwritten.
+*
+* Parameters:
+*   channel: STREAM_CHANNEL_x the block belongs to
+*   data: block of data
+*   size: size of the block in bytes
+*
+* Return:
+*     false if the block was dropped.
+*
+*******************************************************************************/
+bool spill_push(uint8_t channel, const uint8_t *data, uint16_t size)
+{
+#if SPILL_EXTERNAL_SIZE > 0
+    if ((0u == ring_buffer_used(&spill_external)) &&
+        (true == spill_write(&spill_internal, channel, data, size)))
+    {
+        return true;
+    }
+    if (true == spill_write(&spill_external, channel, data, size))
+    {
+        return true;
+    }
+#else
+    if (true == spill_write(&spill_internal, channel, data, size))
+    {
+        return true;
+    }
+#endif
+
+    spill_dropped_blocks++;
+    return false;
+}
+
+/*******************************************************************************
+* Function Name: spill_pop
+********************************************************************************
+* Summary:
+*    Removes the oldest block of data from the spill buffer.
+*
+* Parameters:
+*   channel: receives the STREAM_CHANNEL_x of the block
+*   data: receives the block
+*   size: size of data in bytes, must fit the largest block pushed
+*
+* Return:
+*     The size of the block, 0 if the spill buffer is empty.
+*
+*******************************************************************************/
+uint32_t spill_pop(uint8_t *channel, uint8_t *data, uint32_t size)
+{
+    ring_buffer_t *ring;
+    uint32_t count;
+
+    do
+    {
+        ring = &spill_internal;
+#if SPILL_EXTERNAL_SIZE > 0
+        if (0u == ring_buffer_used(&spill_internal))
+        {
+            ring = &spill_external;
+        }
+#endif
+        count = spill_read(ring, channel, data, size);
+    }
+    /* Blocks given up by spill_drop_oldest are skipped */
+    while ((0u == count) && (false == spill_is_empty()));
+
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: spill_drop_oldest
+********************************************************************************
+* Summary:
+*    Drops the oldest block of a channel still queued, so it is skipped
+*    instead of transmitted. The memory is reclaimed when the blocks in front
+*    of it have been transmitted.
+*
+* Parameters:
+*   channel: STREAM_CHANNEL_x
+*
+* Return:
+*     false if no block of the channel is queued.
+*
+*******************************************************************************/
+bool spill_drop_oldest(uint8_t channel)
+{
+    uint8_t index = channel % STREAM_CHANNEL_COUNT;
+
+    if (spill_discard[index] >= spill_blocks[index])
+    {
+        return false;
+    }
+
+    spill_discard[index]++;
+    spill_dropped_blocks++;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: spill_is_empty
+********************************************************************************
+* Summary:
+*    Returns true when no block is waiting in the spill buffer.
+*
+*******************************************************************************/
+bool spill_is_empty(void)
+{
+    return (0u == spill_used());
+}
+
+/*******************************************************************************
+* Function Name: spill_used
+********************************************************************************
+* Summary:
+*    Returns the number of bytes queued in the spill buffer, headers included.
+*
+*******************************************************************************/
+uint32_t spill_used(void)
+{
+#if SPILL_EXTERNAL_SIZE > 0
+    return ring_buffer_used(&spill_internal) + ring_buffer_used(&spill_external);
+#else
+    return ring_buffer_used(&spill_internal);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: spill_capacity
+********************************************************************************
+* Summary:
+*    Returns the size of the spill buffer in bytes, all tiers included.
+*
+*******************************************************************************/
+uint32_t spill_capacity(void)
+{
+#if SPILL_EXTERNAL_SIZE > 0
+    return spill_internal.size + spill_external.size;
+#else
+    return spill_internal.size;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: spill_dropped
+********************************************************************************
+* Summary:
+*    Returns the number of blocks dropped because the spill buffer was full
+*    or by spill_drop_oldest.
+*
+*******************************************************************************/
+uint32_t spill_dropped(void)
+{
+    return spill_dropped_blocks;
+}
+
+/*******************************************************************************
+* Function Name: spill_write
+********************************************************************************
+* Summary:
+*    Stores a block in one tier, if it has room for it.
+*
+*******************************************************************************/
+static bool spill_write(ring_buffer_t *ring, uint8_t channel, const uint8_t *data, uint16_t size)
+{
+    spill_entry_t entry =
+    {
+        .size = size,
+        .channel = channel,
+        .reserved = 0,
+    };
+
+    if (ring_buffer_free(ring) < (sizeof(entry) + size))
+    {
+        return false;
+    }
+
+    ring_buffer_write(ring, &entry, sizeof(entry));
+    ring_buffer_write(ring, data, size);
+    spill_blocks[channel % STREAM_CHANNEL_COUNT]++;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: spill_read
+********************************************************************************
+* Summary:
+*    Removes the oldest block of one tier. A block larger than the caller
+*    buffer or dropped by spill_drop_oldest is discarded.
+*
+*******************************************************************************/
+static uint32_t spill_read(ring_buffer_t *ring, uint8_t *channel, uint8_t *data, uint32_t size)
+{
+    spill_entry_t entry;
+    uint8_t index;
+
+    if (sizeof(entry) != ring_buffer_peek(ring, &entry, sizeof(entry)))
+    {
+        return 0;
+    }
+
+    ring_buffer_consume(ring, sizeof(entry));
+    index = entry.channel % STREAM_CHANNEL_COUNT;
+    spill_blocks[index]--;
+    if (0u != spill_discard[index])
+    {
+        spill_discard[index]--;
+        ring_buffer_consume(ring, entry.size);
+        return 0;
+    }
+    if (entry.size > size)
+    {
+        ring_buffer_consume(ring, entry.size);
+        return 0;
+    }
+
+    *channel = entry.channel;
+    return ring_buffer_read(ring, data, entry.size);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,95 @@
+/******************************************************************************
+* File Name:   stream_record.c
+*
+* Description: This file implements the framing of the streamed data into
+*              records, so several channels and out of band information can
+*              share one link.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "stream_record.h"
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+/* Sequence number of the next record of each channel */
+static uint16_t stream_record_sequence[STREAM_CHANNEL_COUNT];
+
+/*******************************************************************************
+* Function Name: stream_record_write
+********************************************************************************
+* Summary:
+*    Writes a record header followed by its payload.
+*
+* Parameters:
+*   buffer: receives STREAM_RECORD_HEADER_SIZE + length bytes
+*   type: record type
+*   channel: channel the record belongs to
+*   payload: record payload, can be NULL if it was already written after the
+*            header
+*   length: payload length in bytes
+*   timestamp: device time of the record in microseconds
+*
+* Return:
+*     The number of bytes written.
+*
+*******************************************************************************/
+uint32_t stream_record_write(uint8_t *buffer, stream_record_type_t type, uint8_t channel,
+                             const void *payload, uint16_t length, uint32_t timestamp)
+{
+    stream_record_header_t header =
+    {
+        .sync      = STREAM_RECORD_SYNC,
+        .type      = (uint8_t)type,
+        .channel   = channel,
+        .length    = length,
+        .sequence  = stream_record_sequence[channel % STREAM_CHANNEL_COUNT]++,
+        .timestamp = timestamp,
+    };
+
+    memcpy(buffer, &header, STREAM_RECORD_HEADER_SIZE);
+    if (NULL != payload)
+    {
+        memmove(&buffer[STREAM_RECORD_HEADER_SIZE], payload, length);
+    }
+
+    return STREAM_RECORD_HEADER_SIZE + length;
+}
+
+/* [] END OF FILE */
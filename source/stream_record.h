@@ -0,0 +1,147 @@
+/******************************************************************************
+* File Name:   stream_record.h
+*
+* Description: This file contains the record format and function prototypes
+*   used in stream_record.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SOURCE_STREAM_RECORD_H_
+#define SOURCE_STREAM_RECORD_H_
+
+#include <stdint.h>
+
+#include "config.h"
+
+/******************************************************************************
+ * Constants
+ *****************************************************************************/
+/* First two bytes of every record, used by the host to resynchronize */
+#define STREAM_RECORD_SYNC          (0xA55Au)
+
+/* Channel identifiers, same values as the collection modes in config.h */
+#define STREAM_CHANNEL_NONE         (0u)    /* Records not tied to a channel */
+#define STREAM_CHANNEL_IMU          IMU_COLLECTION
+#define STREAM_CHANNEL_PDM          PDM_COLLECTION
+#define STREAM_CHANNEL_BMM          BMM_COLLECTION
+#define STREAM_CHANNEL_DPS          DPS_COLLECTION
+#define STREAM_CHANNEL_RADAR        RADAR_COLLECTION
+#define STREAM_CHANNEL_COUNT        (8u)
+
+/* Largest label of a marker, in bytes */
+#define STREAM_MARKER_LABEL_SIZE    (24u)
+
+/* Size of the record header in bytes */
+#define STREAM_RECORD_HEADER_SIZE   (sizeof(stream_record_header_t))
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Record types */
+typedef enum
+{
+    STREAM_RECORD_DATA  = 0,    /* Payload holds one block of channel data */
+    STREAM_RECORD_GAP   = 1,    /* Payload holds the number of samples (uint32)
+                                 * not transmitted since the previous record */
+    STREAM_RECORD_DATA_HALF = 2,/* Payload holds one block of channel data at
+                                 * half precision (see shedding_compress) */
+    STREAM_RECORD_SCHEMA = 3,   /* Payload describes the blocks of the
+                                 * channels (see stream_schema.h) */
+    STREAM_RECORD_CLOCK = 4,    /* Payload answers a ping command
+                                 * (stream_clock_t), the timestamp is the
+                                 * time the record was sent */
+    STREAM_RECORD_TRIGGER = 5,  /* Payload holds an edge of the sync line
+                                 * (stream_trigger_t) */
+    STREAM_RECORD_MARKER = 6,   /* Payload marks the start or the stop of a
+                                 * session, or a label (stream_marker_t) */
+} stream_record_type_t;
+
+/* Session markers */
+typedef enum
+{
+    STREAM_MARKER_START = 1,    /* A session starts */
+    STREAM_MARKER_STOP  = 2,    /* The session stops */
+    STREAM_MARKER_LABEL = 3,    /* A new segment of the session starts */
+} stream_marker_kind_t;
+
+/* Record header, all fields little endian. The fields are naturally aligned
+ * so the structure has no padding. */
+typedef struct
+{
+    uint16_t sync;              /* STREAM_RECORD_SYNC */
+    uint8_t  type;              /* stream_record_type_t */
+    uint8_t  channel;           /* STREAM_CHANNEL_x */
+    uint16_t length;            /* Payload length in bytes */
+    uint16_t sequence;          /* Per channel record counter */
+    uint32_t timestamp;         /* Device time in microseconds */
+} stream_record_header_t;
+
+/* Clock record payload, all fields little endian */
+typedef struct
+{
+    uint32_t ping;              /* Identifier of the ping answered */
+    uint32_t received;          /* Device time the ping was received, in
+                                 * microseconds */
+} stream_clock_t;
+
+/* Trigger record payload, all fields little endian. The edges of the sync
+ * line are numbered from the one that started the collection. */
+typedef struct
+{
+    uint32_t edge;              /* Number of the edge */
+    uint32_t time;              /* Device time of the edge, in microseconds */
+    uint32_t period;            /* Interval between the edges driven by the
+                                 * master, in microseconds */
+} stream_trigger_t;
+
+/* Marker record payload, followed by the label (length bytes, not
+ * terminated). The record timestamp is the time of the event. */
+typedef struct
+{
+    uint16_t session;           /* Number of the session, from 1 */
+    uint8_t  kind;              /* stream_marker_kind_t */
+    uint8_t  length;            /* Label length in bytes */
+} stream_marker_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+uint32_t stream_record_write(uint8_t *buffer, stream_record_type_t type, uint8_t channel,
+                             const void *payload, uint16_t length, uint32_t timestamp);
+
+
+#endif /* SOURCE_STREAM_RECORD_H_ */
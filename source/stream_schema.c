@@ -0,0 +1,190 @@
+/******************************************************************************
+* File Name:   stream_schema.c
+*
+* Description: This file implements the schema record, which describes the
+*   layout, rate, scale and units of the blocks of the channel streamed. It
+*   is derived from the build configuration, so host tools can parse the
+*   stream of any build without knowing how it was configured.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "config.h"
+#include "imu.h"
+#include "audio.h"
+#include "audio_features.h"
+#include "bmm.h"
+#include "pressure.h"
+#include "radar.h"
+#include "stream_record.h"
+#include "stream_schema.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Full scale of the accelerometer in g. imu_get_data divides the readings by
+ * 4096, the sensitivity at +/-8 g, so the values are in g at that range only. */
+#ifdef CY_BMI_270_IMU_I2C
+#define STREAM_SCHEMA_IMU_RANGE_G   (2u << (IMU_SAMPLE_RANGE - BMI2_ACC_RANGE_2G))
+#else
+#define STREAM_SCHEMA_IMU_RANGE_G   ((IMU_SAMPLE_RANGE == BMI160_ACCEL_RANGE_2G) ? 2u : \
+                                     (IMU_SAMPLE_RANGE == BMI160_ACCEL_RANGE_4G) ? 4u : \
+                                     (IMU_SAMPLE_RANGE == BMI160_ACCEL_RANGE_8G) ? 8u : 16u)
+#endif
+
+/* Index of the feature field of the PDM blocks, after the samples if any */
+#if AUDIO_OUTPUT_MODE == AUDIO_OUTPUT_RAW_AND_FEATURES
+#define STREAM_SCHEMA_FEATURE_FIELD 1u
+#else
+#define STREAM_SCHEMA_FEATURE_FIELD 0u
+#endif
+
+/* Log-mel values are log2 in Q8, MFCCs are in Q6 (see audio_features.c) */
+#if AUDIO_FEATURE_TYPE == AUDIO_FEATURE_MFCC
+#define STREAM_SCHEMA_FEATURE_UNIT  STREAM_UNIT_NONE
+#define STREAM_SCHEMA_FEATURE_SCALE (1.0f / 64.0f)
+#else
+#define STREAM_SCHEMA_FEATURE_UNIT  STREAM_UNIT_LOG2
+#define STREAM_SCHEMA_FEATURE_SCALE (1.0f / 256.0f)
+#endif
+
+/* Load shedding policy of the channel streamed */
+#if COLLECTION_MODE_SELECT == IMU_COLLECTION
+#define STREAM_SCHEMA_SHED_POLICY   IMU_SHED_POLICY
+#elif COLLECTION_MODE_SELECT == PDM_COLLECTION
+#define STREAM_SCHEMA_SHED_POLICY   PDM_SHED_POLICY
+#elif COLLECTION_MODE_SELECT == BMM_COLLECTION
+#define STREAM_SCHEMA_SHED_POLICY   BMM_SHED_POLICY
+#elif COLLECTION_MODE_SELECT == DPS_COLLECTION
+#define STREAM_SCHEMA_SHED_POLICY   DPS_SHED_POLICY
+#else
+#define STREAM_SCHEMA_SHED_POLICY   RADAR_SHED_POLICY
+#endif
+
+/* The PDM blocks are gated by the voice activity detection, the other
+ * channels are compressed under load when their blocks are wrapped in
+ * records */
+#if (COLLECTION_MODE_SELECT == PDM_COLLECTION) && (AUDIO_VAD_ENABLE == 1)
+#define STREAM_SCHEMA_FLAGS         STREAM_SCHEMA_GATED
+#elif (STREAM_RECORDS_ENABLE == 1) && (STREAM_SCHEMA_SHED_POLICY == SHED_POLICY_COMPRESS)
+#define STREAM_SCHEMA_FLAGS         STREAM_SCHEMA_COMPRESSED
+#else
+#define STREAM_SCHEMA_FLAGS         0u
+#endif
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+/* Fields of the blocks of the channel streamed */
+static const stream_schema_field_t stream_schema_fields[] =
+{
+#if COLLECTION_MODE_SELECT == IMU_COLLECTION
+    { STREAM_CHANNEL_IMU, 0, STREAM_SAMPLE_FLOAT32, STREAM_UNIT_G, 1, IMU_AXIS,
+      IMU_SCAN_RATE * 1000u, (float)STREAM_SCHEMA_IMU_RANGE_G / 8.0f },
+#elif COLLECTION_MODE_SELECT == PDM_COLLECTION
+#if AUDIO_OUTPUT_MODE != AUDIO_OUTPUT_FEATURES
+    { STREAM_CHANNEL_PDM, 0, STREAM_SAMPLE_INT16, STREAM_UNIT_FULL_SCALE, FRAME_SIZE, 1,
+      (PDM_SAMPLE_RATE * 1000u) / FRAME_SIZE, 1.0f / 32768.0f },
+#endif
+#if AUDIO_OUTPUT_MODE != AUDIO_OUTPUT_RAW
+    { STREAM_CHANNEL_PDM, STREAM_SCHEMA_FEATURE_FIELD, STREAM_SAMPLE_INT16,
+      STREAM_SCHEMA_FEATURE_UNIT, AUDIO_FEATURE_VECTORS, AUDIO_FEATURE_VECTOR_SIZE,
+      (PDM_SAMPLE_RATE * 1000u) / FRAME_SIZE, STREAM_SCHEMA_FEATURE_SCALE },
+#endif
+#elif COLLECTION_MODE_SELECT == BMM_COLLECTION
+    { STREAM_CHANNEL_BMM, 0, STREAM_SAMPLE_FLOAT32, STREAM_UNIT_MICROTESLA, 1, bmm_AXIS,
+      bmm_SCAN_RATE * 1000u, 1.0f },
+#elif COLLECTION_MODE_SELECT == DPS_COLLECTION
+    { STREAM_CHANNEL_DPS, 0, STREAM_SAMPLE_FLOAT32, STREAM_UNIT_HECTOPASCAL, 1, 1,
+      DPS_SCAN_RATE * 1000u, 1.0f },
+    { STREAM_CHANNEL_DPS, 1, STREAM_SAMPLE_FLOAT32, STREAM_UNIT_CELSIUS, 1, 1,
+      DPS_SCAN_RATE * 1000u, 1.0f },
+#elif COLLECTION_MODE_SELECT == RADAR_COLLECTION
+#if RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_FFT
+    /* Range bins of each chirp, or of the average of the chirps */
+    { STREAM_CHANNEL_RADAR, 0, STREAM_SAMPLE_INT16, STREAM_UNIT_FULL_SCALE,
+      RADAR_DATA_SIZE / RADAR_NUM_RANGE_BINS, RADAR_NUM_RANGE_BINS,
+      RADAR_SCAN_RATE * 1000u, 1.0f / 16384.0f },
+#elif RADAR_OUTPUT_MODE == RADAR_OUTPUT_RANGE_DOPPLER
+    /* Doppler bins of each range bin */
+    { STREAM_CHANNEL_RADAR, 0, STREAM_SAMPLE_INT16, STREAM_UNIT_FULL_SCALE,
+      RADAR_RD_RANGE_BIN_COUNT, RADAR_RD_DOPPLER_BIN_COUNT,
+      RADAR_SCAN_RATE * 1000u, 1.0f / 16384.0f },
+#else
+    /* 12 bit ADC samples of the first chirp, the rest of the block is unused */
+    { STREAM_CHANNEL_RADAR, 0, STREAM_SAMPLE_INT16, STREAM_UNIT_FULL_SCALE,
+      1, RADAR_DATA_SIZE, RADAR_SCAN_RATE * 1000u, 1.0f / 4096.0f },
+#endif
+#endif
+};
+
+/*******************************************************************************
+* Function Name: stream_schema_write
+********************************************************************************
+* Summary:
+*    Writes a schema record describing the blocks of the channel streamed.
+*
+* Parameters:
+*   buffer: receives STREAM_RECORD_HEADER_SIZE + STREAM_SCHEMA_SIZE bytes at
+*           most
+*   timestamp: device time of the record in microseconds
+*
+* Return:
+*     The number of bytes written.
+*
+*******************************************************************************/
+uint32_t stream_schema_write(uint8_t *buffer, uint32_t timestamp)
+{
+    stream_schema_header_t header =
+    {
+        .version  = STREAM_SCHEMA_VERSION,
+        .count    = (uint8_t)(sizeof(stream_schema_fields) / sizeof(stream_schema_fields[0])),
+        .flags    = STREAM_SCHEMA_FLAGS,
+        .reserved = 0,
+    };
+    uint8_t *payload = &buffer[STREAM_RECORD_HEADER_SIZE];
+
+    memcpy(payload, &header, sizeof(header));
+    memcpy(&payload[sizeof(header)], stream_schema_fields, sizeof(stream_schema_fields));
+
+    return stream_record_write(buffer, STREAM_RECORD_SCHEMA, STREAM_CHANNEL_NONE, NULL,
+                               (uint16_t)(sizeof(header) + sizeof(stream_schema_fields)),
+                               timestamp);
+}
+
+/* [] END OF FILE */
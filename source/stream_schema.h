@@ -0,0 +1,120 @@
+/******************************************************************************
+* File Name:   stream_schema.h
+*
+* Description: This file contains the schema record format and function
+*   prototypes used in stream_schema.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SOURCE_STREAM_SCHEMA_H_
+#define SOURCE_STREAM_SCHEMA_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ * Constants
+ *****************************************************************************/
+/* Version of the schema payload layout */
+#define STREAM_SCHEMA_VERSION       (1u)
+
+/* Largest number of fields described by a schema record */
+#define STREAM_SCHEMA_MAX_FIELDS    (4u)
+
+/* Schema flags */
+#define STREAM_SCHEMA_GATED         (0x01u) /* Blocks are only sent while the
+                                             * channel is active, the others
+                                             * are reported by gap records */
+#define STREAM_SCHEMA_COMPRESSED    (0x02u) /* Blocks can be sent at half
+                                             * precision (DATA_HALF records) */
+
+/* Size of the schema payload in bytes */
+#define STREAM_SCHEMA_SIZE          (sizeof(stream_schema_header_t) + \
+                                     STREAM_SCHEMA_MAX_FIELDS * sizeof(stream_schema_field_t))
+
+/******************************************************************************
+ * Typedefs
+ *****************************************************************************/
+/* Types of the values of a field */
+typedef enum
+{
+    STREAM_SAMPLE_INT16     = 1,
+    STREAM_SAMPLE_FLOAT32   = 2,
+} stream_sample_t;
+
+/* Units of a field, once multiplied by its scale */
+typedef enum
+{
+    STREAM_UNIT_NONE        = 0,    /* Counts or dimensionless */
+    STREAM_UNIT_G           = 1,    /* Standard gravity */
+    STREAM_UNIT_MICROTESLA  = 2,
+    STREAM_UNIT_HECTOPASCAL = 3,
+    STREAM_UNIT_CELSIUS     = 4,
+    STREAM_UNIT_FULL_SCALE  = 5,    /* Fraction of the converter full scale */
+    STREAM_UNIT_LOG2        = 6,    /* Base 2 logarithm of a power */
+} stream_unit_t;
+
+/* Schema payload header, followed by count fields */
+typedef struct
+{
+    uint8_t  version;           /* STREAM_SCHEMA_VERSION */
+    uint8_t  count;             /* Number of fields */
+    uint8_t  flags;             /* STREAM_SCHEMA_x */
+    uint8_t  reserved;
+} stream_schema_header_t;
+
+/* Description of a field, all fields little endian. The fields of a channel
+ * follow each other in its blocks, in the order of their index. Each field
+ * holds rows x columns values, rows being sampled at rows x rate. */
+typedef struct
+{
+    uint8_t  channel;           /* STREAM_CHANNEL_x */
+    uint8_t  field;             /* Index of the field in the block */
+    uint8_t  sample;            /* stream_sample_t */
+    uint8_t  unit;              /* stream_unit_t */
+    uint16_t rows;
+    uint16_t columns;
+    uint32_t rate;              /* Blocks per second, in millihertz */
+    float    scale;             /* Physical value = stored value x scale */
+} stream_schema_field_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+uint32_t stream_schema_write(uint8_t *buffer, uint32_t timestamp);
+
+
+#endif /* SOURCE_STREAM_SCHEMA_H_ */
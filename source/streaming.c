@@ -3,7 +3,7 @@
 *
 * Description: This file contains setup functions for initializing the streaming
 * interface. It supports using either UART or USB CDC. The selected protocol is
-* based on a define from the Makefile.
+* based on STREAM_TRANSPORT in the Makefile.
 *
 *******************************************************************************
 * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
@@ -41,6 +41,47 @@
 #include "streaming.h"
 #include "cybsp.h"
 #include "config.h"
+#if STREAM_RELIABLE_ENABLE == 1
+#include <string.h>
+#include "reliable.h"
+#endif
+
+/* Set while a transfer started by streaming_send is in progress */
+static volatile bool streaming_busy = false;
+
+#if STREAM_FLOW_CONTROL_ENABLE == 1
+/* Bytes sent since the start of the stream, and total number of bytes the
+ * host has granted. Both wrap around. */
+static uint32_t streaming_sent = 0;
+static uint32_t streaming_limit = STREAM_FLOW_INITIAL_CREDIT;
+#endif
+
+#if STREAM_RELIABLE_ENABLE == 1
+/* Frames sent, kept to be sent again */
+static uint8_t streaming_pool[STREAM_RELIABLE_POOL_SIZE];
+/* Frame of the transfer in progress, sent again if the transfer fails */
+static uint16_t streaming_frame;
+static volatile bool streaming_failed = false;
+#endif
+
+#if defined(STREAM_LOG)
+/* Set once data is sent, until it is flushed to the log */
+static bool streaming_unflushed = false;
+#endif
+
+/* Segment of a transfer of a single buffer */
+static mtb_data_streaming_segment_t streaming_segment;
+
+/* Commands received from the host */
+static host_command_parser_t streaming_parser;
+
+static void streaming_transport_init(mtb_data_streaming_interface_t* stream);
+static bool streaming_read_byte(uint8_t* byte);
+static cy_rslt_t streaming_transmit(mtb_data_streaming_interface_t* stream, uint8_t* data,
+                                    size_t count);
+static cy_rslt_t streaming_transmitv(mtb_data_streaming_interface_t* stream,
+                                     const mtb_data_streaming_segment_t* segments, size_t count);
+static bool streaming_has_credit(size_t count);
 
 /*******************************************************************************
 * Function Name: mtb_data_streaming_xfer_done
@@ -53,8 +94,582 @@ static void mtb_data_streaming_xfer_done(const void* tag, cy_rslt_t result)
 {
     CY_UNUSED_PARAMETER(tag);
     //HALT_ON_ERROR(result);
+#if STREAM_RELIABLE_ENABLE == 1
+    if (CY_RSLT_SUCCESS != result)
+    {
+        streaming_failed = true;
+    }
+#endif
+    streaming_busy = false;
+}
+
+/*******************************************************************************
+* Function Name: streaming_init
+********************************************************************************
+* Summary:
+*  Initializes the transport selected in the makefile as the streamer to
+*  collect data.
+*
+* Parameters:
+*  stream: Pass in the stream object
+*
+*******************************************************************************/
+void streaming_init(mtb_data_streaming_interface_t* stream)
+{
+#if STREAM_RELIABLE_ENABLE == 1
+    reliable_init(streaming_pool, sizeof(streaming_pool));
+#endif
+    streaming_transport_init(stream);
+}
+
+/*******************************************************************************
+* Function Name: streaming_send
+********************************************************************************
+* Summary:
+*  Starts sending data and tracks the transfer so that streaming_ready tells
+*  when the data buffer can be reused. With STREAM_RELIABLE_ENABLE, the data
+*  is copied to a frame of the pool first.
+*
+* Parameters:
+*  stream: Pass in the stream object
+*  data: Data to send, must not be modified until streaming_ready is true
+*  count: Number of bytes to send
+*
+* Return:
+*  The status of the send request.
+*
+*******************************************************************************/
+cy_rslt_t streaming_send(mtb_data_streaming_interface_t* stream, uint8_t* data, size_t count)
+{
+    streaming_segment.data = data;
+    streaming_segment.count = count;
+
+    return streaming_sendv(stream, &streaming_segment, 1u);
+}
+
+/*******************************************************************************
+* Function Name: streaming_sendv
+********************************************************************************
+* Summary:
+*  Starts sending data held in several buffers, such as a record header and
+*  its payload, as if they were contiguous. With STREAM_RELIABLE_ENABLE, the
+*  segments are gathered in a frame of the pool.
+*
+* Parameters:
+*  stream: Pass in the stream object
+*  segments: Segments to send, the array and the data must not be modified
+*            until streaming_ready is true
+*  count: Number of segments
+*
+* Return:
+*  The status of the send request.
+*
+*******************************************************************************/
+cy_rslt_t streaming_sendv(mtb_data_streaming_interface_t* stream,
+                          const mtb_data_streaming_segment_t* segments, size_t count)
+{
+#if STREAM_RELIABLE_ENABLE == 1
+    uint32_t size = 0;
+    uint8_t* payload;
+    uint8_t* frame;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        size += segments[i].count;
+    }
+
+    payload = reliable_payload(size);
+    if (NULL == payload)
+    {
+        return MTB_DATA_STREAMING_OVERFLOW_ERR;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        memcpy(payload, segments[i].data, segments[i].count);
+        payload += segments[i].count;
+    }
+
+    size = reliable_frame(NULL, size, &frame, &streaming_frame);
+    return streaming_transmit(stream, frame, size);
+#else
+    return streaming_transmitv(stream, segments, count);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: streaming_process
+********************************************************************************
+* Summary:
+*  Sends again the frames the host asked for, and the frame of a transfer
+*  that failed, before any new data, once the host granted the credits they
+*  use. Called from the main loop.
+*
+* Parameters:
+*  stream: Pass in the stream object
+*
+*******************************************************************************/
+void streaming_process(mtb_data_streaming_interface_t* stream)
+{
+#if STREAM_RELIABLE_ENABLE == 1
+    uint8_t* frame;
+    uint32_t size;
+
+    if (true == streaming_failed)
+    {
+        streaming_failed = false;
+        reliable_nack(streaming_frame);
+    }
+
+    if ((true == streaming_ready()) && (true == reliable_pending()) &&
+        (true == streaming_has_credit(reliable_retransmit_size())))
+    {
+        size = reliable_retransmit(&frame, &streaming_frame);
+        if (0u != size)
+        {
+            streaming_transmit(stream, frame, size);
+        }
+    }
+#else
+    CY_UNUSED_PARAMETER(stream);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: streaming_nack
+********************************************************************************
+* Summary:
+*  Queues a frame the host asked for to be sent again.
+*
+* Parameters:
+*  sequence: Sequence number of the frame
+*
+*******************************************************************************/
+void streaming_nack(uint16_t sequence)
+{
+#if STREAM_RELIABLE_ENABLE == 1
+    reliable_nack(sequence);
+#else
+    CY_UNUSED_PARAMETER(sequence);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: streaming_transmit
+********************************************************************************
+* Summary:
+*  Starts the transfer of a single buffer.
+*
+*******************************************************************************/
+static cy_rslt_t streaming_transmit(mtb_data_streaming_interface_t* stream, uint8_t* data,
+                                    size_t count)
+{
+    streaming_segment.data = data;
+    streaming_segment.count = count;
+
+    return streaming_transmitv(stream, &streaming_segment, 1u);
+}
+
+/*******************************************************************************
+* Function Name: streaming_transmitv
+********************************************************************************
+* Summary:
+*  Starts a transfer and accounts for the credits it uses.
+*
+*******************************************************************************/
+static cy_rslt_t streaming_transmitv(mtb_data_streaming_interface_t* stream,
+                                     const mtb_data_streaming_segment_t* segments, size_t count)
+{
+    cy_rslt_t result;
+
+    streaming_busy = true;
+    result = mtb_data_streaming_sendv(stream, segments, count, NULL);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        streaming_busy = false;
+#if STREAM_RELIABLE_ENABLE == 1
+        streaming_failed = true;
+#endif
+    }
+#if STREAM_FLOW_CONTROL_ENABLE == 1
+    else
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            streaming_sent += segments[i].count;
+        }
+    }
+#endif
+#if defined(STREAM_LOG)
+    if (CY_RSLT_SUCCESS == result)
+    {
+        streaming_unflushed = true;
+    }
+#endif
+
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: streaming_ready
+********************************************************************************
+* Summary:
+*  Returns true when no transfer started by streaming_send is in progress.
+*
+*******************************************************************************/
+bool streaming_ready(void)
+{
+    return (false == streaming_busy);
+}
+
+/*******************************************************************************
+* Function Name: streaming_can_send
+********************************************************************************
+* Summary:
+*  Returns true when new data can be sent: no transfer is in progress, no
+*  frame is waiting to be sent again and, if STREAM_FLOW_CONTROL_ENABLE is
+*  set, the host has granted enough credits for count bytes and, with
+*  STREAM_RELIABLE_ENABLE, the frame header.
+*
+*******************************************************************************/
+bool streaming_can_send(size_t count)
+{
+#if STREAM_RELIABLE_ENABLE == 1
+    if ((true == streaming_failed) || (true == reliable_pending()))
+    {
+        return false;
+    }
+    count += RELIABLE_FRAME_HEADER_SIZE;
+#endif
+
+    return (true == streaming_has_credit(count)) && (true == streaming_ready());
+}
+
+/*******************************************************************************
+* Function Name: streaming_has_credit
+********************************************************************************
+* Summary:
+*  Returns true when the host has granted enough credits to send count
+*  bytes, always true if STREAM_FLOW_CONTROL_ENABLE is not set.
+*
+*******************************************************************************/
+static bool streaming_has_credit(size_t count)
+{
+#if STREAM_FLOW_CONTROL_ENABLE == 1
+    return ((int32_t)(streaming_limit - streaming_sent) >= (int32_t)count);
+#else
+    CY_UNUSED_PARAMETER(count);
+    return true;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: streaming_grant
+********************************************************************************
+* Summary:
+*  Sets the credits granted by the host.
+*
+* Parameters:
+*  limit: Total number of bytes the host can receive since the start of the
+*         stream, wrapping around
+*
+*******************************************************************************/
+void streaming_grant(uint32_t limit)
+{
+#if STREAM_FLOW_CONTROL_ENABLE == 1
+    streaming_limit = limit;
+#else
+    CY_UNUSED_PARAMETER(limit);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: streaming_credit_reset
+********************************************************************************
+* Summary:
+*  Restarts the count of the bytes sent from the next byte, with the initial
+*  credits, as at boot. The host sends it when it connects, as the device
+*  may have been streaming before.
+*
+*******************************************************************************/
+void streaming_credit_reset(void)
+{
+#if STREAM_FLOW_CONTROL_ENABLE == 1
+    streaming_sent = 0;
+    streaming_limit = STREAM_FLOW_INITIAL_CREDIT;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: streaming_receive_command
+********************************************************************************
+* Summary:
+*  Parses the bytes received from the host, without waiting.
+*
+* Parameters:
+*  command: Receives the next command
+*
+* Return:
+*  true when a command was received.
+*
+*******************************************************************************/
+bool streaming_receive_command(host_command_t* command)
+{
+    uint8_t byte;
+
+    while (true == streaming_read_byte(&byte))
+    {
+        if (true == host_command_parse(&streaming_parser, byte, command))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#if defined(STREAM_USB)
+#include <string.h>
+
+/* USB device descriptor information */
+#define USB_VENDOR_ID               (0x058Bu)
+#define USB_PRODUCT_ID              (0x027Du)
+/* Largest bulk and interrupt packets at full-speed */
+#define USB_FS_BULK_MAX_PACKET_SIZE (64u)
+#define USB_FS_INT_MAX_PACKET_SIZE  (64u)
+/* Interval of the CDC notification endpoint, in 125 us units (8 ms) */
+#define USB_INT_INTERVAL            (64u)
+/* The OUT endpoint buffer holds several packets so that the host can keep
+ * sending while the previous packets are processed */
+#define USB_OUT_BUFFER_SIZE         (2u * 8u * USB_FS_BULK_MAX_PACKET_SIZE)
+/* Time between two checks of the enumeration state */
+#define USB_ENUMERATION_POLL_MS     (50u)
+
+static mtb_data_streaming_usb_t usb_obj;
+static U8 usb_out_buffer[USB_OUT_BUFFER_SIZE];
+
+static const USB_DEVICE_INFO usb_device_info =
+{
+    USB_VENDOR_ID,                      /* VendorId */
+    USB_PRODUCT_ID,                     /* ProductId */
+    "Infineon Technologies",            /* VendorName */
+    "Imagimob Data Collection",         /* ProductName */
+    "0001"                              /* SerialNumber */
+};
+
+/*******************************************************************************
+* Function Name: streaming_transport_init
+********************************************************************************
+* Summary:
+*  If STREAM_TRANSPORT=USB is selected in the makefile then this function
+*  initializes a USB CDC device as the streamer to collect data, and waits
+*  until the host has configured it. IN transfers are sent straight from the
+*  caller buffers, so a whole block of data is transmitted back to back at
+*  full-speed USB rate.
+*
+* Parameters:
+*  stream: Pass in the stream object
+*
+*******************************************************************************/
+static void streaming_transport_init(mtb_data_streaming_interface_t* stream)
+{
+    cy_rslt_t result;
+    USB_CDC_INIT_DATA cdc_init_data;
+    USB_ADD_EP_INFO ep_bulk_in;
+    USB_ADD_EP_INFO ep_bulk_out;
+    USB_ADD_EP_INFO ep_int_in;
+
+    USBD_Init();
+
+    memset(&cdc_init_data, 0, sizeof(cdc_init_data));
+
+    ep_bulk_in.Flags          = 0;
+    ep_bulk_in.InDir          = USB_DIR_IN;
+    ep_bulk_in.Interval       = 0;
+    ep_bulk_in.MaxPacketSize  = USB_FS_BULK_MAX_PACKET_SIZE;
+    ep_bulk_in.TransferType   = USB_TRANSFER_TYPE_BULK;
+    cdc_init_data.EPIn        = USBD_AddEPEx(&ep_bulk_in, NULL, 0);
+
+    ep_bulk_out.Flags         = 0;
+    ep_bulk_out.InDir         = USB_DIR_OUT;
+    ep_bulk_out.Interval      = 0;
+    ep_bulk_out.MaxPacketSize = USB_FS_BULK_MAX_PACKET_SIZE;
+    ep_bulk_out.TransferType  = USB_TRANSFER_TYPE_BULK;
+    cdc_init_data.EPOut       = USBD_AddEPEx(&ep_bulk_out, usb_out_buffer, sizeof(usb_out_buffer));
+
+    ep_int_in.Flags           = 0;
+    ep_int_in.InDir           = USB_DIR_IN;
+    ep_int_in.Interval        = USB_INT_INTERVAL;
+    ep_int_in.MaxPacketSize   = USB_FS_INT_MAX_PACKET_SIZE;
+    ep_int_in.TransferType    = USB_TRANSFER_TYPE_INT;
+    cdc_init_data.EPInt       = USBD_AddEPEx(&ep_int_in, NULL, 0);
+
+    usb_obj.handle = USBD_CDC_Add(&cdc_init_data);
+
+    USBD_SetDeviceInfo(&usb_device_info);
+    USBD_Start();
+
+    /* Wait for the host to enumerate the device */
+    while ((USBD_GetState() & (USB_STAT_CONFIGURED | USB_STAT_SUSPENDED)) != USB_STAT_CONFIGURED)
+    {
+        cyhal_system_delay_ms(USB_ENUMERATION_POLL_MS);
+    }
+
+    result = mtb_data_streaming_setup_usb(&usb_obj, mtb_data_streaming_xfer_done, stream);
+    HALT_ON_ERROR(result);
+}
+
+/*******************************************************************************
+* Function Name: streaming_read_byte
+********************************************************************************
+* Summary:
+*  Reads one byte received on the OUT endpoint, if any.
+*
+*******************************************************************************/
+static bool streaming_read_byte(uint8_t* byte)
+{
+    if (0u == USBD_CDC_GetNumBytesInBuffer(usb_obj.handle))
+    {
+        return false;
+    }
+
+    return (1 == USBD_CDC_Read(usb_obj.handle, byte, 1u, 0));
+}
+
+#elif defined(STREAM_SPI_SLAVE)
+
+#include "mtb_data_streaming_spi_slave.h"
+
+/* The host bridge is connected to the SPI pins of the Arduino header, which
+ * the SPI IMU shields also use */
+#define SPI_SLAVE_MOSI              CYBSP_SPI_MOSI
+#define SPI_SLAVE_MISO              CYBSP_SPI_MISO
+#define SPI_SLAVE_CLK               CYBSP_SPI_CLK
+#define SPI_SLAVE_CS                CYBSP_SPI_CS
+#define SPI_SLAVE_BITS              (8u)
+/* The ring holds the data while the host is not reading. Each transaction of
+ * the host is SPI_SLAVE_FRAME_SIZE bytes long (host/spi_receive -f). */
+#define SPI_SLAVE_BUFFER_SIZE       (16u * 1024u)
+#define SPI_SLAVE_RX_BUFFER_SIZE    (256u)
+#define SPI_SLAVE_FRAME_SIZE        (1024u)
+
+static cyhal_spi_t spi_slave;
+static mtb_data_streaming_spi_slave_t spi_slave_obj;
+static uint8_t spi_slave_buffer[SPI_SLAVE_BUFFER_SIZE];
+static uint8_t spi_slave_rx_buffer[SPI_SLAVE_RX_BUFFER_SIZE];
+static uint8_t spi_slave_frame[SPI_SLAVE_FRAME_SIZE];
+static uint8_t spi_slave_rx_frame[SPI_SLAVE_FRAME_SIZE];
+
+/*******************************************************************************
+* Function Name: streaming_transport_init
+********************************************************************************
+* Summary:
+*  If STREAM_TRANSPORT=SPI_SLAVE is selected in the makefile then this function
+*  initializes the SPI block as a slave. An external host bridge clocks the
+*  data out of a ring buffer in frames, transferred by DMA, and sends its
+*  commands in the same transactions.
+*
+* Parameters:
+*  stream: Pass in the stream object
+*
+*******************************************************************************/
+static void streaming_transport_init(mtb_data_streaming_interface_t* stream)
+{
+    cy_rslt_t result;
+
+    result = cyhal_spi_init(&spi_slave, SPI_SLAVE_MOSI, SPI_SLAVE_MISO, SPI_SLAVE_CLK, SPI_SLAVE_CS,
+                            NULL, SPI_SLAVE_BITS, CYHAL_SPI_MODE_00_MSB, true);
+    HALT_ON_ERROR(result);
+
+    spi_slave_obj.spi = &spi_slave;
+    spi_slave_obj.buffer = spi_slave_buffer;
+    spi_slave_obj.buffer_size = SPI_SLAVE_BUFFER_SIZE;
+    spi_slave_obj.rx_buffer = spi_slave_rx_buffer;
+    spi_slave_obj.rx_buffer_size = SPI_SLAVE_RX_BUFFER_SIZE;
+    spi_slave_obj.frame = spi_slave_frame;
+    spi_slave_obj.rx_frame = spi_slave_rx_frame;
+    spi_slave_obj.frame_size = SPI_SLAVE_FRAME_SIZE;
+
+    result = mtb_data_streaming_setup_spi_slave(&spi_slave_obj, mtb_data_streaming_xfer_done,
+                                                stream);
+    HALT_ON_ERROR(result);
+}
+
+/*******************************************************************************
+* Function Name: streaming_read_byte
+********************************************************************************
+* Summary:
+*  Reads one byte sent by the host bridge, if any.
+*
+*******************************************************************************/
+static bool streaming_read_byte(uint8_t* byte)
+{
+    return (1u == mtb_data_streaming_spi_slave_read(&spi_slave_obj, byte, 1u));
 }
 
+#elif defined(STREAM_LOG)
+
+#include "sd_card.h"
+#include "mtb_data_streaming_log.h"
+
+/* Records are gathered in RAM and written to the SD card in large writes. The
+ * buffer is aligned so that the SDHC DMA can use it directly. */
+#define LOG_BUFFER_SIZE             (16u * 1024u)
+#define LOG_INDEX_BUFFER_SIZE       (512u)
+/* The index is updated every LOG_INDEX_INTERVAL buffer writes, and by
+ * streaming_flush. Between two updates, up to LOG_INDEX_INTERVAL *
+ * LOG_BUFFER_SIZE bytes written to the card plus the LOG_BUFFER_SIZE bytes
+ * still in RAM (144 KB) are lost on a power failure. */
+#define LOG_INDEX_INTERVAL          (8u)
+
+static mtb_data_streaming_blockdev_t sd_card_obj;
+static mtb_data_streaming_log_t log_obj;
+CY_ALIGN(32) static uint8_t log_buffer[LOG_BUFFER_SIZE];
+CY_ALIGN(32) static uint8_t log_index_buffer[LOG_INDEX_BUFFER_SIZE];
+
+/*******************************************************************************
+* Function Name: streaming_transport_init
+********************************************************************************
+* Summary:
+*  If STREAM_TRANSPORT=SD_CARD is selected in the makefile then this function
+*  initializes the microSD card and starts a new session of the log the data
+*  is written to. The sessions are read back on the PC with host/log_dump.
+*
+* Parameters:
+*  stream: Pass in the stream object
+*
+*******************************************************************************/
+static void streaming_transport_init(mtb_data_streaming_interface_t* stream)
+{
+    cy_rslt_t result;
+
+    result = sd_card_init(&sd_card_obj);
+    HALT_ON_ERROR(result);
+
+    log_obj.blockdev = &sd_card_obj;
+    log_obj.buffer = log_buffer;
+    log_obj.buffer_size = LOG_BUFFER_SIZE;
+    log_obj.index_buffer = log_index_buffer;
+    log_obj.index_interval = LOG_INDEX_INTERVAL;
+
+    result = mtb_data_streaming_setup_log(&log_obj, mtb_data_streaming_xfer_done, stream);
+    HALT_ON_ERROR(result);
+}
+
+/*******************************************************************************
+* Function Name: streaming_read_byte
+********************************************************************************
+* Summary:
+*  Nothing is received from a log.
+*
+*******************************************************************************/
+static bool streaming_read_byte(uint8_t* byte)
+{
+    CY_UNUSED_PARAMETER(byte);
+    return false;
+}
+
+#else /* defined(STREAM_USB) */
+
 #include "cyhal_uart.h"
 
 #if COLLECTION_MODE_SELECT == IMU_COLLECTION
@@ -62,10 +677,17 @@ static void mtb_data_streaming_xfer_done(const void* tag, cy_rslt_t result)
 #else
 #define UART_BAUD_RATE              (1000000u)
 #endif
-#define RX_BUF_SIZE                 (4u)
+/* Holds the bytes received between two chunks of the continuous receive */
+#define RX_BUF_SIZE                 (64u)
+/* Ring of the continuous receive, read in MTB_DATA_STREAMING_UART_RX_CHUNKS
+ * chunks */
+#define RX_RING_SIZE                (1024u)
 
 static cyhal_uart_t uart_obj;
 static uint8_t      uart_rx_buffer[RX_BUF_SIZE];
+static uint8_t      uart_rx_ring[RX_RING_SIZE];
+static mtb_data_streaming_uart_rx_t uart_rx;
+static mtb_data_streaming_interface_t* uart_stream;
 
 cyhal_uart_t* get_uart()
 {
@@ -73,17 +695,18 @@ cyhal_uart_t* get_uart()
 }
 
 /*******************************************************************************
-* Function Name: streaming_init
+* Function Name: streaming_transport_init
 ********************************************************************************
 * Summary:
-*  If UART_STREAM is selected in the makefile then this function initializes
-*  the UART as the streamer to collect data.
+*  If STREAM_TRANSPORT=UART is selected in the makefile then this function
+*  initializes the UART as the streamer to collect data, and starts the
+*  continuous receive of the host commands.
 *
 * Parameters:
 *  stream: Pass in the stream object
 *
 *******************************************************************************/
-void streaming_init(mtb_data_streaming_interface_t* stream)
+static void streaming_transport_init(mtb_data_streaming_interface_t* stream)
 {
     cy_rslt_t result;
 
@@ -104,5 +727,53 @@ void streaming_init(mtb_data_streaming_interface_t* stream)
     HALT_ON_ERROR(result);
     result = mtb_data_streaming_setup_uart(&uart_obj, mtb_data_streaming_xfer_done, stream);
     HALT_ON_ERROR(result);
+
+    uart_rx.buffer = uart_rx_ring;
+    uart_rx.buffer_size = RX_RING_SIZE;
+    result = mtb_data_streaming_uart_rx_start(stream, &uart_rx);
+    HALT_ON_ERROR(result);
+    uart_stream = stream;
 }
 
+/*******************************************************************************
+* Function Name: streaming_read_byte
+********************************************************************************
+* Summary:
+*  Reads one byte from the continuous receive ring, if any.
+*
+*******************************************************************************/
+static bool streaming_read_byte(uint8_t* byte)
+{
+    if (0u == mtb_data_streaming_uart_rx_peek(uart_stream, byte, 1u))
+    {
+        return false;
+    }
+
+    mtb_data_streaming_uart_rx_consume(uart_stream, 1u);
+    return true;
+}
+
+#endif /* defined(STREAM_USB) */
+
+/*******************************************************************************
+* Function Name: streaming_flush
+********************************************************************************
+* Summary:
+*  If STREAM_TRANSPORT=SD_CARD is selected in the makefile, writes the
+*  records buffered in RAM to the microSD card and updates the index, so that
+*  all the data sent so far is kept on a power failure, and is not
+*  overwritten by the session of the next reset. Does nothing if no data was
+*  sent since the last flush, or for the other transports.
+*
+*******************************************************************************/
+void streaming_flush(void)
+{
+#if defined(STREAM_LOG)
+    /* A flush that failed is tried again on the next call */
+    if ((true == streaming_unflushed) &&
+        (CY_RSLT_SUCCESS == mtb_data_streaming_log_flush(&log_obj)))
+    {
+        streaming_unflushed = false;
+    }
+#endif
+}
@@ -39,11 +39,23 @@
 #include "cy_result.h"
 #include "cy_utils.h"
 #include "mtb_data_streaming.h"
+#include "host_command.h"
 
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
 void streaming_init(mtb_data_streaming_interface_t* stream);
+cy_rslt_t streaming_send(mtb_data_streaming_interface_t* stream, uint8_t* data, size_t count);
+cy_rslt_t streaming_sendv(mtb_data_streaming_interface_t* stream,
+                          const mtb_data_streaming_segment_t* segments, size_t count);
+bool streaming_ready(void);
+bool streaming_can_send(size_t count);
+void streaming_grant(uint32_t limit);
+void streaming_credit_reset(void);
+void streaming_process(mtb_data_streaming_interface_t* stream);
+void streaming_nack(uint16_t sequence);
+bool streaming_receive_command(host_command_t* command);
+void streaming_flush(void);
 
 static inline void HALT_ON_ERROR(cy_rslt_t result)
 {
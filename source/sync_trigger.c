@@ -0,0 +1,151 @@
+/******************************************************************************
+* File Name:   sync_trigger.c
+*
+* Description: This file latches the edges of the sync line shared by the
+*   boards of a synchronized capture. The interrupt of the sync input takes
+*   the time of each edge, so the edges are placed to the microsecond, well
+*   within a sample period of any channel, and they are reported from the
+*   main loop in trigger records. The edges are driven by the master board at
+*   a fixed interval of its clock, so the host can convert the timestamps of
+*   every board to the time of the master. This file does not access the
+*   hardware, so it can be driven by simulated edges on the host.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "config.h"
+#include "sync_trigger.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Edges latched and not reported yet, a power of two. Edges latched while
+ * the queue is full are counted but not reported. */
+#define SYNC_TRIGGER_QUEUE_SIZE     (8u)
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+static volatile uint32_t sync_trigger_time[SYNC_TRIGGER_QUEUE_SIZE];
+static volatile uint32_t sync_trigger_edge_number[SYNC_TRIGGER_QUEUE_SIZE];
+/* Edges latched, written by the interrupt only */
+static volatile uint32_t sync_trigger_count;
+/* Entries of the queue written by the interrupt and read by the main loop */
+static volatile uint32_t sync_trigger_head;
+static volatile uint32_t sync_trigger_tail;
+
+/*******************************************************************************
+* Function Name: sync_trigger_init
+********************************************************************************
+* Summary:
+*   Forgets the edges latched.
+*
+*******************************************************************************/
+void sync_trigger_init(void)
+{
+    sync_trigger_count = 0;
+    sync_trigger_head = 0;
+    sync_trigger_tail = 0;
+}
+
+/*******************************************************************************
+* Function Name: sync_trigger_edge
+********************************************************************************
+* Summary:
+*   Latches an edge of the sync line. Called from the interrupt of the sync
+*   input, as early as possible.
+*
+* Parameters:
+*   time: device time of the edge in microseconds
+*
+*******************************************************************************/
+void sync_trigger_edge(uint32_t time)
+{
+    uint32_t head = sync_trigger_head;
+
+    if ((head - sync_trigger_tail) < SYNC_TRIGGER_QUEUE_SIZE)
+    {
+        sync_trigger_time[head % SYNC_TRIGGER_QUEUE_SIZE] = time;
+        sync_trigger_edge_number[head % SYNC_TRIGGER_QUEUE_SIZE] = sync_trigger_count;
+        sync_trigger_head = head + 1u;
+    }
+    sync_trigger_count++;
+}
+
+/*******************************************************************************
+* Function Name: sync_trigger_pop
+********************************************************************************
+* Summary:
+*   Takes the oldest edge not reported yet.
+*
+* Parameters:
+*   trigger: receives the edge
+*
+* Return:
+*   true if an edge was taken.
+*
+*******************************************************************************/
+bool sync_trigger_pop(stream_trigger_t *trigger)
+{
+    uint32_t tail = sync_trigger_tail;
+
+    if (tail == sync_trigger_head)
+    {
+        return false;
+    }
+
+    trigger->edge = sync_trigger_edge_number[tail % SYNC_TRIGGER_QUEUE_SIZE];
+    trigger->time = sync_trigger_time[tail % SYNC_TRIGGER_QUEUE_SIZE];
+    trigger->period = SYNC_TRIGGER_PERIOD_MS * 1000u;
+    sync_trigger_tail = tail + 1u;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: sync_trigger_edges
+********************************************************************************
+* Summary:
+*   Returns the number of edges latched, the collection is started once it is
+*   not 0.
+*
+*******************************************************************************/
+uint32_t sync_trigger_edges(void)
+{
+    return sync_trigger_count;
+}
+
+/* [] END OF FILE */
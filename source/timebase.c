@@ -0,0 +1,161 @@
+/******************************************************************************
+* File Name:   timebase.c
+*
+* Description: This file implements a free running microsecond time base used
+*              to timestamp the streamed records.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cyhal.h"
+#include "cybsp.h"
+
+#include "timebase.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* The counter runs at 1 MHz and wraps every 50 ms, so any TCPWM counter width
+ * can be used. Completed periods are accumulated in software. */
+#define TIMEBASE_FREQUENCY          (1000000u)
+#define TIMEBASE_PERIOD             (50000u)
+/* Higher than the sensor interrupts so that readers in their handlers always
+ * see the period accumulated */
+#define TIMEBASE_PRIORITY           (1u)
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+static cyhal_timer_t timebase_timer;
+/* Microseconds elapsed at the start of the current period */
+static volatile uint32_t timebase_epoch_us;
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static void timebase_interrupt_handler(void *callback_arg, cyhal_timer_event_t event);
+
+/*******************************************************************************
+* Function Name: timebase_init
+********************************************************************************
+* Summary:
+*   Starts the timer used as the time base.
+*
+* Returns:
+*   The status of the initialization.
+*
+*******************************************************************************/
+cy_rslt_t timebase_init(void)
+{
+    cy_rslt_t rslt;
+    const cyhal_timer_cfg_t timer_cfg =
+    {
+        .compare_value = 0,                 /* Timer compare value, not used */
+        .period = TIMEBASE_PERIOD,          /* Defines the timer period */
+        .direction = CYHAL_TIMER_DIR_UP,    /* Timer counts up */
+        .is_compare = false,                /* Don't use compare mode */
+        .is_continuous = true,              /* Run the timer indefinitely */
+        .value = 0                          /* Initial value of counter */
+    };
+
+    timebase_epoch_us = 0;
+
+    rslt = cyhal_timer_init(&timebase_timer, NC, NULL);
+    if (CY_RSLT_SUCCESS != rslt)
+    {
+        return rslt;
+    }
+
+    rslt = cyhal_timer_configure(&timebase_timer, &timer_cfg);
+    if (CY_RSLT_SUCCESS != rslt)
+    {
+        return rslt;
+    }
+
+    rslt = cyhal_timer_set_frequency(&timebase_timer, TIMEBASE_FREQUENCY);
+    if (CY_RSLT_SUCCESS != rslt)
+    {
+        return rslt;
+    }
+
+    cyhal_timer_register_callback(&timebase_timer, timebase_interrupt_handler, NULL);
+    cyhal_timer_enable_event(&timebase_timer, CYHAL_TIMER_IRQ_TERMINAL_COUNT, TIMEBASE_PRIORITY, true);
+
+    return cyhal_timer_start(&timebase_timer);
+}
+
+/*******************************************************************************
+* Function Name: timebase_now_us
+********************************************************************************
+* Summary:
+*   Returns the time since timebase_init in microseconds. The value wraps
+*   around after about 71 minutes. Can be called from interrupt context.
+*
+* Returns:
+*   The current time in microseconds.
+*
+*******************************************************************************/
+uint32_t timebase_now_us(void)
+{
+    uint32_t epoch;
+    uint32_t count;
+
+    /* Retry if the period elapsed while reading */
+    do
+    {
+        epoch = timebase_epoch_us;
+        count = cyhal_timer_read(&timebase_timer);
+    } while (epoch != timebase_epoch_us);
+
+    return epoch + count;
+}
+
+/*******************************************************************************
+* Function Name: timebase_interrupt_handler
+********************************************************************************
+* Summary:
+*   Accumulates the elapsed periods.
+*
+*******************************************************************************/
+static void timebase_interrupt_handler(void *callback_arg, cyhal_timer_event_t event)
+{
+    (void) callback_arg;
+    (void) event;
+
+    timebase_epoch_us += TIMEBASE_PERIOD;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,268 @@
+/******************************************************************************
+* File Name:   vad.c
+*
+* Description: This file implements an energy and zero crossing based sound
+*              activity detector used to skip the silent PDM frames, with
+*              pre-roll and post-roll frames around each activity.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "vad.h"
+#include "dsp.h"
+
+/******************************************************************************
+ * Macros
+ *****************************************************************************/
+/* Noise floor adaptation weight is 1 / 2^shift per frame. The floor follows
+ * quieter frames immediately, and louder ones slowly (even slower during
+ * activity so that long sounds are not absorbed into the floor). */
+#define VAD_NOISE_ADAPT_SHIFT       (4)
+#define VAD_NOISE_ADAPT_ACTIVE_SHIFT (9)
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+/* Detector state */
+static int32_t vad_noise_floor;
+static bool vad_floor_valid;
+static bool vad_active;
+
+/* Gate state */
+static bool vad_sending;
+static uint32_t vad_postroll_left;
+static uint32_t vad_skipped_frames;
+
+/* Most recent silent frames, oldest at vad_preroll_head */
+#if AUDIO_VAD_PREROLL_FRAMES > 0
+static int16_t vad_preroll[AUDIO_VAD_PREROLL_FRAMES][AUDIO_DATA_SIZE];
+static uint32_t vad_preroll_timestamp[AUDIO_VAD_PREROLL_FRAMES];
+#endif
+static uint32_t vad_preroll_head;
+static uint32_t vad_preroll_count;
+
+/*******************************************************************************
+* Function Name: vad_init
+********************************************************************************
+* Summary:
+*    Resets the detector and gate state.
+*
+*******************************************************************************/
+void vad_init(void)
+{
+    vad_noise_floor = 0;
+    vad_floor_valid = false;
+    vad_active = false;
+
+    vad_sending = false;
+    vad_postroll_left = 0;
+    vad_skipped_frames = 0;
+    vad_preroll_head = 0;
+    vad_preroll_count = 0;
+}
+
+/*******************************************************************************
+* Function Name: vad_detect
+********************************************************************************
+* Summary:
+*    Updates the activity decision with one PCM frame. The frame level is the
+*    log2 of its energy after removing the DC offset, compared with
+*    hysteresis to a tracked noise floor.
+*
+* Parameters:
+*   pcm: PCM samples
+*   count: number of samples
+*
+* Return:
+*     True while sound activity is detected.
+*
+*******************************************************************************/
+bool vad_detect(const int16_t *pcm, uint32_t count)
+{
+    int32_t sum = 0;
+    uint64_t energy = 0;
+    uint32_t crossings = 0;
+    int32_t level;
+
+    for (uint32_t index = 0; index < count; index++)
+    {
+        sum += pcm[index];
+    }
+    int32_t mean = sum / (int32_t)count;
+
+    bool negative = (pcm[0] < mean);
+    for (uint32_t index = 0; index < count; index++)
+    {
+        int32_t sample = pcm[index] - mean;
+
+        energy += (uint64_t)((int64_t)sample * sample);
+        if ((sample < 0) != negative)
+        {
+            negative = !negative;
+            crossings++;
+        }
+    }
+
+    /* log2 of the mean energy in Q8 */
+    level = dsp_log2_q16((energy / count) + 1u) >> 8;
+
+    if (false == vad_floor_valid)
+    {
+        vad_noise_floor = level;
+        vad_floor_valid = true;
+    }
+
+    if (false == vad_active)
+    {
+        vad_active = (level > vad_noise_floor + AUDIO_VAD_ON_THRESHOLD) ||
+                     ((level > vad_noise_floor + AUDIO_VAD_OFF_THRESHOLD) &&
+                      (crossings >= AUDIO_VAD_ZCR_THRESHOLD));
+    }
+    else
+    {
+        vad_active = (level > vad_noise_floor + AUDIO_VAD_OFF_THRESHOLD);
+    }
+
+    if (level < vad_noise_floor)
+    {
+        vad_noise_floor = level;
+    }
+    else
+    {
+        vad_noise_floor += (level - vad_noise_floor) >>
+            (vad_active ? VAD_NOISE_ADAPT_ACTIVE_SHIFT : VAD_NOISE_ADAPT_SHIFT);
+    }
+
+    return vad_active;
+}
+
+/*******************************************************************************
+* Function Name: vad_gate
+********************************************************************************
+* Summary:
+*    Decides whether the current PDM frame is transmitted and writes the
+*    records to send. When an activity starts, a gap record with the number
+*    of samples skipped is written first, followed by the pre-roll frames.
+*    Frames keep being sent for AUDIO_VAD_POSTROLL_FRAMES after the activity
+*    stops.
+*
+* Parameters:
+*   pcm: FRAME_SIZE PCM samples of the frame, used for the detection
+*   data: AUDIO_DATA_SIZE values to transmit for this frame
+*   timestamp: device time of the frame in microseconds
+*   output: receives up to VAD_BUFFER_SIZE bytes of records
+*
+* Return:
+*     The number of bytes written to output, 0 if the frame is skipped.
+*
+*******************************************************************************/
+uint32_t vad_gate(const int16_t *pcm, const int16_t *data, uint32_t timestamp, uint8_t *output)
+{
+    uint32_t size = 0;
+
+    if (true == vad_detect(pcm, FRAME_SIZE))
+    {
+        vad_postroll_left = AUDIO_VAD_POSTROLL_FRAMES;
+    }
+    else if (vad_postroll_left > 0u)
+    {
+        vad_postroll_left--;
+    }
+    else
+    {
+        /* Silent frame, keep it for the pre-roll */
+        vad_sending = false;
+        vad_skipped_frames++;
+#if AUDIO_VAD_PREROLL_FRAMES > 0
+        uint32_t slot = (vad_preroll_head + vad_preroll_count) % AUDIO_VAD_PREROLL_FRAMES;
+        memcpy(vad_preroll[slot], data, sizeof(vad_preroll[slot]));
+        vad_preroll_timestamp[slot] = timestamp;
+        if (vad_preroll_count < AUDIO_VAD_PREROLL_FRAMES)
+        {
+            vad_preroll_count++;
+        }
+        else
+        {
+            vad_preroll_head = (vad_preroll_head + 1u) % AUDIO_VAD_PREROLL_FRAMES;
+        }
+#endif
+        return 0;
+    }
+
+    if (false == vad_sending)
+    {
+        uint32_t skipped = vad_skipped_frames - vad_preroll_count;
+
+        /* The gap ends where the first transmitted frame starts */
+        if (skipped > 0u)
+        {
+            uint32_t gap_end = timestamp;
+#if AUDIO_VAD_PREROLL_FRAMES > 0
+            if (vad_preroll_count > 0u)
+            {
+                gap_end = vad_preroll_timestamp[vad_preroll_head];
+            }
+#endif
+            skipped *= FRAME_SIZE;
+            size += stream_record_write(&output[size], STREAM_RECORD_GAP, STREAM_CHANNEL_PDM,
+                                        &skipped, sizeof(skipped), gap_end);
+        }
+
+#if AUDIO_VAD_PREROLL_FRAMES > 0
+        for (uint32_t index = 0; index < vad_preroll_count; index++)
+        {
+            uint32_t slot = (vad_preroll_head + index) % AUDIO_VAD_PREROLL_FRAMES;
+            size += stream_record_write(&output[size], STREAM_RECORD_DATA, STREAM_CHANNEL_PDM,
+                                        vad_preroll[slot], sizeof(vad_preroll[slot]),
+                                        vad_preroll_timestamp[slot]);
+        }
+#endif
+
+        vad_preroll_head = 0;
+        vad_preroll_count = 0;
+        vad_skipped_frames = 0;
+        vad_sending = true;
+    }
+
+    size += stream_record_write(&output[size], STREAM_RECORD_DATA, STREAM_CHANNEL_PDM,
+                                data, 2 * AUDIO_DATA_SIZE, timestamp);
+
+    return size;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,72 @@
+/******************************************************************************
+* File Name:   vad.h
+*
+* Description: This file contains the function prototypes and constants used
+*   in vad.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SOURCE_VAD_H_
+#define SOURCE_VAD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_features.h"
+#include "config.h"
+#include "stream_record.h"
+
+/******************************************************************************
+ * Constants
+ *****************************************************************************/
+/* Size of one data record of the PDM channel */
+#define VAD_DATA_RECORD_SIZE        (STREAM_RECORD_HEADER_SIZE + 2 * AUDIO_DATA_SIZE)
+
+/* Largest output of vad_gate: a gap record, the pre-roll frames and the
+ * current frame */
+#define VAD_BUFFER_SIZE             (STREAM_RECORD_HEADER_SIZE + sizeof(uint32_t) + \
+                                     (AUDIO_VAD_PREROLL_FRAMES + 1) * VAD_DATA_RECORD_SIZE)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void vad_init(void);
+bool vad_detect(const int16_t *pcm, uint32_t count);
+uint32_t vad_gate(const int16_t *pcm, const int16_t *data, uint32_t timestamp, uint8_t *output);
+
+
+#endif /* SOURCE_VAD_H_ */